@@ -0,0 +1,230 @@
+#include "Bench.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifndef RADCAT_VERSION
+#define RADCAT_VERSION "unknown"
+#endif
+
+namespace Bench {
+
+    std::vector<Case>& cases() {
+        static std::vector<Case> instance;
+        return instance;
+    }
+
+    namespace {
+        std::mutex checkMutex;
+        std::vector<std::string> failedChecks; // Since the last takeFailedChecks()
+    }
+
+    void check(bool condition, const char* what) {
+        if (condition) return;
+        std::lock_guard<std::mutex> lk(checkMutex);
+        if (std::find(failedChecks.begin(), failedChecks.end(), what) == failedChecks.end()) failedChecks.emplace_back(what);
+    }
+
+    std::vector<std::string> takeFailedChecks() {
+        std::lock_guard<std::mutex> lk(checkMutex);
+        return std::exchange(failedChecks, {});
+    }
+
+    double Runner::timeOnce(const Case& c, uint64_t iterations) {
+        State state(iterations);
+        state.resumeTiming();
+        c.body(state);
+        if (state.running) state.pauseTiming();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(state.paused).count());
+    }
+
+    Result Runner::run(const Case& c) const {
+        const double minNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(minTime).count());
+
+        // Grow the iteration count until a single run is long enough to time reliably
+        uint64_t iterations = 1;
+        for (;;) {
+            double ns = timeOnce(c, iterations);
+            if (ns >= minNs || iterations >= (1ull << 40)) break;
+            double factor = ns > 0.0 ? std::clamp(minNs * 1.2 / ns, 2.0, 100.0) : 100.0;
+            iterations = static_cast<uint64_t>(std::ceil(static_cast<double>(iterations) * factor));
+        }
+
+        std::vector<double> perOp;
+        for (int r = 0; r < std::max(1, repetitions); ++r) perOp.push_back(timeOnce(c, iterations) / static_cast<double>(iterations));
+
+        Result res;
+        res.name = c.name;
+        res.iterations = iterations;
+        res.repetitions = static_cast<int>(perOp.size());
+        std::vector<double> sorted = perOp;
+        std::sort(sorted.begin(), sorted.end());
+        res.nsPerOp = sorted.size() % 2 ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0;
+        res.nsMin = sorted.front();
+        res.nsMax = sorted.back();
+        double mean = 0.0;
+        for (double v : perOp) mean += v;
+        mean /= static_cast<double>(perOp.size());
+        double sq = 0.0;
+        for (double v : perOp) sq += (v - mean) * (v - mean);
+        res.nsStdDev = perOp.size() > 1 ? std::sqrt(sq / static_cast<double>(perOp.size() - 1)) : 0.0;
+        res.itemsPerSecond = res.nsPerOp > 0.0 ? static_cast<double>(c.itemsPerIteration) * 1e9 / res.nsPerOp : 0.0;
+        return res;
+    }
+}
+
+namespace {
+
+    std::string jsonEscape(const std::string& s) {
+        std::string out;
+        for (char ch : s) {
+            if (ch == '"' || ch == '\\') { out += '\\'; out += ch; }
+            else if (static_cast<unsigned char>(ch) < 0x20) { char buf[8]; std::snprintf(buf, sizeof(buf), "\\u%04x", ch); out += buf; }
+            else out += ch;
+        }
+        return out;
+    }
+
+    std::string compilerName() {
+    #if defined(__clang__)
+        return "clang " __clang_version__;
+    #elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+    #elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+    #else
+        return "unknown";
+    #endif
+    }
+
+    // One benchmark object per line, so --compare can read the file back without a JSON library.
+    bool writeJson(const std::string& path, const std::vector<Bench::Result>& results, const Bench::Runner& runner) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    #ifdef NDEBUG
+        const char* buildType = "release";
+    #else
+        const char* buildType = "debug";
+    #endif
+
+        out << "{\n  \"context\": {"
+            << "\"date\": \"" << date << "\", "
+            << "\"radcat_version\": \"" << RADCAT_VERSION << "\", "
+            << "\"compiler\": \"" << jsonEscape(compilerName()) << "\", "
+            << "\"build_type\": \"" << buildType << "\", "
+            << "\"cpus\": " << std::thread::hardware_concurrency() << ", "
+            << "\"min_time_ms\": " << runner.minTime.count() << ", "
+            << "\"repetitions\": " << runner.repetitions << "},\n"
+            << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Bench::Result& r = results[i];
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                "    {\"name\": \"%s\", \"iterations\": %llu, \"repetitions\": %d, \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"ns_per_op_max\": %.3f, \"ns_per_op_stddev\": %.3f, \"items_per_second\": %.1f}%s\n",
+                jsonEscape(r.name).c_str(), static_cast<unsigned long long>(r.iterations), r.repetitions,
+                r.nsPerOp, r.nsMin, r.nsMax, r.nsStdDev, r.itemsPerSecond, i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    // name -> ns_per_op of a file written by writeJson
+    std::map<std::string, double> readBaseline(const std::string& path) {
+        std::map<std::string, double> base;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t n = line.find("\"name\": \"");
+            size_t v = line.find("\"ns_per_op\": ");
+            if (n == std::string::npos || v == std::string::npos) continue;
+            n += 9;
+            size_t end = line.find('"', n);
+            if (end == std::string::npos) continue;
+            base[line.substr(n, end - n)] = std::atof(line.c_str() + v + 13);
+        }
+        return base;
+    }
+
+    void printUsage() {
+        std::cout << "RadCatBench [options]\n"
+                  << "  --filter <text>      Only run cases whose name contains text\n"
+                  << "  --list               List the cases and exit\n"
+                  << "  --min-time <ms>      Minimum duration of one timed run (default 50)\n"
+                  << "  --repetitions <n>    Timed runs per case, the median is reported (default 5)\n"
+                  << "  --json <path>        Write the results as JSON\n"
+                  << "  --compare <path>     Compare against an earlier --json file, exit 1 on regressions\n"
+                  << "  --threshold <pct>    Slowdown that counts as a regression (default 10)\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Runner runner;
+    std::string filter, jsonPath, comparePath;
+    double threshold = 10.0;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+        if (arg == "--filter") filter = next();
+        else if (arg == "--list") listOnly = true;
+        else if (arg == "--min-time") runner.minTime = std::chrono::milliseconds(std::atoi(next().c_str()));
+        else if (arg == "--repetitions") runner.repetitions = std::atoi(next().c_str());
+        else if (arg == "--json") jsonPath = next();
+        else if (arg == "--compare") comparePath = next();
+        else if (arg == "--threshold") threshold = std::atof(next().c_str());
+        else { printUsage(); return arg == "--help" || arg == "-h" ? 0 : 2; }
+    }
+
+    // Keep the log quiet, the logging cases pick their own levels
+    AsyncLogger::Instance().setConsoleOutput(false);
+    LogControl::configure("*=1");
+
+    std::vector<Bench::Case> selected;
+    for (const Bench::Case& c : Bench::cases())
+        if (filter.empty() || c.name.find(filter) != std::string::npos) selected.push_back(c);
+    std::sort(selected.begin(), selected.end(), [](const Bench::Case& a, const Bench::Case& b) { return a.name < b.name; });
+
+    if (listOnly) { for (const Bench::Case& c : selected) std::cout << c.name << "\n"; return 0; }
+
+    const std::map<std::string, double> baseline = comparePath.empty() ? std::map<std::string, double>{} : readBaseline(comparePath);
+    if (!comparePath.empty() && baseline.empty()) std::cerr << "No results found in " << comparePath << "\n";
+
+    std::vector<Bench::Result> results;
+    int regressions = 0;
+    int failedChecks = 0;
+    std::printf("%-48s %14s %12s %10s %16s\n", "case", "iterations", "ns/op", "stddev", "items/s");
+    for (const Bench::Case& c : selected) {
+        Bench::Result r = runner.run(c);
+        std::printf("%-48s %14llu %12.2f %10.2f %16.0f", r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.nsPerOp, r.nsStdDev, r.itemsPerSecond);
+        auto it = baseline.find(r.name);
+        if (it != baseline.end() && it->second > 0.0) {
+            double change = (r.nsPerOp - it->second) / it->second * 100.0;
+            std::printf("  %+6.1f%%", change);
+            if (change > threshold) { std::printf("  REGRESSION"); regressions++; }
+        }
+        std::printf("\n");
+        for (const std::string& what : Bench::takeFailedChecks()) { std::printf("  CHECK FAILED: %s\n", what.c_str()); failedChecks++; }
+        std::fflush(stdout);
+        results.push_back(std::move(r));
+    }
+
+    if (!jsonPath.empty() && !writeJson(jsonPath, results, runner)) { std::cerr << "Could not write " << jsonPath << "\n"; return 2; }
+    if (failedChecks) { std::cerr << failedChecks << " check(s) failed\n"; return 1; }
+    if (regressions) { std::cerr << regressions << " case(s) slower than the baseline by more than " << threshold << "%\n"; return 1; }
+    return 0;
+}
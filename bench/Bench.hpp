@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal microbenchmark harness for the hardware-free parts of RadCat (RadCatBench target).
+//
+// A case is a body that runs its operation state.iterations times. The runner grows the iteration count
+// until one run takes at least --min-time, then repeats it --repetitions times and reports ns per operation.
+// Results can be written as JSON (--json) and compared against an earlier file (--compare) to catch regressions.
+//
+// Registration (same pattern as REGISTER_DEVICE), placed in any bench/*.cpp:
+//   static inline bool registered = [](){
+//       Bench::add("ring/push_pop", [](Bench::State& s) { for (uint64_t i = 0; i < s.iterations; ++i) { ... } });
+//       return true;
+//   }();
+namespace Bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    class State {
+    public:
+        explicit State(uint64_t n) : iterations(n) {}
+        const uint64_t iterations;
+
+        // Excludes setup or cleanup inside the body from the measurement.
+        void pauseTiming() { paused += Clock::now() - resumed; running = false; }
+        void resumeTiming() { resumed = Clock::now(); running = true; }
+
+    private:
+        friend class Runner;
+        Clock::time_point resumed = Clock::now();
+        Clock::duration paused{0};
+        bool running = true;
+    };
+
+    struct Case {
+        std::string name;
+        std::function<void(State&)> body;
+        uint64_t itemsPerIteration = 1; // Scales items_per_second (bytes, samples, devices per operation)
+    };
+
+    std::vector<Case>& cases();
+    inline void add(std::string name, std::function<void(State&)> body, uint64_t itemsPerIteration = 1) {
+        cases().push_back({ std::move(name), std::move(body), itemsPerIteration });
+    }
+
+    // Correctness check inside a case body. Failed checks are listed after the case, once each, and make the run exit 1.
+    void check(bool condition, const char* what);
+    std::vector<std::string> takeFailedChecks();
+
+    // Keeps the compiler from discarding a computed value.
+    template<typename T> inline void doNotOptimize(const T& value) {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        static const volatile void* sink;
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    #else
+        asm volatile("" : : "r,m"(value) : "memory");
+    #endif
+    }
+
+    struct Result {
+        std::string name;
+        uint64_t iterations = 0;
+        int repetitions = 0;
+        double nsPerOp = 0.0; // Median over the repetitions
+        double nsMin = 0.0, nsMax = 0.0, nsStdDev = 0.0;
+        double itemsPerSecond = 0.0;
+    };
+
+    class Runner {
+    public:
+        std::chrono::milliseconds minTime{50};
+        int repetitions = 5;
+        Result run(const Case& c) const;
+    private:
+        static double timeOnce(const Case& c, uint64_t iterations); // Nanoseconds, pauses excluded
+    };
+}
@@ -0,0 +1,138 @@
+#include "Bench.hpp"
+#include "DeviceCore.hpp"
+#include "AllComponents.hpp"
+#include "Utils/SchedulerClock.hpp"
+#include <cstdio>
+#include <cstring>
+
+// Device core: registry matching, component lookup and the periodic task scheduler.
+namespace {
+
+    class BenchDevice : public BaseDevice<MCAHistogram, PulseProcessor, FTDIConnection> {
+    public:
+        static inline const DeviceRegistry::RegistryEntry::DeviceInfo deviceInfo = {"Bench Device"};
+        bool connect() override { return true; }
+        bool disconnect() override { return true; }
+        double readValue(const std::string&) override { return 0.0; }
+        bool setValue(const std::string&, double) override { return true; }
+    };
+
+    constexpr uint16_t BenchVid = 0x0403;
+    constexpr int RegisteredTypes = 32;
+
+    // Registered FTDI device types the scanned devices are matched against, on top of the real ones
+    void registerBenchTypes() {
+        static bool done = false;
+        if (done) return;
+        done = true;
+        for (int i = 0; i < RegisteredTypes; ++i) {
+            DeviceRegistry::RegistryEntry entry;
+            entry.creator = [](){ return std::make_unique<BenchDevice>(); };
+            entry.componentTypes = { std::type_index(typeid(FTDIConnection)) };
+            entry.deviceInfo.deviceName = "Bench Type " + std::to_string(i);
+            entry.deviceInfo.vid = BenchVid;
+            entry.deviceInfo.pid = static_cast<uint16_t>(0x7000 + i);
+            entry.deviceInfo.serialNumber = "BT" + std::to_string(i);
+            DeviceRegistry::registry()[entry.deviceInfo.deviceName] = entry;
+        }
+    }
+
+    // Every fourth device is a known type, the rest only share the FTDI vendor id
+    std::vector<FTDIHandler::ScannedDeviceInfo> makeScannedDevices(int count) {
+        std::vector<FTDIHandler::ScannedDeviceInfo> out;
+        for (int i = 0; i < count; ++i) {
+            FTDIHandler::ScannedDeviceInfo info{};
+            const bool known = i % 4 == 0;
+            const int type = i % RegisteredTypes;
+            const uint16_t pid = known ? static_cast<uint16_t>(0x7000 + type) : 0x6014;
+            info.devInfo.ID = (static_cast<DWORD>(pid) << 16) | BenchVid;
+            std::snprintf(info.devInfo.SerialNumber, sizeof(info.devInfo.SerialNumber), "%s%d", known ? "BT" : "FT", known ? type : 1000 + i);
+            std::snprintf(info.devInfo.Description, sizeof(info.devInfo.Description), "%s %d", known ? "Bench Type" : "FT232H Adapter", known ? type : i);
+            info.scanIndex = i;
+            out.push_back(info);
+        }
+        return out;
+    }
+
+    void matchCase(int scanned) {
+        Bench::add("registry/match_ftdi/" + std::to_string(scanned), [scanned](Bench::State& s) {
+            registerBenchTypes();
+            DeviceHandler handler;
+            const auto devices = makeScannedDevices(scanned);
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                handler.matchFtdiDevices(devices);
+                Bench::doNotOptimize(handler.foundDevices.size());
+                handler.foundDevices.clear();
+            }
+        }, static_cast<uint64_t>(scanned));
+    }
+
+    // All tasks are due on every update (interval 0) or none are (interval one minute)
+    void taskCase(int taskCount, bool due) {
+        Bench::add(std::string("tasks/dispatch_") + (due ? "due/" : "idle/") + std::to_string(taskCount), [taskCount, due](Bench::State& s) {
+            s.pauseTiming();
+            DeviceHandler handler;
+            auto device = std::make_unique<BenchDevice>();
+            static uint64_t counter = 0;
+            for (int t = 0; t < taskCount; ++t) device->addTask([]{ counter++; }, due ? 0 : 60000, "bench" + std::to_string(t));
+            device->isInitialized = true;
+            device->tasksActive = true;
+            device->instanceName = "Bench#0";
+            handler.activeDevices.push_back(std::move(device));
+            handler.deviceLogicUpdate(); // Registers the task metrics
+            s.resumeTiming();
+            for (uint64_t i = 0; i < s.iterations; ++i) handler.deviceLogicUpdate();
+            Bench::doNotOptimize(counter);
+        }, static_cast<uint64_t>(taskCount));
+    }
+
+    // One hour of mixed-interval tasks (100 ms to 10 s) on a VirtualClock. The time per operation is what a
+    // simulated hour costs when the scheduler jumps from deadline to deadline.
+    void virtualHourCase(int deviceCount) {
+        Bench::add("tasks/virtual_hour/" + std::to_string(deviceCount), [deviceCount](Bench::State& s) {
+            s.pauseTiming();
+            VirtualClock clock;
+            SchedulerClock::install(&clock);
+            DeviceHandler handler;
+            static uint64_t counter = 0;
+            const int intervals[] = { 100, 250, 1000, 10000 };
+            for (int d = 0; d < deviceCount; ++d) {
+                auto device = std::make_unique<BenchDevice>();
+                device->addTask([]{ counter++; }, intervals[d % 4], "tick");
+                device->isInitialized = true;
+                device->tasksActive = true;
+                device->instanceName = "Bench#" + std::to_string(d);
+                handler.activeDevices.push_back(std::move(device));
+            }
+            s.resumeTiming();
+            for (uint64_t i = 0; i < s.iterations; ++i) Bench::doNotOptimize(handler.runUntil(clock.now() + std::chrono::hours(1)));
+            s.pauseTiming();
+            SchedulerClock::install(nullptr);
+            Bench::doNotOptimize(counter);
+        }, static_cast<uint64_t>(deviceCount));
+    }
+
+    static inline bool registered = [](){
+        for (int n : {1, 16, 256}) matchCase(n);
+
+        Bench::add("components/get_first", [](Bench::State& s) {
+            BenchDevice device;
+            EmptyDevice& base = device;
+            for (uint64_t i = 0; i < s.iterations; ++i) Bench::doNotOptimize(base.systemGetComponent<MCAHistogram>());
+        });
+        Bench::add("components/get_last", [](Bench::State& s) {
+            BenchDevice device;
+            EmptyDevice& base = device;
+            for (uint64_t i = 0; i < s.iterations; ++i) Bench::doNotOptimize(base.systemGetComponent<FTDIConnection>());
+        });
+        Bench::add("components/get_missing", [](Bench::State& s) {
+            BenchDevice device;
+            EmptyDevice& base = device;
+            for (uint64_t i = 0; i < s.iterations; ++i) Bench::doNotOptimize(base.systemGetComponent<UsbConnection>());
+        });
+
+        for (int n : {1, 64, 1024}) { taskCase(n, true); taskCase(n, false); }
+        for (int n : {1, 16}) virtualHourCase(n);
+        return true;
+    }();
+}
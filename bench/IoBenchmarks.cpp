@@ -0,0 +1,376 @@
+#include "Bench.hpp"
+#include "MinixDevice.hpp"
+#include "FTDIHandler.hpp"
+#include "Diagnostics/TrafficCapture.hpp"
+#include "SerialConnection.hpp"
+#include "TcpInstrumentConnection.hpp"
+#include "UdpHandler.hpp"
+#include "RemoteControl.hpp"
+#include "DeviceHandler.hpp"
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <thread>
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+// I/O paths without hardware: MPSSE command assembly, ADC conversion, FTDI session locking, traffic capture,
+// serial line parsing, a serial request/response over a pseudo terminal, network instrument queries, UDP
+// telemetry and the remote control server over loopback.
+namespace {
+
+    constexpr unsigned char VoltageChannel = 0xD0; // AD0
+
+    void frameCase(int samples) {
+        Bench::add("mpsse/adc_burst_frame/" + std::to_string(samples), [samples](Bench::State& s) {
+            MiniXDevice device;
+            std::vector<unsigned char> tx(MiniXDevice::adcBurstCommandSize(samples));
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                Bench::doNotOptimize(device.buildAdcBurstCommands(VoltageChannel, samples, tx));
+                Bench::doNotOptimize(tx.data());
+            }
+        }, MiniXDevice::adcBurstCommandSize(samples));
+    }
+
+    void adcCase(int samples) {
+        Bench::add("adc/convert_voltages/" + std::to_string(samples), [samples](Bench::State& s) {
+            MiniXDevice device;
+            std::vector<unsigned char> raw(samples * 2);
+            std::vector<double> out(samples);
+            std::mt19937 rng(1234);
+            for (auto& b : raw) b = static_cast<unsigned char>(rng());
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                device.convertToVoltages(raw, out);
+                Bench::doNotOptimize(out.data());
+            }
+        }, static_cast<uint64_t>(samples));
+    }
+
+    // Session lookup/creation through the shared handle map, the lock every FTDIConnection takes on connect.
+    // The handles are never passed to the driver.
+    void sessionCase(int threads) {
+        Bench::add("ftdi/get_session_contended/" + std::to_string(threads), [threads](Bench::State& s) {
+            FTDIHandler& handler = FTDIHandler::Instance();
+            FT_DEVICE_LIST_INFO_NODE info{};
+            std::strcpy(info.Description, "Bench Session");
+            std::strcpy(info.SerialNumber, "BS0");
+            auto worker = [&](int id, uint64_t count) {
+                FT_HANDLE handle = reinterpret_cast<FT_HANDLE>(static_cast<uintptr_t>(0x1000 + id % 2));
+                for (uint64_t i = 0; i < count; ++i) Bench::doNotOptimize(handler.getSession(handle, info));
+            };
+            std::vector<std::thread> pool;
+            for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t, s.iterations / threads);
+            worker(0, s.iterations - (s.iterations / threads) * (threads - 1));
+            for (auto& th : pool) th.join();
+        });
+    }
+
+    // What a captured transfer costs the calling thread. The writer thread flushes to a temporary file meanwhile.
+    void captureCase(size_t bytes) {
+        Bench::add("capture/record/" + std::to_string(bytes), [bytes](Bench::State& s) {
+            TrafficCapture& capture = TrafficCapture::Instance();
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / "radcat_bench.rcap";
+            if (!capture.start(path.string())) return;
+            Capture::Stream info;
+            info.description = "Bench Stream";
+            const uint32_t stream = capture.openStream(info);
+            std::vector<unsigned char> payload(bytes, 0xA5);
+            for (uint64_t i = 0; i < s.iterations; ++i) capture.record(stream, Capture::Direction::In, 0, 0, payload.data(), payload.size());
+            s.pauseTiming();
+            capture.stop();
+            std::filesystem::remove(path);
+        }, bytes);
+    }
+
+    // Lines parsed in place from the receive ring, a few of them wrapping around its end
+    void lineParseCase(size_t length) {
+        Bench::add("serial/parse_lines/" + std::to_string(length), [length](Bench::State& s) {
+            SpscByteRing ring(4096);
+            SerialParse::LineParser parser;
+            std::string line(length - 2, 'x');
+            line += "\r\n";
+            size_t total = 0;
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                ring.write(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(line.data()), line.size()));
+                ring.consume(parser.parse(ring.readable(), [&](std::string_view l) { total += l.size(); }));
+            }
+            Bench::doNotOptimize(total);
+        }, length);
+    }
+
+#ifndef _WIN32
+    struct SerialBenchDevice : public BaseDevice<SerialConnection> {
+        bool connect() override { return true; }
+        bool disconnect() override { return true; }
+        double readValue(const std::string&) override { return 0.0; }
+        bool setValue(const std::string&, double) override { return false; }
+    };
+
+    // Query and answer through the event thread, the instrument played by the pty master on this thread
+    void ptyRoundTripCase() {
+        Bench::add("serial/pty_round_trip", [](Bench::State& s) {
+            const int master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) { if (master >= 0) ::close(master); return; }
+            SerialBenchDevice device;
+            SerialConnection& port = device.getComponentRef<SerialConnection>();
+            if (!port.open(ptsname(master), SerialConnection::Config{})) { ::close(master); return; }
+            SerialParse::LineParser parser;
+            char query[16];
+            size_t answers = 0;
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                port.write("MEAS?\n");
+                for (size_t got = 0; got < 6;) { const ssize_t n = ::read(master, query + got, sizeof(query) - got); if (n > 0) got += n; }
+                if (::write(master, "0.125\n", 6) != 6) break;
+                while (port.parse(parser, [&](std::string_view) { answers++; }) == 0) port.waitForData(1, 100);
+            }
+            Bench::doNotOptimize(answers);
+            s.pauseTiming();
+            port.close();
+            ::close(master);
+        });
+    }
+
+    struct TcpBenchDevice : public BaseDevice<TcpInstrumentConnection> {
+        bool connect() override { return true; }
+        bool disconnect() override { return true; }
+        double readValue(const std::string&) override { return 0.0; }
+        bool setValue(const std::string&, double) override { return false; }
+    };
+
+    // Stand-in instrument on loopback, answers every line it gets until the client hangs up
+    struct LoopbackInstrument {
+        int listener = -1;
+        uint16_t port = 0;
+        std::thread server;
+
+        LoopbackInstrument() {
+            listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(addr);
+            if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listener, 1) != 0
+                || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &length) != 0) return;
+            port = ntohs(addr.sin_port);
+            server = std::thread([this] {
+                const int fd = ::accept(listener, nullptr, nullptr);
+                if (fd < 0) return;
+                char in[4096];
+                std::string out;
+                for (ssize_t n; (n = ::read(fd, in, sizeof(in))) > 0;) {
+                    out.clear();
+                    for (ssize_t i = 0; i < n; ++i) if (in[i] == '\n') out += "0.125\n";
+                    if (!out.empty() && ::send(fd, out.data(), out.size(), MSG_NOSIGNAL) < 0) break;
+                }
+                ::close(fd);
+            });
+        }
+        ~LoopbackInstrument() {
+            if (server.joinable()) server.join();
+            if (listener >= 0) ::close(listener);
+        }
+    };
+
+    // Polling eight parameters: one round trip each, or all eight queries in one write
+    void tcpQueryCase(bool pipelined) {
+        constexpr int Parameters = 8;
+        Bench::add(pipelined ? "tcp/query_pipelined/8" : "tcp/query_sequential/8", [pipelined](Bench::State& s) {
+            LoopbackInstrument instrument;
+            TcpBenchDevice device;
+            TcpInstrumentConnection& lan = device.getComponentRef<TcpInstrumentConnection>();
+            if (instrument.port == 0 || !lan.open("127.0.0.1", instrument.port)) { ::shutdown(instrument.listener, SHUT_RDWR); return; }
+            size_t answers = 0;
+            uint64_t tickets[Parameters];
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                if (pipelined) {
+                    for (uint64_t& t : tickets) t = lan.query("MEAS?");
+                    lan.flush();
+                    for (uint64_t t : tickets) answers += lan.reply(t).has_value();
+                }
+                else {
+                    for (int p = 0; p < Parameters; ++p) answers += lan.ask("MEAS?").has_value();
+                }
+            }
+            Bench::doNotOptimize(answers);
+            s.pauseTiming();
+            lan.close();
+        }, Parameters);
+    }
+
+    // Telemetry listener on loopback, the publisher is pointed at it
+    struct TelemetryListener {
+        int fd = -1;
+        uint16_t port = 0;
+
+        TelemetryListener() {
+            fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            const int receiveBuffer = 8 << 20;
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+            timeval timeout{ 0, 200000 };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(addr);
+            if (fd >= 0 && ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 && getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) == 0)
+                port = ntohs(addr.sin_port);
+        }
+        ~TelemetryListener() { if (fd >= 0) ::close(fd); }
+
+        bool startPublisher() {
+            UdpHandler::Config config;
+            config.address = "127.0.0.1";
+            config.port = port;
+            return port != 0 && UdpHandler::Instance().start(config);
+        }
+
+        // Data records in the next datagram, 0 for a catalog, -1 when nothing came
+        int receive() {
+            unsigned char datagram[UdpHandler::MaxDatagramBytes];
+            if (::recv(fd, datagram, sizeof(datagram), 0) < static_cast<ssize_t>(sizeof(UdpHandler::DatagramHeader))) return -1;
+            UdpHandler::DatagramHeader header;
+            std::memcpy(&header, datagram, sizeof(header));
+            return header.type == UdpHandler::DatagramType::Data ? header.count : 0;
+        }
+    };
+
+    // Cost on the device thread, the publisher sends in the background
+    void telemetryPublishCase() {
+        Bench::add("telemetry/publish", [](Bench::State& s) {
+            TelemetryListener listener;
+            if (!listener.startPublisher()) return;
+            UdpHandler& telemetry = UdpHandler::Instance();
+            const uint16_t channel = telemetry.channel("bench/publish");
+            for (uint64_t i = 0; i < s.iterations; ++i) telemetry.sample(channel, static_cast<double>(i));
+            s.pauseTiming();
+            telemetry.stop();
+        });
+    }
+
+    // Producer to listener: records packed into full datagrams, sent in sendmmsg batches
+    void telemetryDeliverCase(int records) {
+        Bench::add("telemetry/deliver/" + std::to_string(records), [records](Bench::State& s) {
+            TelemetryListener listener;
+            if (!listener.startPublisher()) return;
+            UdpHandler& telemetry = UdpHandler::Instance();
+            const uint16_t channel = telemetry.channel("bench/deliver");
+            size_t delivered = 0;
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                const uint64_t now = UdpHandler::now();
+                for (int r = 0; r < records; ++r) telemetry.publish(channel, UdpHandler::RecordKind::Event, static_cast<uint32_t>(r), 662.0, now);
+                for (int got = 0, n; got < records && (n = listener.receive()) >= 0;) got += n;
+                delivered += records;
+            }
+            Bench::doNotOptimize(delivered);
+            s.pauseTiming();
+            telemetry.stop();
+        }, static_cast<uint64_t>(records));
+    }
+
+    // Remote control client in the bench thread, which also plays the logic thread and calls service()
+    struct RemoteClient {
+        int fd = -1;
+        std::vector<uint8_t> requests;
+        std::vector<uint8_t> in;
+
+        bool connect(RemoteControl& remote, DeviceHandler& devices) {
+            fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(remote.getTcpPort());
+            if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+            for (int i = 0; i < 1000 && remote.clientCount() == 0; ++i) { remote.service(devices); std::this_thread::sleep_for(std::chrono::microseconds(100)); }
+            return remote.clientCount() == 1;
+        }
+        ~RemoteClient() { if (fd >= 0) ::close(fd); }
+
+        void readValue(uint32_t id) {
+            RemoteProtocol::Writer out(requests);
+            out.begin(id, static_cast<uint8_t>(RemoteProtocol::Op::ReadValue));
+            out.u16(0);
+            out.str("voltage");
+            out.finish();
+        }
+
+        // Sends the queued requests and services the server until that many responses came back
+        size_t exchange(RemoteControl& remote, DeviceHandler& devices, size_t expected) {
+            if (::send(fd, requests.data(), requests.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(requests.size())) return 0;
+            requests.clear();
+            size_t responses = 0;
+            while (responses < expected) {
+                remote.service(devices);
+                uint8_t chunk[4096];
+                const ssize_t n = ::recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+                if (n == 0) return responses;
+                if (n > 0) in.insert(in.end(), chunk, chunk + n);
+                size_t used = 0;
+                for (uint32_t length; in.size() - used >= 4; used += 4 + length) {
+                    std::memcpy(&length, in.data() + used, 4);
+                    if (in.size() - used - 4 < length) break;
+                    responses++;
+                }
+                in.erase(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(used));
+            }
+            return responses;
+        }
+    };
+
+    // Reading 32 parameters from a beamline script: one round trip each, or all 32 requests in one write and
+    // executed in one service() call
+    void remoteReadCase(bool pipelined) {
+        constexpr int Parameters = 32;
+        Bench::add(pipelined ? "remote/read_value_pipelined/32" : "remote/read_value_sequential/32", [pipelined](Bench::State& s) {
+            DeviceHandler devices;
+            devices.activeDevices.push_back(std::make_unique<TcpBenchDevice>());
+            RemoteControl& remote = RemoteControl::Instance();
+            RemoteControl::Config config;
+            config.tcpPort = 0;
+            if (!remote.start(config)) return;
+            RemoteClient client;
+            if (client.connect(remote, devices)) {
+                size_t responses = 0;
+                uint32_t id = 0;
+                for (uint64_t i = 0; i < s.iterations; ++i) {
+                    if (pipelined) {
+                        for (int p = 0; p < Parameters; ++p) client.readValue(++id);
+                        responses += client.exchange(remote, devices, Parameters);
+                    }
+                    else {
+                        for (int p = 0; p < Parameters; ++p) { client.readValue(++id); responses += client.exchange(remote, devices, 1); }
+                    }
+                }
+                Bench::doNotOptimize(responses);
+            }
+            s.pauseTiming();
+            remote.stop();
+        }, Parameters);
+    }
+#endif
+
+    static inline bool registered = [](){
+        for (int n : {1, 32, 256}) frameCase(n);
+        for (int n : {32, 256, 4096}) adcCase(n);
+        for (int n : {1, 2, 4, 8}) sessionCase(n);
+        Bench::add("capture/record_off", [](Bench::State& s) {
+            unsigned char payload[64] = {};
+            for (uint64_t i = 0; i < s.iterations; ++i) TrafficCapture::Instance().record(1, Capture::Direction::In, 0, 0, payload, sizeof(payload));
+        });
+        for (size_t n : {64, 4096}) captureCase(n);
+        for (size_t n : {16, 256}) lineParseCase(n);
+#ifndef _WIN32
+        ptyRoundTripCase();
+        tcpQueryCase(false);
+        tcpQueryCase(true);
+        telemetryPublishCase();
+        telemetryDeliverCase(6000);
+        remoteReadCase(false);
+        remoteReadCase(true);
+#endif
+        return true;
+    }();
+}
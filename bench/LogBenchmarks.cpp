@@ -0,0 +1,61 @@
+#include "Bench.hpp"
+#include "Debug.hpp"
+
+// Cost of logging on the calling thread. The console is off, so the logger thread only drains the rings.
+namespace {
+
+    // Restores the quiet default of the runner after a case changed a level
+    struct LevelScope {
+        LevelScope(LogCategory c, int level) : category(c), previous(LogControl::getLevel(c)) { LogControl::setLevel(c, level); }
+        ~LevelScope() { LogControl::setLevel(category, previous); }
+        LogCategory category;
+        int previous;
+    };
+
+    // The ring holds 4096 records per thread. Drain every batch outside the timed region so the
+    // case measures the enqueue, not the drop path of a full ring.
+    constexpr uint64_t Batch = 2048;
+
+    static inline bool registered = [](){
+        Bench::add("log/category_filtered", [](Bench::State& s) {
+            LevelScope level(LogCategory::FTDI, 1);
+            for (uint64_t i = 0; i < s.iterations; ++i) DEBUG_LOG(LogCategory::FTDI, "FTDI received ", i, " bytes");
+        });
+
+        Bench::add("log/debug_log", [](Bench::State& s) {
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                Debug.Log("PollData: Successfully polled ", i, " bytes of data.");
+                if ((i + 1) % Batch == 0) { s.pauseTiming(); Debug.Flush(); s.resumeTiming(); }
+            }
+            s.pauseTiming();
+            Debug.Flush();
+        });
+
+        Bench::add("log/debug_log_mixed_args", [](Bench::State& s) {
+            const std::string device = "Mini-X#0";
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                Debug.Log("Device ", device, " HV ", 15.25, " kV, current ", static_cast<int>(i), " uA, on ", true);
+                if ((i + 1) % Batch == 0) { s.pauseTiming(); Debug.Flush(); s.resumeTiming(); }
+            }
+            s.pauseTiming();
+            Debug.Flush();
+        });
+
+        // Same message from one call site: admitted once, then counted as a repeat
+        Bench::add("log/category_repeated", [](Bench::State& s) {
+            LevelScope level(LogCategory::Scan, 3);
+            for (uint64_t i = 0; i < s.iterations; ++i) DEBUG_LOG(LogCategory::Scan, "No FTDI devices found during scan.");
+            s.pauseTiming();
+            Debug.Flush();
+        });
+
+        // Distinct messages from one call site: mostly rejected by the token bucket
+        Bench::add("log/category_rate_limited", [](Bench::State& s) {
+            LevelScope level(LogCategory::Scan, 3);
+            for (uint64_t i = 0; i < s.iterations; ++i) DEBUG_LOG(LogCategory::Scan, "Device at index ", i, " is already assigned.");
+            s.pauseTiming();
+            Debug.Flush();
+        });
+        return true;
+    }();
+}
@@ -0,0 +1,191 @@
+#include "Bench.hpp"
+#include "DeviceHandler.hpp"
+#include "I2cBus.hpp"
+#include "MinixDevice.hpp"
+#include "Simulation/I2cTargetModel.hpp"
+#include "Simulation/SimulatedFTDITransport.hpp"
+#include <thread>
+
+// The FTDI path end to end against SimulatedFTDITransport: DeviceSession locking around real transport calls,
+// a Mini-X driver reading its ADC through the simulated MPSSE engine and board model, and I2cBus polling
+// sensors on an I2cTargetModel.
+// USB latency is set to zero and replies are polled every 50 us instead of every 20 ms, so the numbers are the
+// host-side cost plus the modeled serial clocking rather than the poll interval.
+namespace {
+
+    // Installed on first use and kept for the rest of the run. Replaces the D2XX transport, which no
+    // other case drives (the session lookup case only uses fake handles).
+    SimulatedFTDITransport& simulation() {
+        static SimulatedFTDITransport* sim = [](){
+            auto transport = std::make_unique<SimulatedFTDITransport>();
+            transport->addMiniX("SIM-MX0");
+            transport->addMiniX("SIM-MX1");
+            transport->setTimingAll({ std::chrono::microseconds(0), std::chrono::microseconds(0), true });
+            FTDIHandler::Instance().setPollInterval(std::chrono::microseconds(50));
+            SimulatedFTDITransport* raw = transport.get();
+            FTDIHandler::Instance().setTransport(std::move(transport));
+            return raw;
+        }();
+        return *sim;
+    }
+
+    // A Mini-X activated the way a scan would do it, connected once (openDevice alone sleeps 100 ms).
+    MiniXDevice* connectedMiniX() {
+        static DeviceHandler handler;
+        static MiniXDevice* device = []() -> MiniXDevice* {
+            SimulatedFTDITransport& sim = simulation();
+            DeviceHandler::FoundDeviceInfo found;
+            found.connectionType = DeviceHandler::FoundDeviceInfo::ConnectionType::FTDI;
+            found.deviceRegistryEntry = &DeviceRegistry::registry()["Mini-X"];
+            found.FTDIScannedDeviceInfo = std::make_unique<FTDIHandler::ScannedDeviceInfo>();
+            found.FTDIScannedDeviceInfo->scanIndex = 0;
+            sim.getDeviceInfoDetail(0, found.FTDIScannedDeviceInfo->devInfo);
+            handler.activateDevice(found);
+            if (handler.activeDevices.empty()) return nullptr;
+            auto* minix = dynamic_cast<MiniXDevice*>(handler.activeDevices.back().get());
+            return minix && minix->connect() ? minix : nullptr;
+        }();
+        return device;
+    }
+
+    void burstCase(int samples) {
+        Bench::add("sim/minix_voltage_burst/" + std::to_string(samples), [samples](Bench::State& s) {
+            s.pauseTiming();
+            MiniXDevice* device = connectedMiniX();
+            s.resumeTiming();
+            if (!device) return;
+            for (uint64_t i = 0; i < s.iterations; ++i) Bench::doNotOptimize(device->readVoltageBurst(samples));
+        }, static_cast<uint64_t>(samples));
+    }
+
+    // Several threads sending on one device: tx mutex contention plus the transport call it guards.
+    void sendCase(int threads) {
+        Bench::add("ftdi/session_send_contended/" + std::to_string(threads), [threads](Bench::State& s) {
+            s.pauseTiming();
+            SimulatedFTDITransport& sim = simulation();
+            static FT_HANDLE handle = [&sim]() -> FT_HANDLE {
+                FT_HANDLE h = nullptr;
+                if (sim.open(1, h) != FT_OK) return nullptr;
+                sim.setBitMode(h, 0x00, 0x02);
+                return h;
+            }();
+            FT_DEVICE_LIST_INFO_NODE info{};
+            sim.getDeviceInfoDetail(1, info);
+            auto session = FTDIHandler::Instance().getSession(handle, info);
+            s.resumeTiming();
+            if (!handle) return;
+
+            const unsigned char pins[3] = { 0x80, 0x18, 0x7B }; // SET_DATA_BITS_LOW, chip selects idle
+            auto worker = [&](uint64_t count) {
+                for (uint64_t i = 0; i < count; ++i) Bench::doNotOptimize(session->send(pins, sizeof(pins)));
+            };
+            std::vector<std::thread> pool;
+            for (int t = 1; t < threads; ++t) pool.emplace_back(worker, s.iterations / threads);
+            worker(s.iterations - (s.iterations / threads) * (threads - 1));
+            for (auto& th : pool) th.join();
+        });
+    }
+
+    struct I2cBenchBoard : public BaseDevice<FTDIConnection, I2cBus> {
+        static inline const DeviceRegistry::RegistryEntry::DeviceInfo deviceInfo = {"I2C Bench Board"};
+        bool connect() override { return getComponentRef<FTDIConnection>().fConnect(); }
+        bool disconnect() override { return getComponentRef<FTDIConnection>().fDisconnect(); }
+        double readValue(const std::string&) override { return 0.0; }
+        bool setValue(const std::string&, double) override { return false; }
+    };
+
+    constexpr uint8_t Thermometer = 0x48; // TMP117 style, temperature in register 0x00
+    constexpr uint8_t Barometer = 0x76;   // BMP280 style, pressure and temperature burst from 0xF7
+    constexpr uint8_t Absent = 0x50;
+
+    struct I2cRig {
+        I2cTargetModel* model = nullptr;
+        int index = -1;
+        I2cBenchBoard* board = nullptr; // Null if it did not connect
+    };
+
+    // An FT232H adapter with two sensors on its I2C bus, activated and connected once like connectedMiniX()
+    I2cRig& i2cRig() {
+        static DeviceHandler handler;
+        static DeviceRegistry::RegistryEntry entry{ [](){ return std::make_unique<I2cBenchBoard>(); }, {}, I2cBenchBoard::deviceInfo };
+        static I2cRig rig = []() {
+            SimulatedFTDITransport& sim = simulation();
+            I2cRig r;
+            auto model = std::make_unique<I2cTargetModel>();
+            model->addDevice(Thermometer);
+            model->addDevice(Barometer);
+            model->setRegister(Thermometer, 0x00, 0x0C);
+            model->setRegister(Thermometer, 0x01, 0x80);
+            for (uint8_t i = 0; i < 6; ++i) model->setRegister(Barometer, static_cast<uint8_t>(0xF7 + i), static_cast<uint8_t>(0x50 + i));
+            r.model = model.get();
+            r.index = sim.addDevice(std::move(model), "I2C Adapter", "SIM-I2C0");
+            sim.setTiming(r.index, { std::chrono::microseconds(0), std::chrono::microseconds(0), true });
+
+            DeviceHandler::FoundDeviceInfo found;
+            found.connectionType = DeviceHandler::FoundDeviceInfo::ConnectionType::FTDI;
+            found.deviceRegistryEntry = &entry;
+            found.FTDIScannedDeviceInfo = std::make_unique<FTDIHandler::ScannedDeviceInfo>();
+            found.FTDIScannedDeviceInfo->scanIndex = r.index;
+            sim.getDeviceInfoDetail(r.index, found.FTDIScannedDeviceInfo->devInfo);
+            handler.activateDevice(found);
+            if (handler.activeDevices.empty()) return r;
+            auto* board = dynamic_cast<I2cBenchBoard*>(handler.activeDevices.back().get());
+            r.board = board && board->connect() ? board : nullptr;
+            return r;
+        }();
+        return rig;
+    }
+
+    // A sensor poll: a register read on each of two devices, queued and sent as one batch. Checks that a batch
+    // costs one USB write and one read, that the ACK and data offsets pick the right bytes, that an absent
+    // address is reported as a NAK without failing the other transaction, and that register writes arrive.
+    void i2cPollCase() {
+        Bench::add("sim/i2c_poll/2", [](Bench::State& s) {
+            s.pauseTiming();
+            I2cRig& rig = i2cRig();
+            Bench::check(rig.board != nullptr, "i2c: simulated adapter did not connect");
+            if (!rig.board) return;
+            SimulatedFTDITransport& sim = simulation();
+            I2cBus& bus = rig.board->getComponentRef<I2cBus>();
+            const SimulatedFTDITransport::CallCounts before = sim.callCounts(rig.index);
+            bool polled = true;
+            s.resumeTiming();
+
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                const size_t t = bus.readRegisters(Thermometer, 0x00, 2);
+                const size_t p = bus.readRegisters(Barometer, 0xF7, 6);
+                polled &= bus.execute();
+                const std::span<const uint8_t> temperature = bus.result(t).data, pressure = bus.result(p).data;
+                polled &= temperature.size() == 2 && temperature[0] == 0x0C && temperature[1] == 0x80
+                       && pressure.size() == 6 && pressure[0] == 0x50 && pressure[5] == 0x55;
+            }
+
+            s.pauseTiming();
+            const SimulatedFTDITransport::CallCounts after = sim.callCounts(rig.index);
+            Bench::check(polled, "i2c: poll not acknowledged or returned the wrong bytes");
+            Bench::check(after.writes - before.writes == s.iterations && after.reads - before.reads == s.iterations,
+                         "i2c: a batch took more than one USB write and one read");
+
+            const size_t absent = bus.readRegisters(Absent, 0x00, 1);
+            const size_t present = bus.readRegisters(Thermometer, 0x00, 2);
+            Bench::check(!bus.execute(), "i2c: a batch with an absent address reported success");
+            const I2cBus::Result missing = bus.result(absent), found = bus.result(present);
+            Bench::check(!missing.acked && found.acked && found.data.size() == 2 && found.data[0] == 0x0C,
+                         "i2c: NAK of an absent address not reported, or it broke the other transaction");
+
+            const uint8_t config[] = { 0x27 };
+            bus.writeRegister(Barometer, 0xF4, config);
+            const size_t readBack = bus.readRegisters(Barometer, 0xF4, 1);
+            Bench::check(bus.execute() && bus.result(readBack).data.size() == 1 && bus.result(readBack).data[0] == 0x27
+                         && rig.model->getRegister(Barometer, 0xF4) == 0x27, "i2c: register write did not reach the device");
+            s.resumeTiming();
+        }, 2);
+    }
+
+    static inline bool registered = [](){
+        for (int n : {1, 2, 4, 8}) sendCase(n);
+        for (int n : {1, 32, 256}) burstCase(n);
+        i2cPollCase();
+        return true;
+    }();
+}
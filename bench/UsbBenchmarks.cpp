@@ -0,0 +1,105 @@
+#include "Bench.hpp"
+#include "DeviceHandler.hpp"
+#include "AllComponents.hpp"
+#include "Simulation/SimulatedUsbBackend.hpp"
+
+// LibUsb path against SimulatedUsbBackend: scan and registry matching with many attached devices,
+// and bulk IN transfers through LibUsbHandler/UsbConnection with the USB latency set to zero.
+namespace {
+
+    class BenchUsbDevice : public BaseDevice<UsbConnection> {
+    public:
+        static inline const DeviceRegistry::RegistryEntry::DeviceInfo deviceInfo = {"Bench USB"};
+        bool connect() override { return true; }
+        bool disconnect() override { return true; }
+        double readValue(const std::string&) override { return 0.0; }
+        bool setValue(const std::string&, double) override { return true; }
+    };
+
+    constexpr uint16_t BenchVid = 0x1209;
+    constexpr int RegisteredTypes = 32;
+    constexpr int MaxDevices = 256;
+
+    void registerBenchTypes() {
+        static bool done = false;
+        if (done) return;
+        done = true;
+        for (int i = 0; i < RegisteredTypes; ++i) {
+            DeviceRegistry::RegistryEntry entry;
+            entry.creator = [](){ return std::make_unique<BenchUsbDevice>(); };
+            entry.componentTypes = { std::type_index(typeid(UsbConnection)) };
+            entry.deviceInfo.deviceName = "Bench USB Type " + std::to_string(i);
+            entry.deviceInfo.vid = BenchVid;
+            entry.deviceInfo.pid = static_cast<uint16_t>(0x7000 + i);
+            DeviceRegistry::registry()[entry.deviceInfo.deviceName] = entry;
+        }
+    }
+
+    // Installed on first use: MaxDevices attached devices, every fourth a registered type, the rest
+    // unknown products of the same vendor. Device 0 streams from an unlimited-rate IN endpoint.
+    SimulatedUsbBackend& simulation() {
+        static SimulatedUsbBackend* sim = [](){
+            auto backend = std::make_unique<SimulatedUsbBackend>();
+            for (int i = 0; i < MaxDevices; ++i) {
+                SimulatedUsbBackend::DeviceConfig cfg;
+                cfg.vid = BenchVid;
+                cfg.pid = i % 4 == 0 ? static_cast<uint16_t>(0x7000 + i % RegisteredTypes) : 0x6000;
+                cfg.product = "Bench USB " + std::to_string(i);
+                cfg.serial = "BU" + std::to_string(i);
+                SimulatedUsbBackend::Endpoint in;
+                in.address = 0x81;
+                in.latency = std::chrono::microseconds(0);
+                in.bufferBytes = 1 << 20;
+                cfg.endpoints.push_back(in);
+                backend->addDevice(cfg);
+            }
+            SimulatedUsbBackend* raw = backend.get();
+            LibUsbHandler::Instance().setBackend(std::move(backend));
+            return raw;
+        }();
+        return *sim;
+    }
+
+    // Scan of every attached device plus matching the first n of them. The scan itself always sees
+    // MaxDevices, so the difference between the cases is the matching cost.
+    void matchCase(int count) {
+        Bench::add("registry/match_libusb/" + std::to_string(count), [count](Bench::State& s) {
+            registerBenchTypes();
+            simulation();
+            LibUsbHandler& usb = LibUsbHandler::Instance();
+            DeviceHandler handler;
+            for (uint64_t i = 0; i < s.iterations; ++i) {
+                auto scanned = usb.scanDevices();
+                if (scanned.size() > static_cast<size_t>(count)) scanned.erase(scanned.begin() + count, scanned.end());
+                handler.matchLibUsbDevices(scanned);
+                Bench::doNotOptimize(handler.foundDevices.size());
+                s.pauseTiming();
+                handler.foundDevices.clear();
+                s.resumeTiming();
+            }
+        }, static_cast<uint64_t>(count));
+    }
+
+    void readCase(int bytes) {
+        Bench::add("usb/bulk_read/" + std::to_string(bytes), [bytes](Bench::State& s) {
+            s.pauseTiming();
+            SimulatedUsbBackend& sim = simulation();
+            LibUsbHandler& usb = LibUsbHandler::Instance();
+            static libusb_device_handle* handle = [&]() -> libusb_device_handle* {
+                libusb_device_handle* h = nullptr;
+                return usb.openDevice(&h, BenchVid, 0x7000) ? h : nullptr;
+            }();
+            std::vector<unsigned char> buffer(static_cast<size_t>(bytes));
+            s.resumeTiming();
+            if (!handle) return;
+            for (uint64_t i = 0; i < s.iterations; ++i) Bench::doNotOptimize(usb.readData(handle, 0x01, buffer.data(), bytes, 100));
+            Bench::doNotOptimize(sim.stats(0).bytesIn);
+        }, static_cast<uint64_t>(bytes));
+    }
+
+    static inline bool registered = [](){
+        for (int n : {1, 16, 256}) matchCase(n);
+        for (int n : {512, 16384, 262144}) readCase(n);
+        return true;
+    }();
+}
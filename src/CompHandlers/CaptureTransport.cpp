@@ -0,0 +1,206 @@
+#include "CaptureTransport.hpp"
+#include <cstring>
+
+namespace {
+    // Control arguments are stored as u32 values, independent of the platform's ULONG size
+    template<size_t N> struct Args {
+        uint32_t values[N];
+    };
+
+    uint64_t startTime() {
+        TrafficCapture& capture = TrafficCapture::Instance();
+        return capture.isActive() ? capture.timestamp() : TrafficCapture::NoStart;
+    }
+}
+
+// ---- FTDI ----
+
+uint32_t CaptureFTDITransport::streamOf(FT_HANDLE handle) {
+    if (!TrafficCapture::Instance().isActive()) return 0;
+    std::lock_guard<std::mutex> lk(streamMutex);
+    auto it = streams.find(handle);
+    return it == streams.end() ? 0 : it->second;
+}
+
+void CaptureFTDITransport::control(FT_HANDLE handle, Capture::FtdiOp op, FT_STATUS status, const void* args, size_t size) {
+    if (uint32_t s = streamOf(handle)) TrafficCapture::Instance().record(s, Capture::Direction::Control, static_cast<uint8_t>(op), static_cast<int32_t>(status), args, size);
+}
+
+FT_STATUS CaptureFTDITransport::open(int index, FT_HANDLE& handle) {
+    FT_STATUS status = inner->open(index, handle);
+    TrafficCapture& capture = TrafficCapture::Instance();
+    if (status != FT_OK || !capture.isActive()) return status;
+
+    Capture::Stream info;
+    info.bus = Capture::Bus::Ftdi;
+    FT_DEVICE_LIST_INFO_NODE node{};
+    if (inner->getDeviceInfoDetail(static_cast<DWORD>(index), node) == FT_OK) {
+        info.vid = static_cast<uint16_t>(node.ID >> 16);
+        info.pid = static_cast<uint16_t>(node.ID & 0xFFFF);
+        info.deviceType = static_cast<uint32_t>(node.Type);
+        info.description.assign(node.Description, strnlen(node.Description, sizeof(node.Description)));
+        info.serial.assign(node.SerialNumber, strnlen(node.SerialNumber, sizeof(node.SerialNumber)));
+    }
+    const uint32_t id = capture.openStream(info);
+    std::lock_guard<std::mutex> lk(streamMutex);
+    streams[handle] = id;
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::close(FT_HANDLE handle) {
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> lk(streamMutex);
+        auto it = streams.find(handle);
+        if (it != streams.end()) { id = it->second; streams.erase(it); }
+    }
+    TrafficCapture::Instance().closeStream(id);
+    return inner->close(handle);
+}
+
+FT_STATUS CaptureFTDITransport::resetDevice(FT_HANDLE handle) {
+    FT_STATUS status = inner->resetDevice(handle);
+    control(handle, Capture::FtdiOp::Reset, status, nullptr, 0);
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::purge(FT_HANDLE handle, ULONG mask) {
+    FT_STATUS status = inner->purge(handle, mask);
+    const Args<1> args{ { static_cast<uint32_t>(mask) } };
+    control(handle, Capture::FtdiOp::Purge, status, &args, sizeof(args));
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) {
+    FT_STATUS status = inner->setUSBParameters(handle, inTransferSize, outTransferSize);
+    const Args<2> args{ { static_cast<uint32_t>(inTransferSize), static_cast<uint32_t>(outTransferSize) } };
+    control(handle, Capture::FtdiOp::UsbParameters, status, &args, sizeof(args));
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) {
+    FT_STATUS status = inner->setLatencyTimer(handle, latencyMs);
+    const Args<1> args{ { latencyMs } };
+    control(handle, Capture::FtdiOp::LatencyTimer, status, &args, sizeof(args));
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) {
+    FT_STATUS status = inner->setTimeouts(handle, readTimeoutMs, writeTimeoutMs);
+    const Args<2> args{ { static_cast<uint32_t>(readTimeoutMs), static_cast<uint32_t>(writeTimeoutMs) } };
+    control(handle, Capture::FtdiOp::Timeouts, status, &args, sizeof(args));
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) {
+    FT_STATUS status = inner->setFlowControl(handle, flowControl, xon, xoff);
+    const Args<3> args{ { flowControl, xon, xoff } };
+    control(handle, Capture::FtdiOp::FlowControl, status, &args, sizeof(args));
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) {
+    FT_STATUS status = inner->setBitMode(handle, mask, mode);
+    const Args<2> args{ { mask, mode } };
+    control(handle, Capture::FtdiOp::BitMode, status, &args, sizeof(args));
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) {
+    const uint64_t started = startTime();
+    FT_STATUS status = inner->write(handle, data, size, bytesWritten);
+    if (uint32_t s = streamOf(handle)) {
+        // The bytes the chip accepted; on failure what was attempted, so a replay can still compare commands
+        const size_t n = status == FT_OK ? bytesWritten : size;
+        TrafficCapture::Instance().record(s, Capture::Direction::Out, 0, static_cast<int32_t>(status), data, n, started);
+    }
+    return status;
+}
+
+FT_STATUS CaptureFTDITransport::read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) {
+    const uint64_t started = startTime();
+    FT_STATUS status = inner->read(handle, buffer, size, bytesRead);
+    if (uint32_t s = streamOf(handle)) TrafficCapture::Instance().record(s, Capture::Direction::In, 0, static_cast<int32_t>(status), buffer, bytesRead, started);
+    return status;
+}
+
+// ---- USB ----
+
+uint32_t CaptureUsbBackend::streamOf(libusb_device_handle* handle) {
+    if (!TrafficCapture::Instance().isActive()) return 0;
+    std::lock_guard<std::mutex> lk(streamMutex);
+    auto it = streams.find(handle);
+    return it == streams.end() ? 0 : it->second;
+}
+
+std::string CaptureUsbBackend::stringDescriptor(libusb_device_handle* handle, uint8_t index) {
+    if (!index) return {};
+    unsigned char text[128];
+    int n = inner->getStringDescriptorAscii(handle, index, text, sizeof(text));
+    return n > 0 ? std::string(reinterpret_cast<char*>(text), static_cast<size_t>(n)) : std::string();
+}
+
+int CaptureUsbBackend::open(libusb_device* device, libusb_device_handle** handle) {
+    int r = inner->open(device, handle);
+    TrafficCapture& capture = TrafficCapture::Instance();
+    if (r < 0 || !capture.isActive()) return r;
+
+    Capture::Stream info;
+    info.bus = Capture::Bus::Usb;
+    libusb_device_descriptor desc{};
+    if (inner->getDeviceDescriptor(device, desc) == LIBUSB_SUCCESS) {
+        info.vid = desc.idVendor;
+        info.pid = desc.idProduct;
+        info.deviceType = desc.bcdDevice;
+        info.description = stringDescriptor(*handle, desc.iProduct);
+        info.serial = stringDescriptor(*handle, desc.iSerialNumber);
+    }
+    info.busNumber = inner->getBusNumber(device);
+    uint8_t ports[8];
+    int depth = inner->getPortNumbers(device, ports, sizeof(ports));
+    if (depth > 0) info.portPath.assign(ports, ports + depth);
+
+    const uint32_t id = capture.openStream(info);
+    std::lock_guard<std::mutex> lk(streamMutex);
+    streams[*handle] = id;
+    return r;
+}
+
+void CaptureUsbBackend::close(libusb_device_handle* handle) {
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> lk(streamMutex);
+        auto it = streams.find(handle);
+        if (it != streams.end()) { id = it->second; streams.erase(it); }
+    }
+    TrafficCapture::Instance().closeStream(id);
+    inner->close(handle);
+}
+
+int CaptureUsbBackend::claimInterface(libusb_device_handle* handle, int interfaceNumber) {
+    int r = inner->claimInterface(handle, interfaceNumber);
+    const Args<1> args{ { static_cast<uint32_t>(interfaceNumber) } };
+    if (uint32_t s = streamOf(handle)) TrafficCapture::Instance().record(s, Capture::Direction::Control, static_cast<uint8_t>(Capture::UsbOp::ClaimInterface), r, &args, sizeof(args));
+    return r;
+}
+
+int CaptureUsbBackend::releaseInterface(libusb_device_handle* handle, int interfaceNumber) {
+    int r = inner->releaseInterface(handle, interfaceNumber);
+    const Args<1> args{ { static_cast<uint32_t>(interfaceNumber) } };
+    if (uint32_t s = streamOf(handle)) TrafficCapture::Instance().record(s, Capture::Direction::Control, static_cast<uint8_t>(Capture::UsbOp::ReleaseInterface), r, &args, sizeof(args));
+    return r;
+}
+
+int CaptureUsbBackend::bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                                    int* transferred, unsigned int timeoutMs) {
+    const uint64_t started = startTime();
+    int r = inner->bulkTransfer(handle, endpoint, data, length, transferred, timeoutMs);
+    if (uint32_t s = streamOf(handle)) {
+        const bool in = (endpoint & LIBUSB_ENDPOINT_IN) != 0;
+        const int n = transferred ? *transferred : 0;
+        // OUT records what was attempted when nothing went through, so a replay can still compare it
+        const size_t bytes = static_cast<size_t>(in || n > 0 ? n : length);
+        TrafficCapture::Instance().record(s, in ? Capture::Direction::In : Capture::Direction::Out, endpoint, r, data, bytes, started);
+    }
+    return r;
+}
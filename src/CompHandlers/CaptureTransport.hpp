@@ -0,0 +1,79 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "FTDITransport.hpp"
+#include "UsbBackend.hpp"
+#include "Diagnostics/TrafficCapture.hpp"
+
+// Transport decorators that report all traffic of the wrapped transport to TrafficCapture.
+// Everything is forwarded unchanged. Handles opened while the capture runs get a stream; writes, reads,
+// bulk transfers and configuration calls on them are recorded with their status and payload.
+// FTDI getQueueStatus is not recorded: it is polling, its answers depend on timing, and replay derives it.
+// Handles opened before TrafficCapture::start() are not captured.
+//
+// Installed with FTDIHandler::wrapTransport() / LibUsbHandler::wrapBackend(), or at start-up by setting
+// RADCAT_CAPTURE=<file> (see System).
+class CaptureFTDITransport : public FTDITransport {
+public:
+    explicit CaptureFTDITransport(std::unique_ptr<FTDITransport> wrapped) : inner(std::move(wrapped)) {}
+    FTDITransport& wrapped() { return *inner; }
+
+    FT_STATUS createDeviceInfoList(DWORD& deviceCount) override { return inner->createDeviceInfoList(deviceCount); }
+    FT_STATUS getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) override { return inner->getDeviceInfoDetail(index, info); }
+    FT_STATUS open(int index, FT_HANDLE& handle) override;
+    FT_STATUS close(FT_HANDLE handle) override;
+    FT_STATUS resetDevice(FT_HANDLE handle) override;
+    FT_STATUS purge(FT_HANDLE handle, ULONG mask) override;
+    FT_STATUS setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) override;
+    FT_STATUS setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) override;
+    FT_STATUS setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) override;
+    FT_STATUS setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) override;
+    FT_STATUS setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) override;
+    FT_STATUS write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) override;
+    FT_STATUS read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) override;
+    FT_STATUS getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) override { return inner->getQueueStatus(handle, rxBytes); }
+
+private:
+    uint32_t streamOf(FT_HANDLE handle);
+    void control(FT_HANDLE handle, Capture::FtdiOp op, FT_STATUS status, const void* args, size_t size);
+
+    std::unique_ptr<FTDITransport> inner;
+    std::mutex streamMutex;
+    std::unordered_map<FT_HANDLE, uint32_t> streams;
+};
+
+class CaptureUsbBackend : public UsbBackend {
+public:
+    explicit CaptureUsbBackend(std::unique_ptr<UsbBackend> wrapped) : inner(std::move(wrapped)) {}
+    UsbBackend& wrapped() { return *inner; }
+
+    int initialize() override { return inner->initialize(); }
+    void shutdown() override { inner->shutdown(); }
+    int getDeviceList(std::vector<libusb_device*>& devices) override { return inner->getDeviceList(devices); }
+    void refDevice(libusb_device* device) override { inner->refDevice(device); }
+    void unrefDevice(libusb_device* device) override { inner->unrefDevice(device); }
+    int getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) override { return inner->getDeviceDescriptor(device, descriptor); }
+    uint8_t getBusNumber(libusb_device* device) override { return inner->getBusNumber(device); }
+    int getPortNumbers(libusb_device* device, uint8_t* ports, int length) override { return inner->getPortNumbers(device, ports, length); }
+    int open(libusb_device* device, libusb_device_handle** handle) override;
+    void close(libusb_device_handle* handle) override;
+    int getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) override {
+        return inner->getStringDescriptorAscii(handle, index, data, length);
+    }
+    int claimInterface(libusb_device_handle* handle, int interfaceNumber) override;
+    int releaseInterface(libusb_device_handle* handle, int interfaceNumber) override;
+    int bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                     int* transferred, unsigned int timeoutMs) override;
+    int registerHotplug(HotplugCallback callback) override { return inner->registerHotplug(std::move(callback)); }
+    void deregisterHotplug(int id) override { inner->deregisterHotplug(id); }
+    int handleEvents(int timeoutMs) override { return inner->handleEvents(timeoutMs); }
+
+private:
+    uint32_t streamOf(libusb_device_handle* handle);
+    std::string stringDescriptor(libusb_device_handle* handle, uint8_t index);
+
+    std::unique_ptr<UsbBackend> inner;
+    std::mutex streamMutex;
+    std::unordered_map<libusb_device_handle*, uint32_t> streams;
+};
@@ -0,0 +1,275 @@
+#include "EventLoop.hpp"
+#include "Debug.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <chrono>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <cstring>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    Metrics::Gauge& attachedStreams() {
+        static Metrics::Gauge& gauge = Metrics::Registry::Instance().gauge("radcat_io_streams", "Streams served by the I/O event loop");
+        return gauge;
+    }
+
+#ifndef _WIN32
+    constexpr uint64_t WakeId = 0; // epoll key of the eventfd, stream ids start at 1
+    constexpr int MaxEvents = 64;
+
+    ssize_t sendParts(EventLoop::Stream& stream, const iovec* parts, int count) {
+        if (!stream.isSocket) return ::writev(stream.fd, parts, count);
+        msghdr message{};
+        message.msg_iov = const_cast<iovec*>(parts);
+        message.msg_iovlen = static_cast<size_t>(count);
+        return ::sendmsg(stream.fd, &message, MSG_NOSIGNAL);
+    }
+#endif
+}
+
+bool EventLoop::waitForData(Stream& stream, size_t minBytes, int timeoutMs) {
+    std::unique_lock<std::mutex> lk(stream.waitMutex);
+    stream.dataArrived.wait_for(lk, std::chrono::milliseconds(timeoutMs), [&] { return stream.rx.size() >= minBytes || stream.hasFailed(); });
+    return stream.rx.size() >= minBytes;
+}
+
+size_t EventLoop::streamCount() const {
+    std::lock_guard<std::mutex> lk(streamsMutex);
+    return streams.size();
+}
+
+void EventLoop::wakeWaiters(Stream& stream) {
+    { std::lock_guard<std::mutex> lk(stream.waitMutex); }
+    stream.dataArrived.notify_all();
+}
+
+#ifndef _WIN32
+
+bool EventLoop::attach(Stream& stream) {
+    std::lock_guard<std::mutex> lk(streamsMutex);
+    if (!start()) return false;
+    const uint64_t id = nextStreamId++;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = id;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, stream.fd, &ev) != 0) {
+        Debug.Error("EventLoop: can not watch ", stream.name, ": ", std::strerror(errno));
+        return false;
+    }
+    stream.id = id;
+    streams[id] = &stream;
+    attachedStreams().set(static_cast<double>(streams.size()));
+    return true;
+}
+
+void EventLoop::detach(Stream& stream) {
+    std::lock_guard<std::mutex> lk(streamsMutex);
+    if (stream.fd < 0) return;
+    if (epollFd >= 0) epoll_ctl(epollFd, EPOLL_CTL_DEL, stream.fd, nullptr); // Already gone if the stream failed
+    streams.erase(stream.id);
+    ::close(stream.fd);
+    stream.fd = -1;
+    attachedStreams().set(static_cast<double>(streams.size()));
+}
+
+bool EventLoop::write(Stream& stream, std::span<const uint8_t> data) {
+    if (stream.hasFailed() || stream.fd < 0) return false;
+    if (data.empty()) return true;
+    std::lock_guard<std::mutex> lk(stream.txMutex);
+    SpscByteRing& tx = stream.tx;
+    if (tx.capacity() - tx.size() < data.size()) {
+        Debug.Warn("Transmit buffer of ", stream.name, " is full, dropping a ", data.size(), " byte write.");
+        return false;
+    }
+    // Nothing queued: hand it to the driver from here, the loop thread only sends what does not fit
+    size_t sent = 0;
+    if (tx.empty()) {
+        const iovec part{ const_cast<uint8_t*>(data.data()), data.size() };
+        const ssize_t n = sendParts(stream, &part, 1);
+        if (n > 0) {
+            sent = static_cast<size_t>(n);
+            stream.metrics.txBytes.add(sent);
+        }
+        // Errors other than a full driver buffer show up on the loop thread as EPOLLERR or EPOLLHUP
+    }
+    if (sent == data.size()) return true;
+    tx.write(data.subspan(sent));
+    armWrite(stream);
+    return true;
+}
+
+void EventLoop::fail(Stream& stream, const char* reason) {
+    if (stream.failed.exchange(true, std::memory_order_acq_rel)) return;
+    Debug.Warn(stream.name, " failed: ", reason);
+    if (epollFd >= 0 && stream.fd >= 0) epoll_ctl(epollFd, EPOLL_CTL_DEL, stream.fd, nullptr);
+    wakeWaiters(stream);
+}
+
+bool EventLoop::stop() {
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lk(streamsMutex);
+        if (!thread.joinable()) return false;
+        stopping.store(true, std::memory_order_release);
+        const uint64_t one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0) Debug.Warn("EventLoop: could not wake the loop thread.");
+        finished = std::move(thread);
+    }
+    finished.join();
+    std::lock_guard<std::mutex> lk(streamsMutex);
+    ::close(wakeFd);
+    ::close(epollFd);
+    wakeFd = epollFd = -1;
+    return true;
+}
+
+// Called with streamsMutex held
+bool EventLoop::start() {
+    if (thread.joinable()) return true;
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WakeId;
+    if (epollFd < 0 || wakeFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0) {
+        Debug.Error("EventLoop: could not set up epoll: ", std::strerror(errno));
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (epollFd >= 0) ::close(epollFd);
+        wakeFd = epollFd = -1;
+        return false;
+    }
+    // Streams attached before a stop() are served again
+    for (const auto& [id, stream] : streams) {
+        epoll_event watch{};
+        watch.events = stream->writeArmed.load(std::memory_order_acquire) ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        watch.data.u64 = id;
+        if (!stream->hasFailed()) epoll_ctl(epollFd, EPOLL_CTL_ADD, stream->fd, &watch);
+    }
+    stopping.store(false, std::memory_order_release);
+    thread = std::thread(&EventLoop::run, this);
+    return true;
+}
+
+void EventLoop::run() {
+    Trace::setThreadName("io");
+    static Metrics::Counter& wakeups = Metrics::Registry::Instance().counter("radcat_io_wakeups_total", "Times the I/O event loop woke up");
+    epoll_event ready[MaxEvents];
+    while (!stopping.load(std::memory_order_acquire)) {
+        const int n = epoll_wait(epollFd, ready, MaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            Debug.Error("EventLoop: epoll_wait failed: ", std::strerror(errno));
+            return;
+        }
+        wakeups.add();
+
+        std::lock_guard<std::mutex> lk(streamsMutex);
+        for (int i = 0; i < n; ++i) {
+            auto it = streams.find(ready[i].data.u64);
+            if (it == streams.end()) continue; // The wake-up, or a stream detached since epoll_wait returned
+            Stream& stream = *it->second;
+            const uint32_t flags = ready[i].events;
+            if (flags & EPOLLIN) readStream(stream);
+            if (flags & EPOLLOUT) flushStream(stream);
+            if (flags & (EPOLLERR | EPOLLHUP)) fail(stream, flags & EPOLLHUP ? "hung up" : "error");
+        }
+    }
+}
+
+void EventLoop::armWrite(Stream& stream) {
+    if (stream.writeArmed.exchange(true, std::memory_order_acq_rel)) return;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u64 = stream.id;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, stream.fd, &ev); // Fails only once the stream failed
+}
+
+// Reads everything the fd holds straight into the receive ring
+void EventLoop::readStream(Stream& stream) {
+    if (stream.hasFailed()) return;
+    size_t received = 0;
+    bool closed = false;
+    for (;;) {
+        SpscByteRing::Spans<uint8_t> free = stream.rx.writable();
+        ssize_t n;
+        if (free.empty()) {
+            // The owner does not keep up: keep the fd drained and drop the newest bytes, like a UART overrun
+            uint8_t sink[4096];
+            n = ::read(stream.fd, sink, sizeof(sink));
+            if (n > 0) {
+                if (stream.overruns.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed) == 0)
+                    Debug.Warn("Receive buffer of ", stream.name, " is full, dropping input.");
+                stream.metrics.overrunBytes.add(static_cast<uint64_t>(n));
+                continue;
+            }
+        }
+        else {
+            iovec parts[2] = { { free.first.data(), free.first.size() }, { free.second.data(), free.second.size() } };
+            n = ::readv(stream.fd, parts, free.second.empty() ? 1 : 2);
+            if (n > 0) {
+                stream.rx.commit(static_cast<size_t>(n));
+                received += static_cast<size_t>(n);
+                if (static_cast<size_t>(n) < free.size()) break; // Drained, level-triggered epoll reports anything newer
+                continue;
+            }
+        }
+        // A raw tty returns 0 when it has nothing (VMIN and VTIME are 0) and reports hang-ups as EPOLLHUP or EIO,
+        // a socket returns 0 once the peer closed it
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) fail(stream, std::strerror(errno));
+        closed = n == 0 && stream.isSocket;
+        break;
+    }
+    if (received) {
+        stream.metrics.rxBytes.add(received);
+        wakeWaiters(stream);
+    }
+    if (closed) fail(stream, "closed by peer");
+}
+
+// Sends the queued writes as far as the fd takes them, stops watching for EPOLLOUT once they are out
+void EventLoop::flushStream(Stream& stream) {
+    if (stream.hasFailed()) return;
+    for (;;) {
+        SpscByteRing::Spans<const uint8_t> pending = stream.tx.readable();
+        if (pending.empty()) break;
+        iovec parts[2] = { { const_cast<uint8_t*>(pending.first.data()), pending.first.size() }, { const_cast<uint8_t*>(pending.second.data()), pending.second.size() } };
+        const ssize_t n = sendParts(stream, parts, pending.second.empty() ? 1 : 2);
+        if (n > 0) {
+            stream.tx.consume(static_cast<size_t>(n));
+            stream.metrics.txBytes.add(static_cast<uint64_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return; // Stays armed
+        fail(stream, n < 0 ? std::strerror(errno) : "write failed");
+        return;
+    }
+    // Disarm before clearing the flag: a write() that sees the flag cleared re-arms after this MOD, never before it.
+    // One that still saw it set returned without arming, the exchange syncs with it so the re-check finds its bytes.
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = stream.id;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, stream.fd, &ev);
+    stream.writeArmed.exchange(false, std::memory_order_acq_rel);
+    if (!stream.tx.empty()) armWrite(stream); // write() queued more while this was disarming
+}
+
+#else
+
+bool EventLoop::attach(Stream& stream) {
+    Debug.Error("The I/O event loop is not supported on this platform yet, can not serve ", stream.name);
+    return false;
+}
+void EventLoop::detach(Stream&) {}
+bool EventLoop::write(Stream&, std::span<const uint8_t>) { return false; }
+void EventLoop::fail(Stream& stream, const char*) { stream.failed.store(true, std::memory_order_release); wakeWaiters(stream); }
+bool EventLoop::stop() { return false; }
+
+#endif
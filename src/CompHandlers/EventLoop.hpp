@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "Diagnostics/Metrics.hpp"
+#include "Utils/RingBuffer.hpp"
+
+// One I/O thread for every non-blocking byte stream RadCat talks to: serial ports (SerialConnection) and network
+// instruments (TcpInstrumentConnection). It waits on all of them with epoll, reads whatever arrives straight into
+// the stream's receive ring and sends the stream's queued writes as the fd drains, so dozens of instruments cost
+// one thread instead of a blocking reader each. The thread starts with the first stream.
+//
+// Linux only for now; elsewhere attach() fails.
+class EventLoop {
+public:
+    static EventLoop& Instance(){static EventLoop instance; return instance;}
+
+    // Traffic of one stream, registered by its owner with its own names and labels
+    struct StreamMetrics {
+        Metrics::Counter& rxBytes;
+        Metrics::Counter& txBytes;
+        Metrics::Counter& overrunBytes;      // Received bytes dropped because the receive ring was full
+    };
+
+    // An open fd and its buffers, shared by its owner and the loop thread. Lives on the heap while attached.
+    struct Stream {
+        Stream(std::string streamName, int streamFd, bool socket, size_t receiveBufferSize, size_t transmitBufferSize, const StreamMetrics& streamMetrics)
+        : name(std::move(streamName)), fd(streamFd), isSocket(socket), rx(receiveBufferSize), tx(transmitBufferSize), metrics(streamMetrics) {}
+
+        const std::string name;              // Port path or host:port, for logs
+        int fd;                              // Closed by detach()
+        const bool isSocket;                 // Sent with MSG_NOSIGNAL, a closed peer must not raise SIGPIPE
+        uint64_t id = 0;                     // Key in the loop's stream table
+
+        SpscByteRing rx;                     // Loop thread -> owner
+        SpscByteRing tx;                     // Owner -> loop thread
+        std::mutex txMutex;                  // One writer at a time
+        std::atomic<bool> writeArmed{false}; // Loop waits for the fd to drain tx
+        std::atomic<bool> failed{false};
+        std::atomic<uint64_t> overruns{0};
+
+        std::mutex waitMutex;
+        std::condition_variable dataArrived;
+        StreamMetrics metrics;
+
+        bool hasFailed() const { return failed.load(std::memory_order_acquire); }
+    };
+
+    // Starts serving a stream whose fd is open and non-blocking.
+    bool attach(Stream& stream);
+    // Stops serving the stream and closes its fd. Once this returns the loop thread no longer touches it.
+    void detach(Stream& stream);
+
+    // Writes data from the calling thread while nothing is queued, queues what the fd does not take right away.
+    // All or nothing: false, with nothing sent, if the stream failed or its transmit ring can not take all of it.
+    bool write(Stream& stream, std::span<const uint8_t> data);
+    // Waits until at least minBytes are received. False on timeout or failure.
+    bool waitForData(Stream& stream, size_t minBytes, int timeoutMs);
+    // Marks the stream failed and stops serving it, e.g. when its owner lost track of the protocol.
+    void fail(Stream& stream, const char* reason);
+
+    // Stops the loop thread. Streams still attached are no longer served, detach() still closes them.
+    bool stop();
+    size_t streamCount() const;
+
+private:
+    EventLoop() = default;
+    ~EventLoop() { stop(); }
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool start();
+    void run();
+    void armWrite(Stream& stream);
+    void readStream(Stream& stream);
+    void flushStream(Stream& stream);
+    static void wakeWaiters(Stream& stream);
+
+    int epollFd = -1;
+    int wakeFd = -1;                         // eventfd that interrupts the loop on stop()
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+
+    mutable std::mutex streamsMutex;         // Held by the loop thread while it works on streams
+    std::unordered_map<uint64_t, Stream*> streams;
+    uint64_t nextStreamId = 1;
+};
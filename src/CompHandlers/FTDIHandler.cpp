@@ -1,7 +1,19 @@
 #include "FTDIHandler.hpp"
+#include "LibUsbFTDITransport.hpp"
 #include "Debug.hpp"
+#include "Diagnostics/Trace.hpp"
+#include "Utils/SchedulerClock.hpp"
 #include <thread>
 #include <chrono>
+#include <cstring>
+
+namespace {
+    // Multi-interface chips, newer than the bundled ftd2xx.h
+    constexpr ULONG DeviceType2232H = 6;
+    constexpr ULONG DeviceType4232H = 7;
+}
+
+FTDIHandler::FTDIHandler() : transports{ std::make_unique<D2xxTransport>(), std::make_unique<LibUsbFTDITransport>() } {}
 
 bool FTDIHandler::initialize() {
    
@@ -19,9 +31,9 @@ FT_STATUS FTDIHandler::sendData(FT_HANDLE deviceHandle, const unsigned char* dat
     if (size == 0) { Debug.Warn("FTDI sendData: zero size requested"); return FT_OK; }
     if (!deviceHandle) { Debug.Error("FTDI sendData: device not connected"); return FT_INVALID_HANDLE; }
     DWORD bytesWritten = 0;
-    FT_STATUS ftStatus = FT_Write(deviceHandle, (LPVOID)data, size, &bytesWritten);
-    if(ftStatus != FT_OK){ Debug.Error("FTDI Write Error: " + std::to_string(ftStatus)); }
-    else if(bytesWritten != size) {Debug.Warn("FTDI sendData: requested " + std::to_string(size) + " bytes, but wrote " + std::to_string(bytesWritten) + " bytes.");}
+    FT_STATUS ftStatus = getTransport().write(deviceHandle, data, size, bytesWritten);
+    if(ftStatus != FT_OK){ DEBUG_ERROR(LogCategory::FTDI, "FTDI Write Error: ", ftStatus); }
+    else if(bytesWritten != size) {DEBUG_WARN(LogCategory::FTDI, "FTDI sendData: requested ", size, " bytes, but wrote ", bytesWritten, " bytes.");}
     return ftStatus;
 }
 
@@ -30,15 +42,69 @@ FT_STATUS FTDIHandler::receiveData(FT_HANDLE deviceHandle, unsigned char* buffer
     if (!buffer) { Debug.Error("FTDI receiveData: null buffer pointer"); return FT_INVALID_PARAMETER; }
     if (size == 0) { Debug.Warn("FTDI receiveData: zero size requested"); return FT_OK; }
     if (!deviceHandle) { Debug.Error("FTDI receiveData: device not connected"); return FT_INVALID_HANDLE; }
-    FT_STATUS ftStatus = FT_Read(deviceHandle, buffer, size, &bytesRead);
-    if (ftStatus != FT_OK) { Debug.Error("FTDI Read Error: " + std::to_string(ftStatus)); }
-    else if (bytesRead == 0) { Debug.Warn("FTDI Read: no data available"); }
-    else if constexpr (debug) { Debug.Log("FTDI received " + std::to_string(bytesRead) + " bytes"); }
+    FT_STATUS ftStatus = getTransport().read(deviceHandle, buffer, size, bytesRead);
+    if (ftStatus != FT_OK) { DEBUG_ERROR(LogCategory::FTDI, "FTDI Read Error: ", ftStatus); }
+    else if (bytesRead == 0) { DEBUG_WARN(LogCategory::FTDI, "FTDI Read: no data available"); }
+    else { DEBUG_LOG(LogCategory::FTDI, "FTDI received ", bytesRead, " bytes"); }
     return ftStatus;
 }
 
+void FTDIHandler::setTransport(std::unique_ptr<FTDITransport> newTransport, Backend backend) {
+    if (!newTransport) return;
+    std::lock_guard<std::mutex> lk(mapMutex);
+    handleSyncMap.clear(); // Handles of the old transport mean nothing to the new one
+    transports[static_cast<int>(backend)] = std::move(newTransport);
+}
+
+void FTDIHandler::wrapTransport(const std::function<std::unique_ptr<FTDITransport>(std::unique_ptr<FTDITransport>)>& wrap) {
+    std::lock_guard<std::mutex> lk(mapMutex);
+    for (auto& transport : transports) transport = wrap(std::move(transport));
+    handleSyncMap.clear();
+}
+
+void FTDIHandler::setDefaultBackend(Backend backend) {
+    std::lock_guard<std::mutex> lk(backendMutex);
+    defaultBackend = backend;
+}
+
+void FTDIHandler::setBackend(const std::string& serial, Backend backend) {
+    std::lock_guard<std::mutex> lk(backendMutex);
+    backendBySerial[serial] = backend;
+}
+
+FTDIHandler::Backend FTDIHandler::backendFor(const FT_DEVICE_LIST_INFO_NODE& info) const {
+    std::lock_guard<std::mutex> lk(backendMutex);
+    auto it = backendBySerial.find(std::string(info.SerialNumber, strnlen(info.SerialNumber, sizeof(info.SerialNumber))));
+    if (it == backendBySerial.end()) it = backendBySerial.find(interfaceOf(info).chip);
+    return it != backendBySerial.end() ? it->second : defaultBackend;
+}
+
+// D2XX lists every interface of a multi-interface chip with the channel letter appended to the serial
+// ("FT5XQ1ZLA") and to the description ("Quad RS232-HS A"). Interfaces without a serial are grouped by
+// location, the interfaces of one chip have consecutive LocIds.
+FTDIHandler::ChipInterface FTDIHandler::interfaceOf(const FT_DEVICE_LIST_INFO_NODE& info) {
+    ChipInterface iface;
+    iface.chip.assign(info.SerialNumber, strnlen(info.SerialNumber, sizeof(info.SerialNumber)));
+    switch (info.Type) {
+        case FT_DEVICE_2232C:
+        case DeviceType2232H: iface.channels = 2; break;
+        case DeviceType4232H: iface.channels = 4; break;
+        default: return iface;
+    }
+
+    const std::string description(info.Description, strnlen(info.Description, sizeof(info.Description)));
+    const char letter = !iface.chip.empty() ? iface.chip.back() : (description.size() > 2 && description[description.size() - 2] == ' ') ? description.back() : 0;
+    if (letter >= 'A' && letter < 'A' + iface.channels) {
+        iface.channel = letter - 'A';
+        if (!iface.chip.empty()) iface.chip.pop_back();
+    }
+    if (iface.chip.empty()) iface.chip = "loc" + std::to_string(info.LocId - iface.channel);
+    iface.hasMPSSE = info.Type != DeviceType4232H || iface.channel < 2; // FT4232H: MPSSE on A and B only
+    return iface;
+}
+
 // DeviceSession Methods
-std::shared_ptr<FTDIHandler::DeviceSession> FTDIHandler::getSession(FT_HANDLE handle, const FT_DEVICE_LIST_INFO_NODE& info) {
+std::shared_ptr<FTDIHandler::DeviceSession> FTDIHandler::getSession(FT_HANDLE handle, const FT_DEVICE_LIST_INFO_NODE& info, Backend backend) {
     if (!handle) return nullptr;
     std::lock_guard<std::mutex> lk(mapMutex);
     auto it = handleSyncMap.find(handle);
@@ -49,19 +115,70 @@ std::shared_ptr<FTDIHandler::DeviceSession> FTDIHandler::getSession(FT_HANDLE ha
         auto newIt = handleSyncMap.emplace(handle, std::move(sp)).first;
         it = newIt;
     }
-    return std::shared_ptr<DeviceSession>(new DeviceSession(handle, info, it->second.tx, it->second.rx));
+
+    const std::string chip = interfaceOf(info).chip;
+    std::shared_ptr<DeviceSession::ChipLink> link = chipLinks[chip].lock();
+    if (!link) {
+        link = std::make_shared<DeviceSession::ChipLink>();
+        Metrics::Registry& reg = Metrics::Registry::Instance();
+        const Metrics::Labels labels = { {"chip", chip} };
+        link->txBytes = &reg.counter("radcat_ftdi_chip_tx_bytes_total", "Bytes written over the chip's USB link, all interfaces", labels);
+        link->rxBytes = &reg.counter("radcat_ftdi_chip_rx_bytes_total", "Bytes read over the chip's USB link, all interfaces", labels);
+        link->calls = &reg.counter("radcat_ftdi_chip_calls_total", "Driver read and write calls on the chip, all interfaces", labels);
+        link->overlappedCalls = &reg.counter("radcat_ftdi_chip_overlapped_calls_total", "Driver calls started while another call on the chip was in progress", labels);
+        link->openInterfaces = &reg.gauge("radcat_ftdi_chip_open_interfaces", "Interfaces of the chip with an open session", labels);
+        chipLinks[chip] = link;
+    }
+    link->openInterfaces->set(++link->sessions);
+    return std::shared_ptr<DeviceSession>(new DeviceSession(getTransport(backend), handle, info, it->second.tx, it->second.rx, std::move(link)));
+}
+
+FTDIHandler::DeviceSession::~DeviceSession() {
+    if (link) link->openInterfaces->set(--link->sessions);
+}
+
+void FTDIHandler::DeviceSession::linkEnter() {
+    link->calls->add();
+    if (link->inFlight.fetch_add(1, std::memory_order_relaxed) > 0) link->overlappedCalls->add();
+}
+
+void FTDIHandler::DeviceSession::linkLeave(uint64_t txBytes, uint64_t rxBytes) {
+    link->inFlight.fetch_sub(1, std::memory_order_relaxed);
+    if (txBytes) link->txBytes->add(txBytes);
+    if (rxBytes) link->rxBytes->add(rxBytes);
+}
+
+void FTDIHandler::DeviceSession::registerMetrics() {
+    Metrics::Registry& reg = Metrics::Registry::Instance();
+    const Metrics::Labels labels = { {"device", devInfo.Description}, {"serial", devInfo.SerialNumber} };
+    metrics.txBytes = &reg.counter("radcat_ftdi_tx_bytes_total", "Bytes written to the FTDI device", labels);
+    metrics.rxBytes = &reg.counter("radcat_ftdi_rx_bytes_total", "Bytes read from the FTDI device", labels);
+    metrics.sendLatency = &reg.histogram("radcat_ftdi_send_seconds", "Driver write call time", labels);
+    metrics.receiveLatency = &reg.histogram("radcat_ftdi_receive_seconds", "Driver read call time", labels);
+    metrics.txLockWait = &reg.histogram("radcat_ftdi_tx_lock_wait_seconds", "Time spent waiting for the session tx mutex", labels);
+    metrics.rxLockWait = &reg.histogram("radcat_ftdi_rx_lock_wait_seconds", "Time spent waiting for the session rx mutex", labels);
+    metrics.pollWait = &reg.histogram("radcat_ftdi_poll_wait_seconds", "pollData time until data arrived or timed out", labels);
+    metrics.pollTimeouts = &reg.counter("radcat_ftdi_poll_timeouts_total", "pollData calls that timed out", labels);
 }
 
 FT_STATUS FTDIHandler::DeviceSession::send(const unsigned char* data, DWORD size) {
     if (!data) { Debug.Error("FTDI sendData: null data pointer"); return FT_INVALID_PARAMETER; }
     if (size == 0) { Debug.Warn("FTDI sendData: zero size requested"); return FT_OK; }
     if (!ftHandle) { Debug.Error("FTDI sendData: device not connected"); return FT_INVALID_HANDLE; }
+    RC_TRACE_SCOPE_DETAIL("ftdi", "send", devInfo.Description);
 
+    const auto lockStart = Metrics::Clock::now();
     std::lock_guard<std::mutex> txLock(*txMutex);
+    const auto callStart = Metrics::Clock::now();
+    metrics.txLockWait->record(callStart - lockStart);
     DWORD bytesWritten = 0;
-    FT_STATUS ftStatus = FT_Write(ftHandle, (LPVOID)data, size, &bytesWritten);
-    if(ftStatus != FT_OK){ Debug.Error("FTDI Write Error: " + std::to_string(ftStatus)); }
-    else if(bytesWritten != size) {Debug.Warn("FTDI sendData: requested " + std::to_string(size) + " bytes, but wrote " + std::to_string(bytesWritten) + " bytes.");}
+    linkEnter();
+    FT_STATUS ftStatus = transport->write(ftHandle, data, size, bytesWritten);
+    linkLeave(bytesWritten, 0);
+    metrics.sendLatency->recordSince(callStart);
+    metrics.txBytes->add(bytesWritten);
+    if(ftStatus != FT_OK){ DEBUG_ERROR(LogCategory::FTDI, "FTDI Write Error: ", ftStatus); }
+    else if(bytesWritten != size) {DEBUG_WARN(LogCategory::FTDI, "FTDI sendData: requested ", size, " bytes, but wrote ", bytesWritten, " bytes.");}
     return ftStatus;
 }
 
@@ -70,44 +187,66 @@ FT_STATUS FTDIHandler::DeviceSession::receive(unsigned char* buffer, DWORD size,
     if (!buffer) { Debug.Error("FTDI receiveData: null buffer pointer"); return FT_INVALID_PARAMETER; }
     if (size == 0) { Debug.Warn("FTDI receiveData: zero size requested"); return FT_OK; }
     if (!ftHandle) { Debug.Error("FTDI receiveData: device not connected"); return FT_INVALID_HANDLE; }
+    RC_TRACE_SCOPE_DETAIL("ftdi", "receive", devInfo.Description);
 
+    const auto lockStart = Metrics::Clock::now();
     std::lock_guard<std::mutex> rxLock(*rxMutex);
-    FT_STATUS ftStatus = FT_Read(ftHandle, buffer, size, &bytesRead);
-    if (ftStatus != FT_OK) { Debug.Error("FTDI Read Error: " + std::to_string(ftStatus)); }
-    else if (bytesRead == 0) { Debug.Warn("FTDI Read: no data available"); }
-    else if constexpr (FTDIHandler::debug) { Debug.Log("FTDI received " + std::to_string(bytesRead) + " bytes"); }
+    const auto callStart = Metrics::Clock::now();
+    metrics.rxLockWait->record(callStart - lockStart);
+    linkEnter();
+    FT_STATUS ftStatus = transport->read(ftHandle, buffer, size, bytesRead);
+    linkLeave(0, bytesRead);
+    metrics.receiveLatency->recordSince(callStart);
+    metrics.rxBytes->add(bytesRead);
+    if (ftStatus != FT_OK) { DEBUG_ERROR(LogCategory::FTDI, "FTDI Read Error: ", ftStatus); }
+    else if (bytesRead == 0) { DEBUG_WARN(LogCategory::FTDI, "FTDI Read: no data available"); }
+    else { DEBUG_LOG(LogCategory::FTDI, "FTDI received ", bytesRead, " bytes"); }
     return ftStatus;
 }
 
+FT_STATUS FTDIHandler::DeviceSession::purge(ULONG mask) {
+    if (!ftHandle) { Debug.Error("FTDI purge: device not connected"); return FT_INVALID_HANDLE; }
+    std::unique_lock<std::mutex> txLock(*txMutex, std::defer_lock);
+    std::unique_lock<std::mutex> rxLock(*rxMutex, std::defer_lock);
+    if (mask & FT_PURGE_TX) txLock.lock();
+    if (mask & FT_PURGE_RX) rxLock.lock();
+    return transport->purge(ftHandle, mask);
+}
+
 bool FTDIHandler::DeviceSession::pollData(DWORD bytesToRead, DWORD& bytesRead, int timeoutMs) {
     bytesRead = 0;
     if (!ftHandle || bytesToRead == 0) { Debug.Error("PollData: Invalid handle or bytesToRead."); return false; }
     if (timeoutMs <= 0) { Debug.Error("PollData: timeout must be positive."); return false; }
+    RC_TRACE_SCOPE_DETAIL("ftdi", "pollData", devInfo.Description);
 
-    const int pollInterval = 20; // ms
-    int elapsed = 0;
+    const std::chrono::microseconds pollInterval = FTDIHandler::Instance().getPollInterval();
+    SchedulerClock& clock = SchedulerClock::current();
+    const auto deadline = clock.now() + std::chrono::milliseconds(timeoutMs);
     DWORD rxBytes = 0;
 
     // Lock rx mutex for per-handle synchronization with receive()
+    const auto lockStart = Metrics::Clock::now();
     std::lock_guard<std::mutex> rxLock(*rxMutex);
+    const auto pollStart = Metrics::Clock::now();
+    metrics.rxLockWait->record(pollStart - lockStart);
 
-    while (bytesRead < bytesToRead && elapsed < timeoutMs) {
-        FT_STATUS st = FT_GetQueueStatus(ftHandle, &rxBytes);
-        if (st != FT_OK) {Debug.Error("FTDI GetQueueStatus error: " + std::to_string(st)); return false;}
+    while (bytesRead < bytesToRead && clock.now() < deadline) {
+        FT_STATUS st = transport->getQueueStatus(ftHandle, rxBytes);
+        if (st != FT_OK) {DEBUG_ERROR(LogCategory::FTDI, "FTDI GetQueueStatus error: ", st); return false;}
         if (rxBytes > 0) {
             bytesRead = rxBytes;
             if (bytesRead > bytesToRead) bytesRead = bytesToRead;
         }
         if (bytesRead >= bytesToRead) break;
-        std::this_thread::sleep_for(std::chrono::milliseconds(pollInterval));
-        elapsed += pollInterval;
+        clock.sleepFor(pollInterval);
     }
 
-    if (bytesRead < bytesToRead) {Debug.Warn("PollData: Timeout waiting for data. Requested: " + std::to_string(bytesToRead) + ", Received: " + std::to_string(bytesRead));
+    metrics.pollWait->recordSince(pollStart);
+    if (bytesRead < bytesToRead) {metrics.pollTimeouts->add(); DEBUG_WARN(LogCategory::FTDI, "PollData: Timeout waiting for data. Requested: ", bytesToRead, ", Received: ", bytesRead);
         return false;
     }
 
-    if constexpr (FTDIHandler::debug) Debug.Log("PollData: Successfully polled " + std::to_string(bytesRead) + " bytes of data.");
+    DEBUG_LOG(LogCategory::FTDI, "PollData: Successfully polled ", bytesRead, " bytes of data.");
     return true;
 }
 
@@ -122,30 +261,32 @@ bool FTDIHandler::DeviceSession::openMPSSE() {
     }
 
     if (!ftHandle) { Debug.Error("OpenMPSSE: invalid FT_HANDLE"); return false; }
+    if (!iface.hasMPSSE) { Debug.Error("OpenMPSSE: interface ", static_cast<char>('A' + iface.channel), " of ", devInfo.Description, " has no MPSSE"); return false; }
+    RC_TRACE_SCOPE_DETAIL("ftdi", "openMPSSE", devInfo.Description);
 
     std::lock_guard<std::mutex> txLock(*txMutex);
     std::lock_guard<std::mutex> rxLock(*rxMutex);
 
     unsigned char tx[5]; unsigned char rx[5]; FT_STATUS status; DWORD ret_bytes;
     //Set USB Parameters and Latency Timer
-    FT_SetUSBParameters(ftHandle, 65536, 65536); //Set USB request transfer sizes
-    FT_SetLatencyTimer(ftHandle, 4); //4ms
-    FT_SetTimeouts(ftHandle, 40, 40); //40ms read/write timeouts
-    FT_SetFlowControl(ftHandle, FT_FLOW_RTS_CTS, 0, 0);
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    transport->setUSBParameters(ftHandle, 65536, 65536); //Set USB request transfer sizes
+    transport->setLatencyTimer(ftHandle, 4); //4ms
+    transport->setTimeouts(ftHandle, 40, 40); //40ms read/write timeouts
+    transport->setFlowControl(ftHandle, FT_FLOW_RTS_CTS, 0, 0);
+    SchedulerClock::current().sleepFor(std::chrono::milliseconds(20));
 
-    status = FT_SetBitMode(ftHandle, 0x0, 0x02);  //enable MPSSE 
-    if(status != FT_OK){Debug.Error("Failed to enable MPSSE: " + std::to_string(status)); return false;}
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-    FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
+    status = transport->setBitMode(ftHandle, 0x0, 0x02);  //enable MPSSE 
+    if(status != FT_OK){Debug.Error("Failed to enable MPSSE: ", status); return false;}
+    SchedulerClock::current().sleepFor(std::chrono::milliseconds(20));
+    transport->purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
 
     //Test MPSSE by sending command 0xAA and expecting response 0xFA 0xAA
     tx[0] = 0xAA;
-    FT_Write(ftHandle, tx, 1, &ret_bytes);
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-    FT_Read(ftHandle, rx, 2, &ret_bytes);
+    transport->write(ftHandle, tx, 1, ret_bytes);
+    SchedulerClock::current().sleepFor(std::chrono::milliseconds(20));
+    transport->read(ftHandle, rx, 2, ret_bytes);
     // Expect: 0xFA 0xAA back
-    if (ret_bytes == 2 && rx[0] == 0xFA && rx[1] == 0xAA) { if constexpr (FTDIHandler::debug) Debug.Log("MPSSE ENGINE OK."); }
+    if (ret_bytes == 2 && rx[0] == 0xFA && rx[1] == 0xAA) { DEBUG_LOG(LogCategory::FTDI, "MPSSE ENGINE OK."); }
     else { Debug.Error("Unexpected response from MPSSE engine."); return false; }
     return true;
 }
@@ -154,36 +295,53 @@ bool FTDIHandler::DeviceSession::connectionStatus() {
     if (!ftHandle) return false;
     DWORD rxBytes = 0;
     std::lock_guard<std::mutex> rxLock(*rxMutex);
-    FT_STATUS status = FT_GetQueueStatus(ftHandle, &rxBytes);
+    FT_STATUS status = transport->getQueueStatus(ftHandle, rxBytes);
     return (status == FT_OK);
 }
 
 int FTDIHandler::getDeviceCount() {
-    if constexpr(debug) Debug.Log("FTDIHandler: Scanning for FTDI devices...");
+    DEBUG_LOG(LogCategory::FTDI, "FTDIHandler: Scanning for FTDI devices...");
     FT_STATUS status; DWORD numDevs;
-    status = FT_CreateDeviceInfoList(&numDevs);
+    Backend backend;
+    { std::lock_guard<std::mutex> lk(backendMutex); backend = defaultBackend; }
+    status = getTransport(backend).createDeviceInfoList(numDevs);
     if (status != FT_OK) {Debug.Error("Error getting device list: " , status); return -1;}
-    if (numDevs == 0) {Debug.Warn("No FTDI devices found."); return 0;}
-    if constexpr(debug) Debug.Log("Number of FTDI devices found: " , numDevs);
+    if (numDevs == 0) {DEBUG_WARN(LogCategory::Scan, "No FTDI devices found."); return 0;}
+    DEBUG_LOG(LogCategory::FTDI, "Number of FTDI devices found: " , numDevs);
     return static_cast<int>(numDevs);
 }
 
 std::vector<FTDIHandler::ScannedDeviceInfo> FTDIHandler::scanDevices() {
-    if constexpr(debug) Debug.Log("FTDIHandler: Scanning for FTDI devices...");
-    FT_STATUS status; DWORD numDevs;
+    RC_TRACE_SCOPE("ftdi", "scanDevices");
+    DEBUG_LOG(LogCategory::FTDI, "FTDIHandler: Scanning for FTDI devices...");
 
-    status = FT_CreateDeviceInfoList(&numDevs);
+    // A backend is only asked when some device may use it, both list every chip they can reach
+    bool used[2] = {false, false};
+    {
+        std::lock_guard<std::mutex> lk(backendMutex);
+        used[static_cast<int>(defaultBackend)] = true;
+        for (const auto& [serial, backend] : backendBySerial) used[static_cast<int>(backend)] = true;
+    }
     std::vector<ScannedDeviceInfo> scannedDevices;
-    if (status != FT_OK) {Debug.Error("Error getting device list: " , status); return scannedDevices;}
-    if (numDevs == 0) {Debug.Warn("No FTDI devices found."); return scannedDevices;}
+    if (used[static_cast<int>(Backend::D2xx)]) scanBackend(Backend::D2xx, scannedDevices);
+    if (used[static_cast<int>(Backend::LibUsb)]) scanBackend(Backend::LibUsb, scannedDevices);
+    if (scannedDevices.empty()) DEBUG_WARN(LogCategory::Scan, "No FTDI devices found.");
+    return scannedDevices;
+}
+
+void FTDIHandler::scanBackend(Backend backend, std::vector<ScannedDeviceInfo>& scannedDevices) {
+    FT_STATUS status; DWORD numDevs;
+    FTDITransport& transport = getTransport(backend);
+    status = transport.createDeviceInfoList(numDevs);
+    if (status != FT_OK) {Debug.Error("Error getting device list: " , status); return;}
 
     for (DWORD i = 0; i < numDevs; i++) {
         FT_DEVICE_LIST_INFO_NODE devInfo;
-        status = FT_GetDeviceInfoDetail(i, &devInfo.Flags, &devInfo.Type, &devInfo.ID, &devInfo.LocId, devInfo.SerialNumber, devInfo.Description, &devInfo.ftHandle);
+        status = transport.getDeviceInfoDetail(i, devInfo);
         if (status != FT_OK) {Debug.Error("Error getting device info for device " , i , ": " , status); continue;}
-        scannedDevices.push_back({devInfo, static_cast<int>(i)});
-        if constexpr(debug) Debug.Log("Found FTDI Device - Type: " , devInfo.Type , ", ID: " , devInfo.ID , ", Description: " , devInfo.Description);
+        if (backendFor(devInfo) != backend) continue; // Listed by the other backend
+        scannedDevices.push_back({devInfo, static_cast<int>(i), interfaceOf(devInfo), backend});
+        DEBUG_LOG(LogCategory::FTDI, "Found FTDI Device - Type: " , devInfo.Type , ", ID: " , devInfo.ID , ", Description: " , devInfo.Description,
+                  backend == Backend::LibUsb ? " (libusb)" : "");
     }
-    
-    return scannedDevices;
-}
\ No newline at end of file
+}
@@ -1,18 +1,37 @@
 #pragma once
 #include "BaseComponentHandler.hpp"
+#include "FTDITransport.hpp"
+#include "Diagnostics/Metrics.hpp"
 #include <ftd2xx.h>
+#include <functional>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 class FTDIHandler : public BaseComponentHandler {
 public:
-    constexpr static bool debug = false;
+    // Where a listed device sits on its chip. FT2232H and FT4232H list each interface (channel A to D) as a
+    // device of its own, with its own handle and MPSSE, but all of them share the chip's USB link.
+    struct ChipInterface {
+        std::string chip;   // Same for every interface of one chip: the serial without the channel letter
+        int channel = 0;    // 0 = A, 1 = B, ...
+        int channels = 1;   // Interfaces of the chip
+        bool hasMPSSE = true;
+    };
+    static ChipInterface interfaceOf(const FT_DEVICE_LIST_INFO_NODE& info);
+
+    // Driver behind a device: the FTDI D2XX library, or LibUsbFTDITransport talking to the chip over libusb
+    enum class Backend { D2xx, LibUsb };
 
     struct ScannedDeviceInfo {
         FT_DEVICE_LIST_INFO_NODE devInfo;
-        int scanIndex;
+        int scanIndex;                      // In the list of its backend
+        ChipInterface iface = {};
+        Backend backend = Backend::D2xx;
     };
     
     bool initialize() override;
@@ -23,35 +42,97 @@ public:
     std::vector<ScannedDeviceInfo> scanDevices();
     int getDeviceCount();
 
+    // ---- Transport ----
+    // Each backend's traffic goes through its installed transport (D2xxTransport and LibUsbFTDITransport
+    // unless replaced). Swap them only while no device is open, e.g. at start-up to run against a simulated board.
+    FTDITransport& getTransport(Backend backend = Backend::D2xx) { return *transports[static_cast<int>(backend)]; }
+    void setTransport(std::unique_ptr<FTDITransport> newTransport, Backend backend = Backend::D2xx);
+    // Replaces every backend's transport with wrap(current), which must return one, to put a decorator such as CaptureFTDITransport in front of it
+    void wrapTransport(const std::function<std::unique_ptr<FTDITransport>(std::unique_ptr<FTDITransport>)>& wrap);
+
+    // ---- Backend selection ----
+    // Devices use the default backend (D2XX) unless one is set for their serial, or for the chip serial to
+    // cover all interfaces of an FT2232H/FT4232H. A scan lists each device from its backend only.
+    void setDefaultBackend(Backend backend);
+    void setBackend(const std::string& serial, Backend backend);
+    Backend backendFor(const FT_DEVICE_LIST_INFO_NODE& info) const;
+
     class DeviceSession {
     public:
+        ~DeviceSession();
         FT_HANDLE handle() const { return ftHandle; }
         // Per -device synchronized methods
         FT_STATUS send(const unsigned char* data, DWORD size);
         FT_STATUS receive(unsigned char* buffer, DWORD size, DWORD& bytesRead);
         bool connectionStatus();
         bool pollData(DWORD bytesToRead, DWORD& bytesRead, int timeoutMs);
+        FT_STATUS purge(ULONG mask); // FT_PURGE_RX and/or FT_PURGE_TX
         bool openMPSSE();
+        const ChipInterface& chipInterface() const { return iface; }
 
     private:
         friend class FTDIHandler;
-        DeviceSession(FT_HANDLE h,
+        struct ChipLink;
+        DeviceSession(FTDITransport& t,
+                      FT_HANDLE h,
                       const FT_DEVICE_LIST_INFO_NODE& info,
                       std::shared_ptr<std::mutex> tx,
-                      std::shared_ptr<std::mutex> rx)
-            : ftHandle(h), devInfo(info), txMutex(std::move(tx)), rxMutex(std::move(rx)) {
+                      std::shared_ptr<std::mutex> rx,
+                      std::shared_ptr<ChipLink> chipLink)
+            : transport(&t), ftHandle(h), devInfo(info), iface(interfaceOf(info)), txMutex(std::move(tx)), rxMutex(std::move(rx)), link(std::move(chipLink)) {
                 if (!txMutex) txMutex = std::make_shared<std::mutex>();
                 if (!rxMutex) rxMutex = std::make_shared<std::mutex>();
+                registerMetrics();
             }
+        void registerMetrics();
+        void linkEnter();
+        void linkLeave(uint64_t txBytes, uint64_t rxBytes);
+        FTDITransport* transport;
         FT_HANDLE ftHandle;
         FT_DEVICE_LIST_INFO_NODE devInfo;
+        ChipInterface iface;
         std::shared_ptr<std::mutex> txMutex;
         std::shared_ptr<std::mutex> rxMutex;
+
+        // The USB link of a chip, shared by the sessions of all its interfaces. Only counts, never locks:
+        // the interfaces run in parallel, the metrics show how much of that overlaps and what each one moves.
+        struct ChipLink {
+            std::atomic<int> inFlight{0};             // Driver calls in progress over all interfaces
+            Metrics::Counter* txBytes = nullptr;
+            Metrics::Counter* rxBytes = nullptr;
+            Metrics::Counter* calls = nullptr;
+            Metrics::Counter* overlappedCalls = nullptr; // Started while another interface of the chip was in a call
+            Metrics::Gauge* openInterfaces = nullptr;
+            std::atomic<int> sessions{0};
+        };
+        std::shared_ptr<ChipLink> link;
+
+        // Per device I/O metrics, labeled with the device description and serial
+        struct SessionMetrics {
+            Metrics::Counter* txBytes = nullptr;
+            Metrics::Counter* rxBytes = nullptr;
+            Metrics::Histogram* sendLatency = nullptr;
+            Metrics::Histogram* receiveLatency = nullptr;
+            Metrics::Histogram* txLockWait = nullptr;
+            Metrics::Histogram* rxLockWait = nullptr;
+            Metrics::Histogram* pollWait = nullptr;
+            Metrics::Counter* pollTimeouts = nullptr;
+        } metrics;
     };
-    std::shared_ptr<DeviceSession> getSession(FT_HANDLE handle, const FT_DEVICE_LIST_INFO_NODE& info);
+    // Sessions of one chip's interfaces are independent (own handle, own locks) and share the chip's link metrics
+    std::shared_ptr<DeviceSession> getSession(FT_HANDLE handle, const FT_DEVICE_LIST_INFO_NODE& info, Backend backend = Backend::D2xx);
+
+    // Sleep between receive queue checks while DeviceSession::pollData() waits for a reply. The 20 ms default keeps
+    // driver calls rare on hardware, simulations with modeled timing can poll finer.
+    void setPollInterval(std::chrono::microseconds interval) { pollIntervalUs.store(interval.count(), std::memory_order_relaxed); }
+    std::chrono::microseconds getPollInterval() const { return std::chrono::microseconds(pollIntervalUs.load(std::memory_order_relaxed)); }
+
+    // Changes whenever an interface is opened or closed, for callers caching anything that depends on open devices
+    uint64_t openStateVersion() const { return openChanges.load(std::memory_order_acquire); }
 
 private:
-	FTDIHandler() = default;
+    friend class FTDIConnection;
+	FTDIHandler();
 	~FTDIHandler() = default;
 	FTDIHandler(const FTDIHandler&) = delete;
 	FTDIHandler& operator=(const FTDIHandler&) = delete;
@@ -64,7 +145,16 @@ private:
     FT_STATUS sendData(FT_HANDLE deviceHandle, const unsigned char* data, DWORD size);
     FT_STATUS receiveData(FT_HANDLE deviceHandle, unsigned char* buffer, DWORD size, DWORD& bytesRead);
 
+    void scanBackend(Backend backend, std::vector<ScannedDeviceInfo>& scannedDevices);
+
+    std::unique_ptr<FTDITransport> transports[2];
     std::mutex mapMutex;
+    mutable std::mutex backendMutex;
+    Backend defaultBackend = Backend::D2xx;
+    std::unordered_map<std::string, Backend> backendBySerial;
     struct SyncPair { std::shared_ptr<std::mutex> tx, rx; };
     std::unordered_map<FT_HANDLE, SyncPair> handleSyncMap;
+    std::unordered_map<std::string, std::weak_ptr<DeviceSession::ChipLink>> chipLinks;
+    std::atomic<uint64_t> openChanges{0};
+    std::atomic<int64_t> pollIntervalUs{20000};
 };
@@ -0,0 +1,33 @@
+#include "FTDITransport.hpp"
+
+FT_STATUS D2xxTransport::createDeviceInfoList(DWORD& deviceCount) { return FT_CreateDeviceInfoList(&deviceCount); }
+
+FT_STATUS D2xxTransport::getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) {
+    return FT_GetDeviceInfoDetail(index, &info.Flags, &info.Type, &info.ID, &info.LocId, info.SerialNumber, info.Description, &info.ftHandle);
+}
+
+FT_STATUS D2xxTransport::open(int index, FT_HANDLE& handle) { return FT_Open(index, &handle); }
+
+FT_STATUS D2xxTransport::close(FT_HANDLE handle) { return FT_Close(handle); }
+
+FT_STATUS D2xxTransport::resetDevice(FT_HANDLE handle) { return FT_ResetDevice(handle); }
+
+FT_STATUS D2xxTransport::purge(FT_HANDLE handle, ULONG mask) { return FT_Purge(handle, mask); }
+
+FT_STATUS D2xxTransport::setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) { return FT_SetUSBParameters(handle, inTransferSize, outTransferSize); }
+
+FT_STATUS D2xxTransport::setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) { return FT_SetLatencyTimer(handle, latencyMs); }
+
+FT_STATUS D2xxTransport::setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) { return FT_SetTimeouts(handle, readTimeoutMs, writeTimeoutMs); }
+
+FT_STATUS D2xxTransport::setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) { return FT_SetFlowControl(handle, flowControl, xon, xoff); }
+
+FT_STATUS D2xxTransport::setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) { return FT_SetBitMode(handle, mask, mode); }
+
+FT_STATUS D2xxTransport::write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) {
+    return FT_Write(handle, const_cast<unsigned char*>(data), size, &bytesWritten);
+}
+
+FT_STATUS D2xxTransport::read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) { return FT_Read(handle, buffer, size, &bytesRead); }
+
+FT_STATUS D2xxTransport::getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) { return FT_GetQueueStatus(handle, &rxBytes); }
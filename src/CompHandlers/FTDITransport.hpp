@@ -0,0 +1,53 @@
+#pragma once
+#include <ftd2xx.h>
+
+// The D2XX calls RadCat makes, behind one interface. FTDIHandler, its DeviceSessions and FTDIConnection
+// go through the installed transport instead of calling FT_* directly, so the same driver code can run
+// against the real library (D2xxTransport) or a software stand-in (Simulation/SimulatedFTDITransport).
+// Semantics and status codes follow D2XX. Implementations must be safe to call from several threads,
+// one DeviceSession may be writing while another thread reads the same handle.
+class FTDITransport {
+public:
+    virtual ~FTDITransport() = default;
+
+    // ---- Enumeration ----
+    virtual FT_STATUS createDeviceInfoList(DWORD& deviceCount) = 0;
+    virtual FT_STATUS getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) = 0;
+
+    // ---- Device ----
+    virtual FT_STATUS open(int index, FT_HANDLE& handle) = 0;
+    virtual FT_STATUS close(FT_HANDLE handle) = 0;
+    virtual FT_STATUS resetDevice(FT_HANDLE handle) = 0;
+    virtual FT_STATUS purge(FT_HANDLE handle, ULONG mask) = 0;
+
+    // ---- Configuration ----
+    virtual FT_STATUS setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) = 0;
+    virtual FT_STATUS setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) = 0;
+    virtual FT_STATUS setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) = 0;
+    virtual FT_STATUS setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) = 0;
+    virtual FT_STATUS setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) = 0;
+
+    // ---- Data ----
+    virtual FT_STATUS write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) = 0;
+    virtual FT_STATUS read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) = 0;
+    virtual FT_STATUS getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) = 0;
+};
+
+// Forwards every call to the FTDI D2XX library. The default transport.
+class D2xxTransport : public FTDITransport {
+public:
+    FT_STATUS createDeviceInfoList(DWORD& deviceCount) override;
+    FT_STATUS getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) override;
+    FT_STATUS open(int index, FT_HANDLE& handle) override;
+    FT_STATUS close(FT_HANDLE handle) override;
+    FT_STATUS resetDevice(FT_HANDLE handle) override;
+    FT_STATUS purge(FT_HANDLE handle, ULONG mask) override;
+    FT_STATUS setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) override;
+    FT_STATUS setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) override;
+    FT_STATUS setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) override;
+    FT_STATUS setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) override;
+    FT_STATUS setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) override;
+    FT_STATUS write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) override;
+    FT_STATUS read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) override;
+    FT_STATUS getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) override;
+};
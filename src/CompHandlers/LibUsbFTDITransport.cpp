@@ -0,0 +1,409 @@
+#include "LibUsbFTDITransport.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+    constexpr uint16_t FtdiVid = 0x0403;
+
+    // FTDI vendor requests (host to device, vendor, device recipient)
+    constexpr uint8_t RequestOut = 0x40;
+    constexpr uint8_t SioReset = 0x00;
+    constexpr uint8_t SioSetFlowControl = 0x02;
+    constexpr uint8_t SioSetLatencyTimer = 0x09;
+    constexpr uint8_t SioSetBitMode = 0x0B;
+
+    // SioReset values. FTDI names them from the chip's side: purging "RX" drops what the host sent,
+    // purging "TX" what the chip has not delivered to the host yet.
+    constexpr uint16_t ResetSio = 0;
+    constexpr uint16_t PurgeChipRx = 1;
+    constexpr uint16_t PurgeChipTx = 2;
+
+    constexpr unsigned int ControlTimeoutMs = 1000;
+    constexpr int MaxTransferSize = 65536;
+    constexpr int StatusBytes = 2;
+
+    // Multi-interface chips, newer than the bundled ftd2xx.h
+    constexpr ULONG DeviceType2232H = 6;
+    constexpr ULONG DeviceType4232H = 7;
+    constexpr ULONG DeviceType232H = 8;
+    constexpr ULONG DeviceTypeX = 9;
+
+    bool isFtdiPid(uint16_t pid) { return pid == 0x6001 || pid == 0x6010 || pid == 0x6011 || pid == 0x6014 || pid == 0x6015; }
+
+    // Chip type from bcdDevice, as D2XX reports it
+    ULONG typeOf(uint16_t bcdDevice) {
+        switch (bcdDevice >> 8) {
+            case 0x02: return FT_DEVICE_AM;
+            case 0x04: return FT_DEVICE_BM;
+            case 0x05: return FT_DEVICE_2232C;
+            case 0x06: return FT_DEVICE_232R;
+            case 0x07: return DeviceType2232H;
+            case 0x08: return DeviceType4232H;
+            case 0x09: return DeviceType232H;
+            case 0x10: return DeviceTypeX;
+            default:   return FT_DEVICE_UNKNOWN;
+        }
+    }
+
+    int interfacesOf(ULONG type) {
+        if (type == FT_DEVICE_2232C || type == DeviceType2232H) return 2;
+        return type == DeviceType4232H ? 4 : 1;
+    }
+
+    void copyString(char* dst, size_t size, const std::string& src) {
+        std::memset(dst, 0, size);
+        std::memcpy(dst, src.data(), std::min(src.size(), size - 1));
+    }
+
+    std::string stringDescriptor(libusb_device_handle* usb, uint8_t index) {
+        unsigned char text[64] = {};
+        if (!usb || !index) return {};
+        const int n = libusb_get_string_descriptor_ascii(usb, index, text, sizeof(text));
+        return n > 0 ? std::string(reinterpret_cast<char*>(text), n) : std::string();
+    }
+
+    template<typename Pred> bool waitFor(std::unique_lock<std::mutex>& lk, std::condition_variable& cv, ULONG timeoutMs, Pred pred) {
+        if (!timeoutMs) { cv.wait(lk, pred); return true; }
+        return cv.wait_for(lk, std::chrono::milliseconds(timeoutMs), pred);
+    }
+}
+
+LibUsbFTDITransport::~LibUsbFTDITransport() {
+    std::vector<FT_HANDLE> open;
+    {
+        std::lock_guard<std::mutex> lk(listMutex);
+        for (auto& h : handles) open.push_back(h.get());
+    }
+    for (FT_HANDLE h : open) close(h);
+    stopping = true;
+    if (events.joinable()) events.join();
+    clearList();
+    if (ctx) libusb_exit(ctx);
+}
+
+bool LibUsbFTDITransport::ensureContext() {
+    if (ctx) return true;
+    if (libusb_init(&ctx) != LIBUSB_SUCCESS) { ctx = nullptr; return false; }
+    events = std::thread(&LibUsbFTDITransport::eventLoop, this);
+    return true;
+}
+
+void LibUsbFTDITransport::eventLoop() {
+    timeval tv{0, 100000}; // Wakes up to notice stopping
+    while (!stopping) libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+}
+
+void LibUsbFTDITransport::clearList() {
+    for (Entry& e : entries) libusb_unref_device(e.device);
+    entries.clear();
+}
+
+LibUsbFTDITransport::Handle* LibUsbFTDITransport::lookup(FT_HANDLE handle) const {
+    std::lock_guard<std::mutex> lk(listMutex);
+    for (const auto& h : handles)
+        if (h.get() == handle) return h.get();
+    return nullptr;
+}
+
+FT_STATUS LibUsbFTDITransport::vendorRequest(Handle& h, uint8_t request, uint16_t value, uint16_t index) {
+    if (h.gone) return FT_IO_ERROR;
+    const int r = libusb_control_transfer(h.usb, RequestOut, request, value, index, nullptr, 0, ControlTimeoutMs);
+    if (r == LIBUSB_ERROR_NO_DEVICE) {
+        { std::lock_guard<std::mutex> lk(h.mutex); h.gone = true; }
+        h.changed.notify_all();
+    }
+    return r < 0 ? FT_IO_ERROR : FT_OK;
+}
+
+// Reports a failed transfer once, an unplugged device for good
+FT_STATUS LibUsbFTDITransport::takeFailure(Handle& h) {
+    if (h.gone) return FT_IO_ERROR;
+    if (h.failure == LIBUSB_TRANSFER_COMPLETED) return FT_OK;
+    h.failure = LIBUSB_TRANSFER_COMPLETED;
+    return FT_IO_ERROR;
+}
+
+// ---- Transfer callbacks, on the event thread ----
+
+void LIBUSB_CALL LibUsbFTDITransport::inDone(libusb_transfer* transfer) {
+    Handle& h = *static_cast<Handle*>(transfer->user_data);
+    std::lock_guard<std::mutex> lk(h.mutex);
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+        // Every packet starts with the modem status, a packet of only that carries no data
+        for (int at = 0; at < transfer->actual_length; at += h.packetSize) {
+            const int n = std::min(h.packetSize, transfer->actual_length - at);
+            if (n > StatusBytes) h.rx.insert(h.rx.end(), transfer->buffer + at + StatusBytes, transfer->buffer + at + n);
+        }
+        if (h.rxHead > 0 && h.rxHead >= h.rx.size() / 2) { h.rx.erase(h.rx.begin(), h.rx.begin() + h.rxHead); h.rxHead = 0; }
+        transfer->length = h.inTransferSize;
+        if (!h.closing && libusb_submit_transfer(transfer) == LIBUSB_SUCCESS) { h.changed.notify_all(); return; }
+    }
+    else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) h.gone = true;
+    else if (transfer->status != LIBUSB_TRANSFER_CANCELLED) h.failure = transfer->status;
+    --h.inFlightIn;
+    h.changed.notify_all();
+}
+
+void LIBUSB_CALL LibUsbFTDITransport::outDone(libusb_transfer* transfer) {
+    Handle& h = *static_cast<Handle*>(transfer->user_data);
+    std::lock_guard<std::mutex> lk(h.mutex);
+    if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) h.gone = true;
+    else if (transfer->status != LIBUSB_TRANSFER_COMPLETED) h.failure = transfer->status;
+    else if (transfer->actual_length != transfer->length) h.failure = LIBUSB_TRANSFER_ERROR;
+    --h.inFlightOut;
+    h.changed.notify_all();
+    // The transfer and its buffer are freed by libusb (LIBUSB_TRANSFER_FREE_*)
+}
+
+// ---- Enumeration ----
+
+FT_STATUS LibUsbFTDITransport::createDeviceInfoList(DWORD& deviceCount) {
+    deviceCount = 0;
+    std::lock_guard<std::mutex> lk(listMutex);
+    if (!ensureContext()) return FT_OTHER_ERROR;
+    clearList();
+
+    libusb_device** list = nullptr;
+    const ssize_t count = libusb_get_device_list(ctx, &list);
+    if (count < 0) return FT_IO_ERROR;
+    for (ssize_t i = 0; i < count; ++i) {
+        libusb_device_descriptor desc{};
+        if (libusb_get_device_descriptor(list[i], &desc) != LIBUSB_SUCCESS) continue;
+        if (desc.idVendor != FtdiVid || !isFtdiPid(desc.idProduct)) continue;
+
+        // Strings need the device opened, without permission it is listed without them like D2XX does
+        libusb_device_handle* usb = nullptr;
+        if (libusb_open(list[i], &usb) != LIBUSB_SUCCESS) usb = nullptr;
+        const std::string serial = stringDescriptor(usb, desc.iSerialNumber);
+        const std::string product = stringDescriptor(usb, desc.iProduct);
+        if (usb) libusb_close(usb);
+
+        const ULONG type = typeOf(desc.bcdDevice);
+        const int interfaces = interfacesOf(type);
+        const DWORD location = static_cast<DWORD>(libusb_get_bus_number(list[i])) << 12 | static_cast<DWORD>(libusb_get_device_address(list[i])) << 4;
+        for (int n = 0; n < interfaces; ++n) {
+            Entry e;
+            e.device = libusb_ref_device(list[i]);
+            e.interfaceNumber = n;
+            e.info.Type = type;
+            e.info.ID = static_cast<DWORD>(desc.idVendor) << 16 | desc.idProduct;
+            e.info.LocId = location + n; // Consecutive for the interfaces of one chip
+            const std::string letter = interfaces > 1 ? std::string(1, static_cast<char>('A' + n)) : std::string();
+            copyString(e.info.SerialNumber, sizeof(e.info.SerialNumber), serial.empty() ? serial : serial + letter);
+            copyString(e.info.Description, sizeof(e.info.Description), letter.empty() ? product : product + " " + letter);
+            entries.push_back(e);
+        }
+    }
+    libusb_free_device_list(list, 1);
+    deviceCount = static_cast<DWORD>(entries.size());
+    return FT_OK;
+}
+
+FT_STATUS LibUsbFTDITransport::getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    if (index >= entries.size()) return FT_DEVICE_NOT_FOUND;
+    const Entry& e = entries[index];
+    info = e.info;
+    info.Flags = 0;
+    info.ftHandle = nullptr;
+    for (const auto& h : handles) {
+        if (h->device != e.device || h->interfaceNumber != e.interfaceNumber) continue;
+        info.Flags = 0x1; // FT_FLAGS_OPENED
+        info.ftHandle = h.get();
+    }
+    return FT_OK;
+}
+
+// ---- Device ----
+
+FT_STATUS LibUsbFTDITransport::open(int index, FT_HANDLE& handle) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    if (index < 0 || index >= static_cast<int>(entries.size())) return FT_DEVICE_NOT_FOUND;
+    const Entry& e = entries[index];
+    for (const auto& h : handles)
+        if (h->device == e.device && h->interfaceNumber == e.interfaceNumber) return FT_DEVICE_NOT_OPENED; // Like D2XX, one open per interface
+
+    auto h = std::make_unique<Handle>();
+    if (libusb_open(e.device, &h->usb) != LIBUSB_SUCCESS) return FT_DEVICE_NOT_OPENED;
+    libusb_set_auto_detach_kernel_driver(h->usb, 1); // ftdi_sio, reattached on release
+    if (libusb_claim_interface(h->usb, e.interfaceNumber) != LIBUSB_SUCCESS) { libusb_close(h->usb); return FT_DEVICE_NOT_OPENED; }
+
+    h->device = e.device;
+    h->interfaceNumber = e.interfaceNumber;
+    h->index = static_cast<uint16_t>(e.interfaceNumber + 1);
+    h->inEndpoint = static_cast<unsigned char>(0x81 + 2 * e.interfaceNumber);
+    h->outEndpoint = static_cast<unsigned char>(0x02 + 2 * e.interfaceNumber);
+    h->packetSize = std::max(libusb_get_max_packet_size(e.device, h->inEndpoint), StatusBytes + 1);
+    h->inTransferSize = std::max(h->packetSize, 4096 / h->packetSize * h->packetSize);
+
+    for (int i = 0; i < InTransfers; ++i) {
+        libusb_transfer* t = libusb_alloc_transfer(0);
+        auto* buffer = static_cast<unsigned char*>(std::malloc(MaxTransferSize));
+        libusb_fill_bulk_transfer(t, h->usb, h->inEndpoint, buffer, h->inTransferSize, &LibUsbFTDITransport::inDone, h.get(), 0);
+        t->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+        h->inTransfers.push_back(t);
+        if (libusb_submit_transfer(t) == LIBUSB_SUCCESS) ++h->inFlightIn;
+    }
+    if (h->inFlightIn == 0) {
+        for (libusb_transfer* t : h->inTransfers) libusb_free_transfer(t);
+        libusb_release_interface(h->usb, h->interfaceNumber);
+        libusb_close(h->usb);
+        return FT_IO_ERROR;
+    }
+    handle = h.get();
+    handles.push_back(std::move(h));
+    return FT_OK;
+}
+
+FT_STATUS LibUsbFTDITransport::close(FT_HANDLE handle) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    {
+        std::unique_lock<std::mutex> lk(h->mutex);
+        h->closing = true;
+        for (libusb_transfer* t : h->inTransfers) libusb_cancel_transfer(t);
+        // The event thread completes the cancellations, an unplugged device may never answer
+        h->changed.wait_for(lk, std::chrono::milliseconds(ControlTimeoutMs), [h] { return h->inFlightIn == 0 && h->inFlightOut == 0; });
+        if (h->inFlightIn != 0 || h->inFlightOut != 0) return FT_IO_ERROR; // Still referenced by libusb, keep it
+    }
+    for (libusb_transfer* t : h->inTransfers) libusb_free_transfer(t);
+    libusb_release_interface(h->usb, h->interfaceNumber);
+    libusb_close(h->usb);
+
+    std::lock_guard<std::mutex> lk(listMutex);
+    handles.erase(std::remove_if(handles.begin(), handles.end(), [h](const std::unique_ptr<Handle>& p) { return p.get() == h; }), handles.end());
+    return FT_OK;
+}
+
+FT_STATUS LibUsbFTDITransport::resetDevice(FT_HANDLE handle) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    const FT_STATUS status = vendorRequest(*h, SioReset, ResetSio, h->index);
+    std::lock_guard<std::mutex> lk(h->mutex);
+    h->rx.clear();
+    h->rxHead = 0;
+    h->failure = LIBUSB_TRANSFER_COMPLETED;
+    return status;
+}
+
+FT_STATUS LibUsbFTDITransport::purge(FT_HANDLE handle, ULONG mask) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    if (mask & FT_PURGE_TX) {
+        // Let the writes in flight land first, they would otherwise arrive after the purge
+        std::unique_lock<std::mutex> lk(h->mutex);
+        waitFor(lk, h->changed, ControlTimeoutMs, [h] { return h->inFlightOut == 0; });
+    }
+    if (mask & FT_PURGE_TX) if (FT_STATUS st = vendorRequest(*h, SioReset, PurgeChipRx, h->index); st != FT_OK) return st;
+    if (mask & FT_PURGE_RX) {
+        if (FT_STATUS st = vendorRequest(*h, SioReset, PurgeChipTx, h->index); st != FT_OK) return st;
+        std::lock_guard<std::mutex> lk(h->mutex);
+        h->rx.clear();
+        h->rxHead = 0;
+    }
+    return FT_OK;
+}
+
+// ---- Configuration ----
+
+FT_STATUS LibUsbFTDITransport::setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    // Whole packets, applied as the IN transfers are resubmitted. Writes go out in one transfer whatever their size.
+    std::lock_guard<std::mutex> lk(h->mutex);
+    const int size = static_cast<int>(std::clamp<ULONG>(inTransferSize, h->packetSize, MaxTransferSize));
+    h->inTransferSize = size / h->packetSize * h->packetSize;
+    return FT_OK;
+}
+
+FT_STATUS LibUsbFTDITransport::setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    if (latencyMs < 1) return FT_INVALID_PARAMETER;
+    return vendorRequest(*h, SioSetLatencyTimer, latencyMs, h->index);
+}
+
+FT_STATUS LibUsbFTDITransport::setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(h->mutex);
+    h->readTimeoutMs = readTimeoutMs;
+    h->writeTimeoutMs = writeTimeoutMs;
+    return FT_OK;
+}
+
+FT_STATUS LibUsbFTDITransport::setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    // The FT_FLOW_* values are the wire values, in the high byte of wIndex
+    const uint16_t value = flowControl == FT_FLOW_XON_XOFF ? static_cast<uint16_t>(xon | xoff << 8) : 0;
+    return vendorRequest(*h, SioSetFlowControl, value, static_cast<uint16_t>(flowControl | h->index));
+}
+
+FT_STATUS LibUsbFTDITransport::setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) {
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    return vendorRequest(*h, SioSetBitMode, static_cast<uint16_t>(mask | mode << 8), h->index);
+}
+
+// ---- Data ----
+
+FT_STATUS LibUsbFTDITransport::write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) {
+    bytesWritten = 0;
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    std::unique_lock<std::mutex> lk(h->mutex);
+    if (FT_STATUS st = takeFailure(*h); st != FT_OK) return st;
+    if (!size) return FT_OK;
+
+    // Back-pressure: a write timeout leaves nothing written, like FT_Write
+    if (!waitFor(lk, h->changed, h->writeTimeoutMs, [h] { return h->inFlightOut < MaxWritesInFlight || h->gone; })) return FT_OK;
+    if (h->gone) return FT_IO_ERROR;
+
+    libusb_transfer* t = libusb_alloc_transfer(0);
+    auto* buffer = static_cast<unsigned char*>(std::malloc(size));
+    if (!t || !buffer) { libusb_free_transfer(t); std::free(buffer); return FT_INSUFFICIENT_RESOURCES; }
+    std::memcpy(buffer, data, size);
+    libusb_fill_bulk_transfer(t, h->usb, h->outEndpoint, buffer, static_cast<int>(size), &LibUsbFTDITransport::outDone, h, h->writeTimeoutMs);
+    t->flags = LIBUSB_TRANSFER_FREE_BUFFER | LIBUSB_TRANSFER_FREE_TRANSFER;
+    const int r = libusb_submit_transfer(t);
+    if (r != LIBUSB_SUCCESS) {
+        libusb_free_transfer(t);
+        if (r == LIBUSB_ERROR_NO_DEVICE) h->gone = true;
+        return FT_IO_ERROR;
+    }
+    ++h->inFlightOut;
+    bytesWritten = size;
+    return FT_OK;
+}
+
+FT_STATUS LibUsbFTDITransport::read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) {
+    bytesRead = 0;
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    std::unique_lock<std::mutex> lk(h->mutex);
+    if (FT_STATUS st = takeFailure(*h); st != FT_OK) return st;
+
+    // Like FT_Read: returns once size bytes arrived or the timeout expired, with whatever was received
+    waitFor(lk, h->changed, h->readTimeoutMs, [h, size] { return h->available() >= size || h->gone || h->failure != LIBUSB_TRANSFER_COMPLETED || h->inFlightIn == 0; });
+    const size_t n = std::min<size_t>(size, h->available());
+    std::memcpy(buffer, h->rx.data() + h->rxHead, n);
+    h->rxHead += n;
+    if (h->rxHead == h->rx.size()) { h->rx.clear(); h->rxHead = 0; }
+    bytesRead = static_cast<DWORD>(n);
+    if (n) return FT_OK;
+    return takeFailure(*h);
+}
+
+FT_STATUS LibUsbFTDITransport::getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) {
+    rxBytes = 0;
+    Handle* h = lookup(handle);
+    if (!h) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(h->mutex);
+    if (h->gone) return FT_IO_ERROR;
+    rxBytes = static_cast<DWORD>(h->available());
+    return FT_OK;
+}
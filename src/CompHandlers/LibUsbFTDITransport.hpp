@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "FTDITransport.hpp"
+#include "Included/libusb.h"
+
+// FTDITransport that drives FTDI chips over libusb instead of the D2XX library: FTDI vendor control
+// requests for reset, purge, latency timer, flow control and bitmode, bulk transfers for the data.
+//
+// Every open interface keeps InTransfers bulk IN transfers queued, so the chip is drained continuously
+// like the D2XX driver does. The chip starts every USB packet with two modem status bytes; they are
+// stripped as the transfers complete and the payload goes to a receive FIFO that read() and
+// getQueueStatus() serve from. Writes are asynchronous too: write() copies the data into an OUT transfer
+// and returns once it is submitted, with up to MaxWritesInFlight per interface, so the next MPSSE batch
+// can be queued while the previous one is still on the bus. A failed transfer is reported by the next
+// call on the handle. One event thread per transport completes the transfers.
+//
+// Lists FT232BM/R, FT2232C/D/H, FT4232H, FT232H and FT-X chips (VID 0x0403), one entry per interface with
+// the channel letter appended to serial and description, like D2XX. The ftdi_sio kernel driver is
+// detached from an interface while it is open. Selected per device with FTDIHandler::setBackend(); it uses
+// libusb directly rather than UsbBackend, which has no control or asynchronous transfers.
+class LibUsbFTDITransport : public FTDITransport {
+public:
+    static constexpr int InTransfers = 4;
+    static constexpr int MaxWritesInFlight = 4;
+
+    LibUsbFTDITransport() = default;
+    ~LibUsbFTDITransport() override;
+
+    // ---- FTDITransport ----
+    FT_STATUS createDeviceInfoList(DWORD& deviceCount) override;
+    FT_STATUS getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) override;
+    FT_STATUS open(int index, FT_HANDLE& handle) override;
+    FT_STATUS close(FT_HANDLE handle) override;
+    FT_STATUS resetDevice(FT_HANDLE handle) override;
+    FT_STATUS purge(FT_HANDLE handle, ULONG mask) override;
+    FT_STATUS setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) override;
+    FT_STATUS setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) override;
+    FT_STATUS setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) override;
+    FT_STATUS setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) override;
+    FT_STATUS setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) override;
+    FT_STATUS write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) override;
+    FT_STATUS read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) override;
+    FT_STATUS getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) override;
+
+private:
+    // One interface of a listed chip
+    struct Entry {
+        libusb_device* device = nullptr; // Referenced while listed
+        int interfaceNumber = 0;         // 0 = A
+        FT_DEVICE_LIST_INFO_NODE info{};
+    };
+
+    // An open interface. FT_HANDLEs are Handle pointers.
+    struct Handle {
+        libusb_device* device = nullptr;
+        libusb_device_handle* usb = nullptr;
+        int interfaceNumber = 0;
+        uint16_t index = 1;              // wIndex of the vendor requests: interface + 1
+        unsigned char inEndpoint = 0x81;
+        unsigned char outEndpoint = 0x02;
+        int packetSize = 64;
+        int inTransferSize = 4096;       // Multiple of packetSize
+        std::vector<libusb_transfer*> inTransfers;
+
+        std::mutex mutex;                // State below, shared with the transfer callbacks
+        std::condition_variable changed;
+        std::vector<uint8_t> rx;         // Received payload, status bytes stripped, from rxHead on
+        size_t rxHead = 0;
+        int inFlightIn = 0;
+        int inFlightOut = 0;
+        int failure = LIBUSB_TRANSFER_COMPLETED; // First failed transfer since the last call reported it
+        std::atomic<bool> gone{false};   // Unplugged, every call fails from now on. Set under mutex for the waits,
+                                         // vendorRequest reads it without
+        bool closing = false;
+        ULONG readTimeoutMs = 0;         // 0: wait for the data, like D2XX
+        ULONG writeTimeoutMs = 0;
+
+        size_t available() const { return rx.size() - rxHead; }
+    };
+
+    static void LIBUSB_CALL inDone(libusb_transfer* transfer);
+    static void LIBUSB_CALL outDone(libusb_transfer* transfer);
+    static FT_STATUS takeFailure(Handle& h);
+
+    bool ensureContext();
+    void clearList();
+    Handle* lookup(FT_HANDLE handle) const;
+    FT_STATUS vendorRequest(Handle& h, uint8_t request, uint16_t value, uint16_t index);
+    void eventLoop();
+
+    libusb_context* ctx = nullptr;
+    mutable std::mutex listMutex;
+    std::vector<Entry> entries;
+    std::vector<std::unique_ptr<Handle>> handles;
+    std::thread events;
+    std::atomic<bool> stopping{false};
+};
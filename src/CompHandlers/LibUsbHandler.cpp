@@ -1,9 +1,10 @@
 #include "LibUsbHandler.hpp"
+#include "Diagnostics/Trace.hpp"
 
 
 bool LibUsbHandler::initialize() {
-    if (ctx) {
-        if constexpr (debug) Debug.Log("LibUsbHandler initialized successfully.");
+    if (initialized) {
+        DEBUG_LOG(LogCategory::LibUsb, "LibUsbHandler initialized successfully.");
         return true;
     }
 
@@ -12,10 +13,10 @@ bool LibUsbHandler::initialize() {
 }
 
 bool LibUsbHandler::shutdown() {
-    if (ctx) {
-        libusb_exit(ctx);
-        ctx = nullptr;
-        if constexpr (debug) Debug.Log("LibUsbHandler shut down successfully.");
+    if (initialized) {
+        backend->shutdown();
+        initialized = false;
+        DEBUG_LOG(LogCategory::LibUsb, "LibUsbHandler shut down successfully.");
         return true;
     } else {
         Debug.Warn("LibUsbHandler shutdown called, but context was already null.");
@@ -23,27 +24,41 @@ bool LibUsbHandler::shutdown() {
     }
 }
 
+void LibUsbHandler::setBackend(std::unique_ptr<UsbBackend> newBackend) {
+    if (!newBackend) return;
+    if (initialized) backend->shutdown();
+    backend = std::move(newBackend);
+    int r = backend->initialize();
+    initialized = r >= 0;
+    if (!initialized) Debug.Error("Failed to initialize USB backend: " , r);
+}
+
+void LibUsbHandler::wrapBackend(const std::function<std::unique_ptr<UsbBackend>(std::unique_ptr<UsbBackend>)>& wrap) {
+    backend = wrap(std::move(backend));
+}
+
 std::vector<LibUsbHandler::ScannedDeviceInfo> LibUsbHandler::scanDevices() {
-    if (!ctx) if (!attemptReinitialize()){Debug.Error("LibUsbHandler scanDevices called but context is null after re-initialization."); return {}; }
+    RC_TRACE_SCOPE("libusb", "scanDevices");
+    if (!initialized) if (!attemptReinitialize()){Debug.Error("LibUsbHandler scanDevices called but context is null after re-initialization."); return {}; }
 
-    libusb_device **list;
-    ssize_t cnt = libusb_get_device_list(ctx, &list);
+    std::vector<libusb_device*> list;
+    int cnt = backend->getDeviceList(list);
     if (cnt < 0) { 
     Debug.Error("Error getting USB device list: " , cnt); 
-    libusb_free_device_list(list, 1); 
+    for (libusb_device* device : list) backend->unrefDevice(device);
     return {};
     }
     std::vector<ScannedDeviceInfo> scannedDevicesInfo;
-    scannedDevicesInfo.reserve(static_cast<size_t>(cnt));
-    for (ssize_t i = 0; i < cnt; i++) {
+    scannedDevicesInfo.reserve(list.size());
+    for (size_t i = 0; i < list.size(); i++) {
         libusb_device* device = list[i];
         libusb_device_descriptor desc;
-        int r = libusb_get_device_descriptor(device, &desc);
+        int r = backend->getDeviceDescriptor(device, desc);
         if (r < 0) { Debug.Error("Failed to get device descriptor for device " , i , ": " , r); continue; }
-        scannedDevicesInfo.emplace_back(*device, desc, static_cast<int>(i));
-        if constexpr (debug) Debug.Log("Found USB Device - VID: " ,  desc.idVendor, ", PID: " ,  desc.idProduct);
+        scannedDevicesInfo.emplace_back(*backend, *device, desc, static_cast<int>(i));
+        DEBUG_LOG(LogCategory::LibUsb, "Found USB Device - VID: " ,  desc.idVendor, ", PID: " ,  desc.idProduct);
     }
-    libusb_free_device_list(list, 1);
+    for (libusb_device* device : list) backend->unrefDevice(device); // ScannedDeviceInfo holds its own reference
     return scannedDevicesInfo;
 }
 
@@ -52,26 +67,72 @@ bool LibUsbHandler::deviceMatch(std::unique_ptr<LibUsbHandler::ScannedDeviceInfo
         Debug.Error("LibUsbHandler::deviceMatch called with null ScannedDeviceInfo.");
         return false;
     }
+    RC_TRACE_SCOPE("libusb", "open");
     usbComponent.deviceInfo.vid = info->descriptor.idVendor;
     usbComponent.deviceInfo.pid = info->descriptor.idProduct;
     usbComponent.deviceInfo.device = info->device;
-    usbComponent.deviceInfo.busNumber = libusb_get_bus_number(info->device);
-    int r = libusb_open(info->device, &usbComponent.deviceHandle);
+    usbComponent.deviceInfo.busNumber = info->busNumber;
+    usbComponent.deviceInfo.portPath = info->portPath;
+    usbComponent.handler = this;
+    int r = backend->open(info->device, &usbComponent.deviceHandle);
     if (r < 0) { Debug.Error("Failed to open USB device: " , r); return false; }
+
+    if (info->descriptor.iSerialNumber) {
+        unsigned char serial[128];
+        int n = backend->getStringDescriptorAscii(usbComponent.deviceHandle, info->descriptor.iSerialNumber, serial, sizeof(serial));
+        if (n > 0) usbComponent.deviceInfo.serial.assign(reinterpret_cast<char*>(serial), static_cast<size_t>(n));
+    }
     return true;
 }
 
+bool LibUsbHandler::openDevice(libusb_device_handle** handle, uint16_t vendorID, uint16_t productID) {
+    if (!handle) return false;
+    *handle = nullptr;
+    std::vector<ScannedDeviceInfo> devices = scanDevices();
+    for (ScannedDeviceInfo& info : devices) {
+        if (info.descriptor.idVendor != vendorID || info.descriptor.idProduct != productID) continue;
+        int r = backend->open(info.device, handle);
+        if (r < 0) { Debug.Error("Failed to open USB device VID: " , vendorID , " PID: " , productID , ": " , r); return false; }
+        return true;
+    }
+    DEBUG_LOG(LogCategory::LibUsb, "No USB device with VID: " , vendorID , " PID: " , productID);
+    return false;
+}
+
+void LibUsbHandler::closeDevice(libusb_device_handle* handle) {
+    if (handle) backend->close(handle);
+}
+
+int LibUsbHandler::readData(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length, unsigned int timeout) {
+    if (!handle || !data || length <= 0) return LIBUSB_ERROR_INVALID_PARAM;
+    RC_TRACE_SCOPE("libusb", "read");
+    int transferred = 0;
+    int r = backend->bulkTransfer(handle, endpoint | LIBUSB_ENDPOINT_IN, data, length, &transferred, timeout);
+    if (r < 0 && !(r == LIBUSB_ERROR_TIMEOUT && transferred > 0)) return r;
+    return transferred;
+}
+
+int LibUsbHandler::writeData(libusb_device_handle* handle, unsigned char endpoint, const unsigned char* data, int length, unsigned int timeout) {
+    if (!handle || !data || length <= 0) return LIBUSB_ERROR_INVALID_PARAM;
+    RC_TRACE_SCOPE("libusb", "write");
+    int transferred = 0;
+    int r = backend->bulkTransfer(handle, static_cast<unsigned char>(endpoint & ~LIBUSB_ENDPOINT_IN), const_cast<unsigned char*>(data), length, &transferred, timeout);
+    if (r < 0 && !(r == LIBUSB_ERROR_TIMEOUT && transferred > 0)) return r;
+    return transferred;
+}
+
 bool LibUsbHandler::attemptReinitialize() {
     Debug.Warn("LibUsbHandler scanDevices called but context is null. Attempting re-initialization...");
-    if (ctx) {
+    if (initialized) {
         Debug.Log("LibUsbHandler context is already initialized.");
         return true;
     }
-    int r = libusb_init(&ctx);
+    int r = backend->initialize();
     if (r < 0) {
         Debug.Error("Failed to re-initialize libusb: " , r);
         return false;
     }
+    initialized = true;
     Debug.Log("LibUsbHandler re-initialized successfully.");
     return true;
 }
\ No newline at end of file
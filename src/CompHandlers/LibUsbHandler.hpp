@@ -1,6 +1,9 @@
 #pragma once
 #include "Included/libusb.h"
 #include "BaseComponentHandler.hpp"
+#include "UsbBackend.hpp"
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include "UsbConnection.hpp"
@@ -8,38 +11,60 @@
 
 class LibUsbHandler : public BaseComponentHandler {
 public:
-    constexpr static bool debug = true;
     static LibUsbHandler& Instance(){static LibUsbHandler instance; return instance;}
-    libusb_context* getContext() { return ctx; }
     bool initialize() override;
     bool shutdown() override;
 
+    // ---- Backend ----
+    // All libusb traffic goes through the installed backend (LibUsbBackend unless replaced).
+    // Swap it only while no device is open and no scan result is alive, e.g. at start-up.
+    UsbBackend& getBackend() { return *backend; }
+    void setBackend(std::unique_ptr<UsbBackend> newBackend);
+    // Replaces the backend with wrap(current), which must return one, to put a decorator such as CaptureUsbBackend in front of it.
+    // The wrapped backend stays initialized.
+    void wrapBackend(const std::function<std::unique_ptr<UsbBackend>(std::unique_ptr<UsbBackend>)>& wrap);
+
     struct ScannedDeviceInfo {
         libusb_device* device = nullptr;
         libusb_device_descriptor descriptor{};
         int scanIndex = 0;
+        uint8_t busNumber = 0;
+        std::vector<uint8_t> portPath; // Physical location, tells identical devices on one bus apart
+        UsbBackend* backend = nullptr; // Owner of device
         
         // No default construction, copy, or assignment,
         ScannedDeviceInfo() = delete;
         ScannedDeviceInfo(const ScannedDeviceInfo&) = delete;
         ScannedDeviceInfo& operator=(const ScannedDeviceInfo&) = delete;
-        ~ScannedDeviceInfo() noexcept { if (device) libusb_unref_device(device); }
+        ~ScannedDeviceInfo() noexcept { if (device) backend->unrefDevice(device); }
         // Custom constructor for initialization with ref count management
-        explicit ScannedDeviceInfo(libusb_device& dev, const libusb_device_descriptor& desc, int index)
-        : device(&dev), descriptor(desc), scanIndex(index) { libusb_ref_device(device); }
+        explicit ScannedDeviceInfo(UsbBackend& owner, libusb_device& dev, const libusb_device_descriptor& desc, int index)
+        : device(&dev), descriptor(desc), scanIndex(index), backend(&owner) {
+            backend->refDevice(device);
+            busNumber = backend->getBusNumber(device);
+            uint8_t ports[8];
+            int depth = backend->getPortNumbers(device, ports, sizeof(ports));
+            if (depth > 0) portPath.assign(ports, ports + depth);
+        }
         // Move allowed
         ScannedDeviceInfo(ScannedDeviceInfo&& other) noexcept
         : device(other.device),
         descriptor(other.descriptor),
-        scanIndex(other.scanIndex) {
+        scanIndex(other.scanIndex),
+        busNumber(other.busNumber),
+        portPath(std::move(other.portPath)),
+        backend(other.backend) {
             other.device = nullptr;
         }
         ScannedDeviceInfo& operator=(ScannedDeviceInfo&& other) noexcept {
             if (this != &other) {
-                if (device) libusb_unref_device(device);
+                if (device) backend->unrefDevice(device);
                 device = other.device;
                 descriptor = other.descriptor;
                 scanIndex = other.scanIndex;
+                busNumber = other.busNumber;
+                portPath = std::move(other.portPath);
+                backend = other.backend;
                 other.device = nullptr;
             }
             return *this;
@@ -54,13 +79,17 @@ public:
     bool deviceMatch(std::unique_ptr<LibUsbHandler::ScannedDeviceInfo>& info, UsbConnection& usbComponent);
     bool openDevice(libusb_device_handle** handle, uint16_t vendorID, uint16_t productID);
     void closeDevice(libusb_device_handle* handle);
-    int readData(libusb_device_handle* handle, unsigned char* data, int length, unsigned int timeout);
-    int writeData(libusb_device_handle* handle, const unsigned char* data, int length, unsigned int timeout);
+    // Bulk transfers, return the bytes transferred or a negative LIBUSB_ERROR code.
+    // A timeout with partial data returns the partial count.
+    int readData(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length, unsigned int timeout);
+    int writeData(libusb_device_handle* handle, unsigned char endpoint, const unsigned char* data, int length, unsigned int timeout);
 
 private:
-    libusb_context* ctx = nullptr;
+    std::unique_ptr<UsbBackend> backend = std::make_unique<LibUsbBackend>();
+    bool initialized = false;
     LibUsbHandler(){
-    int r = libusb_init(&ctx);
+    int r = backend->initialize();
     if (r < 0) Debug.Error("Failed to initialize libusb: " , r);
+    else initialized = true;
     }
 };
\ No newline at end of file
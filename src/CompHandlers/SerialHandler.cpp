@@ -0,0 +1,171 @@
+#include "SerialHandler.hpp"
+#include "Debug.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <termios.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    Metrics::Gauge& openPortsGauge() {
+        static Metrics::Gauge& gauge = Metrics::Registry::Instance().gauge("radcat_serial_open_ports", "Open serial ports");
+        return gauge;
+    }
+
+    EventLoop::StreamMetrics metricsFor(const std::string& path) {
+        Metrics::Registry& reg = Metrics::Registry::Instance();
+        const Metrics::Labels labels = { {"port", path} };
+        return { reg.counter("radcat_serial_rx_bytes_total", "Bytes received on a serial port", labels),
+                 reg.counter("radcat_serial_tx_bytes_total", "Bytes sent on a serial port", labels),
+                 reg.counter("radcat_serial_overrun_bytes_total", "Received bytes dropped because the receive buffer was full", labels) };
+    }
+
+#ifndef _WIN32
+    speed_t speedFor(int baudRate) {
+        switch (baudRate) {
+            case 1200: return B1200;
+            case 2400: return B2400;
+            case 4800: return B4800;
+            case 9600: return B9600;
+            case 19200: return B19200;
+            case 38400: return B38400;
+            case 57600: return B57600;
+            case 115200: return B115200;
+        #ifdef B230400
+            case 230400: return B230400;
+        #endif
+        #ifdef B460800
+            case 460800: return B460800;
+        #endif
+        #ifdef B921600
+            case 921600: return B921600;
+        #endif
+            default: return B0;
+        }
+    }
+
+    // Raw mode, no echo or line editing, reads return whatever is there. Returns what failed, nullptr on success.
+    const char* configure(int fd, const SerialHandler::PortConfig& config) {
+        const speed_t speed = speedFor(config.baudRate);
+        if (speed == B0) return "unsupported baud rate";
+        if (config.dataBits < 5 || config.dataBits > 8) return "unsupported data bits";
+        termios tio{};
+        if (tcgetattr(fd, &tio) != 0) return "not a terminal";
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS);
+        constexpr tcflag_t sizes[] = { CS5, CS6, CS7, CS8 };
+        tio.c_cflag |= sizes[config.dataBits - 5];
+        if (config.parity != SerialHandler::Parity::None) tio.c_cflag |= PARENB;
+        if (config.parity == SerialHandler::Parity::Odd) tio.c_cflag |= PARODD;
+        if (config.stopBits == 2) tio.c_cflag |= CSTOPB;
+        tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+        if (config.flowControl == SerialHandler::FlowControl::RtsCts) tio.c_cflag |= CRTSCTS;
+        if (config.flowControl == SerialHandler::FlowControl::XonXoff) tio.c_iflag |= IXON | IXOFF;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(fd, TCSANOW, &tio) != 0) return "settings rejected";
+        return nullptr;
+    }
+
+    std::string readAttribute(const std::filesystem::path& file) {
+        std::ifstream in(file);
+        std::string value;
+        std::getline(in, value);
+        return value;
+    }
+#endif
+}
+
+bool SerialHandler::initialize() {
+    DEBUG_LOG(LogCategory::Serial, "SerialHandler initialized.");
+    return true;
+}
+
+// Open ports belong to their SerialConnections, the EventLoop is stopped by the System
+bool SerialHandler::shutdown() {
+    DEBUG_LOG(LogCategory::Serial, "SerialHandler shut down with ", openPortCount(), " ports open.");
+    return true;
+}
+
+std::vector<SerialHandler::ScannedDeviceInfo> SerialHandler::scanDevices() {
+    RC_TRACE_SCOPE("serial", "scanDevices");
+    std::vector<ScannedDeviceInfo> found;
+#ifndef _WIN32
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator("/sys/class/tty", ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("ttyUSB", 0) != 0 && name.rfind("ttyACM", 0) != 0) continue;
+        ScannedDeviceInfo& info = found.emplace_back();
+        info.path = "/dev/" + name;
+
+        // The descriptor attributes are on the USB device a few levels above the tty's interface
+        fs::path dev = fs::canonical(entry.path() / "device", ec);
+        for (; !ec && dev.has_relative_path(); dev = dev.parent_path()) {
+            if (!fs::exists(dev / "idVendor", ec)) continue;
+            info.vid = static_cast<uint16_t>(std::strtoul(readAttribute(dev / "idVendor").c_str(), nullptr, 16));
+            info.pid = static_cast<uint16_t>(std::strtoul(readAttribute(dev / "idProduct").c_str(), nullptr, 16));
+            info.serial = readAttribute(dev / "serial");
+            info.description = readAttribute(dev / "product");
+            break;
+        }
+        ec.clear();
+        DEBUG_LOG(LogCategory::Scan, "Found serial port ", info.path, " - VID: ", info.vid, ", PID: ", info.pid, " ", info.description);
+    }
+    std::sort(found.begin(), found.end(), [](const ScannedDeviceInfo& a, const ScannedDeviceInfo& b) { return a.path < b.path; });
+#endif
+    return found;
+}
+
+size_t SerialHandler::openPortCount() const { return openPorts.load(std::memory_order_relaxed); }
+
+void SerialHandler::closePort(std::unique_ptr<EventLoop::Stream>& port) {
+    if (!port) return;
+    EventLoop::Instance().detach(*port);
+    port.reset();
+    openPortsGauge().set(static_cast<double>(openPorts.fetch_sub(1, std::memory_order_relaxed) - 1));
+}
+
+#ifndef _WIN32
+
+std::unique_ptr<EventLoop::Stream> SerialHandler::openPort(const std::string& path, const PortConfig& config) {
+    RC_TRACE_SCOPE_DETAIL("serial", "open", path);
+    const int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) { Debug.Error("Could not open serial port ", path, ": ", std::strerror(errno)); return nullptr; }
+    if (const char* error = configure(fd, config)) {
+        Debug.Error("Could not configure serial port ", path, ": ", error);
+        ::close(fd);
+        return nullptr;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    auto port = std::make_unique<EventLoop::Stream>(path, fd, false, config.receiveBufferSize, config.transmitBufferSize, metricsFor(path));
+    if (!EventLoop::Instance().attach(*port)) { ::close(fd); return nullptr; }
+    openPortsGauge().set(static_cast<double>(openPorts.fetch_add(1, std::memory_order_relaxed) + 1));
+    return port;
+}
+
+void SerialHandler::discardDriverInput(EventLoop::Stream& port) {
+    if (port.fd >= 0) tcflush(port.fd, TCIFLUSH);
+}
+
+#else
+
+std::unique_ptr<EventLoop::Stream> SerialHandler::openPort(const std::string& path, const PortConfig&) {
+    Debug.Error("Serial ports are not supported on this platform yet, can not open ", path);
+    return nullptr;
+}
+void SerialHandler::discardDriverInput(EventLoop::Stream&) {}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BaseComponentHandler.hpp"
+#include "EventLoop.hpp"
+
+// Serial ports (tty devices) for SerialConnection: finds USB serial ports, opens and configures them and hands
+// them to the shared EventLoop, which does all reading and writing for every open port on one thread.
+//
+// Linux only for now (termios); elsewhere scanDevices() finds nothing and ports do not open.
+class SerialHandler : public BaseComponentHandler {
+public:
+    static SerialHandler& Instance(){static SerialHandler instance; return instance;}
+    bool initialize() override;
+    bool shutdown() override;
+
+    struct ScannedDeviceInfo {
+        std::string path;                // /dev/ttyUSB0, /dev/ttyACM0
+        uint16_t vid = 0;                // Of the USB device behind the port, 0 if there is none
+        uint16_t pid = 0;
+        std::string serial;
+        std::string description;         // USB product string
+    };
+
+    // USB serial ports (USB-UART adapters and CDC-ACM instruments), sorted by path.
+    std::vector<ScannedDeviceInfo> scanDevices();
+
+    enum class Parity { None, Even, Odd };
+    enum class FlowControl { None, RtsCts, XonXoff };
+
+    struct PortConfig {
+        int baudRate = 9600;
+        int dataBits = 8;                // 5 to 8
+        Parity parity = Parity::None;
+        int stopBits = 1;                // 1 or 2
+        FlowControl flowControl = FlowControl::None;
+        size_t receiveBufferSize = 64 * 1024;  // Bytes that can wait for parsing, more are dropped and counted as overrun
+        size_t transmitBufferSize = 16 * 1024; // Bytes that can wait for the port
+    };
+
+    // Opens the tty raw and non-blocking and attaches it to the EventLoop. nullptr if that failed.
+    std::unique_ptr<EventLoop::Stream> openPort(const std::string& path, const PortConfig& config);
+    // Detaches and closes the port.
+    void closePort(std::unique_ptr<EventLoop::Stream>& port);
+    // Drops what the driver received but the event loop did not pick up yet.
+    void discardDriverInput(EventLoop::Stream& port);
+
+    size_t openPortCount() const;
+
+private:
+    SerialHandler() = default;
+    SerialHandler(const SerialHandler&) = delete;
+    SerialHandler& operator=(const SerialHandler&) = delete;
+
+    std::atomic<size_t> openPorts{0};
+};
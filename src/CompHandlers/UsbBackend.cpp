@@ -0,0 +1,84 @@
+#include "UsbBackend.hpp"
+
+int LibUsbBackend::initialize() {
+    if (ctx) return LIBUSB_SUCCESS;
+    return libusb_init(&ctx);
+}
+
+void LibUsbBackend::shutdown() {
+    if (!ctx) return;
+    {
+        std::lock_guard<std::mutex> lk(hotplugMutex);
+        for (auto& [id, callback] : hotplugCallbacks) libusb_hotplug_deregister_callback(ctx, id);
+        hotplugCallbacks.clear();
+    }
+    libusb_exit(ctx);
+    ctx = nullptr;
+}
+
+int LibUsbBackend::getDeviceList(std::vector<libusb_device*>& devices) {
+    libusb_device** list = nullptr;
+    ssize_t count = libusb_get_device_list(ctx, &list);
+    if (count < 0) return static_cast<int>(count);
+    devices.insert(devices.end(), list, list + count);
+    libusb_free_device_list(list, 0); // References move to the caller
+    return LIBUSB_SUCCESS;
+}
+
+void LibUsbBackend::refDevice(libusb_device* device) { libusb_ref_device(device); }
+
+void LibUsbBackend::unrefDevice(libusb_device* device) { libusb_unref_device(device); }
+
+int LibUsbBackend::getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) { return libusb_get_device_descriptor(device, &descriptor); }
+
+uint8_t LibUsbBackend::getBusNumber(libusb_device* device) { return libusb_get_bus_number(device); }
+
+int LibUsbBackend::getPortNumbers(libusb_device* device, uint8_t* ports, int length) { return libusb_get_port_numbers(device, ports, length); }
+
+int LibUsbBackend::open(libusb_device* device, libusb_device_handle** handle) { return libusb_open(device, handle); }
+
+void LibUsbBackend::close(libusb_device_handle* handle) { libusb_close(handle); }
+
+int LibUsbBackend::getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) {
+    return libusb_get_string_descriptor_ascii(handle, index, data, length);
+}
+
+int LibUsbBackend::claimInterface(libusb_device_handle* handle, int interfaceNumber) { return libusb_claim_interface(handle, interfaceNumber); }
+
+int LibUsbBackend::releaseInterface(libusb_device_handle* handle, int interfaceNumber) { return libusb_release_interface(handle, interfaceNumber); }
+
+int LibUsbBackend::bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                                int* transferred, unsigned int timeoutMs) {
+    return libusb_bulk_transfer(handle, endpoint, data, length, transferred, timeoutMs);
+}
+
+int LIBUSB_CALL LibUsbBackend::hotplugTrampoline(libusb_context*, libusb_device* device, libusb_hotplug_event event, void* userData) {
+    (*static_cast<HotplugCallback*>(userData))(device, event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+    return 0; // Stay registered
+}
+
+int LibUsbBackend::registerHotplug(HotplugCallback callback) {
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) return LIBUSB_ERROR_NOT_SUPPORTED;
+    auto holder = std::make_unique<HotplugCallback>(std::move(callback));
+    libusb_hotplug_callback_handle id = 0;
+    int r = libusb_hotplug_register_callback(ctx, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                             LIBUSB_HOTPLUG_NO_FLAGS, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY,
+                                             LIBUSB_HOTPLUG_MATCH_ANY, &LibUsbBackend::hotplugTrampoline, holder.get(), &id);
+    if (r < 0) return r;
+    std::lock_guard<std::mutex> lk(hotplugMutex);
+    hotplugCallbacks[id] = std::move(holder);
+    return id;
+}
+
+void LibUsbBackend::deregisterHotplug(int id) {
+    std::lock_guard<std::mutex> lk(hotplugMutex);
+    auto it = hotplugCallbacks.find(id);
+    if (it == hotplugCallbacks.end()) return;
+    libusb_hotplug_deregister_callback(ctx, id);
+    hotplugCallbacks.erase(it);
+}
+
+int LibUsbBackend::handleEvents(int timeoutMs) {
+    timeval tv{ timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+    return libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "Included/libusb.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// The libusb calls RadCat makes, behind one interface. LibUsbHandler and UsbConnection go through the
+// installed backend instead of calling libusb directly, so scan, match and transfers can run against the
+// real library (LibUsbBackend) or a software stand-in (Simulation/SimulatedUsbBackend).
+// Device and handle pointers are opaque to callers and only meaningful to the backend that produced them.
+// Return values follow libusb: LIBUSB_SUCCESS or a negative LIBUSB_ERROR code.
+class UsbBackend {
+public:
+    virtual ~UsbBackend() = default;
+
+    virtual int initialize() = 0;
+    virtual void shutdown() = 0;
+
+    // ---- Enumeration ----
+    // Appends every attached device, each with one reference the caller releases with unrefDevice().
+    virtual int getDeviceList(std::vector<libusb_device*>& devices) = 0;
+    virtual void refDevice(libusb_device* device) = 0;
+    virtual void unrefDevice(libusb_device* device) = 0;
+    virtual int getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) = 0;
+    virtual uint8_t getBusNumber(libusb_device* device) = 0;
+    virtual int getPortNumbers(libusb_device* device, uint8_t* ports, int length) = 0; // Returns the depth
+
+    // ---- Device ----
+    virtual int open(libusb_device* device, libusb_device_handle** handle) = 0;
+    virtual void close(libusb_device_handle* handle) = 0;
+    virtual int getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) = 0;
+    virtual int claimInterface(libusb_device_handle* handle, int interfaceNumber) = 0;
+    virtual int releaseInterface(libusb_device_handle* handle, int interfaceNumber) = 0;
+
+    // ---- Data ----
+    // Synchronous bulk transfer. The direction comes from the endpoint address (bit 7 set = IN).
+    virtual int bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                             int* transferred, unsigned int timeoutMs) = 0;
+
+    // ---- Hotplug ----
+    // Callbacks run from handleEvents() on the calling thread, like libusb's. Returns a callback id >= 0,
+    // or LIBUSB_ERROR_NOT_SUPPORTED when the platform has no hotplug support.
+    using HotplugCallback = std::function<void(libusb_device* device, bool arrived)>;
+    virtual int registerHotplug(HotplugCallback callback) = 0;
+    virtual void deregisterHotplug(int id) = 0;
+    virtual int handleEvents(int timeoutMs) = 0;
+};
+
+// Forwards every call to libusb, owning the libusb context. The default backend.
+class LibUsbBackend : public UsbBackend {
+public:
+    ~LibUsbBackend() override { shutdown(); }
+
+    int initialize() override;
+    void shutdown() override;
+    libusb_context* getContext() const { return ctx; }
+
+    int getDeviceList(std::vector<libusb_device*>& devices) override;
+    void refDevice(libusb_device* device) override;
+    void unrefDevice(libusb_device* device) override;
+    int getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) override;
+    uint8_t getBusNumber(libusb_device* device) override;
+    int getPortNumbers(libusb_device* device, uint8_t* ports, int length) override;
+    int open(libusb_device* device, libusb_device_handle** handle) override;
+    void close(libusb_device_handle* handle) override;
+    int getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) override;
+    int claimInterface(libusb_device_handle* handle, int interfaceNumber) override;
+    int releaseInterface(libusb_device_handle* handle, int interfaceNumber) override;
+    int bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                     int* transferred, unsigned int timeoutMs) override;
+    int registerHotplug(HotplugCallback callback) override;
+    void deregisterHotplug(int id) override;
+    int handleEvents(int timeoutMs) override;
+
+private:
+    static int LIBUSB_CALL hotplugTrampoline(libusb_context* ctx, libusb_device* device, libusb_hotplug_event event, void* userData);
+
+    libusb_context* ctx = nullptr;
+    std::mutex hotplugMutex;
+    std::map<int, std::unique_ptr<HotplugCallback>> hotplugCallbacks; // libusb callback handle -> callback
+};
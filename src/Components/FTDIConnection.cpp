@@ -1,14 +1,18 @@
 #include "FTDIConnection.hpp"
 #include "debug.hpp"
 #include "deviceCore.hpp"
+#include "Diagnostics/Trace.hpp"
+#include "Utils/SchedulerClock.hpp"
 
 bool FTDIConnection::fConnect() {
     if (connected) return true;
+    RC_TRACE_SCOPE_DETAIL("ftdi", "fConnect", myDeviceName);
     tryingToConnect = true;
 
     if(!openDevice()) { tryingToConnect = false; connected = false; return false; }
     if(!session) { Debug.Error("FTDI fConnect: No valid session available."); tryingToConnect = false; connected = false; return false; }
     if(!(session->openMPSSE())) { tryingToConnect = false; connected = false; return false; }
+    setupDone = true;
 
     connected = true; tryingToConnect = false; return true; // Successfully connected
 }
@@ -24,31 +28,35 @@ bool FTDIConnection::fDisconnect() {
 
 bool FTDIConnection::closeDevice(){
     if (!deviceIsOpen) return true;
-    FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
-    FT_ResetDevice(ftHandle);
-    FT_STATUS status = FT_Close(ftHandle);
-    if (status != FT_OK) { Debug.Error("Failed to close FTDI device: " + std::to_string(status)); return false; }
+    handler.getTransport(backend).purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX);
+    handler.getTransport(backend).resetDevice(ftHandle);
+    FT_STATUS status = handler.getTransport(backend).close(ftHandle);
+    if (status != FT_OK) { Debug.Error("Failed to close FTDI device: ", status); return false; }
     deviceIsOpen = false;
+    setupDone = false;
     ftHandle = nullptr;
+    handler.openChanges.fetch_add(1, std::memory_order_release);
     if constexpr (debug) Debug.Log("FTDI device closed successfully.");
     return true;
 }
 
 bool FTDIConnection::openDevice(){
     if (deviceIsOpen) return true;
+    RC_TRACE_SCOPE("ftdi", "openDevice");
 
-    ftStatus = FT_Open(FTDIIndex, &ftHandle);
+    ftStatus = handler.getTransport(backend).open(FTDIIndex, ftHandle);
     if (ftStatus != FT_OK) {
-        Debug.Error("Failed to open FTDI device: "+ std::to_string(FTDIIndex) + ", " + std::to_string(ftStatus));
+        Debug.Error("Failed to open FTDI device: ", FTDIIndex, ", ", ftStatus);
         tryingToConnect = false; connected = false; return false;
     }
 
     deviceIsOpen = true;
+    handler.openChanges.fetch_add(1, std::memory_order_release);
     if constexpr (debug) Debug.Log("FTDI device opened successfully.");
-    session = FTDIHandler::Instance().getSession(ftHandle, devInfo);
-    FT_ResetDevice(ftHandle); // Reset device to ensure clean state
-    FT_Purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX); // Clear RX and TX buffers
-    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Wait for device to stabilize
+    session = handler.getSession(ftHandle, devInfo, backend);
+    handler.getTransport(backend).resetDevice(ftHandle); // Reset device to ensure clean state
+    handler.getTransport(backend).purge(ftHandle, FT_PURGE_RX | FT_PURGE_TX); // Clear RX and TX buffers
+    SchedulerClock::current().sleepFor(std::chrono::milliseconds(100)); // Wait for device to stabilize
     return true;
 }
 
@@ -67,6 +75,11 @@ bool FTDIConnection::PollData(DWORD bytesToRead, DWORD& bytesRead, int timeoutMs
     Debug.Error("FTDI PollData: No valid session available."); return false;
 }
 
+FT_STATUS FTDIConnection::purgeData(ULONG mask) {
+    if (session) return session->purge(mask);
+    Debug.Error("FTDI purgeData: No valid session available."); return FT_INVALID_HANDLE;
+}
+
 void FTDIConnection::setup() {
     myDeviceName = parent->deviceInfo.deviceName;
 }
@@ -12,13 +12,17 @@ public:
     FT_STATUS sendData(const unsigned char* data, DWORD size);
     FT_STATUS receiveData(unsigned char* buffer, DWORD size, DWORD& bytesRead);
     bool PollData(DWORD bytesToRead, DWORD& bytesRead, int timeoutMs);
+    FT_STATUS purgeData(ULONG mask);
     bool fConnect();
     bool fDisconnect();
 
     //Getters and Setters
-    void setDevInfo(const FT_DEVICE_LIST_INFO_NODE& info) { devInfo = info; }
+    void setDevInfo(const FT_DEVICE_LIST_INFO_NODE& info) { devInfo = info; iface = FTDIHandler::interfaceOf(info); }
     int getFTDIIndex() const { return FTDIIndex; }
     FT_DEVICE_LIST_INFO_NODE getDevInfo() const { return devInfo; }
+    // Chip and channel of the interface, interfaces of one FT2232H/FT4232H run independently of each other
+    const FTDIHandler::ChipInterface& getInterface() const { return iface; }
+    FTDIHandler::Backend getBackend() const { return backend; }
     bool isConnected() const { return connected; }
     bool isDeviceOpen() const { return deviceIsOpen; }
     bool isMPSSEOn() const { return setupDone; }
@@ -30,6 +34,8 @@ private:
     FTDIHandler& handler = FTDIHandler::Instance();
     std::shared_ptr<FTDIHandler::DeviceSession> session;
     FT_DEVICE_LIST_INFO_NODE devInfo;
+    FTDIHandler::ChipInterface iface;
+    FTDIHandler::Backend backend = FTDIHandler::Backend::D2xx;
     static constexpr bool debug = false; //Debug flag
     FT_HANDLE ftHandle = nullptr;
     FT_STATUS ftStatus = FT_OK;
@@ -45,5 +51,6 @@ private:
     bool closeDevice();
     void setup();
     void setFTDIIndex(int index) { FTDIIndex = index; }
+    void setBackend(FTDIHandler::Backend newBackend) { backend = newBackend; }
 
 };
\ No newline at end of file
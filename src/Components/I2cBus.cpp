@@ -0,0 +1,152 @@
+#include "I2cBus.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Shift commands, MSB first
+    constexpr uint8_t WriteBytesFalling = 0x11;
+    constexpr uint8_t ReadBytesRising = 0x20;
+    constexpr uint8_t WriteBitsFalling = 0x13;
+    constexpr uint8_t ReadBitsRising = 0x22;
+
+    // ADBUS pins
+    constexpr uint8_t Scl = 0x01;
+    constexpr uint8_t SdaOut = 0x02;
+    constexpr uint8_t SdaIn = 0x04;
+
+    // With three-phase clocking SCL runs at 2/3 of the plain rate: 60 MHz / ((1 + divisor) * 2) * 2 / 3
+    uint16_t divisorFor(double clockHz) {
+        const double divisor = std::ceil(20e6 / std::max(clockHz, 1.0)) - 1.0;
+        return static_cast<uint16_t>(std::clamp(divisor, 0.0, 65535.0));
+    }
+}
+
+size_t I2cBus::write(uint8_t address, std::span<const uint8_t> data) {
+    Transaction& t = begin(address);
+    writeByte(t, static_cast<uint8_t>(address << 1));
+    for (uint8_t byte : data) writeByte(t, byte);
+    stop();
+    return pending.size() - 1;
+}
+
+size_t I2cBus::writeRegister(uint8_t address, uint8_t reg, std::span<const uint8_t> data) {
+    Transaction& t = begin(address);
+    writeByte(t, static_cast<uint8_t>(address << 1));
+    writeByte(t, reg);
+    for (uint8_t byte : data) writeByte(t, byte);
+    stop();
+    return pending.size() - 1;
+}
+
+size_t I2cBus::read(uint8_t address, size_t count) {
+    Transaction& t = begin(address);
+    writeByte(t, static_cast<uint8_t>(address << 1 | 1));
+    readBytes(t, count);
+    stop();
+    return pending.size() - 1;
+}
+
+size_t I2cBus::readRegisters(uint8_t address, uint8_t reg, size_t count) {
+    Transaction& t = begin(address);
+    writeByte(t, static_cast<uint8_t>(address << 1));
+    writeByte(t, reg);
+    start(true);
+    writeByte(t, static_cast<uint8_t>(address << 1 | 1));
+    readBytes(t, count);
+    stop();
+    return pending.size() - 1;
+}
+
+bool I2cBus::execute(int timeoutMs) {
+    completed.clear();
+    const bool sent = queue.execute(timeoutMs);
+    if (sent) completed.swap(pending);
+    pending.clear();
+    if (!sent) return false;
+
+    bool acked = true;
+    for (size_t i = 0; i < completed.size(); ++i) {
+        if (result(i).acked) continue;
+        DEBUG_WARN(LogCategory::FTDI, "I2C device at address ", static_cast<int>(completed[i].address), " did not acknowledge.");
+        acked = false;
+    }
+    return acked;
+}
+
+I2cBus::Result I2cBus::result(size_t transaction) const {
+    Result r;
+    if (transaction >= completed.size()) return r;
+    const Transaction& t = completed[transaction];
+    std::span<const uint8_t> reply = queue.reply();
+    if (reply.size() < std::max(t.ackOffset + t.acks, t.dataOffset + t.dataCount)) return r;
+    // The ACK bit is the SDA level at the ninth clock, sampled into bit 0: low means acknowledged
+    r.acked = std::none_of(reply.begin() + t.ackOffset, reply.begin() + t.ackOffset + t.acks, [](uint8_t bit) { return bit & 0x01; });
+    r.data = reply.subspan(t.dataOffset, t.dataCount);
+    return r;
+}
+
+I2cBus::Transaction& I2cBus::begin(uint8_t address) {
+    Transaction& t = pending.emplace_back();
+    t.address = address;
+    setup();
+    start(false);
+    return t;
+}
+
+// Clocking for I2C, all dropped by the queue once the adapter runs with it
+void I2cBus::setup() {
+    queue.setClockFlag(MpsseQueue::ClockFlag::DivideBy5, false);
+    queue.setClockFlag(MpsseQueue::ClockFlag::ThreePhase, true);
+    queue.setClockFlag(MpsseQueue::ClockFlag::Adaptive, false);
+    queue.setDivisor(divisorFor(config.clockHz));
+    if (config.driveZeroOnly) queue.setDriveZeroOnly(Scl | SdaOut, 0);
+}
+
+// SDA falls while SCL is high. A repeated START first releases SDA while SCL is still low.
+void I2cBus::start(bool repeated) {
+    if (repeated) lines(false, true);
+    lines(true, true); hold();
+    lines(true, false); hold();
+    lines(false, false);
+}
+
+// SDA rises while SCL is high, leaving the bus idle
+void I2cBus::stop() {
+    lines(false, false);
+    lines(true, false); hold();
+    lines(true, true); hold();
+}
+
+// Eight bits out on the falling edge, then SDA released for the ACK bit clocked in on the rising edge
+void I2cBus::writeByte(Transaction& t, uint8_t byte) {
+    lines(false, (queue.levels(Port::Low) & SdaOut) != 0);
+    queue.shiftBytes(WriteBytesFalling, std::span<const uint8_t>(&byte, 1));
+    lines(false, true, false);
+    const size_t at = queue.shiftBits(ReadBitsRising, 0, 1);
+    if (t.acks++ == 0) t.ackOffset = at;
+}
+
+// Each byte is answered with an ACK, the last one with a NAK so the device lets go of SDA before STOP
+void I2cBus::readBytes(Transaction& t, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const bool last = i + 1 == count;
+        lines(false, true, false);
+        const size_t at = queue.readBytes(ReadBytesRising, 1);
+        if (i == 0) t.dataOffset = at;
+        lines(false, last);
+        queue.shiftBits(WriteBitsFalling, last ? 0xFF : 0x00, 1);
+    }
+    t.dataCount = count;
+}
+
+// SCL and SDA levels, the other low byte pins unchanged. SDA in is always an input; a released SDA is an
+// input too, unless the pins are open-drain and driving it high releases it.
+void I2cBus::lines(bool scl, bool sda, bool driveSda) {
+    const uint8_t levels = (queue.levels(Port::Low) & ~(Scl | SdaOut)) | (scl ? Scl : 0) | (sda ? SdaOut : 0);
+    uint8_t outputs = (queue.outputs(Port::Low) & ~(SdaOut | SdaIn)) | Scl;
+    if (driveSda || config.driveZeroOnly) outputs |= SdaOut;
+    queue.setPort(Port::Low, levels, outputs);
+}
+
+void I2cBus::hold() { queue.repeatPort(Port::Low, config.holdWrites - 1); }
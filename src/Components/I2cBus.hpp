@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "componentCore.hpp"
+#include "FTDIConnection.hpp"
+#include "MpsseQueue.hpp"
+
+// I2C over the MPSSE port of the device's FTDIConnection (FTDI AN_113 wiring: ADBUS0 SCL, ADBUS1 and
+// ADBUS2 tied together as SDA), for sensor boards behind FT232H/FT2232H adapters.
+//
+// Three-phase clocking keeps SDA valid across both SCL edges. Transactions are queued and execute() sends
+// all of them as one MPSSE command stream: every ACK bit the host expects is clocked in as part of that
+// stream and comes back in the same reply as the data, so a whole sensor poll (any number of register
+// writes and multi-register reads) costs one USB round trip instead of one per byte. ACKs are checked
+// once the reply is in; a transaction that was not acknowledged reports it in its Result, the others
+// in the batch are unaffected.
+//
+// Usage: class MySensorBoard : public BaseDevice<FTDIConnection, I2cBus> { ... };
+//   I2cBus& bus = getComponentRef<I2cBus>();
+//   size_t t = bus.readRegisters(0x48, 0x00, 2);   // e.g. a TMP117 temperature register
+//   size_t p = bus.readRegisters(0x76, 0xF7, 6);   // and a BMP280 pressure/temperature burst
+//   if (bus.execute()) use(bus.result(t).data, bus.result(p).data);
+COMPONENT class I2cBus : public BaseComponent {
+public:
+    template<typename DeviceType> I2cBus(DeviceType& parentDevice) : BaseComponent(&parentDevice), queue(&parentDevice.template getComponentRef<FTDIConnection>()) {}
+
+    using Port = MpsseQueue::Port;
+    using Pin = MpsseQueue::Pin;
+    using Stats = MpsseQueue::Stats;
+
+    struct Config {
+        double clockHz = 100e3;          // SCL, 100 kHz standard mode or 400 kHz fast mode
+        bool driveZeroOnly = false;      // FT232H only: open-drain SCL and SDA. Otherwise SDA is released by making it an input
+        int holdWrites = 4;              // GPIO writes per START/STOP step, holding it for the bus setup and hold times
+    };
+
+    struct Result {
+        bool acked = false;              // Every byte the host sent was acknowledged
+        std::span<const uint8_t> data;   // Bytes read, valid until the next execute()
+    };
+
+    // Takes effect with the next transaction.
+    void configure(const Config& newConfig) { config = newConfig; }
+    const Config& getConfig() const { return config; }
+
+    // Other pins of the adapter (enables, resets), queued with the transactions. Writes that change nothing are dropped.
+    void setPin(Pin pin, bool high) { queue.setPin(pin, high); }
+
+    // Transactions, each from START to STOP, addresses are 7-bit. They return the transaction's index in the batch.
+    size_t write(uint8_t address, std::span<const uint8_t> data);
+    size_t writeRegister(uint8_t address, uint8_t reg, std::span<const uint8_t> data);
+    size_t read(uint8_t address, size_t count);
+    // Register address, repeated START, then count bytes (the device auto-increments the register)
+    size_t readRegisters(uint8_t address, uint8_t reg, size_t count);
+
+    // Sends every queued transaction as one write and collects all ACK bits and data with one read.
+    // Returns false if the transfer failed or any transaction was not acknowledged.
+    bool execute(int timeoutMs = 100);
+
+    // Results of the last execute(), by transaction index.
+    Result result(size_t transaction) const;
+    size_t resultCount() const { return completed.size(); }
+
+    // Drops the queued transactions.
+    void discard() { pending.clear(); queue.discard(); }
+
+    // Drops the queue and forgets the adapter's pin and clock state. Call after the device was (re)opened.
+    void invalidate() { pending.clear(); completed.clear(); queue.invalidate(); }
+
+    const Stats& getStats() const { return queue.getStats(); }
+
+private:
+    static constexpr bool debug = false; //Debug flag
+
+    // Where a transaction's replies landed: its ACK bits first, then the bytes it read
+    struct Transaction {
+        uint8_t address = 0;
+        size_t ackOffset = 0;
+        size_t acks = 0;
+        size_t dataOffset = 0;
+        size_t dataCount = 0;
+    };
+
+    Transaction& begin(uint8_t address);
+    void setup();
+    void start(bool repeated);
+    void stop();
+    void writeByte(Transaction& t, uint8_t byte);
+    void readBytes(Transaction& t, size_t count);
+    void lines(bool scl, bool sda, bool driveSda = true);
+    void hold();
+
+    MpsseQueue queue;
+    Config config;
+    std::vector<Transaction> pending;
+    std::vector<Transaction> completed;
+};
@@ -0,0 +1,125 @@
+#include "MCAHistogram.hpp"
+#include "Debug.hpp"
+#include "Utils/Simd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+uint64_t MCAHistogram::nextInstanceId() {
+    static std::atomic<uint64_t> counter{1};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool MCAHistogram::configure(int binCount, double offset, double gain) {
+    if (!(gain > 0.0)) { Debug.Error("MCAHistogram configure: energy per bin must be positive, got ", gain); return false; }
+    int clamped = std::clamp(binCount, minBins, maxBins);
+    if (clamped != binCount) Debug.Warn("MCAHistogram configure: ", binCount, " bins out of range, using ", clamped);
+
+    std::lock_guard<std::mutex> lk(*shardMutex);
+    bins = clamped;
+    storeCalibration(offset, gain);
+    for (auto& shard : shards) shard->counts = std::make_unique<uint64_t[]>(bins + 2);
+    baseline.assign(bins + 2, 0);
+    clearTime = std::chrono::steady_clock::now();
+    if constexpr (debug) Debug.Log("MCAHistogram configured: ", bins, " bins, ", gain, " per bin");
+    return true;
+}
+
+void MCAHistogram::setCalibration(double offset, double gain) {
+    if (!(gain > 0.0)) { Debug.Error("MCAHistogram setCalibration: energy per bin must be positive, got ", gain); return; }
+    std::lock_guard<std::mutex> lk(*shardMutex);
+    storeCalibration(offset, gain);
+}
+
+void MCAHistogram::storeCalibration(double offset, double gain) {
+    std::atomic_ref<uint32_t> sequence(calibrationSequence);
+    const uint32_t current = sequence.load(std::memory_order_relaxed);
+    sequence.store(current + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    store(energyOffset, offset);
+    store(energyPerBin, gain);
+    store(binsPerEnergy, 1.0 / gain);
+    sequence.store(current + 2, std::memory_order_release);
+}
+
+void MCAHistogram::addEvents(std::span<const double> energies) {
+    Shard& shard = localShard();
+    uint64_t* counts = shard.counts.get();
+    const Calibration cal = calibration();
+    const double offset = cal.energyOffset, scale = cal.binsPerEnergy, limit = static_cast<double>(bins);
+    for (double energy : energies) {
+        double bin = (energy - offset) * scale;
+        if (!(bin >= 0.0)) bump(counts[bins]); // Also NaN
+        else if (!(bin < limit)) bump(counts[bins + 1]);
+        else bump(counts[static_cast<uint32_t>(bin)]);
+    }
+}
+
+// Slow path, once per thread per histogram.
+MCAHistogram::Shard& MCAHistogram::registerShard() {
+    std::lock_guard<std::mutex> lk(*shardMutex);
+    const std::thread::id self = std::this_thread::get_id();
+    for (auto& shard : shards) if (shard->owner == self) return *shard;
+
+    auto shard = std::make_unique<Shard>();
+    shard->owner = self;
+    shard->counts = std::make_unique<uint64_t[]>(bins + 2);
+    shards.push_back(std::move(shard));
+    if constexpr (debug) Debug.Log("MCAHistogram: registered shard ", shards.size(), " for a new acquisition thread");
+    return *shards.back();
+}
+
+// Live shards are loaded slot by slot, the vector kernels only run on the private copies.
+void MCAHistogram::addShard(uint64_t* dst, const uint64_t* counts, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] += load(counts[i]);
+}
+
+// Sums all shards into out (bins + 2 entries) and removes the clear() baseline.
+void MCAHistogram::mergeLocked(std::vector<uint64_t>& out) const {
+    const size_t n = static_cast<size_t>(bins) + 2;
+    out.assign(n, 0);
+    for (const auto& shard : shards) addShard(out.data(), shard->counts.get(), n);
+    Simd::subU64(out.data(), baseline.data(), n);
+}
+
+MCAHistogram::Snapshot MCAHistogram::snapshot() const {
+    Snapshot snap;
+    {
+        std::lock_guard<std::mutex> lk(*shardMutex);
+        mergeLocked(snap.counts);
+        snap.realTimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clearTime).count();
+    }
+    snap.underflow = snap.counts[bins];
+    snap.overflow = snap.counts[bins + 1];
+    snap.counts.resize(bins);
+    snap.totalCounts = Simd::sumU64(snap.counts.data(), snap.counts.size());
+    const Calibration cal = calibration();
+    snap.energyOffset = cal.energyOffset;
+    snap.energyPerBin = cal.energyPerBin;
+    return snap;
+}
+
+uint64_t MCAHistogram::roiSum(int firstBin, int lastBin) const {
+    firstBin = std::max(firstBin, 0);
+    lastBin = std::min(lastBin, bins - 1);
+    if (firstBin > lastBin) return 0;
+    const size_t n = static_cast<size_t>(lastBin - firstBin) + 1;
+
+    std::lock_guard<std::mutex> lk(*shardMutex);
+    uint64_t total = 0;
+    for (const auto& shard : shards)
+        for (size_t i = 0; i < n; ++i) total += load(shard->counts[firstBin + i]);
+    return total - Simd::sumU64(baseline.data() + firstBin, n);
+}
+
+uint64_t MCAHistogram::totalCounts() const { return roiSum(0, bins - 1); }
+
+// Moves the baseline up to the current totals. Writers keep incrementing their shards untouched.
+void MCAHistogram::clear() {
+    std::lock_guard<std::mutex> lk(*shardMutex);
+    const size_t n = static_cast<size_t>(bins) + 2;
+    std::fill(baseline.begin(), baseline.end(), 0);
+    for (const auto& shard : shards) addShard(baseline.data(), shard->counts.get(), n);
+    clearTime = std::chrono::steady_clock::now();
+    if constexpr (debug) Debug.Log("MCAHistogram cleared.");
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include "componentCore.hpp"
+
+// Multichannel analyzer (MCA) spectrum accumulator.
+// Every acquisition thread increments its own shard of the histogram, so the hot path has no locks and no atomic
+// read-modify-writes.
+// Readers (UI, storage, ROI logic) merge all shards on demand.
+// Clearing does not touch the shards: it records a baseline that later reads subtract, so acquisition never has to stop.
+//
+// Usage: class MyDetector : public BaseDevice<UsbConnection, MCAHistogram> { ... };
+//        getComponentRef<MCAHistogram>().addEvent(energyKeV);
+COMPONENT class MCAHistogram : public BaseComponent {
+public:
+    template<typename DeviceType> MCAHistogram(DeviceType& parentDevice) : BaseComponent(&parentDevice) { configure(defaultBins); }
+
+    static constexpr int minBins = 1024;
+    static constexpr int maxBins = 65536;
+    static constexpr int defaultBins = 4096;
+
+    struct Snapshot {
+        std::vector<uint64_t> counts; // One entry per bin
+        uint64_t totalCounts = 0;     // Sum of all in-range bins
+        uint64_t underflow = 0;       // Events below bin 0
+        uint64_t overflow = 0;        // Events above the last bin
+        double energyOffset = 0.0;    // Energy of bin 0
+        double energyPerBin = 1.0;    // Calibration gain
+        double realTimeSeconds = 0.0; // Time since the last clear()
+    };
+
+    // Sets the number of bins (clamped to [minBins, maxBins]) and the calibration, and resets all counts.
+    // Not safe while acquisition threads are running. Use clear() for that.
+    bool configure(int bins, double energyOffset = 0.0, double energyPerBin = 1.0);
+
+    // Calibration energy = offset + gain * bin. Can be changed at any time, only affects future events.
+    void setCalibration(double energyOffset, double energyPerBin);
+
+    struct Calibration {
+        double energyOffset;
+        double energyPerBin;
+        double binsPerEnergy; // 1 / energyPerBin
+    };
+    // Consistent copy of the calibration while setCalibration() may run on another thread
+    Calibration calibration() const;
+
+    // ---- Hot path (acquisition threads) ----
+    // Bins a calibrated energy. NaN counts as underflow.
+    inline void addEvent(double energy) {
+        Shard& shard = localShard();
+        const Calibration cal = calibration();
+        double bin = (energy - cal.energyOffset) * cal.binsPerEnergy;
+        if (!(bin >= 0.0)) { bump(shard.counts[bins]); return; }
+        if (!(bin < static_cast<double>(bins))) { bump(shard.counts[bins + 1]); return; }
+        bump(shard.counts[static_cast<uint32_t>(bin)]);
+    }
+
+    // Bins a raw channel number, bypassing the calibration.
+    inline void addChannel(uint32_t channel) {
+        Shard& shard = localShard();
+        bump(shard.counts[channel < static_cast<uint32_t>(bins) ? channel : static_cast<uint32_t>(bins + 1)]);
+    }
+
+    // Bins a block of calibrated energies with a single shard and calibration lookup.
+    void addEvents(std::span<const double> energies);
+
+    // ---- Read side (any thread, acquisition keeps running) ----
+    Snapshot snapshot() const;
+    uint64_t roiSum(int firstBin, int lastBin) const; // Inclusive bin range
+    uint64_t totalCounts() const;
+    void clear();
+
+    int binCount() const { return bins; }
+    double getEnergyOffset() const { return calibration().energyOffset; }
+    double getEnergyPerBin() const { return calibration().energyPerBin; }
+
+private:
+    static constexpr bool debug = false; //Debug flag
+
+    // One shard per writing thread. Slots [bins] and [bins+1] hold underflow and overflow.
+    // Only the owning thread writes a shard, readers load it while it is live. Both sides access the slots as
+    // relaxed atomics, which compile to plain loads and stores: a bin read mid-increment reports either the old
+    // or the new value, which is all a live spectrum needs.
+    struct Shard {
+        std::thread::id owner;
+        std::unique_ptr<uint64_t[]> counts;
+    };
+
+    // Owner only, so a relaxed load and store is a complete increment
+    static void bump(uint64_t& slot) {
+        std::atomic_ref<uint64_t> count(slot);
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    template<typename T> static T load(const T& slot) { return std::atomic_ref<T>(const_cast<T&>(slot)).load(std::memory_order_relaxed); }
+    template<typename T> static void store(T& slot, T value) { std::atomic_ref<T>(slot).store(value, std::memory_order_relaxed); }
+    static void addShard(uint64_t* dst, const uint64_t* counts, size_t n); // dst[i] += counts[i]
+
+    Shard& localShard();
+    Shard& registerShard();
+    void mergeLocked(std::vector<uint64_t>& out) const; // Requires shardMutex
+
+    void storeCalibration(double offset, double gain); // Requires shardMutex
+
+    // Calibration behind a seqlock: the sequence is odd while storeCalibration() writes, readers retry until
+    // they copied all three values within one even sequence. Accessed through atomic_ref like the shard slots.
+    int bins = 0;
+    uint32_t calibrationSequence = 0;
+    alignas(std::atomic_ref<double>::required_alignment) double energyOffset = 0.0;
+    alignas(std::atomic_ref<double>::required_alignment) double energyPerBin = 1.0;
+    alignas(std::atomic_ref<double>::required_alignment) double binsPerEnergy = 1.0;
+
+    // Unique per instance (never reused), so thread-local shard caches can not alias a destroyed histogram.
+    const uint64_t instanceId = nextInstanceId();
+    static uint64_t nextInstanceId();
+
+    // Guards shards/baseline. Never taken on the hot path once a thread is registered.
+    // Held by pointer so the component stays movable for BaseDevice's component tuple.
+    std::unique_ptr<std::mutex> shardMutex = std::make_unique<std::mutex>();
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<uint64_t> baseline; // Raw totals at the last clear(), bins + 2 entries
+    std::chrono::steady_clock::time_point clearTime = std::chrono::steady_clock::now();
+};
+
+inline MCAHistogram::Calibration MCAHistogram::calibration() const {
+    std::atomic_ref<uint32_t> sequence(const_cast<uint32_t&>(calibrationSequence));
+    for (;;) {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        const Calibration cal{ load(energyOffset), load(energyPerBin), load(binsPerEnergy) };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!(before & 1) && sequence.load(std::memory_order_relaxed) == before) return cal;
+    }
+}
+
+// Fast path: a small per-thread cache maps histogram instances to this thread's shard.
+inline MCAHistogram::Shard& MCAHistogram::localShard() {
+    struct CacheEntry { uint64_t id = 0; Shard* shard = nullptr; };
+    static thread_local CacheEntry cache[4];
+    static thread_local unsigned nextSlot = 0;
+    for (CacheEntry& entry : cache) if (entry.id == instanceId) return *entry.shard;
+    Shard& shard = registerShard();
+    cache[nextSlot++ % 4] = { instanceId, &shard };
+    return shard;
+}
@@ -0,0 +1,157 @@
+#include "MpsseQueue.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+
+namespace {
+    // MPSSE commands
+    constexpr uint8_t SetLowByte = 0x80;
+    constexpr uint8_t SetHighByte = 0x82;
+    constexpr uint8_t SetDivisor = 0x86;
+    constexpr uint8_t SendImmediate = 0x87;
+    constexpr uint8_t DriveZeroOnly = 0x9E;
+
+    // Off / on opcodes of the clocking flags, in ClockFlag order
+    constexpr uint8_t FlagOpcodes[3][2] = { { 0x8A, 0x8B }, { 0x8D, 0x8C }, { 0x97, 0x96 } };
+
+    // Shift command flags
+    constexpr uint8_t WriteData = 0x10;
+    constexpr uint8_t ReadData = 0x20;
+
+    constexpr size_t MaxShiftBytes = 65536;
+}
+
+void MpsseQueue::declare(Port port, uint8_t levels, uint8_t outputs) {
+    const int p = static_cast<int>(port);
+    for (ChipState* s : { &state, &sent }) {
+        s->levels[p] = levels;
+        s->outputs[p] = outputs;
+        s->known[p] = false;
+    }
+}
+
+void MpsseQueue::setPort(Port port, uint8_t levels, uint8_t outputs) { writePort(port, levels, outputs); }
+
+void MpsseQueue::setPin(Pin pin, bool high) {
+    const int p = static_cast<int>(pin.port);
+    const uint8_t levels = high ? state.levels[p] | pin.mask : state.levels[p] & ~pin.mask;
+    writePort(pin.port, levels, state.outputs[p]);
+}
+
+void MpsseQueue::repeatPort(Port port, int writes) {
+    const int p = static_cast<int>(port);
+    for (int i = 0; i < writes; ++i) commands.insert(commands.end(), { port == Port::Low ? SetLowByte : SetHighByte, state.levels[p], state.outputs[p] });
+    stats.gpioWrites += std::max(writes, 0);
+}
+
+void MpsseQueue::setDivisor(uint16_t divisor) {
+    writeSetting(state.divisor, divisor, { SetDivisor, static_cast<uint8_t>(divisor & 0xFF), static_cast<uint8_t>(divisor >> 8) }, stats.divisorWrites, stats.divisorWritesDropped);
+}
+
+void MpsseQueue::setClockFlag(ClockFlag flag, bool on) {
+    const int f = static_cast<int>(flag);
+    writeSetting(state.flags[f], on ? 1 : 0, { FlagOpcodes[f][on ? 1 : 0] }, stats.clockModeWrites, stats.clockModeWritesDropped);
+}
+
+void MpsseQueue::setDriveZeroOnly(uint8_t lowMask, uint8_t highMask) {
+    writeSetting(state.driveZeroOnly, lowMask | highMask << 8, { DriveZeroOnly, lowMask, highMask }, stats.clockModeWrites, stats.clockModeWritesDropped);
+}
+
+size_t MpsseQueue::shiftBytes(uint8_t opcode, std::span<const uint8_t> out) {
+    const size_t offset = replyBytes;
+    for (size_t done = 0; done < out.size(); ) {
+        const size_t n = std::min(out.size() - done, MaxShiftBytes);
+        commands.insert(commands.end(), { opcode, static_cast<uint8_t>((n - 1) & 0xFF), static_cast<uint8_t>((n - 1) >> 8) });
+        commands.insert(commands.end(), out.begin() + done, out.begin() + done + n);
+        done += n;
+    }
+    if (opcode & ReadData) replyBytes += out.size();
+    if (opcode & WriteData) state.known[0] = false;
+    return offset;
+}
+
+size_t MpsseQueue::readBytes(uint8_t opcode, size_t count) {
+    const size_t offset = replyBytes;
+    for (size_t done = 0; done < count; ) {
+        const size_t n = std::min(count - done, MaxShiftBytes);
+        commands.insert(commands.end(), { opcode, static_cast<uint8_t>((n - 1) & 0xFF), static_cast<uint8_t>((n - 1) >> 8) });
+        done += n;
+    }
+    replyBytes += count;
+    return offset;
+}
+
+size_t MpsseQueue::shiftBits(uint8_t opcode, uint8_t bits, int count) {
+    const size_t offset = replyBytes;
+    if (count < 1 || count > 8) { DEBUG_ERROR(LogCategory::FTDI, "MPSSE bit shift: bit count out of range: ", count); return offset; }
+    if (opcode & WriteData) {
+        commands.insert(commands.end(), { opcode, static_cast<uint8_t>(count - 1), bits });
+        state.known[0] = false;
+    }
+    else commands.insert(commands.end(), { opcode, static_cast<uint8_t>(count - 1) });
+    if (opcode & ReadData) ++replyBytes;
+    return offset;
+}
+
+bool MpsseQueue::execute(int timeoutMs) {
+    replyBuffer.clear();
+    if (commands.empty()) return true;
+    if (!connection->isDeviceOpen() || !connection->isMPSSEOn()) { DEBUG_ERROR(LogCategory::FTDI, "MPSSE queue: device not open or MPSSE not enabled."); discard(); return false; }
+
+    const DWORD expected = static_cast<DWORD>(replyBytes);
+    if (expected) commands.push_back(SendImmediate); // Flush the reply without waiting for the latency timer
+    FT_STATUS status = connection->sendData(commands.data(), static_cast<DWORD>(commands.size()));
+    ++stats.batches;
+    stats.commandBytes += commands.size();
+    commands.clear();
+    replyBytes = 0;
+    if (status != FT_OK) { DEBUG_ERROR(LogCategory::FTDI, "MPSSE queue write error: ", status); invalidate(); return false; }
+    sent = state;
+    if (!expected) return true;
+
+    DWORD bytesRead = 0;
+    replyBuffer.resize(expected);
+    if (!connection->PollData(expected, bytesRead, timeoutMs)) { DEBUG_ERROR(LogCategory::FTDI, "MPSSE reply timed out, ", bytesRead, " of ", expected, " bytes available."); dropReply(); return false; }
+    status = connection->receiveData(replyBuffer.data(), expected, bytesRead);
+    if (status != FT_OK) { DEBUG_ERROR(LogCategory::FTDI, "MPSSE reply read error: ", status); dropReply(); return false; }
+    if (bytesRead < expected) { DEBUG_ERROR(LogCategory::FTDI, "MPSSE reply too short: ", bytesRead, " of ", expected, " bytes."); dropReply(); return false; }
+    stats.replyBytes += expected;
+    return true;
+}
+
+// The rest of a failed reply may still arrive and would be read as the next batch's reply. Whether the chip ran
+// the batch is unknown as well.
+void MpsseQueue::dropReply() {
+    replyBuffer.clear();
+    connection->purgeData(FT_PURGE_RX);
+    invalidate();
+}
+
+void MpsseQueue::discard() {
+    commands.clear();
+    replyBytes = 0;
+    state = sent;
+}
+
+void MpsseQueue::invalidate() {
+    ChipState forgotten;
+    for (int p = 0; p < 2; ++p) { forgotten.levels[p] = state.levels[p]; forgotten.outputs[p] = state.outputs[p]; }
+    state = sent = forgotten;
+    discard();
+}
+
+void MpsseQueue::writePort(Port port, uint8_t levels, uint8_t outputs) {
+    const int p = static_cast<int>(port);
+    if (state.known[p] && state.levels[p] == levels && state.outputs[p] == outputs) { ++stats.gpioWritesDropped; return; }
+    commands.insert(commands.end(), { port == Port::Low ? SetLowByte : SetHighByte, levels, outputs });
+    state.levels[p] = levels;
+    state.outputs[p] = outputs;
+    state.known[p] = true;
+    ++stats.gpioWrites;
+}
+
+void MpsseQueue::writeSetting(int& current, int value, std::initializer_list<uint8_t> command, uint64_t& writes, uint64_t& dropped) {
+    if (current == value) { ++dropped; return; }
+    commands.insert(commands.end(), command);
+    current = value;
+    ++writes;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <vector>
+#include "FTDIConnection.hpp"
+
+// An MPSSE command stream under construction, shared by the bus components (SpiBus, I2cBus).
+//
+// Tracks the state the chip will be in once the queue has run (pin levels and directions of both ports,
+// clock divisor, clocking flags, open-drain outputs) and drops commands that would not change it, across
+// batches too. Shifts that drive data out leave ADBUS1 at their last bit, so the low port counts as unknown
+// after them and its next write always goes out. execute() sends the queue as one write and collects every
+// reply byte with one read.
+class MpsseQueue {
+public:
+    enum class Port : uint8_t { Low = 0, High = 1 }; // ADBUS, ACBUS
+    enum class ClockFlag : uint8_t { DivideBy5, ThreePhase, Adaptive };
+
+    struct Pin {
+        Port port = Port::Low;
+        uint8_t mask = 0;
+    };
+
+    struct Stats {
+        uint64_t batches = 0;
+        uint64_t commandBytes = 0;
+        uint64_t replyBytes = 0;
+        uint64_t gpioWrites = 0;
+        uint64_t gpioWritesDropped = 0;
+        uint64_t divisorWrites = 0;
+        uint64_t divisorWritesDropped = 0;
+        uint64_t clockModeWrites = 0;         // Clocking flags and open-drain setup
+        uint64_t clockModeWritesDropped = 0;
+    };
+
+    explicit MpsseQueue(FTDIConnection* connection) : connection(connection) {}
+
+    // Pin state, writes that change nothing are dropped. declare() only sets what the next write of the
+    // port carries, for lines a bus wants idle without writing them yet.
+    void declare(Port port, uint8_t levels, uint8_t outputs);
+    void setPort(Port port, uint8_t levels, uint8_t outputs);
+    void setPin(Pin pin, bool high);
+    void repeatPort(Port port, int writes); // Writes the current state again, to hold it for setup and hold times
+    uint8_t levels(Port port) const { return state.levels[static_cast<int>(port)]; }
+    uint8_t outputs(Port port) const { return state.outputs[static_cast<int>(port)]; }
+
+    // Clock setup, dropped when the chip already runs with it
+    void setDivisor(uint16_t divisor);
+    void setClockFlag(ClockFlag flag, bool on);
+    void setDriveZeroOnly(uint8_t lowMask, uint8_t highMask); // FT232H only: open-drain pins (0x9E)
+
+    // Shift commands (AN_108 opcodes). Return the offset of the bytes they read in reply().
+    size_t shiftBytes(uint8_t opcode, std::span<const uint8_t> out);   // Write, or full duplex
+    size_t readBytes(uint8_t opcode, size_t count);
+    size_t shiftBits(uint8_t opcode, uint8_t bits, int count);         // 1 to 8 bits
+
+    // Sends the queue as one write, closed with SEND_IMMEDIATE and followed by one read when replies are due.
+    // Keep a batch's replies within the chip's receive buffer. A failed write forgets the chip state, a failed
+    // reply also purges the receive buffer so late bytes can not pass for the next batch's reply.
+    bool execute(int timeoutMs);
+
+    // Drops the queue, the state goes back to what the chip last received.
+    void discard();
+
+    // Drops the queue and forgets the chip state, the next commands go out unconditionally.
+    // Call after the device was (re)opened.
+    void invalidate();
+
+    std::span<const uint8_t> reply() const { return replyBuffer; }
+    std::span<const uint8_t> queued() const { return commands; } // Without the closing SEND_IMMEDIATE
+    size_t queuedReplyBytes() const { return replyBytes; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct ChipState {
+        uint8_t levels[2] = {0, 0};
+        uint8_t outputs[2] = {0, 0};
+        bool known[2] = {false, false};  // The chip's pins match levels and outputs
+        int divisor = -1;                // -1 unknown, likewise below
+        int flags[3] = {-1, -1, -1};
+        int driveZeroOnly = -1;          // Low mask | high mask << 8
+    };
+
+    void writePort(Port port, uint8_t levels, uint8_t outputs);
+    void writeSetting(int& current, int value, std::initializer_list<uint8_t> command, uint64_t& writes, uint64_t& dropped);
+    void dropReply();
+
+    FTDIConnection* connection;
+    ChipState state;                     // With the queue applied
+    ChipState sent;                      // As of the last execute()
+    std::vector<uint8_t> commands;
+    size_t replyBytes = 0;
+    std::vector<uint8_t> replyBuffer;
+    Stats stats;
+};
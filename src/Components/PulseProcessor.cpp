@@ -0,0 +1,122 @@
+#include "PulseProcessor.hpp"
+#include "Debug.hpp"
+#include "Utils/Simd.hpp"
+#include <algorithm>
+#include <cmath>
+
+bool PulseProcessor::configure(const Config& newConfig) {
+    if (newConfig.riseSamples < 1 || newConfig.fastRiseSamples < 1 || newConfig.flatTopSamples < 0) {
+        Debug.Error("PulseProcessor configure: rise and flat top lengths must be positive."); return false;
+    }
+    if (newConfig.flatTopSamples < newConfig.fastRiseSamples) {
+        Debug.Error("PulseProcessor configure: flat top (", newConfig.flatTopSamples, ") must cover the fast rise (", newConfig.fastRiseSamples, ").");
+        return false;
+    }
+    if (newConfig.sampleRateHz <= 0.0 || newConfig.baselineSamples < 1) {
+        Debug.Error("PulseProcessor configure: sample rate and baseline length must be positive."); return false;
+    }
+
+    config = newConfig;
+    slow.k = config.riseSamples;
+    slow.l = config.riseSamples + config.flatTopSamples;
+    slow.invK = 1.0 / slow.k;
+    fast.k = config.fastRiseSamples;
+    fast.l = config.fastRiseSamples;
+    fast.invK = 1.0 / fast.k;
+
+    poleZero = config.decaySamples > 0.0 ? std::exp(-1.0 / config.decaySamples) : 1.0;
+    baselineAlpha = 1.0 / config.baselineSamples;
+    history = std::max(slow.k + slow.l, fast.k + fast.l);
+
+    // Trigger lands somewhere in the fast rise, so sampling here stays on the slow flat top.
+    sampleOffset = slow.k + (config.flatTopSamples - fast.k) / 2;
+    inspectWindow = config.pileUpWindow > 0 ? config.pileUpWindow : slow.k + slow.l;
+    inspectWindow = std::max(inspectWindow, sampleOffset + 1);
+
+    reset();
+    if constexpr (debug) Debug.Log("PulseProcessor configured: rise ", slow.k, ", flat top ", config.flatTopSamples, ", fast rise ", fast.k);
+    return true;
+}
+
+void PulseProcessor::reset() {
+    for (Shaper* s : { &slow, &fast }) { s->prevD = 0; s->f = 0.0; s->t = 0.0; }
+    baseline = fastBaseline = 0.0;
+    sampleIndex = lastTrigger = 0;
+    anyTrigger = false;
+    armed = true;
+    primed = false;
+    stats = {};
+    pending.clear();
+    widened.assign(history, 0);
+}
+
+size_t PulseProcessor::processBlock(std::span<const int16_t> samples, std::vector<PulseEvent>& out) {
+    const size_t n = samples.size();
+    if (n == 0) return 0;
+    const size_t before = out.size();
+
+    // Widen into [history | block]; the first block seeds the history with its first sample to avoid a start-up step.
+    widened.resize(history + n);
+    Simd::widenI16(samples.data(), widened.data() + history, n, config.invertPolarity);
+    if (!primed) { std::fill(widened.begin(), widened.begin() + history, widened[history]); primed = true; }
+
+    const int32_t* x = widened.data() + history;
+    slow.d.resize(n);
+    fast.d.resize(n);
+    Simd::fourTapDiff(x, slow.d.data(), n, slow.k, slow.l);
+    Simd::fourTapDiff(x, fast.d.data(), n, fast.k, fast.l);
+
+    const double a = poleZero, threshold = config.threshold, rearm = config.threshold * 0.5;
+    const double nsPerSample = 1e9 / config.sampleRateHz;
+    const uint64_t quietSlow = static_cast<uint64_t>(slow.k + slow.l);
+    const uint64_t quietFast = static_cast<uint64_t>(fast.k + fast.l);
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t idx = sampleIndex + i;
+
+        // Pole-zero correction followed by the two running sums of the trapezoid
+        const int32_t ds = slow.d[i], df = fast.d[i];
+        slow.f += ds - a * slow.prevD; slow.prevD = ds; slow.t += slow.f;
+        fast.f += df - a * fast.prevD; fast.prevD = df; fast.t += fast.f;
+        const double height = slow.t * slow.invK;
+        const double fastHeight = fast.t * fast.invK - fastBaseline;
+
+        // Trigger with hysteresis
+        if (armed && fastHeight > threshold) {
+            armed = false;
+            stats.triggers++;
+            bool piled = anyTrigger && idx - lastTrigger < static_cast<uint64_t>(inspectWindow);
+            if (piled && !pending.empty()) pending.back().pileUp = true;
+            pending.push_back({ idx, idx + sampleOffset, 0.0, false, piled });
+            lastTrigger = idx;
+            anyTrigger = true;
+        } else if (!armed && fastHeight < rearm) {
+            armed = true;
+        }
+
+        // Baseline restoration while neither filter sees a pulse
+        const uint64_t sinceTrigger = anyTrigger ? idx - lastTrigger : UINT64_MAX;
+        if (sinceTrigger > quietSlow) baseline += (height - baseline) * baselineAlpha;
+        if (armed && sinceTrigger > quietFast) fastBaseline += (fast.t * fast.invK - fastBaseline) * baselineAlpha;
+
+        // Peak-height extraction and pile-up inspection
+        for (PendingEvent& ev : pending) {
+            if (ev.sampleAt > idx) break;
+            if (!ev.sampled && ev.sampleAt == idx) { ev.energy = height - baseline; ev.sampled = true; }
+        }
+        while (!pending.empty() && idx >= pending.front().trigger + inspectWindow) {
+            const PendingEvent ev = pending.front();
+            pending.pop_front();
+            if (ev.pileUp && config.rejectPileUp) { stats.pileUpRejected++; continue; }
+            stats.accepted++;
+            out.push_back({ ev.trigger, static_cast<uint64_t>(ev.trigger * nsPerSample), ev.energy * config.energyGain, ev.pileUp });
+        }
+    }
+
+    // Keep the tail as history for the next block
+    std::copy(widened.end() - history, widened.end(), widened.begin());
+    widened.resize(history);
+    sampleIndex += n;
+    stats.samples += n;
+    return out.size() - before;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+#include "componentCore.hpp"
+
+// Digital pulse processing for waveform-capable detectors (cheap digitizers instead of a hardware MCA).
+// Raw ADC blocks go through pole-zero corrected trapezoidal shaping, baseline restoration,
+// pile-up inspection and peak-height extraction. The output is a list of energies with timestamps,
+// ready to be fed into an MCAHistogram.
+//
+// The shaper front end (widening + 4-tap differencing) runs in SIMD kernels, the two running sums
+// and the trigger logic run in one fused scalar pass. Filter state is carried across blocks,
+// so blocks can be any size and pulses may straddle block boundaries.
+//
+// Usage: class MyDigitizer : public BaseDevice<UsbConnection, PulseProcessor, MCAHistogram> { ... };
+COMPONENT class PulseProcessor : public BaseComponent {
+public:
+    template<typename DeviceType> PulseProcessor(DeviceType& parentDevice) : BaseComponent(&parentDevice) { configure(Config{}); }
+
+    struct Config {
+        double sampleRateHz = 50e6;     // Digitizer sample rate, used for timestamps
+        int riseSamples = 100;          // Slow (energy) filter rise time
+        int flatTopSamples = 25;        // Slow filter flat top, must be >= fastRiseSamples
+        int fastRiseSamples = 10;       // Fast (trigger) filter rise time, triangular shape
+        double decaySamples = 2500.0;   // Preamp decay constant for pole-zero correction, 0 = step pulses (reset preamp)
+        double threshold = 50.0;        // Trigger threshold on the fast filter, ADC units
+        int pileUpWindow = 0;           // Minimum trigger spacing, 0 = full slow filter length
+        int baselineSamples = 1024;     // Baseline restoration averaging length
+        double energyGain = 1.0;        // Energy per ADC unit of pulse height
+        bool invertPolarity = false;    // Negative-going pulses
+        bool rejectPileUp = true;       // Drop piled-up events instead of flagging them
+    };
+
+    struct PulseEvent {
+        uint64_t sampleIndex = 0;       // Trigger position since reset()
+        uint64_t timestampNs = 0;       // Trigger time since reset()
+        double energy = 0.0;            // Baseline-restored pulse height * energyGain
+        bool pileUp = false;            // Only set when rejectPileUp is false
+    };
+
+    struct Stats {
+        uint64_t samples = 0;
+        uint64_t triggers = 0;
+        uint64_t accepted = 0;
+        uint64_t pileUpRejected = 0;
+    };
+
+    // Applies a new configuration and resets the filter state.
+    bool configure(const Config& newConfig);
+
+    // Clears filter state, pending events and statistics. Timestamps restart at zero.
+    void reset();
+
+    // Processes one block of raw samples and appends the finished events to out.
+    // Returns the number of events appended.
+    size_t processBlock(std::span<const int16_t> samples, std::vector<PulseEvent>& out);
+
+    const Config& getConfig() const { return config; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    static constexpr bool debug = false; //Debug flag
+
+    struct PendingEvent {
+        uint64_t trigger;
+        uint64_t sampleAt;
+        double energy;
+        bool sampled;
+        bool pileUp;
+    };
+
+    // Running state of one trapezoidal filter (history lives in the shared widened buffer)
+    struct Shaper {
+        int k = 0, l = 0;
+        double invK = 1.0;
+        int32_t prevD = 0;
+        double f = 0.0, t = 0.0;
+        std::vector<int32_t> d;
+    };
+
+    Config config;
+    Stats stats;
+    Shaper slow, fast;
+    double poleZero = 1.0;          // exp(-1/decaySamples), 1 for step pulses
+    double baselineAlpha = 0.0;
+    double baseline = 0.0, fastBaseline = 0.0;
+    int sampleOffset = 0;           // Trigger to flat-top sampling point
+    int inspectWindow = 0;          // Pile-up inspection window
+    int history = 0;                // Samples of history kept in front of each block
+    uint64_t sampleIndex = 0;
+    uint64_t lastTrigger = 0;
+    bool anyTrigger = false;
+    bool armed = true;
+    bool primed = false;            // History seeded with the first sample
+    std::vector<int32_t> widened;
+    std::deque<PendingEvent> pending;
+};
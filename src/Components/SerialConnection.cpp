@@ -0,0 +1,34 @@
+#include "SerialConnection.hpp"
+#include "Debug.hpp"
+
+bool SerialConnection::open(const std::string& portPath, const Config& newConfig) {
+    if (isOpen()) close();
+    if (portPath.empty()) { Debug.Error("SerialConnection: no port to open."); return false; }
+    path = portPath;
+    config = newConfig;
+    port = handler.openPort(path, config);
+    if (!port) return false;
+    DEBUG_LOG(LogCategory::Serial, "Opened ", path, " at ", config.baudRate, " baud.");
+    return true;
+}
+
+void SerialConnection::close() {
+    if (!isOpen()) return;
+    handler.closePort(port);
+    DEBUG_LOG(LogCategory::Serial, "Closed ", path, ".");
+}
+
+bool SerialConnection::write(std::span<const uint8_t> data) {
+    if (!isOpen() || hasFailed()) { Debug.Error("Serial write: ", path.empty() ? "port" : path, " is not open."); return false; }
+    return EventLoop::Instance().write(*port, data);
+}
+
+void SerialConnection::discardInput() {
+    if (!isOpen()) return;
+    handler.discardDriverInput(*port);
+    port->rx.consume(port->rx.size());
+}
+
+bool SerialConnection::waitForData(size_t minBytes, int timeoutMs) {
+    return isOpen() && EventLoop::Instance().waitForData(*port, minBytes, timeoutMs);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include "componentCore.hpp"
+#include "SerialHandler.hpp"
+#include "SerialParsers.hpp"
+
+// RS-232 or USB-CDC instrument on a tty (survey meters, HV supplies, older MCAs). The port is opened raw and
+// non-blocking; the shared EventLoop thread does all reading and writing for every open port, so any number of
+// serial instruments costs one thread.
+//
+// Received bytes go straight from the kernel into a receive ring, parse() runs a SerialParse parser over them
+// in place. write() returns right away: what the driver does not take at once is queued and sent by the event
+// loop as the port drains.
+//
+// Usage: class MySurveyMeter : public BaseDevice<SerialConnection> { ... };
+//   SerialConnection& port = getComponentRef<SerialConnection>();
+//   port.open({ .baudRate = 115200 });               // The scanned port, or port.open("/dev/ttyUSB0", config)
+//   port.write("MEAS:DOSE?\n");
+//   port.parse(lines, [&](std::string_view line) { dose = std::stod(std::string(line)); });
+COMPONENT class SerialConnection : public BaseComponent {
+public:
+    template<typename DeviceType> SerialConnection(DeviceType& parentDevice) : BaseComponent(&parentDevice) {}
+    SerialConnection(SerialConnection&&) = default; // Moved into the device's component tuple, before it is opened
+    ~SerialConnection() override { close(); }
+
+    using Parity = SerialHandler::Parity;
+    using FlowControl = SerialHandler::FlowControl;
+    using Config = SerialHandler::PortConfig;
+
+    // Port found by the last scan, set by the DeviceHandler
+    SerialHandler::ScannedDeviceInfo deviceInfo;
+
+    bool open() { return open(deviceInfo.path, Config{}); }
+    bool open(const Config& config) { return open(deviceInfo.path, config); }
+    bool open(const std::string& path, const Config& config);
+    void close();
+    bool isOpen() const { return port != nullptr; }
+    // The port hung up (unplugged) or reported an error. It stays open until close(), but nothing gets through.
+    bool hasFailed() const { return port && port->hasFailed(); }
+    const std::string& getPath() const { return path; }
+    const Config& getConfig() const { return config; }
+
+    // Queues data for sending. Returns false if the port is not usable or the transmit buffer can not take all of it,
+    // in which case nothing is queued.
+    bool write(std::span<const uint8_t> data);
+    bool write(std::string_view text) { return write(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(text.data()), text.size())); }
+
+    // Runs parser over the received bytes, handing every complete message to onMessage, and frees what it used.
+    // Call from one thread only (usually the device's task).
+    template<typename Parser, typename F> size_t parse(Parser& parser, F&& onMessage) {
+        if (!port) return 0;
+        const size_t used = parser.parse(port->rx.readable(), onMessage);
+        port->rx.consume(used);
+        return used;
+    }
+
+    // Received bytes in place, for protocols without a parser. Free them with consume().
+    SerialParse::Bytes received() const { return port ? port->rx.readable() : SerialParse::Bytes{}; }
+    void consume(size_t count) { if (port) port->rx.consume(count); }
+    size_t available() const { return port ? port->rx.size() : 0; }
+    // Drops everything received so far, including what the driver still holds.
+    void discardInput();
+
+    // Waits until at least minBytes are received, for request/response instruments. False on timeout or failure.
+    bool waitForData(size_t minBytes, int timeoutMs);
+
+    // Received bytes dropped because the receive buffer was full
+    uint64_t overrunBytes() const { return port ? port->overruns.load(std::memory_order_relaxed) : 0; }
+
+private:
+    static constexpr bool debug = false; //Debug flag
+    SerialHandler& handler = SerialHandler::Instance();
+    std::string path;
+    Config config;
+    std::unique_ptr<EventLoop::Stream> port; // On the heap, the event loop holds on to it while open
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "Utils/RingBuffer.hpp"
+
+// Message parsers for SerialConnection::parse(). They run on the connection's receive ring in place: a message
+// that lies in one piece is handed to the callback as a view into the ring, only one that wraps around the end
+// of the ring is put together in the parser's scratch buffer first. Views are valid during the callback only.
+// parse() returns the bytes used up (messages and discarded garbage); an incomplete message stays in the ring.
+namespace SerialParse {
+
+    using Bytes = SpscByteRing::Spans<const uint8_t>;
+
+    // Two ring pieces read as one stream
+    class Stream {
+    public:
+        explicit Stream(Bytes data) : data(data) {}
+        size_t size() const { return data.size(); }
+        uint8_t operator[](size_t i) const { return i < data.first.size() ? data.first[i] : data.second[i - data.first.size()]; }
+
+        // Position of the first byte equal to value from position from on, size() if there is none
+        size_t find(uint8_t value, size_t from) const {
+            const size_t split = data.first.size();
+            if (from < split) {
+                if (const void* hit = std::memchr(data.first.data() + from, value, split - from))
+                    return static_cast<const uint8_t*>(hit) - data.first.data();
+                from = split;
+            }
+            if (from >= size()) return size();
+            const void* hit = std::memchr(data.second.data() + (from - split), value, size() - from);
+            return hit ? split + (static_cast<const uint8_t*>(hit) - data.second.data()) : size();
+        }
+
+        // count bytes from position from, in place when they do not wrap, otherwise copied into scratch
+        std::span<const uint8_t> view(size_t from, size_t count, std::vector<uint8_t>& scratch) const {
+            const size_t split = data.first.size();
+            if (from + count <= split) return data.first.subspan(from, count);
+            if (from >= split) return data.second.subspan(from - split, count);
+            scratch.resize(count);
+            std::memcpy(scratch.data(), data.first.data() + from, split - from);
+            std::memcpy(scratch.data() + (split - from), data.second.data(), count - (split - from));
+            return scratch;
+        }
+
+    private:
+        Bytes data;
+    };
+
+    // Text lines, as from SCPI instruments and most survey meters
+    class LineParser {
+    public:
+        struct Config {
+            char delimiter = '\n';
+            bool stripCarriageReturn = true; // "\r\n" endings
+            bool skipEmpty = true;
+            size_t maxLength = 4096;         // Longer lines are dropped up to their delimiter
+        };
+
+        LineParser() = default;
+        explicit LineParser(const Config& config) : config(config) {}
+
+        // Calls onLine(std::string_view) for every complete line, without the delimiter.
+        template<typename F> size_t parse(Bytes data, F&& onLine) {
+            const Stream in(data);
+            size_t used = 0;
+            for (;;) {
+                const size_t end = in.find(static_cast<uint8_t>(config.delimiter), used);
+                if (end == in.size()) {
+                    // No delimiter yet: keep waiting unless the line can not fit anymore
+                    if (in.size() - used < config.maxLength) return used;
+                    if (!discarding) dropped++;
+                    discarding = true;
+                    return in.size();
+                }
+                if (discarding) { discarding = false; used = end + 1; continue; }
+
+                size_t length = end - used;
+                if (config.stripCarriageReturn && length > 0 && in[end - 1] == '\r') length--;
+                if (length > config.maxLength) dropped++;
+                else if (length > 0 || !config.skipEmpty) {
+                    const std::span<const uint8_t> line = in.view(used, length, scratch);
+                    onLine(std::string_view(reinterpret_cast<const char*>(line.data()), line.size()));
+                }
+                used = end + 1;
+            }
+        }
+
+        // Lines dropped for being longer than maxLength
+        uint64_t droppedLines() const { return dropped; }
+        void reset() { discarding = false; }
+
+    private:
+        Config config;
+        std::vector<uint8_t> scratch;
+        bool discarding = false;
+        uint64_t dropped = 0;
+    };
+
+    // Binary frames made of a sync pattern, a header with a length field, the payload and a trailer.
+    // For an Amptek DP5 packet (F5 FA, PID1, PID2, 16-bit big endian length, data, 16-bit checksum):
+    //   { .sync = {0xF5, 0xFA}, .lengthOffset = 4, .lengthSize = 2, .headerSize = 6, .trailerSize = 2 }
+    // Bytes before a sync pattern are skipped. Checksums are left to the device, it gets the whole frame.
+    class FrameParser {
+    public:
+        struct Config {
+            std::vector<uint8_t> sync;       // Start of every frame, empty if frames follow each other without one
+            size_t lengthOffset = 0;         // Of the length field, from the start of the frame
+            size_t lengthSize = 1;           // 1, 2 or 4 bytes
+            bool bigEndian = true;
+            size_t headerSize = 1;           // Bytes before the payload, including sync and length field
+            size_t trailerSize = 0;          // Bytes after the payload
+            size_t maxFrameSize = 65536;     // Larger lengths are treated as a false sync
+        };
+
+        explicit FrameParser(const Config& config) : config(config) {}
+
+        // Calls onFrame(std::span<const uint8_t>) for every complete frame, header and trailer included.
+        template<typename F> size_t parse(Bytes data, F&& onFrame) {
+            const Stream in(data);
+            size_t used = 0;
+            for (;;) {
+                const size_t start = findSync(in, used);
+                skipped += start - used;
+                used = start;
+                if (in.size() - used < config.headerSize) return used;
+
+                uint64_t length = 0;
+                for (size_t i = 0; i < config.lengthSize; ++i) {
+                    const uint8_t byte = in[used + config.lengthOffset + i];
+                    length |= static_cast<uint64_t>(byte) << (8 * (config.bigEndian ? config.lengthSize - 1 - i : i));
+                }
+                const uint64_t frameSize = config.headerSize + length + config.trailerSize;
+                if (frameSize > config.maxFrameSize) {
+                    // Not a frame after all, look for the next sync pattern
+                    badFrames++;
+                    skipped++;
+                    used++;
+                    continue;
+                }
+                if (in.size() - used < frameSize) return used;
+                onFrame(in.view(used, static_cast<size_t>(frameSize), scratch));
+                used += static_cast<size_t>(frameSize);
+                frames++;
+            }
+        }
+
+        uint64_t frameCount() const { return frames; }
+        uint64_t skippedBytes() const { return skipped; }
+        uint64_t badFrameCount() const { return badFrames; }
+
+    private:
+        // Start of the first (possibly partial) sync pattern from position from on. A partial one at the end
+        // of the data is kept for the next call.
+        size_t findSync(const Stream& in, size_t from) const {
+            if (config.sync.empty()) return from;
+            for (size_t at = in.find(config.sync[0], from); at < in.size(); at = in.find(config.sync[0], at + 1)) {
+                size_t i = 1;
+                while (i < config.sync.size() && at + i < in.size() && in[at + i] == config.sync[i]) ++i;
+                if (i == config.sync.size() || at + i == in.size()) return at;
+            }
+            return in.size();
+        }
+
+        Config config;
+        std::vector<uint8_t> scratch;
+        uint64_t frames = 0;
+        uint64_t skipped = 0;
+        uint64_t badFrames = 0;
+    };
+}
@@ -0,0 +1,94 @@
+#include "SpiBus.hpp"
+#include "Debug.hpp"
+
+namespace {
+    // Shift command flags
+    constexpr uint8_t WriteOnFalling = 0x01;
+    constexpr uint8_t BitMode = 0x02;
+    constexpr uint8_t ReadOnFalling = 0x04;
+    constexpr uint8_t WriteData = 0x10;
+    constexpr uint8_t ReadData = 0x20;
+
+    // ADBUS pins the MPSSE uses for serial data
+    constexpr uint8_t ClockPin = 0x01;
+    constexpr uint8_t DataOutPin = 0x02;
+}
+
+int SpiBus::addDevice(const DeviceConfig& config) {
+    devices.push_back(config);
+    const Port port = config.select.port;
+    queue.declare(port, selectLevels(config, queue.levels(port), false), queue.outputs(port) | config.select.mask);
+    return static_cast<int>(devices.size()) - 1;
+}
+
+void SpiBus::begin(int device) {
+    if (device < 0 || device >= static_cast<int>(devices.size())) { Debug.Error("SpiBus begin: unknown device ", device); return; }
+    if (active >= 0) end();
+    active = device;
+    const DeviceConfig& config = devices[device];
+    const bool idleHigh = (config.mode & 0x02) != 0;
+    const bool highAtSelect = idleHigh && !config.clockLowAtSelect;
+
+    queue.setDivisor(config.clockDivisor);
+
+    // Clock to its select level and data out low, with the chip select in the same write when it shares the port
+    uint8_t low = (queue.levels(Port::Low) & ~(ClockPin | DataOutPin)) | (highAtSelect ? ClockPin : 0);
+    const uint8_t lowOutputs = queue.outputs(Port::Low) | ClockPin | DataOutPin;
+    if (config.select.port == Port::Low) low = selectLevels(config, low, true);
+    queue.setPort(Port::Low, low, lowOutputs);
+    if (config.select.port == Port::High) queue.setPort(Port::High, selectLevels(config, queue.levels(Port::High), true), queue.outputs(Port::High));
+    if (highAtSelect != idleHigh) queue.setPort(Port::Low, queue.levels(Port::Low) | ClockPin, queue.outputs(Port::Low));
+}
+
+void SpiBus::end() {
+    if (active < 0) return;
+    const DeviceConfig& config = devices[active];
+    const Port port = config.select.port;
+    queue.setPort(port, selectLevels(config, queue.levels(port), false), queue.outputs(port));
+    active = -1;
+}
+
+void SpiBus::write(std::span<const uint8_t> data) {
+    if (inTransaction("write")) queue.shiftBytes(shiftOpcode(true, false, false), data);
+}
+
+void SpiBus::writeBits(uint8_t bits, int count) {
+    if (inTransaction("writeBits")) queue.shiftBits(shiftOpcode(true, false, true), bits, count);
+}
+
+size_t SpiBus::read(size_t bytes) {
+    if (!inTransaction("read")) return queue.queuedReplyBytes();
+    return queue.readBytes(shiftOpcode(false, true, false), bytes);
+}
+
+size_t SpiBus::transfer(std::span<const uint8_t> data) {
+    if (!inTransaction("transfer")) return queue.queuedReplyBytes();
+    return queue.shiftBytes(shiftOpcode(true, true, false), data);
+}
+
+bool SpiBus::execute(int timeoutMs) {
+    end();
+    return queue.execute(timeoutMs);
+}
+
+// Modes 0 and 3 change data on the falling edge and sample on the rising edge, modes 1 and 2 the other way round
+uint8_t SpiBus::shiftOpcode(bool out, bool in, bool bits) const {
+    const DeviceConfig& config = devices[active];
+    const bool sampleOnRising = ((config.mode >> 1) & 1) == (config.mode & 1);
+    const Edge writeEdge = config.writeEdge.value_or(sampleOnRising ? Edge::Falling : Edge::Rising);
+    const Edge readEdge = config.readEdge.value_or(sampleOnRising ? Edge::Rising : Edge::Falling);
+    uint8_t opcode = bits ? BitMode : 0;
+    if (out) opcode |= WriteData | (writeEdge == Edge::Falling ? WriteOnFalling : 0);
+    if (in) opcode |= ReadData | (readEdge == Edge::Falling ? ReadOnFalling : 0);
+    return opcode;
+}
+
+uint8_t SpiBus::selectLevels(const DeviceConfig& config, uint8_t levels, bool selected) {
+    return selected == config.selectActiveHigh ? levels | config.select.mask : levels & ~config.select.mask;
+}
+
+bool SpiBus::inTransaction(const char* what) const {
+    if (active >= 0) return true;
+    Debug.Error("SpiBus ", what, ": no device selected, call begin() first.");
+    return false;
+}
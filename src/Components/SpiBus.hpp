@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "componentCore.hpp"
+#include "FTDIConnection.hpp"
+#include "MpsseQueue.hpp"
+
+// SPI over the MPSSE port of the device's FTDIConnection, for devices with one or more SPI peripherals.
+//
+// The bus owns the GPIO state of both MPSSE ports (ADBUS low byte, ACBUS high byte). Devices declare
+// their peripherals once (chip select line and polarity, SPI mode, clock divisor) and queue transactions;
+// everything queued until execute() goes out as one write, with one read for all replies. The command
+// stream only carries what changes the bus: GPIO writes that repeat the current pin state and divisor
+// writes that repeat the current divisor are dropped, across batches too (see MpsseQueue).
+// ADBUS0 is the clock, ADBUS1 data out and ADBUS2 data in, as the MPSSE fixes them. Data out is driven
+// low whenever a peripheral is selected.
+//
+// Usage: class MyDevice : public BaseDevice<FTDIConnection, SpiBus> { ... };
+//   SpiBus& bus = getComponentRef<SpiBus>();
+//   int adc = bus.addDevice({ .select = { SpiBus::Port::Low, 0x08 }, .mode = 0 });
+//   bus.begin(adc); bus.writeBits(0xD0, 4); size_t at = bus.read(2); bus.end();
+//   if (bus.execute()) use(bus.reply().subspan(at, 2));
+COMPONENT class SpiBus : public BaseComponent {
+public:
+    template<typename DeviceType> SpiBus(DeviceType& parentDevice) : BaseComponent(&parentDevice), queue(&parentDevice.template getComponentRef<FTDIConnection>()) {}
+
+    using Port = MpsseQueue::Port;
+    using Pin = MpsseQueue::Pin;
+    using Stats = MpsseQueue::Stats;
+    enum class Edge : uint8_t { Rising, Falling };
+
+    struct DeviceConfig {
+        Pin select;                      // Chip select line
+        bool selectActiveHigh = false;
+        uint8_t mode = 0;                // SPI mode 0-3, bit 1 CPOL (clock idle level), bit 0 CPHA
+        uint16_t clockDivisor = 3;       // TCK = 6 MHz / (1 + divisor) with the chip's default divide-by-5
+        bool clockLowAtSelect = false;   // Select with the clock low, then move it to its idle level (parts that latch CPOL at select)
+        std::optional<Edge> writeEdge = std::nullopt; // Overrides of the mode's data edges, for parts that follow no standard mode
+        std::optional<Edge> readEdge = std::nullopt;
+    };
+
+    // Declares a peripheral. Its chip select becomes an output at the inactive level, driven with the next
+    // write of its port. Returns the id for begin().
+    int addDevice(const DeviceConfig& config);
+
+    // Pin state, queued like transactions. Writes that change nothing are dropped.
+    void setPort(Port port, uint8_t levels, uint8_t outputs) { queue.setPort(port, levels, outputs); }
+    void setPin(Pin pin, bool high) { queue.setPin(pin, high); }
+    uint8_t pinLevels(Port port) const { return queue.levels(port); } // With the queue applied
+
+    // Transactions: begin() selects a peripheral, end() deselects it, the shifts in between are MSB first.
+    void begin(int device);
+    void write(std::span<const uint8_t> data);
+    void writeBits(uint8_t bits, int count);          // The top count bits of bits, 1 to 8
+    size_t read(size_t bytes);                        // Returns the offset of the bytes in reply()
+    size_t transfer(std::span<const uint8_t> data);   // Full duplex, returns the offset in reply()
+    void end();
+
+    // Sends the queue as one write, closed with SEND_IMMEDIATE and followed by one read when replies are due.
+    // Keep a batch's replies within the chip's receive buffer. On failure the pin state is forgotten.
+    bool execute(int timeoutMs = 100);
+
+    // Drops the queue, the pin state goes back to what the device last received.
+    void discard() { active = -1; queue.discard(); }
+
+    // Drops the queue and forgets the device's pin and divisor state, the next writes go out unconditionally.
+    // Call after the device was (re)opened.
+    void invalidate() { active = -1; queue.invalidate(); }
+
+    std::span<const uint8_t> reply() const { return queue.reply(); }
+    std::span<const uint8_t> queued() const { return queue.queued(); } // Command stream so far, without the closing SEND_IMMEDIATE
+    size_t queuedReplyBytes() const { return queue.queuedReplyBytes(); }
+    const Stats& getStats() const { return queue.getStats(); }
+
+private:
+    static constexpr bool debug = false; //Debug flag
+
+    uint8_t shiftOpcode(bool out, bool in, bool bits) const;
+    static uint8_t selectLevels(const DeviceConfig& config, uint8_t levels, bool selected);
+    bool inTransaction(const char* what) const;
+
+    MpsseQueue queue;
+    std::vector<DeviceConfig> devices;
+    int active = -1;
+};
@@ -0,0 +1,193 @@
+#include "TcpInstrumentConnection.hpp"
+#include "Debug.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <cstring>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+#ifndef _WIN32
+    // Non-blocking connect to the first address of host that answers within timeoutMs. Returns the socket, -1 on failure.
+    int connectSocket(const std::string& host, uint16_t port, int timeoutMs) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        const int r = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found);
+        if (r != 0) { Debug.Error("Can not resolve ", host, ": ", gai_strerror(r)); return -1; }
+
+        int fd = -1;
+        std::string error = "no address";
+        for (addrinfo* a = found; a && fd < 0; a = a->ai_next) {
+            fd = ::socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+            if (fd < 0) { error = std::strerror(errno); continue; }
+            if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+            if (errno == EINPROGRESS) {
+                pollfd p{ fd, POLLOUT, 0 };
+                int soError = 0;
+                socklen_t length = sizeof(soError);
+                if (::poll(&p, 1, timeoutMs) != 1) error = "timed out";
+                else if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &soError, &length) != 0) error = std::strerror(errno);
+                else if (soError != 0) error = std::strerror(soError);
+                else break;
+            }
+            else error = std::strerror(errno);
+            ::close(fd);
+            fd = -1;
+        }
+        freeaddrinfo(found);
+        if (fd < 0) { Debug.Error("Could not connect to ", host, ":", port, ": ", error); return -1; }
+
+        // Commands are batched here already, Nagle's algorithm would only hold the batches back
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+        return fd;
+    }
+#else
+    int connectSocket(const std::string& host, uint16_t port, int) {
+        Debug.Error("Network instruments are not supported on this platform yet, can not connect to ", host, ":", port);
+        return -1;
+    }
+#endif
+}
+
+bool TcpInstrumentConnection::open(const std::string& host, uint16_t port, const Config& newConfig) {
+    if (isOpen()) close();
+    config = newConfig;
+    endpoint = host + ":" + std::to_string(port);
+    RC_TRACE_SCOPE_DETAIL("net", "connect", endpoint);
+    const int fd = connectSocket(host, port, config.connectTimeoutMs);
+    if (fd < 0) return false;
+
+    Metrics::Registry& reg = Metrics::Registry::Instance();
+    const Metrics::Labels labels = { {"endpoint", endpoint} };
+    const EventLoop::StreamMetrics metrics{
+        reg.counter("radcat_tcp_rx_bytes_total", "Bytes received from a network instrument", labels),
+        reg.counter("radcat_tcp_tx_bytes_total", "Bytes sent to a network instrument", labels),
+        reg.counter("radcat_tcp_overrun_bytes_total", "Received bytes dropped because the receive buffer was full", labels) };
+    roundTrip = &reg.histogram("radcat_tcp_reply_seconds", "Time from sending a query to its reply", labels);
+    stream = std::make_unique<EventLoop::Stream>(endpoint, fd, true, config.receiveBufferSize, config.transmitBufferSize, metrics);
+    if (!EventLoop::Instance().attach(*stream)) {
+        EventLoop::Instance().detach(*stream); // Closes the socket
+        stream.reset();
+        return false;
+    }
+
+    // An empty reply is still a reply, skipping it would put every later one on the wrong query
+    lines = SerialParse::LineParser({ .delimiter = config.terminator, .skipEmpty = false, .maxLength = config.receiveBufferSize });
+    pending.clear();
+    replies.clear();
+    sentAt.clear();
+    nextTicket = 1;
+    sentTickets = matchedTickets = 0;
+    stats = {};
+    DEBUG_LOG(LogCategory::Network, "Connected to ", endpoint, ".");
+    return true;
+}
+
+void TcpInstrumentConnection::close() {
+    if (!isOpen()) return;
+    EventLoop::Instance().detach(*stream);
+    stream.reset();
+    pending.clear();
+    replies.clear();
+    sentAt.clear();
+    DEBUG_LOG(LogCategory::Network, "Disconnected from ", endpoint, ".");
+}
+
+bool TcpInstrumentConnection::queue(std::string_view text) {
+    if (!isOpen() || hasFailed()) { Debug.Error("TCP instrument ", endpoint.empty() ? "connection" : endpoint, " is not connected."); return false; }
+    pending.append(text);
+    pending.push_back(config.terminator);
+    return true;
+}
+
+bool TcpInstrumentConnection::command(std::string_view text) {
+    if (!queue(text)) return false;
+    stats.commands++;
+    return true;
+}
+
+uint64_t TcpInstrumentConnection::query(std::string_view text) {
+    if (!queue(text)) return 0;
+    stats.queries++;
+    return nextTicket++;
+}
+
+bool TcpInstrumentConnection::flush() {
+    if (!isOpen() || hasFailed()) return false;
+    if (pending.empty()) return true;
+    RC_TRACE_SCOPE_DETAIL("net", "flush", endpoint);
+    // Stays queued if the transmit buffer is full, the next flush tries again
+    if (!EventLoop::Instance().write(*stream, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(pending.data()), pending.size()))) return false;
+    pending.clear();
+    stats.flushes++;
+    const Clock::time_point now = Clock::now();
+    for (uint64_t t = sentTickets + 1; t < nextTicket; ++t) sentAt.push_back(now);
+    sentTickets = nextTicket - 1;
+    stats.maxInFlight = std::max(stats.maxInFlight, inFlight());
+    return true;
+}
+
+// Hands every complete line to the oldest query still waiting for its reply
+void TcpInstrumentConnection::collectReplies() {
+    const uint64_t droppedBefore = lines.droppedLines();
+    const size_t used = lines.parse(stream->rx.readable(), [&](std::string_view line) {
+        if (matchedTickets == sentTickets) {
+            stats.unexpectedReplies++;
+            DEBUG_WARN(LogCategory::Network, "Unexpected reply from ", endpoint, ": ", line);
+            return;
+        }
+        ++matchedTickets;
+        replies.emplace(matchedTickets, std::string(line));
+        roundTrip->recordSince(sentAt.front());
+        sentAt.pop_front();
+        stats.replies++;
+    });
+    stream->rx.consume(used);
+    // A lost reply would hand every later query the answer of the one before
+    if (lines.droppedLines() != droppedBefore) EventLoop::Instance().fail(*stream, "reply longer than maxLength dropped, later replies would not match their queries");
+    else if (stream->overruns.load(std::memory_order_relaxed) != 0) EventLoop::Instance().fail(*stream, "receive buffer overrun, later replies would not match their queries");
+}
+
+std::optional<std::string> TcpInstrumentConnection::reply(uint64_t ticket) {
+    if (!isOpen() || ticket == 0 || ticket >= nextTicket) return std::nullopt;
+    if (ticket > sentTickets && !flush()) return std::nullopt;
+    collectReplies();
+    if (ticket > matchedTickets) {
+        RC_TRACE_SCOPE_DETAIL("net", "reply", endpoint);
+        const Clock::time_point deadline = sentAt[ticket - matchedTickets - 1] + std::chrono::milliseconds(config.replyTimeoutMs);
+        while (ticket > matchedTickets) {
+            if (hasFailed()) return std::nullopt;
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+            if (left.count() <= 0) {
+                EventLoop::Instance().fail(*stream, "reply timed out, later replies would not match their queries");
+                return std::nullopt;
+            }
+            EventLoop::Instance().waitForData(*stream, stream->rx.size() + 1, static_cast<int>(left.count()));
+            collectReplies();
+        }
+    }
+    auto it = replies.find(ticket);
+    if (it == replies.end()) return std::nullopt; // Taken already
+    std::string text = std::move(it->second);
+    replies.erase(it);
+    return text;
+}
+
+std::optional<std::string> TcpInstrumentConnection::ask(std::string_view text) {
+    const uint64_t ticket = query(text);
+    if (ticket == 0) return std::nullopt;
+    return reply(ticket);
+}
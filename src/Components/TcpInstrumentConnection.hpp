@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "componentCore.hpp"
+#include "EventLoop.hpp"
+#include "SerialParsers.hpp"
+
+// Network instrument with a line based command protocol, e.g. SCPI over raw TCP on port 5025 (HV supplies,
+// digitizers, multimeters). The socket is non-blocking and served by the shared EventLoop thread.
+//
+// Commands and queries are pipelined: they are collected until flush() and go out in one write, and the replies
+// come back in the order the queries were sent, so a poll of several parameters costs one network round trip
+// instead of one per parameter. Every query gets a ticket, reply(ticket) returns its answer.
+//
+// A reply that does not arrive in time, is too long for the line parser or is lost to a receive buffer overrun
+// leaves the connection out of step (a late answer would be taken for the next query's), so the connection is
+// marked failed then. close() and open() it again to recover.
+//
+// Usage: class MyHvSupply : public BaseDevice<TcpInstrumentConnection> { ... };
+//   TcpInstrumentConnection& lan = getComponentRef<TcpInstrumentConnection>();
+//   lan.open("192.168.1.50");                        // Port 5025
+//   auto v = lan.query("MEAS:VOLT?");
+//   auto i = lan.query("MEAS:CURR?");
+//   lan.command("SOUR:VOLT 1500");
+//   lan.flush();                                     // All three in one write
+//   if (auto volts = lan.reply(v)) ...
+COMPONENT class TcpInstrumentConnection : public BaseComponent {
+public:
+    template<typename DeviceType> TcpInstrumentConnection(DeviceType& parentDevice) : BaseComponent(&parentDevice) {}
+    TcpInstrumentConnection(TcpInstrumentConnection&&) = default; // Moved into the device's component tuple, before it is opened
+    ~TcpInstrumentConnection() override { close(); }
+
+    static constexpr uint16_t ScpiPort = 5025;
+
+    struct Config {
+        char terminator = '\n';              // Ends every command and every reply
+        int connectTimeoutMs = 2000;
+        int replyTimeoutMs = 1000;           // From the flush that sent the query
+        size_t receiveBufferSize = 256 * 1024; // Also the longest reply (waveforms, spectra)
+        size_t transmitBufferSize = 64 * 1024;
+    };
+
+    struct Stats {
+        uint64_t commands = 0;
+        uint64_t queries = 0;
+        uint64_t flushes = 0;                // Writes, each carrying any number of commands and queries
+        uint64_t replies = 0;
+        uint64_t unexpectedReplies = 0;      // Lines received with no query waiting for them, dropped
+        size_t maxInFlight = 0;              // Most queries sent and not yet answered at once
+    };
+
+    bool open(const std::string& host, uint16_t port = ScpiPort) { return open(host, port, Config{}); }
+    bool open(const std::string& host, uint16_t port, const Config& config);
+    void close();
+    bool isOpen() const { return stream != nullptr; }
+    // Closed by the instrument, a socket error, or a reply timeout. Stays open until close().
+    bool hasFailed() const { return stream && stream->hasFailed(); }
+    const std::string& getEndpoint() const { return endpoint; }
+
+    // Queued until flush(). The terminator is appended.
+    bool command(std::string_view text);
+    // Queued until flush(), returns the ticket for reply(), 0 if the connection is not usable.
+    uint64_t query(std::string_view text);
+    // Sends everything queued in one write.
+    bool flush();
+    // The reply to a query, flushing first if it is still queued. Replies can be taken in any order, but each
+    // only once. nullopt on timeout, failure, or for a ticket that was already taken.
+    std::optional<std::string> reply(uint64_t ticket);
+    // query(), flush() and reply() in one, for a single round trip.
+    std::optional<std::string> ask(std::string_view text);
+
+    // Queries sent and not answered yet
+    size_t inFlight() const { return static_cast<size_t>(sentTickets - matchedTickets); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    static constexpr bool debug = false; //Debug flag
+    using Clock = Metrics::Clock;
+
+    bool queue(std::string_view text);
+    void collectReplies();
+
+    std::string endpoint;                    // host:port
+    Config config;
+    std::unique_ptr<EventLoop::Stream> stream; // On the heap, the event loop holds on to it while open
+    SerialParse::LineParser lines;
+    std::string pending;                     // Commands not flushed yet
+
+    uint64_t nextTicket = 1;                 // Tickets are per connection, in query order
+    uint64_t sentTickets = 0;                // Highest ticket flushed
+    uint64_t matchedTickets = 0;             // Highest ticket answered
+    std::deque<Clock::time_point> sentAt;    // Flush time of tickets matchedTickets + 1 ... sentTickets
+    std::unordered_map<uint64_t, std::string> replies; // Answered, not taken yet
+    Stats stats;
+    Metrics::Histogram* roundTrip = nullptr;
+};
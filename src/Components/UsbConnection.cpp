@@ -1,4 +1,5 @@
 #include "UsbConnection.hpp"
+#include "LibUsbHandler.hpp"
 
 void UsbConnection::initialize() {
     
@@ -6,4 +7,30 @@ void UsbConnection::initialize() {
 
 void UsbConnection::update() {
     
-}
\ No newline at end of file
+}
+
+int UsbConnection::sendData(unsigned char endpoint, const unsigned char* data, int length, unsigned int timeoutMs) {
+    if (!deviceHandle || !handler) { Debug.Error("USB sendData: device not connected"); return LIBUSB_ERROR_NO_DEVICE; }
+    return handler->writeData(deviceHandle, endpoint, data, length, timeoutMs);
+}
+
+int UsbConnection::receiveData(unsigned char endpoint, unsigned char* buffer, int length, unsigned int timeoutMs) {
+    if (!deviceHandle || !handler) { Debug.Error("USB receiveData: device not connected"); return LIBUSB_ERROR_NO_DEVICE; }
+    return handler->readData(deviceHandle, endpoint, buffer, length, timeoutMs);
+}
+
+bool UsbConnection::claimInterface(int interfaceNumber) {
+    if (!deviceHandle || !handler) return false;
+    int r = handler->getBackend().claimInterface(deviceHandle, interfaceNumber);
+    if (r < 0) { Debug.Error("Failed to claim USB interface " , interfaceNumber , ": " , r); return false; }
+    claimedInterface = interfaceNumber;
+    return true;
+}
+
+void UsbConnection::closeDevice() {
+    if (!deviceHandle || !handler) return;
+    if (claimedInterface >= 0) handler->getBackend().releaseInterface(deviceHandle, claimedInterface);
+    claimedInterface = -1;
+    handler->closeDevice(deviceHandle);
+    deviceHandle = nullptr;
+}
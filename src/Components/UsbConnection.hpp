@@ -7,24 +7,33 @@
 
 class LibUsbHandler;
 struct LibUsbDeviceInfo {
-    uint16_t vid;
-    uint16_t pid;
+    uint16_t vid = 0;
+    uint16_t pid = 0;
     std::string serial;          // empty if none
-    uint8_t busNumber;
-    std::vector<uint8_t> portPath;
-    libusb_device* device;       // stored with ref count
+    uint8_t busNumber = 0;
+    std::vector<uint8_t> portPath; // Hub ports from the root, empty if unknown
+    libusb_device* device = nullptr; // stored with ref count
 };
 
 class UsbConnection : public BaseComponent {
 public:
-    UsbConnection(EmptyDevice* parentDevice) : BaseComponent(parentDevice) {}
+    template<typename DeviceType> UsbConnection(DeviceType& parentDevice) : BaseComponent(&parentDevice) {}
     LibUsbDeviceInfo deviceInfo;
     ~UsbConnection() override = default;
     void initialize() override;
     void update() override;
 
-    LibUsbHandler* handler;
+    //Interface Methods, bulk transfers on the given endpoint number.
+    //Return the bytes transferred or a negative LIBUSB_ERROR code.
+    int sendData(unsigned char endpoint, const unsigned char* data, int length, unsigned int timeoutMs);
+    int receiveData(unsigned char endpoint, unsigned char* buffer, int length, unsigned int timeoutMs);
+    bool claimInterface(int interfaceNumber);
+    void closeDevice();
+    bool isDeviceOpen() const { return deviceHandle != nullptr; }
+
+    LibUsbHandler* handler = nullptr;
 private:
 friend class LibUsbHandler;
 libusb_device_handle* deviceHandle = nullptr;
+int claimedInterface = -1;
 };
@@ -2,3 +2,9 @@
 
 #include "FTDIConnection.hpp"
 #include "UsbConnection.hpp"
+#include "SerialConnection.hpp"
+#include "TcpInstrumentConnection.hpp"
+#include "MCAHistogram.hpp"
+#include "PulseProcessor.hpp"
+#include "SpiBus.hpp"
+#include "I2cBus.hpp"
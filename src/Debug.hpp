@@ -1,12 +1,18 @@
 #pragma once
 #include <string>
-#include <iostream>
-#include <chrono>
-#include <iomanip>
-#include <sstream>
-#include <type_traits>
-#include <concepts>
+#include "Diagnostics/AsyncLogger.hpp"
+#include "Diagnostics/LogControl.hpp"
 
+// Compile-time cap on logging. Release builds can pass -DRADCAT_DEBUG_LEVEL=1 (or 0) to compile
+// everything above that level out completely, including the runtime category checks.
+#ifndef RADCAT_DEBUG_LEVEL
+#define RADCAT_DEBUG_LEVEL 3
+#endif
+
+// Debug.Log/Warn/Error front end. Messages go through the AsyncLogger: the caller only copies
+// its arguments into a per-thread ring, formatting and console/file output happen on the logger thread.
+// Pass values as separate arguments (Debug.Log("Opened ", index)) instead of building strings,
+// so nothing is formatted on the calling thread.
 struct DebugClass {
 
     static DebugClass& getInstance() {
@@ -14,89 +20,48 @@ struct DebugClass {
         return instance;
     }
 
-    // Stringify any type
-    template<typename T>
-    std::string stringify(const T& v) {
-        if constexpr (requires { std::ostringstream{} << v; }) {
-            std::ostringstream oss;
-            oss << v;
-            return oss.str();
-        } else if constexpr (requires { std::to_string(v); }) {
-            return std::to_string(v);
-        } else {
-            return "[unprintable type]";
-        }
-    }
-
-    constexpr static int debugLevel = 3; // 0=none, 1=errors, 2=warnings, 3=info
-
-    // ANSI color codes
-    enum class Color { DEFAULT, RED, YELLOW, GREEN, CYAN, WHITE };
-
-    inline static std::string colorCode(Color c) {
-        switch (c) {
-            case Color::RED:    return "\033[31m"; // Error
-            case Color::YELLOW: return "\033[33m"; // Warning
-            case Color::GREEN:  return "\033[32m"; // Timestamp
-            case Color::CYAN:   return "\033[36m"; // For later use
-            case Color::WHITE:  return "\033[37m"; // Log
-            default:            return "\033[0m";
-        }
-    }
-
-    // Get current time as HH:MM:SS
-    inline static std::string currentTime() {
-        auto now = std::chrono::system_clock::now();
-        auto time_since_epoch = now.time_since_epoch();
-        auto hours = std::chrono::duration_cast<std::chrono::hours>(time_since_epoch) % 24;
-        auto minutes = std::chrono::duration_cast<std::chrono::minutes>(time_since_epoch) % 60;
-        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(time_since_epoch) % 60;
-        
-        std::ostringstream oss;
-        oss << std::setfill('0') << std::setw(2) << hours.count() << ":"
-            << std::setfill('0') << std::setw(2) << minutes.count() << ":"
-            << std::setfill('0') << std::setw(2) << seconds.count();
-        return oss.str();
-    }
-
-    // Printing
-    inline static void print(const std::string& prefix, const std::string& msg, Color c, bool isError=false, int LinesBeforeMessage=1) {
-        for (int i = 0; i < LinesBeforeMessage; ++i) std::cout << std::endl; // Empty Lines
-        std::ostream& out = isError ? std::cerr : std::cout;
-        out << colorCode(Color::GREEN) << "[" << currentTime() << "] " << colorCode(Color::DEFAULT); // Timestamp
-        out << colorCode(c) << prefix << " " << msg << colorCode(Color::DEFAULT) << std::endl; // Prefix and message
-    }
+    constexpr static int debugLevel = RADCAT_DEBUG_LEVEL; // 0=none, 1=errors, 2=warnings, 3=info
 
     // Logging functions
-    inline void Log(const std::string& msg, int LinesBeforeMessage=1)    { if constexpr (debugLevel >= 3) print("[DEBUG]:", msg, Color::WHITE, false, LinesBeforeMessage); }
-    inline void Warn(const std::string& msg, int LinesBeforeMessage=1)   { if constexpr (debugLevel >= 2) print("[WARNING]:", msg, Color::YELLOW, false, LinesBeforeMessage); }
-    inline void Error(const std::string& msg, int LinesBeforeMessage=1)  { if constexpr (debugLevel >= 1) print("[ERROR]:", msg, Color::RED, true, LinesBeforeMessage); }
+    inline void Log(const std::string& msg, int LinesBeforeMessage=1)    { if constexpr (debugLevel >= 3) AsyncLogger::Instance().write(AsyncLogger::Level::Info, LinesBeforeMessage, msg); }
+    inline void Warn(const std::string& msg, int LinesBeforeMessage=1)   { if constexpr (debugLevel >= 2) AsyncLogger::Instance().write(AsyncLogger::Level::Warning, LinesBeforeMessage, msg); }
+    inline void Error(const std::string& msg, int LinesBeforeMessage=1)  { if constexpr (debugLevel >= 1) AsyncLogger::Instance().write(AsyncLogger::Level::Error, LinesBeforeMessage, msg); }
 
     //Templated function for any type
     template<typename... Args> 
     inline void Log(const Args&... args) {
-        if constexpr (debugLevel < 3) return;
-        std::ostringstream oss;
-        ((oss << stringify(args)), ...);
-        Log(oss.str());
+        if constexpr (debugLevel >= 3) AsyncLogger::Instance().write(AsyncLogger::Level::Info, 1, args...);
     }
 
     template<typename... Args> 
     inline void Warn(const Args&... args) {
-        if constexpr (debugLevel < 2) return;
-        std::ostringstream oss;
-        ((oss << stringify(args)), ...);
-        Warn(oss.str());
+        if constexpr (debugLevel >= 2) AsyncLogger::Instance().write(AsyncLogger::Level::Warning, 1, args...);
     }
 
     template<typename... Args> 
     inline void Error(const Args&... args) {
-        if constexpr (debugLevel < 1) return;
-        std::ostringstream oss;
-        ((oss << stringify(args)), ...);
-        Error(oss.str());
+        if constexpr (debugLevel >= 1) AsyncLogger::Instance().write(AsyncLogger::Level::Error, 1, args...);
     }
 
+    // Blocks until everything logged so far is written (before exiting, after a crash report, etc.)
+    inline void Flush() { AsyncLogger::Instance().flush(); }
+
 };
 
-inline DebugClass& Debug = DebugClass::getInstance();
\ No newline at end of file
+inline DebugClass& Debug = DebugClass::getInstance();
+
+// Categorized logging for noisy subsystems: DEBUG_WARN(LogCategory::FTDI, "PollData: timeout after ", ms, " ms");
+// Checked against the category's runtime level (LogControl), then rate limited and de-duplicated per call site.
+#define DEBUG_AT_LEVEL(CATEGORY, LEVEL, ...) \
+    do { \
+        if constexpr (DebugClass::debugLevel >= static_cast<int>(LEVEL)) { \
+            if (LogControl::enabled(CATEGORY, LEVEL)) { \
+                static LogSite radcatLogSite(CATEGORY, LEVEL, __FILE__, __LINE__); \
+                radcatLogSite.submit(__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define DEBUG_LOG(CATEGORY, ...)   DEBUG_AT_LEVEL(CATEGORY, AsyncLogger::Level::Info, __VA_ARGS__)
+#define DEBUG_WARN(CATEGORY, ...)  DEBUG_AT_LEVEL(CATEGORY, AsyncLogger::Level::Warning, __VA_ARGS__)
+#define DEBUG_ERROR(CATEGORY, ...) DEBUG_AT_LEVEL(CATEGORY, AsyncLogger::Level::Error, __VA_ARGS__)
@@ -2,10 +2,122 @@
 #include "Debug.hpp"
 #include "ftd2xx.h"
 #include "AllComponents.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// A worker thread running one device update at a time for deviceLogicUpdate()
+class DeviceHandler::Lane {
+public:
+    explicit Lane(int index) : worker(&Lane::run, this, index) {}
+    ~Lane() {
+        { std::lock_guard<std::mutex> lk(mutex); stopping = true; }
+        wake.notify_one();
+        worker.join();
+    }
+
+    void start(std::function<void()> work) {
+        { std::lock_guard<std::mutex> lk(mutex); job = std::move(work); }
+        wake.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lk(mutex);
+        done.wait(lk, [this] { return !job; });
+    }
+
+private:
+    void run(int index) {
+        Trace::setThreadName("lane" + std::to_string(index));
+        std::unique_lock<std::mutex> lk(mutex);
+        for (;;) {
+            wake.wait(lk, [this] { return job || stopping; });
+            if (!job) return;
+            lk.unlock();
+            job();
+            lk.lock();
+            job = nullptr;
+            done.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void()> job;
+    bool stopping = false;
+    std::thread worker; // Last, starts once the members above exist
+};
+
+DeviceHandler::DeviceHandler() = default;
+DeviceHandler::~DeviceHandler() = default;
+
+void DeviceHandler::updateDevice(EmptyDevice& device) {
+    RC_TRACE_SCOPE_DETAIL("device", "update", device.instanceName);
+    const auto start = Metrics::Clock::now();
+    device.systemUpdate();
+    if (device.updateTime) device.updateTime->recordSince(start);
+}
+
+// A device goes on a lane when another active device has an open interface on the same chip. Counts the open
+// interfaces per chip once instead of comparing every pair.
+void DeviceHandler::refreshLanes(bool parallel) {
+    // Read before the open states, an interface opening meanwhile leaves the version behind and triggers another refresh
+    const uint64_t openVersion = ftdiHandler.openStateVersion();
+    laneDevices.clear();
+    localDevices.clear();
+    std::unordered_map<std::string, int> openPerChip;
+    auto openMultiChannel = [](const EmptyDevice& device) -> const FTDIConnection* {
+        const auto* ftdiComp = device.systemGetComponent<FTDIConnection>();
+        return ftdiComp && ftdiComp->isDeviceOpen() && ftdiComp->getInterface().channels >= 2 ? ftdiComp : nullptr;
+    };
+    if (parallel)
+        for (const auto& device : activeDevices)
+            if (const auto* ftdiComp = openMultiChannel(*device)) openPerChip[ftdiComp->getInterface().chip]++;
+    for (const auto& device : activeDevices) {
+        const auto* ftdiComp = parallel ? openMultiChannel(*device) : nullptr;
+        if (ftdiComp && openPerChip[ftdiComp->getInterface().chip] >= 2) laneDevices.push_back(device.get());
+        else localDevices.push_back(device.get());
+    }
+
+    groupedDevices = activeDevices.size();
+    groupedOpenVersion = openVersion;
+    groupedParallel = parallel;
+    groupingValid = true;
+    while (lanes.size() < laneDevices.size()) lanes.push_back(std::make_unique<Lane>(static_cast<int>(lanes.size())));
+}
 
 void DeviceHandler::deviceLogicUpdate() {
-    for (auto& device : activeDevices) {
-        device->systemUpdate();
+    const bool parallel = parallelInterfaces && !SchedulerClock::installed();
+    if (!groupingValid || groupedDevices != activeDevices.size() || groupedOpenVersion != ftdiHandler.openStateVersion() || groupedParallel != parallel)
+        refreshLanes(parallel);
+
+    // Interfaces sharing a chip each get a lane, the other devices update on this thread meanwhile
+    for (size_t i = 0; i < laneDevices.size(); ++i) {
+        EmptyDevice* device = laneDevices[i];
+        lanes[i]->start([device] { updateDevice(*device); });
+    }
+    for (EmptyDevice* device : localDevices) updateDevice(*device);
+    for (size_t i = 0; i < laneDevices.size(); ++i) lanes[i]->wait();
+}
+
+std::chrono::steady_clock::time_point DeviceHandler::nextTaskDeadline() const {
+    auto due = std::chrono::steady_clock::time_point::max();
+    for (const auto& device : activeDevices) due = std::min(due, device->nextTaskDue());
+    return due;
+}
+
+uint64_t DeviceHandler::runUntil(std::chrono::steady_clock::time_point end) {
+    SchedulerClock& clock = SchedulerClock::current();
+    uint64_t updates = 0;
+    for (;;) {
+        deviceLogicUpdate();
+        updates++;
+        if (clock.now() >= end) return updates;
+        clock.sleepUntil(std::min(nextTaskDeadline(), end));
     }
 }
 
@@ -13,26 +125,123 @@ void DeviceHandler::deviceLogicUpdate() {
 // Matched devices are instantiated and added to the activeDevices list. Yet they are not connected automatically.
 // Neither their automation starts, they are waiting for explicit connect() calls by the UI. This only sets up the devices and UI entries.
 void DeviceHandler::deviceScan() {
+    static Metrics::Registry& reg = Metrics::Registry::Instance();
+    static Metrics::Histogram& ftdiTime = reg.histogram("radcat_device_scan_seconds", "Device scan duration per handler", { {"handler", "ftdi"} });
+    static Metrics::Histogram& libUsbTime = reg.histogram("radcat_device_scan_seconds", "Device scan duration per handler", { {"handler", "libusb"} });
+    static Metrics::Counter& ftdiMatches = reg.counter("radcat_device_scan_matches_total", "Scanned devices matched to a registered device type", { {"handler", "ftdi"} });
+    static Metrics::Counter& libUsbMatches = reg.counter("radcat_device_scan_matches_total", "Scanned devices matched to a registered device type", { {"handler", "libusb"} });
+    static Metrics::Histogram& serialTime = reg.histogram("radcat_device_scan_seconds", "Device scan duration per handler", { {"handler", "serial"} });
+    static Metrics::Counter& serialMatches = reg.counter("radcat_device_scan_matches_total", "Scanned devices matched to a registered device type", { {"handler", "serial"} });
+
+    RC_TRACE_SCOPE("scan", "deviceScan");
+    size_t before = foundDevices.size();
+    auto start = Metrics::Clock::now();
     ftdiScan();
+    ftdiTime.recordSince(start);
+    ftdiMatches.add(foundDevices.size() - before);
+
+    before = foundDevices.size();
+    start = Metrics::Clock::now();
     libUsbScan();
+    libUsbTime.recordSince(start);
+    libUsbMatches.add(foundDevices.size() - before);
+
+    before = foundDevices.size();
+    start = Metrics::Clock::now();
+    serialScan();
+    serialTime.recordSince(start);
+    serialMatches.add(foundDevices.size() - before);
+}
+
+void DeviceHandler::serialScan() {
+    RC_TRACE_SCOPE("scan", "serialScan");
+    DEBUG_LOG(LogCategory::Scan, "Scanning for serial ports...");
+
+    std::vector<SerialHandler::ScannedDeviceInfo> scannedDevices = serialHandler.scanDevices();
+    if (scannedDevices.empty()) { DEBUG_LOG(LogCategory::Scan, "No serial ports found during scan."); return; }
+    matchSerialDevices(scannedDevices);
+}
+
+void DeviceHandler::matchSerialDevices(const std::vector<SerialHandler::ScannedDeviceInfo>& scannedDevices) {
+    auto SerialDevices = DeviceRegistry::getRegisteredDevicesWithComponents<SerialConnection>();
+
+    for (const SerialHandler::ScannedDeviceInfo& info : scannedDevices) {
+
+        // Check active devices, a port belongs to one device
+        bool alreadyAssigned = false;
+        for (auto& device : activeDevices) {
+            auto* serialComp = device->systemGetComponent<SerialConnection>();
+            if (serialComp && serialComp->deviceInfo.path == info.path) {
+                DEBUG_LOG(LogCategory::Scan, "Serial port " , info.path , " is already assigned to an active device. Skipping.");
+                alreadyAssigned = true;
+                break;
+            }
+        }
+        if (alreadyAssigned) continue;
+
+        // Check all registered devices for potential serial matches
+        for (const auto& entry : SerialDevices) {
+            const DeviceRegistry::RegistryEntry::DeviceInfo& deviceInfo = entry->deviceInfo;
+            FoundDeviceInfo foundDevice;
+
+            if (!info.serial.empty() && deviceInfo.serialNumber == info.serial) {
+                foundDevice.matchData.serialMatch = true;
+                foundDevice.matchData.matchScore++;
+            }
+            if (deviceInfo.vid != 0 && deviceInfo.vid == info.vid) {
+                foundDevice.matchData.vidMatch = true;
+                foundDevice.matchData.matchScore++;
+            }
+            if (deviceInfo.pid != 0 && deviceInfo.pid == info.pid) {
+                foundDevice.matchData.pidMatch = true;
+                foundDevice.matchData.matchScore++;
+            }
+
+            std::string deviceNameLower = deviceInfo.deviceName;
+            std::string foundDeviceNameLower = info.description;
+            std::transform(deviceNameLower.begin(), deviceNameLower.end(), deviceNameLower.begin(), ::tolower);
+            std::transform(foundDeviceNameLower.begin(), foundDeviceNameLower.end(), foundDeviceNameLower.begin(), ::tolower);
+            if (!foundDeviceNameLower.empty() && (foundDeviceNameLower.find(deviceNameLower) != std::string::npos ||
+                deviceNameLower.find(foundDeviceNameLower) != std::string::npos)) {
+                foundDevice.matchData.nameMatch = true;
+                foundDevice.matchData.matchScore++;
+            }
+
+            if(foundDevice.matchData.matchScore <= 2) continue; //Not enough matches
+
+            DEBUG_LOG(LogCategory::Scan, "MATCH FOUND! Device: ", deviceInfo.deviceName, " on ", info.path);
+            foundDevice.deviceRegistryEntry = entry;
+            foundDevice.connectionType = FoundDeviceInfo::ConnectionType::Serial;
+            foundDevice.SerialScannedDeviceInfo = std::make_unique<SerialHandler::ScannedDeviceInfo>(info);
+            foundDevices.emplace_back(std::move(foundDevice));
+            break;
+        }
+    }
 }
 
 void DeviceHandler::libUsbScan() {
-    if constexpr(debug) Debug.Log("Scanning for LibUsb devices...");
+    RC_TRACE_SCOPE("scan", "libUsbScan");
+    DEBUG_LOG(LogCategory::Scan, "Scanning for LibUsb devices...");
 
     std::vector<LibUsbHandler::ScannedDeviceInfo> scannedDevices = libUsbHandler.scanDevices();
-    if (scannedDevices.empty()) { if constexpr(debug) Debug.Warn("No LibUsb devices found during scan."); return; }
+    if (scannedDevices.empty()) { DEBUG_LOG(LogCategory::Scan, "No LibUsb devices found during scan."); return; }
+    matchLibUsbDevices(scannedDevices);
+}
+
+void DeviceHandler::matchLibUsbDevices(std::vector<LibUsbHandler::ScannedDeviceInfo>& scannedDevices) {
+    auto UsbDevices = DeviceRegistry::getRegisteredDevicesWithComponents<UsbConnection>();
 
     for(LibUsbHandler::ScannedDeviceInfo& info : scannedDevices) { // For each detected LibUsb device
         uint16_t vid = info.descriptor.idVendor;
         uint16_t pid = info.descriptor.idProduct;
         
-        // Check active devices to see if already assigned
+        // Check active devices to see if already assigned. Identical devices share bus, VID and PID, the port path tells them apart.
         bool alreadyAssigned = false;
         for (auto& device : activeDevices) {
             UsbConnection* usbComp = device->systemGetComponent<UsbConnection>();
-            if(usbComp && usbComp->deviceInfo.busNumber == libusb_get_bus_number(info.device) && usbComp->deviceInfo.vid == vid && usbComp->deviceInfo.pid == pid) {
-                if constexpr(debug) Debug.Log("LibUsb device VID: " , vid , " PID: " , pid , " is already assigned to an active device. Skipping.");
+            if(usbComp && usbComp->deviceInfo.busNumber == info.busNumber && usbComp->deviceInfo.portPath == info.portPath
+               && usbComp->deviceInfo.vid == vid && usbComp->deviceInfo.pid == pid) {
+                DEBUG_LOG(LogCategory::Scan, "LibUsb device VID: " , vid , " PID: " , pid , " is already assigned to an active device. Skipping.");
                 alreadyAssigned = true;
                 break;
             }
@@ -40,7 +249,6 @@ void DeviceHandler::libUsbScan() {
         if (alreadyAssigned) continue;
 
         // Check all registered devices for potential LibUsb matches
-        auto UsbDevices = DeviceRegistry::getRegisteredDevicesWithComponents<UsbConnection>();
         for (const auto& entry : UsbDevices) {
             const DeviceRegistry::RegistryEntry::DeviceInfo& deviceInfo = entry->deviceInfo;
             FoundDeviceInfo foundDevice;
@@ -52,8 +260,7 @@ void DeviceHandler::libUsbScan() {
             }
 
             // PID Check
-            uint16_t pid = info.descriptor.idProduct;
-            if (deviceInfo.pid == 0 && deviceInfo.pid == pid){
+            if (deviceInfo.pid != 0 && deviceInfo.pid == pid){
                 foundDevice.matchData.pidMatch = true;
                 foundDevice.matchData.matchScore++;
             }
@@ -70,7 +277,7 @@ void DeviceHandler::libUsbScan() {
 
             if(foundDevice.matchData.matchScore <= 2) continue; //Not enough matches
             
-            if constexpr(debug) Debug.Log("MATCH FOUND! Device : " , deviceInfo.deviceName);
+            DEBUG_LOG(LogCategory::Scan, "MATCH FOUND! Device : " , deviceInfo.deviceName);
             foundDevice.connectionType = FoundDeviceInfo::ConnectionType::LibUsb;
             foundDevice.deviceRegistryEntry = entry;
             foundDevice.LibUsbScannedDeviceInfo = std::make_unique<LibUsbHandler::ScannedDeviceInfo>(std::move(info));
@@ -81,10 +288,15 @@ void DeviceHandler::libUsbScan() {
 }
 
 void DeviceHandler::ftdiScan() {
-    if constexpr(debug) Debug.Log("Scanning for FTDI devices...");
+    RC_TRACE_SCOPE("scan", "ftdiScan");
+    DEBUG_LOG(LogCategory::Scan, "Scanning for FTDI devices...");
     
     std::vector<FTDIHandler::ScannedDeviceInfo> scannedDevices = ftdiHandler.scanDevices();
-    if (scannedDevices.empty()) { if constexpr(debug) Debug.Warn("No FTDI devices found during scan."); return; }
+    if (scannedDevices.empty()) { DEBUG_LOG(LogCategory::Scan, "No FTDI devices found during scan."); return; }
+    matchFtdiDevices(scannedDevices);
+}
+
+void DeviceHandler::matchFtdiDevices(const std::vector<FTDIHandler::ScannedDeviceInfo>& scannedDevices) {
     auto FTDIDevices = DeviceRegistry::getRegisteredDevicesWithComponents<FTDIConnection>();
 
     for (const FTDIHandler::ScannedDeviceInfo& scannedDevice : scannedDevices) {
@@ -93,8 +305,8 @@ void DeviceHandler::ftdiScan() {
         bool alreadyAssigned = false;
         for (auto& device : activeDevices) {
             auto* ftdiComp = device->systemGetComponent<FTDIConnection>();
-            if (ftdiComp && ftdiComp->getFTDIIndex() == scannedDevice.scanIndex) {
-                if constexpr(debug) Debug.Log("FTDI device at index " , scannedDevice.scanIndex , " is already assigned to an active device. Skipping.");
+            if (ftdiComp && ftdiComp->getFTDIIndex() == scannedDevice.scanIndex && ftdiComp->getBackend() == scannedDevice.backend) {
+                DEBUG_LOG(LogCategory::Scan, "FTDI device at index " , scannedDevice.scanIndex , " is already assigned to an active device. Skipping.");
                 alreadyAssigned = true;
                 break;
             }
@@ -139,7 +351,7 @@ void DeviceHandler::ftdiScan() {
             
             if(foundDevice.matchData.matchScore <= 2) continue; //Not enough matches
 
-            if constexpr(debug) Debug.Log("MATCH FOUND! Device: ", deviceInfo.deviceName);
+            DEBUG_LOG(LogCategory::Scan, "MATCH FOUND! Device: ", deviceInfo.deviceName);
             foundDevice.deviceRegistryEntry = entry;
             foundDevice.connectionType = FoundDeviceInfo::ConnectionType::FTDI;
             foundDevice.FTDIScannedDeviceInfo = std::make_unique<FTDIHandler::ScannedDeviceInfo>(scannedDevice);
@@ -150,22 +362,35 @@ void DeviceHandler::ftdiScan() {
 }
 
 void DeviceHandler::activateDevice(FoundDeviceInfo& DeviceInfo) {
+    RC_TRACE_SCOPE_DETAIL("scan", "activateDevice", DeviceInfo.deviceRegistryEntry->deviceInfo.deviceName);
     // Create device instance
     auto matchedDevice = DeviceInfo.deviceRegistryEntry->creator();
+    const std::string& typeName = DeviceInfo.deviceRegistryEntry->deviceInfo.deviceName;
+    matchedDevice->instanceName = typeName + "#" + std::to_string(activatedPerType[typeName]++);
+    matchedDevice->updateTime = &Metrics::Registry::Instance().histogram("radcat_device_update_seconds", "Time spent in one device logic update", { {"device", matchedDevice->instanceName} });
 
     if (DeviceInfo.connectionType == FoundDeviceInfo::ConnectionType::FTDI) {
         FTDIConnection* ftdiComp = matchedDevice->systemGetComponent<FTDIConnection>();
-        
-    } 
+        if (!ftdiComp || !DeviceInfo.FTDIScannedDeviceInfo) return;
+        ftdiComp->setFTDIIndex(DeviceInfo.FTDIScannedDeviceInfo->scanIndex);
+        ftdiComp->setDevInfo(DeviceInfo.FTDIScannedDeviceInfo->devInfo);
+        ftdiComp->setBackend(DeviceInfo.FTDIScannedDeviceInfo->backend);
+    }
     else if (DeviceInfo.connectionType == FoundDeviceInfo::ConnectionType::LibUsb) {
         UsbConnection* usbComp = matchedDevice->systemGetComponent<UsbConnection>();
 
         if ( !libUsbHandler.deviceMatch(DeviceInfo.LibUsbScannedDeviceInfo, *usbComp) ) return; // Matching failed
 
     }
+    else if (DeviceInfo.connectionType == FoundDeviceInfo::ConnectionType::Serial) {
+        SerialConnection* serialComp = matchedDevice->systemGetComponent<SerialConnection>();
+        if (!serialComp || !DeviceInfo.SerialScannedDeviceInfo) return;
+        serialComp->deviceInfo = *DeviceInfo.SerialScannedDeviceInfo; // Opened by the device's connect()
+    }
 
 
 
     activeDevices.push_back(std::move(matchedDevice));
+    groupingValid = false;
 }
 
@@ -1,9 +1,13 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <string>
+#include <unordered_map>
 #include "DeviceCore.hpp"
 #include "FTDIHandler.hpp"
 #include "LibUsbHandler.hpp"
+#include "SerialHandler.hpp"
 
 
 class DeviceHandler {
@@ -22,6 +26,7 @@ public:
         enum class ConnectionType {
             FTDI,
             LibUsb,
+            Serial,
             Other
         } connectionType;
         const DeviceRegistry::RegistryEntry* deviceRegistryEntry;
@@ -34,25 +39,69 @@ public:
 
         //FTDI Data
         std::unique_ptr<FTDIHandler::ScannedDeviceInfo> FTDIScannedDeviceInfo = nullptr;
+
+        //Serial Data
+        std::unique_ptr<SerialHandler::ScannedDeviceInfo> SerialScannedDeviceInfo = nullptr;
     };
 
 
     std::vector<FoundDeviceInfo> foundDevices;
     std::vector<std::unique_ptr<EmptyDevice>> activeDevices;
 
-    
-    const static bool debug = false;
+    // Devices on different interfaces of one FTDI chip (FT2232H, FT4232H channels) update in parallel, one
+    // lane thread each, so their USB round trips overlap instead of queueing up on the logic thread.
+    // deviceLogicUpdate() still returns once every device is done. Sequential while a SchedulerClock is
+    // installed, a VirtualClock is driven from one thread. Anything a device writes from its update must belong to that
+    // instance (plot and telemetry channels are keyed by instanceName), single-producer rings must not be shared.
+    bool parallelInterfaces = true;
+
+    DeviceHandler();
+    ~DeviceHandler();
 
     void deviceScan();
     void deviceLogicUpdate();
 
+    // Earliest periodic task deadline over all active devices, time_point::max() if nothing is scheduled.
+    std::chrono::steady_clock::time_point nextTaskDeadline() const;
+    // Runs deviceLogicUpdate() until the scheduler clock reaches end, waiting on the clock for the next deadline
+    // in between. With a VirtualClock installed this jumps from deadline to deadline (a task with a 0 ms interval
+    // stops time). Returns the number of updates.
+    uint64_t runUntil(std::chrono::steady_clock::time_point end);
+
     void activateDevice(FoundDeviceInfo& DeviceInfo);
+
+    // Matches already scanned FTDI devices against the registry and appends the hits to foundDevices.
+    // Called by deviceScan(), split out so matching can run without hardware (benchmarks, simulations).
+    void matchFtdiDevices(const std::vector<FTDIHandler::ScannedDeviceInfo>& scannedDevices);
+    // Same for LibUsb devices. Matched entries are moved out of scannedDevices into foundDevices.
+    void matchLibUsbDevices(std::vector<LibUsbHandler::ScannedDeviceInfo>& scannedDevices);
+    // Same for serial ports, by the USB device behind them.
+    void matchSerialDevices(const std::vector<SerialHandler::ScannedDeviceInfo>& scannedDevices);
     
 
 private:
     LibUsbHandler& libUsbHandler = LibUsbHandler::Instance();
     FTDIHandler& ftdiHandler = FTDIHandler::Instance();
+    SerialHandler& serialHandler = SerialHandler::Instance();
     void ftdiScan();
     void libUsbScan();
-    
+    void serialScan();
+
+    // Instances activated so far per device type. Names are never reused, so a device activated after another
+    // was removed can not take over its metrics and traces.
+    std::unordered_map<std::string, uint64_t> activatedPerType;
+
+    class Lane;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    // Lane grouping of deviceLogicUpdate(), only rebuilt when devices are added, an FTDI interface opens or closes,
+    // or the parallel setting changes
+    std::vector<EmptyDevice*> laneDevices;   // Share a chip with another open interface, one lane each
+    std::vector<EmptyDevice*> localDevices;  // Updated on the calling thread
+    size_t groupedDevices = 0;
+    uint64_t groupedOpenVersion = 0;
+    bool groupedParallel = false;
+    bool groupingValid = false;
+    static void updateDevice(EmptyDevice& device);
+    void refreshLanes(bool parallel);
+
 };
\ No newline at end of file
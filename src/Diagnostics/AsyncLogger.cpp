@@ -0,0 +1,265 @@
+#include "AsyncLogger.hpp"
+#include "LogControl.hpp"
+#include "MappedLogFile.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+    constexpr auto idleSleep = std::chrono::milliseconds(2);
+    constexpr auto siteFlushInterval = std::chrono::milliseconds(100); // Summaries of call sites that went quiet
+
+    constexpr std::string_view colorDefault = "\033[0m";
+    constexpr std::string_view colorTime    = "\033[32m";
+
+    std::string_view levelPrefix(AsyncLogger::Level level) {
+        switch (level) {
+            case AsyncLogger::Level::Error:   return "[ERROR]:";
+            case AsyncLogger::Level::Warning: return "[WARNING]:";
+            default:                          return "[DEBUG]:";
+        }
+    }
+
+    std::string_view levelColor(AsyncLogger::Level level) {
+        switch (level) {
+            case AsyncLogger::Level::Error:   return "\033[31m";
+            case AsyncLogger::Level::Warning: return "\033[33m";
+            default:                          return "\033[37m";
+        }
+    }
+
+    // HH:MM:SS of a system_clock timestamp, same as the old synchronous Debug print
+    void appendTime(std::string& out, uint64_t timestampNs) {
+        const uint64_t seconds = timestampNs / 1000000000ull;
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%02u:%02u:%02u", static_cast<unsigned>(seconds / 3600 % 24), static_cast<unsigned>(seconds / 60 % 60), static_cast<unsigned>(seconds % 60));
+        out += buf;
+    }
+
+    template<typename T> T readRaw(const unsigned char*& p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    // Turns the tagged payload back into text
+    void decodePayload(const AsyncLogger::Record& rec, std::string& out) {
+        using Tag = AsyncLogger::ArgTag;
+        const unsigned char* p = rec.payload;
+        const unsigned char* end = rec.payload + rec.payloadSize;
+        char buf[32];
+        while (p < end) {
+            const Tag tag = static_cast<Tag>(*p++);
+            switch (tag) {
+                case Tag::Int:     std::snprintf(buf, sizeof(buf), "%" PRId64, readRaw<int64_t>(p)); out += buf; break;
+                case Tag::UInt:    std::snprintf(buf, sizeof(buf), "%" PRIu64, readRaw<uint64_t>(p)); out += buf; break;
+                case Tag::Double:  std::snprintf(buf, sizeof(buf), "%g", readRaw<double>(p)); out += buf; break;
+                case Tag::Bool:    out += readRaw<bool>(p) ? '1' : '0'; break;
+                case Tag::Char:    out += readRaw<char>(p); break;
+                case Tag::Pointer: std::snprintf(buf, sizeof(buf), "0x%" PRIx64, readRaw<uint64_t>(p)); out += buf; break;
+                case Tag::String: {
+                    const uint16_t len = readRaw<uint16_t>(p);
+                    out.append(reinterpret_cast<const char*>(p), len);
+                    p += len;
+                    break;
+                }
+                default: return; // Corrupt record, drop the rest
+            }
+        }
+    }
+}
+
+AsyncLogger& AsyncLogger::Instance() {
+    // Never destroyed: threads may still log while static destructors run, shutdown() is registered with atexit instead.
+    static AsyncLogger* instance = new AsyncLogger();
+    return *instance;
+}
+
+AsyncLogger::AsyncLogger() {
+    batch.reserve(RingRecords);
+    running.store(true, std::memory_order_release);
+    writer = std::thread(&AsyncLogger::writerLoop, this);
+    std::atexit([] { AsyncLogger::Instance().shutdown(); });
+}
+
+AsyncLogger::~AsyncLogger() { shutdown(); }
+
+// Each thread owns one ring. The holder marks it retired on thread exit so the writer can free it once drained.
+AsyncLogger::ThreadBuffer& AsyncLogger::localBuffer() {
+    struct Holder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~Holder() { if (buffer) buffer->retired.store(true, std::memory_order_release); }
+    };
+    thread_local Holder holder;
+    if (!holder.buffer) holder.buffer = registerThread();
+    return *holder.buffer;
+}
+
+std::shared_ptr<AsyncLogger::ThreadBuffer> AsyncLogger::registerThread() {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lk(registryMutex);
+    buffers.push_back(buffer);
+    return buffer;
+}
+
+void AsyncLogger::writerLoop() {
+    auto nextSiteFlush = std::chrono::steady_clock::now() + siteFlushInterval;
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        if (std::chrono::steady_clock::now() >= nextSiteFlush) {
+            LogSite::flushPending();
+            nextSiteFlush = std::chrono::steady_clock::now() + siteFlushInterval;
+        }
+        size_t written = drainOnce();
+        drainedGeneration.fetch_add(1, std::memory_order_release);
+        if (written == 0) std::this_thread::sleep_for(idleSleep);
+    }
+    LogSite::flushPending(true);
+    drainOnce();
+    drainedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+size_t AsyncLogger::drainOnce() {
+    std::vector<std::shared_ptr<ThreadBuffer>> current;
+    {
+        std::lock_guard<std::mutex> lk(registryMutex);
+        current = buffers;
+    }
+
+    std::lock_guard<std::mutex> lk(outputMutex);
+    batch.clear();
+    std::vector<ThreadBuffer*> finished;
+    for (auto& buffer : current) {
+        const bool retired = buffer->retired.load(std::memory_order_acquire); // Read before draining, nothing can follow it
+        const size_t start = batch.size();
+        const size_t available = buffer->ring.size();
+        batch.resize(start + available);
+        batch.resize(start + buffer->ring.popBulk(batch.data() + start, available));
+        if (retired) finished.push_back(buffer.get());
+    }
+
+    // Merge the threads into one timeline
+    std::sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+        return a.timestampNs != b.timestampNs ? a.timestampNs < b.timestampNs : a.sequence < b.sequence;
+    });
+    for (const Record& rec : batch) emitRecord(rec);
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> reg(registryMutex);
+        for (ThreadBuffer* done : finished) {
+            auto it = std::find_if(buffers.begin(), buffers.end(), [done](const auto& b) { return b.get() == done; });
+            if (it == buffers.end()) continue;
+            retiredDropped += done->dropped.load(std::memory_order_relaxed);
+            buffers.erase(it);
+        }
+        for (const auto& buffer : buffers) dropped += buffer->dropped.load(std::memory_order_relaxed);
+        dropped += retiredDropped;
+    }
+    if (dropped > reportedDropped) {
+        Record rec{};
+        rec.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        rec.level = Level::Warning;
+        Encoder enc{ rec.payload, rec.payload + PayloadSize };
+        encodeArg(enc, "Logger: ");
+        encodeArg(enc, dropped - reportedDropped);
+        encodeArg(enc, " messages dropped, log rings were full.");
+        rec.payloadSize = static_cast<uint16_t>(enc.pos - rec.payload);
+        emitRecord(rec);
+        reportedDropped = dropped;
+    }
+
+    if (!batch.empty() || !pending.empty()) flushOutputs();
+    return batch.size();
+}
+
+void AsyncLogger::emitRecord(const Record& rec) {
+    message.clear();
+    decodePayload(rec, message);
+    const bool isError = rec.level == Level::Error;
+
+    if (consoleEnabled.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < rec.linesBefore; ++i) appendConsole(false, "\n"); // Empty lines
+        std::string text;
+        text.reserve(message.size() + 48);
+        text += colorTime; text += '['; appendTime(text, rec.timestampNs); text += "] "; text += colorDefault;
+        text += levelColor(rec.level); text += levelPrefix(rec.level); text += ' '; text += message; text += colorDefault; text += '\n';
+        appendConsole(isError, text);
+    }
+
+    if (file) {
+        fileOut += '['; appendTime(fileOut, rec.timestampNs); fileOut += "] ";
+        fileOut += levelPrefix(rec.level); fileOut += ' '; fileOut += message; fileOut += '\n';
+    }
+}
+
+// Keeps stdout/stderr interleaving intact: switching streams writes out what is pending first.
+void AsyncLogger::appendConsole(bool toError, std::string_view text) {
+    if (toError != pendingIsError && !pending.empty()) {
+        std::ostream& out = pendingIsError ? std::cerr : std::cout;
+        out.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+        out.flush();
+        pending.clear();
+    }
+    pendingIsError = toError;
+    pending += text;
+}
+
+void AsyncLogger::flushOutputs() {
+    if (!pending.empty()) {
+        std::ostream& out = pendingIsError ? std::cerr : std::cout;
+        out.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+        out.flush();
+        pending.clear();
+    }
+    if (!fileOut.empty()) {
+        if (file) file->write(fileOut);
+        fileOut.clear();
+    }
+}
+
+bool AsyncLogger::openFile(const std::string& path, size_t fileBytes, int maxFiles) {
+    auto newFile = std::make_unique<MappedLogFile>(path, fileBytes, maxFiles);
+    if (!newFile->isOpen()) return false;
+    std::lock_guard<std::mutex> lk(outputMutex);
+    flushOutputs();
+    file = std::move(newFile);
+    return true;
+}
+
+void AsyncLogger::closeFile() {
+    flush();
+    std::lock_guard<std::mutex> lk(outputMutex);
+    flushOutputs();
+    file.reset();
+}
+
+void AsyncLogger::flush() {
+    if (!running.load(std::memory_order_acquire) || std::this_thread::get_id() == writer.get_id()) return;
+    // Two full passes: the one in progress may have started before our last message was committed.
+    const uint64_t target = drainedGeneration.load(std::memory_order_acquire) + 2;
+    while (running.load(std::memory_order_acquire) && drainedGeneration.load(std::memory_order_acquire) < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void AsyncLogger::shutdown() {
+    if (!running.load(std::memory_order_acquire)) return;
+    stopRequested.store(true, std::memory_order_release);
+    if (writer.joinable() && std::this_thread::get_id() != writer.get_id()) writer.join();
+    running.store(false, std::memory_order_release);
+    // Producers that saw running before it was cleared may have committed after the writer's last pass,
+    // later ones write synchronously
+    drainOnce();
+    std::lock_guard<std::mutex> lk(outputMutex);
+    flushOutputs();
+    file.reset(); // Trims the mapped file to its used size
+}
+
+uint64_t AsyncLogger::droppedMessages() const {
+    uint64_t total = 0;
+    std::lock_guard<std::mutex> lk(registryMutex);
+    for (const auto& buffer : buffers) total += buffer->dropped.load(std::memory_order_relaxed);
+    return total + retiredDropped;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Utils/RingBuffer.hpp"
+
+class MappedLogFile;
+
+// Asynchronous logger behind Debug.Log/Warn/Error.
+// The calling thread only copies its raw arguments (tagged, binary) into its own lock-free ring.
+// A background thread merges all rings in timestamp order, formats the text and writes it
+// to the console and, optionally, to a rotating memory-mapped file.
+// When a ring is full the message is dropped and counted instead of blocking the caller.
+class AsyncLogger {
+public:
+    enum class Level : uint8_t { Error = 1, Warning = 2, Info = 3 };
+
+    // Tags of the binary argument encoding
+    enum class ArgTag : uint8_t { Int, UInt, Double, Bool, Char, String, Pointer };
+
+    static constexpr size_t PayloadSize = 232;  // Record is 256 bytes, longer messages are truncated
+    static constexpr size_t RingRecords = 4096; // Per thread
+
+    struct Record {
+        uint64_t timestampNs;   // system_clock, since epoch
+        uint64_t sequence;      // Per thread, keeps same-timestamp records in order
+        Level level;
+        uint8_t linesBefore;
+        uint16_t payloadSize;
+        uint32_t reserved;
+        unsigned char payload[PayloadSize];
+    };
+
+    static AsyncLogger& Instance();
+
+    // ---- Call site ----
+    template<typename... Args> void write(Level level, int linesBefore, const Args&... args) {
+        if (!running.load(std::memory_order_acquire)) { writeSynchronous(level, linesBefore, args...); return; }
+        ThreadBuffer& buffer = localBuffer();
+        Record* rec = buffer.ring.reserve();
+        if (!rec) { buffer.dropped.fetch_add(1, std::memory_order_relaxed); return; }
+        rec->timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        rec->sequence = buffer.sequence++;
+        rec->level = level;
+        rec->linesBefore = static_cast<uint8_t>(linesBefore < 0 ? 0 : (linesBefore > 255 ? 255 : linesBefore));
+        rec->reserved = 0;
+        Encoder enc{ rec->payload, rec->payload + PayloadSize };
+        (encodeArg(enc, args), ...);
+        rec->payloadSize = static_cast<uint16_t>(enc.pos - rec->payload);
+        buffer.ring.commit();
+    }
+
+    // ---- Configuration ----
+    void setConsoleOutput(bool enabled) { consoleEnabled.store(enabled, std::memory_order_relaxed); }
+
+    // Also writes plain (uncolored) text into a memory-mapped file of fileBytes bytes.
+    // When it fills up, path becomes path.1 (older files shift up to path.<maxFiles>) and a fresh file is started.
+    bool openFile(const std::string& path, size_t fileBytes = 16u << 20, int maxFiles = 5);
+    void closeFile();
+
+    // Blocks until everything logged before this call has been written.
+    void flush();
+
+    // Stops the writer thread after a final drain. Later messages are written synchronously.
+    void shutdown();
+
+    uint64_t droppedMessages() const;
+
+private:
+    AsyncLogger();
+    ~AsyncLogger();
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    struct ThreadBuffer {
+        ThreadBuffer() : ring(RingRecords) {}
+        SpscRing<Record> ring;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false}; // Owning thread exited, free once drained
+        uint64_t sequence = 0;
+    };
+
+    struct Encoder {
+        unsigned char* pos;
+        unsigned char* end;
+        void put(ArgTag tag, const void* data, size_t n) {
+            if (static_cast<size_t>(end - pos) < n + 1) { pos = end; return; }
+            *pos++ = static_cast<unsigned char>(tag);
+            std::memcpy(pos, data, n);
+            pos += n;
+        }
+        void putString(std::string_view s) {
+            size_t room = static_cast<size_t>(end - pos);
+            if (room < 4) { pos = end; return; }
+            uint16_t len = static_cast<uint16_t>(s.size() < room - 3 ? s.size() : room - 3);
+            *pos++ = static_cast<unsigned char>(ArgTag::String);
+            std::memcpy(pos, &len, sizeof(len));
+            std::memcpy(pos + sizeof(len), s.data(), len);
+            pos += sizeof(len) + len;
+        }
+    };
+
+    // Same text as streaming the value into an std::ostream; only unknown types are formatted on the caller.
+    template<typename T> static void encodeArg(Encoder& enc, const T& v) {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (std::is_same_v<U, bool>) { enc.put(ArgTag::Bool, &v, sizeof(bool)); }
+        else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) { char c = static_cast<char>(v); enc.put(ArgTag::Char, &c, 1); }
+        else if constexpr (std::is_enum_v<U>) { encodeArg(enc, static_cast<std::underlying_type_t<U>>(v)); }
+        else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) { int64_t x = v; enc.put(ArgTag::Int, &x, sizeof(x)); }
+        else if constexpr (std::is_integral_v<U>) { uint64_t x = v; enc.put(ArgTag::UInt, &x, sizeof(x)); }
+        else if constexpr (std::is_floating_point_v<U>) { double x = static_cast<double>(v); enc.put(ArgTag::Double, &x, sizeof(x)); }
+        else if constexpr (std::is_convertible_v<const U&, std::string_view>) { enc.putString(std::string_view(v)); }
+        else if constexpr (std::is_pointer_v<U>) { uint64_t x = reinterpret_cast<uintptr_t>(v); enc.put(ArgTag::Pointer, &x, sizeof(x)); }
+        else { enc.putString(stringify(v)); }
+    }
+
+    template<typename T> static std::string stringify(const T& v) {
+        if constexpr (requires(std::ostringstream& os) { os << v; }) { std::ostringstream oss; oss << v; return oss.str(); }
+        else if constexpr (requires { std::to_string(v); }) { return std::to_string(v); }
+        else { return "[unprintable type]"; }
+    }
+
+    // Used before the writer thread runs and after shutdown().
+    template<typename... Args> void writeSynchronous(Level level, int linesBefore, const Args&... args) {
+        Record rec{};
+        rec.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        rec.level = level;
+        rec.linesBefore = static_cast<uint8_t>(linesBefore < 0 ? 0 : (linesBefore > 255 ? 255 : linesBefore));
+        Encoder enc{ rec.payload, rec.payload + PayloadSize };
+        (encodeArg(enc, args), ...);
+        rec.payloadSize = static_cast<uint16_t>(enc.pos - rec.payload);
+        std::lock_guard<std::mutex> lk(outputMutex);
+        emitRecord(rec);
+        flushOutputs();
+    }
+
+    ThreadBuffer& localBuffer();
+    std::shared_ptr<ThreadBuffer> registerThread();
+    void writerLoop();
+    size_t drainOnce(); // Returns the number of records written
+    void emitRecord(const Record& rec); // Requires outputMutex
+    void appendConsole(bool toError, std::string_view text); // Requires outputMutex
+    void flushOutputs();          // Requires outputMutex
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> consoleEnabled{true};
+    std::thread writer;
+
+    mutable std::mutex registryMutex; // Thread registration only
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint64_t retiredDropped = 0;
+
+    std::mutex outputMutex; // Sinks and scratch strings, writer thread or synchronous path
+    std::unique_ptr<MappedLogFile> file;
+    std::vector<Record> batch;
+    std::string pending, fileOut, message; // Console text not yet written, file text, decode scratch
+    bool pendingIsError = false;           // Which console stream `pending` belongs to
+    uint64_t reportedDropped = 0;
+    std::atomic<uint64_t> drainedGeneration{0};
+};
@@ -0,0 +1,124 @@
+#include "LogControl.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+    constexpr const char* categoryNames[] = { "", "[FTDI] ", "[LibUsb] ", "[Scan] ", "[Device] ", "[Task] ", "[Serial] ", "[Network] " };
+    constexpr const char* categoryKeys[] = { "general", "ftdi", "libusb", "scan", "device", "task", "serial", "net" };
+    static_assert(std::size(categoryNames) == LogControl::CategoryCount && std::size(categoryKeys) == LogControl::CategoryCount);
+
+    uint64_t steadyNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Calls apply(categoryIndex, level) for every valid "name=level" entry, report(entry) for the invalid ones.
+    template<typename Apply, typename Report> bool parseSpec(std::string_view spec, Apply&& apply, Report&& report) {
+        bool ok = true;
+        while (!spec.empty()) {
+            size_t comma = spec.find(',');
+            std::string_view entry = spec.substr(0, comma);
+            spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+            if (entry.empty()) continue;
+
+            size_t eq = entry.find('=');
+            if (eq == std::string_view::npos || eq + 1 >= entry.size() || !std::isdigit(static_cast<unsigned char>(entry[eq + 1]))) { report(entry); ok = false; continue; }
+            std::string key(entry.substr(0, eq));
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            int level = std::clamp(entry[eq + 1] - '0', 0, 3);
+
+            bool matched = false;
+            for (size_t i = 0; i < LogControl::CategoryCount; ++i) {
+                if (key == "*" || key == categoryKeys[i]) { apply(i, level); matched = true; }
+            }
+            if (!matched) { report(entry); ok = false; }
+        }
+        return ok;
+    }
+}
+
+// General follows Debug.Log and prints everything, subsystems start at warnings.
+LogControl::State::State() {
+    for (auto& level : levels) level.store(2, std::memory_order_relaxed);
+    levels[static_cast<size_t>(LogCategory::General)].store(3, std::memory_order_relaxed);
+    if (const char* env = std::getenv("RADCAT_LOG")) {
+        parseSpec(env, [this](size_t i, int level) { levels[i].store(level, std::memory_order_relaxed); }, [](std::string_view) {});
+    }
+}
+
+const char* LogControl::name(LogCategory category) {
+    size_t i = static_cast<size_t>(category);
+    return i < CategoryCount ? categoryNames[i] : "";
+}
+
+bool LogControl::configure(std::string_view spec) {
+    return parseSpec(spec,
+        [](size_t i, int level) { setLevel(static_cast<LogCategory>(i), level); },
+        [](std::string_view entry) { AsyncLogger::Instance().write(AsyncLogger::Level::Warning, 1, "LogControl: invalid entry '", entry, "', expected category=level"); });
+}
+
+LogSite::LogSite(LogCategory siteCategory, AsyncLogger::Level siteLevel, const char* siteFile, int siteLine)
+: category(siteCategory), level(siteLevel), file(siteFile), line(siteLine) {
+    next = allSites.load(std::memory_order_relaxed);
+    while (!allSites.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+LogSite::Decision LogSite::admit(uint64_t hash) {
+    const uint64_t now = steadyNs();
+    const LogControl::State& cfg = LogControl::state();
+    const double rate = cfg.ratePerSecond.load(std::memory_order_relaxed);
+    const double burst = cfg.burst.load(std::memory_order_relaxed);
+    const uint64_t window = cfg.repeatWindowNs.load(std::memory_order_relaxed);
+
+    while (busy.test_and_set(std::memory_order_acquire)) { /* Held for a few dozen instructions */ }
+    Decision d;
+
+    if (tokens < 0.0) { tokens = burst; lastRefillNs = now; }
+    tokens = std::min(burst, tokens + static_cast<double>(now - lastRefillNs) * 1e-9 * rate);
+    lastRefillNs = now;
+
+    const bool same = lastPrintNs != 0 && hash == lastHash;
+    if (same && now - lastPrintNs < window) {
+        repeats++;
+        lastHeldNs = now;
+    } else if (tokens < 1.0) {
+        rateLimited++;
+        lastHeldNs = now;
+    } else {
+        tokens -= 1.0;
+        d.admitted = true;
+        if (same) d.sameRepeats = repeats;
+        else d.previousRepeats = repeats;
+        d.rateLimited = rateLimited;
+        repeats = 0;
+        rateLimited = 0;
+        lastHash = hash;
+        lastPrintNs = now;
+    }
+
+    busy.clear(std::memory_order_release);
+    return d;
+}
+
+void LogSite::flushPending(bool force) {
+    const uint64_t now = steadyNs();
+    const uint64_t window = LogControl::state().repeatWindowNs.load(std::memory_order_relaxed);
+    for (LogSite* site = allSites.load(std::memory_order_acquire); site; site = site->next) {
+        while (site->busy.test_and_set(std::memory_order_acquire)) {}
+        const bool due = (site->repeats > 0 || site->rateLimited > 0) && (force || now - site->lastHeldNs >= window);
+        const uint64_t repeats = due ? site->repeats : 0;
+        const uint64_t rateLimited = due ? site->rateLimited : 0;
+        if (due) { site->repeats = 0; site->rateLimited = 0; }
+        site->busy.clear(std::memory_order_release);
+        if (!due) continue;
+
+        // The message itself is not kept, the call site identifies it
+        const std::string_view path(site->file);
+        const std::string_view where = path.substr(path.find_last_of("/\\") + 1);
+        AsyncLogger& logger = AsyncLogger::Instance();
+        const char* tag = LogControl::name(site->category);
+        if (repeats > 0 && rateLimited > 0) logger.write(site->level, 1, tag, "Last message from ", where, ":", site->line, " repeated ", repeats, " times, ", rateLimited, " rate-limited");
+        else if (repeats > 0) logger.write(site->level, 1, tag, "Last message from ", where, ":", site->line, " repeated ", repeats, " times");
+        else logger.write(site->level, 1, tag, rateLimited, " messages from ", where, ":", site->line, " rate-limited");
+    }
+}
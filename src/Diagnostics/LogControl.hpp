@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "AsyncLogger.hpp"
+
+// Runtime log categories. Each category has its own level, changeable while running
+// (LogControl::setLevel, or RADCAT_LOG="ftdi=3,scan=2" in the environment at start-up).
+// Levels: 0=none, 1=errors, 2=warnings, 3=info. The compile-time DebugClass::debugLevel still caps everything.
+enum class LogCategory : uint8_t { General, FTDI, LibUsb, Scan, Device, Task, Serial, Network, Count };
+
+class LogControl {
+public:
+    static constexpr size_t CategoryCount = static_cast<size_t>(LogCategory::Count);
+
+    static bool enabled(LogCategory category, AsyncLogger::Level level) {
+        return static_cast<int>(level) <= state().levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(LogCategory category, int level) { state().levels[static_cast<size_t>(category)].store(level, std::memory_order_relaxed); }
+    static int getLevel(LogCategory category) { return state().levels[static_cast<size_t>(category)].load(std::memory_order_relaxed); }
+
+    // "ftdi=3,scan=1" or "*=2,task=3". Unknown names are reported and skipped. Returns false if any entry was invalid.
+    static bool configure(std::string_view spec);
+
+    // Per call site token bucket: burst messages at once, refilled at perSecond.
+    static void setRateLimit(double perSecond, double burst) {
+        state().ratePerSecond.store(perSecond, std::memory_order_relaxed);
+        state().burst.store(burst, std::memory_order_relaxed);
+    }
+    // Identical messages from one call site within this window are counted instead of printed.
+    static void setRepeatWindow(std::chrono::milliseconds window) { state().repeatWindowNs.store(static_cast<uint64_t>(window.count()) * 1000000ull, std::memory_order_relaxed); }
+
+    static const char* name(LogCategory category);
+
+private:
+    friend class LogSite;
+    struct State {
+        State();
+        std::array<std::atomic<int>, CategoryCount> levels;
+        std::atomic<double> ratePerSecond{5.0};
+        std::atomic<double> burst{20.0};
+        std::atomic<uint64_t> repeatWindowNs{1000000000ull};
+    };
+    static State& state() { static State s; return s; }
+};
+
+// State of one logging call site, created by the DEBUG_LOG/DEBUG_WARN/DEBUG_ERROR macros.
+// Costs one hash of the arguments and a short uncontended spin lock per admitted or dropped message.
+// Counts held back when a burst ends are written by the logger thread once the site has been quiet for the
+// repeat window (flushPending), the next message from the site does not have to come first.
+class LogSite {
+public:
+    LogSite(LogCategory category, AsyncLogger::Level level, const char* file, int line);
+
+    template<typename... Args> void submit(const Args&... args) {
+        uint64_t hash = 1469598103934665603ull;
+        (hashArg(hash, args), ...);
+        Decision d = admit(hash);
+        if (!d.admitted) return;
+
+        AsyncLogger& logger = AsyncLogger::Instance();
+        const char* tag = LogControl::name(category);
+        if (d.previousRepeats > 0) logger.write(level, 1, tag, "Previous message repeated ", d.previousRepeats, " times");
+        if (d.sameRepeats > 0 && d.rateLimited > 0) logger.write(level, 1, tag, args..., " [repeated ", d.sameRepeats, " times, ", d.rateLimited, " rate-limited]");
+        else if (d.sameRepeats > 0) logger.write(level, 1, tag, args..., " [repeated ", d.sameRepeats, " times]");
+        else if (d.rateLimited > 0) logger.write(level, 1, tag, args..., " [", d.rateLimited, " rate-limited]");
+        else logger.write(level, 1, tag, args...);
+    }
+
+    // Writes the summaries of sites that have been quiet for the repeat window, or of all sites with force.
+    // Called from the logger thread.
+    static void flushPending(bool force = false);
+
+private:
+    struct Decision {
+        bool admitted = false;
+        uint64_t previousRepeats = 0; // Collapsed copies of the previous (different) message
+        uint64_t sameRepeats = 0;     // Collapsed copies of this message since it was last printed
+        uint64_t rateLimited = 0;     // Messages dropped by the token bucket since the last print
+    };
+
+    Decision admit(uint64_t hash);
+
+    static void mix(uint64_t& h, const void* data, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+    }
+    template<typename T> static void hashArg(uint64_t& h, const T& v) {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (std::is_arithmetic_v<U> || std::is_enum_v<U> || (std::is_pointer_v<U> && !std::is_convertible_v<U, std::string_view>)) mix(h, &v, sizeof(U));
+        else if constexpr (std::is_convertible_v<const U&, std::string_view>) { std::string_view s(v); mix(h, s.data(), s.size()); }
+        else mix(h, "?", 1); // Other types do not take part in duplicate detection
+    }
+
+    const LogCategory category;
+    const AsyncLogger::Level level;
+    const char* const file;
+    const int line;
+    LogSite* next = nullptr;    // Sites are static and never go away, flushPending() walks this list
+    static inline std::atomic<LogSite*> allSites{nullptr};
+
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+    double tokens = -1.0;       // < 0: not initialized yet
+    uint64_t lastRefillNs = 0;
+    uint64_t lastHash = 0;
+    uint64_t lastPrintNs = 0;
+    uint64_t lastHeldNs = 0;    // Last message counted instead of printed
+    uint64_t repeats = 0;
+    uint64_t rateLimited = 0;
+};
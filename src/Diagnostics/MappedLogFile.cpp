@@ -0,0 +1,90 @@
+#include "MappedLogFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+// This file can not log through Debug (it is the logger's own sink), failures are reported on stderr.
+#include <cstdio>
+
+MappedLogFile::MappedLogFile(std::string filePath, size_t fileBytes, int maxFileCount)
+    : path(std::move(filePath)), capacity(std::max<size_t>(fileBytes, 4096)), maxFiles(std::max(maxFileCount, 1)) {
+    map();
+}
+
+MappedLogFile::~MappedLogFile() { unmap(); }
+
+bool MappedLogFile::map() {
+    used = 0;
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) { fileHandle = nullptr; std::fprintf(stderr, "MappedLogFile: can not create %s\n", path.c_str()); return false; }
+    const unsigned long long size = capacity;
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFFull), nullptr);
+    if (!mappingHandle) { CloseHandle(fileHandle); fileHandle = nullptr; std::fprintf(stderr, "MappedLogFile: can not map %s\n", path.c_str()); return false; }
+    base = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, capacity));
+    if (!base) { CloseHandle(mappingHandle); CloseHandle(fileHandle); mappingHandle = fileHandle = nullptr; return false; }
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { std::fprintf(stderr, "MappedLogFile: can not create %s\n", path.c_str()); return false; }
+    if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) { ::close(fd); fd = -1; return false; }
+    void* p = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) { ::close(fd); fd = -1; std::fprintf(stderr, "MappedLogFile: can not map %s\n", path.c_str()); return false; }
+    base = static_cast<char*>(p);
+#endif
+    return true;
+}
+
+// Unmaps and trims the file to the bytes actually written.
+void MappedLogFile::unmap() {
+    if (!base) return;
+#ifdef _WIN32
+    FlushViewOfFile(base, used);
+    UnmapViewOfFile(base);
+    CloseHandle(mappingHandle);
+    LARGE_INTEGER end; end.QuadPart = static_cast<LONGLONG>(used);
+    SetFilePointerEx(fileHandle, end, nullptr, FILE_BEGIN);
+    SetEndOfFile(fileHandle);
+    CloseHandle(fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    ::msync(base, capacity, MS_ASYNC);
+    ::munmap(base, capacity);
+    if (::ftruncate(fd, static_cast<off_t>(used)) != 0) std::fprintf(stderr, "MappedLogFile: can not trim %s\n", path.c_str());
+    ::close(fd);
+    fd = -1;
+#endif
+    base = nullptr;
+}
+
+void MappedLogFile::rotate() {
+    unmap();
+    std::error_code ec;
+    for (int i = maxFiles - 1; i >= 1; --i) {
+        std::string from = path + "." + std::to_string(i);
+        if (std::filesystem::exists(from, ec)) std::filesystem::rename(from, path + "." + std::to_string(i + 1), ec);
+    }
+    std::filesystem::rename(path, path + ".1", ec);
+    map();
+}
+
+void MappedLogFile::write(std::string_view text) {
+    while (!text.empty() && base) {
+        size_t n = std::min(text.size(), capacity - used);
+        std::memcpy(base + used, text.data(), n);
+        used += n;
+        text.remove_prefix(n);
+        if (used == capacity) rotate();
+    }
+}
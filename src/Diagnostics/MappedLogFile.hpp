@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Fixed-size memory-mapped log file with rotation. Writing is a memcpy into the mapping,
+// the OS pages it out in the background. When the file is full it is truncated to its used size,
+// shifted to path.1 (path.1 -> path.2, ... up to path.<maxFiles>) and a fresh mapping is started.
+class MappedLogFile {
+public:
+    MappedLogFile(std::string filePath, size_t fileBytes, int maxFiles);
+    ~MappedLogFile();
+    MappedLogFile(const MappedLogFile&) = delete;
+    MappedLogFile& operator=(const MappedLogFile&) = delete;
+
+    bool isOpen() const { return base != nullptr; }
+    void write(std::string_view text);
+
+private:
+    bool map();
+    void unmap();
+    void rotate();
+
+    std::string path;
+    size_t capacity;
+    int maxFiles;
+    size_t used = 0;
+    char* base = nullptr;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
@@ -0,0 +1,277 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace Metrics {
+
+    namespace Detail {
+        // Owns the calling thread's slots, folds them into the registry when the thread exits.
+        struct ThreadHolder {
+            std::unique_ptr<ThreadSlots> slots;
+            ~ThreadHolder() { localSlots = nullptr; }
+        };
+
+        ThreadSlots& registerThread() {
+            thread_local ThreadHolder holder;
+            if (!holder.slots) {
+                holder.slots = std::make_unique<ThreadSlots>();
+                Registry& reg = Registry::Instance();
+                std::lock_guard<std::mutex> lk(reg.mutex);
+                reg.threads.push_back(holder.slots.get());
+            }
+            localSlots = holder.slots.get();
+            return *holder.slots;
+        }
+
+        std::atomic<uint64_t>* ThreadSlots::allocate(uint32_t c) {
+            Page* page = pages[c >> PageBits].load(std::memory_order_relaxed);
+            if (!page) {
+                page = new Page();
+                pages[c >> PageBits].store(page, std::memory_order_release);
+            }
+            std::atomic<std::atomic<uint64_t>*>& entry = page->chunks[c & (PageChunks - 1)];
+            if (std::atomic<uint64_t>* existing = entry.load(std::memory_order_relaxed)) return existing;
+            auto* fresh = new std::atomic<uint64_t>[ChunkSlots]();
+            entry.store(fresh, std::memory_order_release);
+            return fresh;
+        }
+
+        ThreadSlots::~ThreadSlots() {
+            Registry& reg = Registry::Instance();
+            std::lock_guard<std::mutex> lk(reg.mutex);
+            reg.threads.erase(std::remove(reg.threads.begin(), reg.threads.end(), this), reg.threads.end());
+            for (uint32_t p = 0; p < MaxPages; ++p) {
+                Page* page = pages[p].load(std::memory_order_acquire);
+                if (!page) continue;
+                for (uint32_t c = 0; c < PageChunks; ++c) {
+                    std::atomic<uint64_t>* chunk = page->chunks[c].load(std::memory_order_acquire);
+                    if (!chunk) continue;
+                    const size_t first = (static_cast<size_t>(p) * PageChunks + c) << ChunkBits;
+                    if (reg.retired.size() < first + ChunkSlots) reg.retired.resize(first + ChunkSlots, 0);
+                    for (uint32_t i = 0; i < ChunkSlots; ++i) reg.retired[first + i] += chunk[i].load(std::memory_order_relaxed);
+                    delete[] chunk;
+                }
+                delete page;
+            }
+        }
+    }
+
+    namespace {
+        std::string renderLabels(const Labels& labels) {
+            std::string out;
+            for (const auto& [key, value] : labels) {
+                if (!out.empty()) out += ',';
+                out += key;
+                out += "=\"";
+                for (char c : value) {
+                    if (c == '\\' || c == '"') { out += '\\'; out += c; }
+                    else if (c == '\n') out += "\\n";
+                    else out += c;
+                }
+                out += '"';
+            }
+            return out;
+        }
+
+        // Smallest bucket bound below which at least q of the samples fall
+        uint64_t quantile(const uint64_t* buckets, uint64_t count, double q) {
+            if (count == 0) return 0;
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(count) + 0.5));
+            uint64_t seen = 0;
+            for (uint32_t b = 0; b < Histogram::Buckets; ++b) {
+                seen += buckets[b];
+                if (seen >= rank) return Histogram::bucketUpperBound(b);
+            }
+            return Histogram::bucketUpperBound(Histogram::Buckets - 1);
+        }
+
+        // Count, sum and percentiles of Histogram::Buckets counts followed by the sum
+        void fillHistogram(Sample& s, const uint64_t* buckets) {
+            uint64_t count = 0;
+            uint32_t last = 0;
+            for (uint32_t b = 0; b < Histogram::Buckets; ++b) if (buckets[b]) { count += buckets[b]; last = b; }
+            s.value = static_cast<double>(count);
+            s.sum = buckets[Histogram::Buckets];
+            s.p50 = quantile(buckets, count, 0.50);
+            s.p90 = quantile(buckets, count, 0.90);
+            s.p99 = quantile(buckets, count, 0.99);
+            s.max = count ? Histogram::bucketUpperBound(last) : 0;
+        }
+
+        void appendNumber(std::string& out, double v) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.9g", v);
+            out += buf;
+        }
+    }
+
+    uint64_t Histogram::bucketUpperBound(uint32_t b) {
+        if (b < 2 * SubBuckets) return b;
+        const uint32_t magnitude = (b - 2 * SubBuckets) / SubBuckets + SubBucketBits + 1;
+        const uint64_t sub = (b - 2 * SubBuckets) % SubBuckets;
+        const int shift = static_cast<int>(magnitude) - SubBucketBits;
+        return ((SubBuckets + sub) << shift) + (uint64_t{1} << shift) - 1;
+    }
+
+    uint64_t Counter::value() const {
+        Registry& reg = Registry::Instance();
+        std::lock_guard<std::mutex> lk(reg.mutex);
+        uint64_t total = id < reg.retired.size() ? reg.retired[id] : 0;
+        for (const Detail::ThreadSlots* t : reg.threads) {
+            const std::atomic<uint64_t>* chunk = t->chunk(id >> Detail::ChunkBits, std::memory_order_acquire);
+            if (chunk) total += chunk[id & (Detail::ChunkSlots - 1)].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    Registry& Registry::Instance() {
+        // Never destroyed, exiting threads still fold their slots into it during shutdown.
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    Registry::Entry& Registry::findOrAdd(Kind kind, const std::string& name, const std::string& help, const Labels& labels, uint32_t slotCount) {
+        std::string rendered = renderLabels(labels);
+        std::string key = name + "{" + rendered + "}" + static_cast<char>('0' + static_cast<int>(kind)); // Kind mismatches get their own slots
+        auto it = index.find(key);
+        if (it != index.end()) return entries[it->second];
+
+        if (slotCount > Detail::MaxSlots - nextSlot) {
+            // Out of slot ids. The metric still works for its caller, but records into the discard range.
+            if (discarded.empty()) std::fprintf(stderr, "Metrics: all %u slots taken, %s and later metrics are not exported\n", Detail::MaxSlots, name.c_str());
+            Entry& e = discarded.emplace_back();
+            e.kind = kind;
+            e.name = name;
+            return e;
+        }
+
+        Entry& e = entries.emplace_back();
+        e.kind = kind;
+        e.name = name;
+        e.help = help;
+        e.labels = std::move(rendered);
+        e.slot = nextSlot;
+        nextSlot += slotCount;
+        index.emplace(std::move(key), entries.size() - 1);
+        return e;
+    }
+
+    Counter& Registry::counter(const std::string& name, const std::string& help, const Labels& labels) {
+        std::lock_guard<std::mutex> lk(mutex);
+        Entry& e = findOrAdd(Kind::Counter, name, help, labels, 1);
+        if (!e.counter) e.counter.reset(new Counter(e.slot));
+        return *e.counter;
+    }
+
+    Gauge& Registry::gauge(const std::string& name, const std::string& help, const Labels& labels) {
+        std::lock_guard<std::mutex> lk(mutex);
+        Entry& e = findOrAdd(Kind::Gauge, name, help, labels, 0);
+        if (!e.gauge) e.gauge.reset(new Gauge());
+        return *e.gauge;
+    }
+
+    Histogram& Registry::histogram(const std::string& name, const std::string& help, const Labels& labels) {
+        std::lock_guard<std::mutex> lk(mutex);
+        Entry& e = findOrAdd(Kind::Histogram, name, help, labels, Histogram::Buckets + 1);
+        if (!e.histogram) e.histogram.reset(new Histogram(e.slot));
+        return *e.histogram;
+    }
+
+    std::vector<uint64_t> Registry::collect() const {
+        std::vector<uint64_t> totals(nextSlot, 0);
+        const size_t keep = std::min<size_t>(retired.size(), totals.size());
+        std::copy(retired.begin(), retired.begin() + keep, totals.begin());
+        for (const Detail::ThreadSlots* t : threads) {
+            for (uint32_t first = 0, c = 0; first < nextSlot; first += Detail::ChunkSlots, ++c) {
+                const std::atomic<uint64_t>* chunk = t->chunk(c, std::memory_order_acquire);
+                if (!chunk) continue;
+                const uint32_t n = std::min(Detail::ChunkSlots, nextSlot - first);
+                for (uint32_t i = 0; i < n; ++i) totals[first + i] += chunk[i].load(std::memory_order_relaxed);
+            }
+        }
+        return totals;
+    }
+
+    std::vector<Sample> Registry::snapshot() const {
+        std::lock_guard<std::mutex> lk(mutex);
+        const std::vector<uint64_t> totals = collect();
+        std::vector<Sample> out;
+        out.reserve(entries.size());
+        for (const Entry& e : entries) {
+            Sample s{ e.name, e.labels, e.kind };
+            switch (e.kind) {
+                case Kind::Counter: s.value = static_cast<double>(totals[e.slot]); break;
+                case Kind::Gauge:   s.value = e.gauge ? e.gauge->value() : 0.0; break;
+                case Kind::Histogram: fillHistogram(s, totals.data() + e.slot); break;
+            }
+            out.push_back(std::move(s));
+        }
+        return out;
+    }
+
+    std::vector<uint64_t> Registry::histogramTotals(const std::string& name) const {
+        std::lock_guard<std::mutex> lk(mutex);
+        const std::vector<uint64_t> totals = collect();
+        std::vector<uint64_t> out(Histogram::Buckets + 1, 0);
+        for (const Entry& e : entries) {
+            if (e.kind != Kind::Histogram || e.name != name) continue;
+            for (uint32_t b = 0; b <= Histogram::Buckets; ++b) out[b] += totals[e.slot + b];
+        }
+        return out;
+    }
+
+    Sample Registry::summarize(const std::string& name, const std::vector<uint64_t>& totals) {
+        Sample s{ name, {}, Kind::Histogram };
+        if (totals.size() == Histogram::Buckets + 1) fillHistogram(s, totals.data());
+        return s;
+    }
+
+    std::string Registry::prometheusText() const {
+        // Exported bucket bounds (seconds); the fine buckets are folded into these
+        static constexpr double bounds[] = { 1e-6, 1e-5, 5e-5, 1e-4, 5e-4, 1e-3, 5e-3, 1e-2, 5e-2, 0.1, 0.5, 1.0, 5.0, 10.0 };
+
+        std::lock_guard<std::mutex> lk(mutex);
+        const std::vector<uint64_t> totals = collect();
+        std::string out;
+        out.reserve(entries.size() * 128);
+
+        // Families are written together, HELP/TYPE once per name
+        std::vector<const Entry*> sorted;
+        sorted.reserve(entries.size());
+        for (const Entry& e : entries) sorted.push_back(&e);
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+        const std::string* lastName = nullptr;
+        for (const Entry* e : sorted) {
+            if (!lastName || *lastName != e->name) {
+                out += "# HELP "; out += e->name; out += ' '; out += e->help; out += '\n';
+                out += "# TYPE "; out += e->name;
+                out += e->kind == Kind::Counter ? " counter\n" : e->kind == Kind::Gauge ? " gauge\n" : " histogram\n";
+                lastName = &e->name;
+            }
+            const std::string braces = e->labels.empty() ? std::string() : "{" + e->labels + "}";
+            if (e->kind == Kind::Counter || e->kind == Kind::Gauge) {
+                out += e->name; out += braces; out += ' ';
+                appendNumber(out, e->kind == Kind::Counter ? static_cast<double>(totals[e->slot]) : e->gauge->value());
+                out += '\n';
+                continue;
+            }
+
+            const uint64_t* buckets = totals.data() + e->slot;
+            const std::string prefix = e->labels.empty() ? std::string() : e->labels + ",";
+            uint64_t cumulative = 0;
+            uint32_t b = 0;
+            for (double bound : bounds) {
+                const uint64_t limitNs = static_cast<uint64_t>(bound * 1e9);
+                for (; b < Histogram::Buckets && Histogram::bucketUpperBound(b) <= limitNs; ++b) cumulative += buckets[b];
+                out += e->name; out += "_bucket{"; out += prefix; out += "le=\""; appendNumber(out, bound); out += "\"} ";
+                appendNumber(out, static_cast<double>(cumulative)); out += '\n';
+            }
+            for (; b < Histogram::Buckets; ++b) cumulative += buckets[b];
+            out += e->name; out += "_bucket{"; out += prefix; out += "le=\"+Inf\"} "; appendNumber(out, static_cast<double>(cumulative)); out += '\n';
+            out += e->name; out += "_sum"; out += braces; out += ' '; appendNumber(out, static_cast<double>(buckets[Histogram::Buckets]) * 1e-9); out += '\n';
+            out += e->name; out += "_count"; out += braces; out += ' '; appendNumber(out, static_cast<double>(cumulative)); out += '\n';
+        }
+        return out;
+    }
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Run-time metrics: counters, gauges and latency histograms.
+//
+// Every metric owns a range of slot ids. Each thread writes into its own lazily allocated slot chunks
+// (a plain load + store, no locked instruction, no sharing), the reader sums all threads when a snapshot
+// is taken. Recording is a few nanoseconds and never blocks, so it can sit on the I/O hot paths.
+//
+// Usage:
+//   static Metrics::Counter& bytes = Metrics::Registry::Instance().counter("radcat_ftdi_tx_bytes_total", "Bytes written", {{"device", name}});
+//   bytes.add(n);
+//   { Metrics::ScopedTimer t(sendLatency); ... }
+namespace Metrics {
+
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+    using Clock = std::chrono::steady_clock;
+
+    namespace Detail {
+        constexpr uint32_t ChunkBits = 12;
+        constexpr uint32_t ChunkSlots = 1u << ChunkBits;
+        constexpr uint32_t PageBits = 10;
+        constexpr uint32_t PageChunks = 1u << PageBits; // 4M slots per page
+        constexpr uint32_t MaxPages = 64;
+        constexpr uint32_t MaxSlots = MaxPages * PageChunks * ChunkSlots; // Registration stops here, see Registry
+
+        // Slot storage of one thread: pages of chunk pointers, both allocated on first use. Only the owner
+        // allocates, and publishes with release. Ids are below MaxSlots, so no lookup can leave the tables.
+        struct ThreadSlots {
+            struct Page {
+                std::array<std::atomic<std::atomic<uint64_t>*>, PageChunks> chunks{};
+            };
+            std::array<std::atomic<Page*>, MaxPages> pages{};
+
+            std::atomic<uint64_t>* chunk(uint32_t c, std::memory_order order) const {
+                const Page* page = pages[c >> PageBits].load(order);
+                return page ? page->chunks[c & (PageChunks - 1)].load(order) : nullptr;
+            }
+            std::atomic<uint64_t>* allocate(uint32_t c);
+            ~ThreadSlots();
+        };
+
+        ThreadSlots& registerThread();
+        inline thread_local ThreadSlots* localSlots = nullptr;
+
+        inline void bump(uint32_t id, uint64_t v) {
+            ThreadSlots* t = localSlots;
+            if (!t) t = &registerThread();
+            std::atomic<uint64_t>* chunk = t->chunk(id >> ChunkBits, std::memory_order_relaxed);
+            if (!chunk) chunk = t->allocate(id >> ChunkBits);
+            std::atomic<uint64_t>& slot = chunk[id & (ChunkSlots - 1)];
+            slot.store(slot.load(std::memory_order_relaxed) + v, std::memory_order_relaxed); // Single writer
+        }
+    }
+
+    class Counter {
+    public:
+        void add(uint64_t v = 1) { Detail::bump(id, v); }
+        uint64_t value() const;
+    private:
+        friend class Registry;
+        explicit Counter(uint32_t slot) : id(slot) {}
+        uint32_t id;
+    };
+
+    class Gauge {
+    public:
+        void set(double v) { current.store(v, std::memory_order_relaxed); }
+        double value() const { return current.load(std::memory_order_relaxed); }
+    private:
+        friend class Registry;
+        Gauge() = default;
+        std::atomic<double> current{0.0};
+    };
+
+    // Log-linear (HDR-style) histogram of nanosecond values: exact below 32 ns, then 16 sub-buckets
+    // per power of two, so any recorded value is off by at most 1/16 (6.25 %). Covers up to ~39 hours.
+    class Histogram {
+    public:
+        static constexpr int SubBucketBits = 4;
+        static constexpr uint32_t SubBuckets = 1u << SubBucketBits;
+        static constexpr int MaxMagnitude = 47;
+        static constexpr uint32_t Buckets = 2 * SubBuckets + (MaxMagnitude - SubBucketBits) * SubBuckets;
+
+        static uint32_t bucketOf(uint64_t v) {
+            if (v < 2 * SubBuckets) return static_cast<uint32_t>(v);
+            int msb = 63 - std::countl_zero(v);
+            if (msb > MaxMagnitude) return Buckets - 1;
+            uint32_t sub = static_cast<uint32_t>(v >> (msb - SubBucketBits)) & (SubBuckets - 1);
+            return 2 * SubBuckets + static_cast<uint32_t>(msb - SubBucketBits - 1) * SubBuckets + sub;
+        }
+        static uint64_t bucketUpperBound(uint32_t b); // Largest value stored in bucket b
+
+        void record(uint64_t ns) {
+            Detail::bump(base + bucketOf(ns), 1);
+            Detail::bump(base + Buckets, ns); // Sum
+        }
+        void record(Clock::duration d) { record(static_cast<uint64_t>(d.count() < 0 ? 0 : std::chrono::duration_cast<std::chrono::nanoseconds>(d).count())); }
+        void recordSince(Clock::time_point start) { record(Clock::now() - start); }
+
+    private:
+        friend class Registry;
+        explicit Histogram(uint32_t slot) : base(slot) {}
+        uint32_t base; // Buckets slots, then the sum
+    };
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& h) : hist(h), start(Clock::now()) {}
+        ~ScopedTimer() { hist.recordSince(start); }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    private:
+        Histogram& hist;
+        Clock::time_point start;
+    };
+
+    enum class Kind { Counter, Gauge, Histogram };
+
+    // One metric as seen by the panel. Histogram values are in nanoseconds.
+    struct Sample {
+        std::string name;
+        std::string labels; // Rendered: device="Mini-X",task="voltage"
+        Kind kind;
+        double value = 0.0; // Counter total, gauge value or histogram count
+        uint64_t sum = 0;
+        uint64_t p50 = 0, p90 = 0, p99 = 0, max = 0;
+    };
+
+    class Registry {
+    public:
+        static Registry& Instance();
+
+        // Returns the existing metric when name and labels match, references stay valid for the program lifetime.
+        Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+        Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+        Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+        std::vector<Sample> snapshot() const;
+        // Bucket counts of a histogram family summed over all its label sets, the last element is the sum of
+        // the values. Subtract an earlier result to look at an interval only (fleet-wide percentiles in load runs).
+        std::vector<uint64_t> histogramTotals(const std::string& name) const;
+        static Sample summarize(const std::string& name, const std::vector<uint64_t>& totals);
+        std::string prometheusText() const; // Text exposition format 0.0.4
+
+    private:
+        friend struct Detail::ThreadSlots;
+        friend Detail::ThreadSlots& Detail::registerThread();
+        friend class Counter;
+        Registry() = default;
+
+        struct Entry {
+            Kind kind;
+            std::string name, help, labels;
+            uint32_t slot = 0;
+            std::unique_ptr<Counter> counter;
+            std::unique_ptr<Gauge> gauge;
+            std::unique_ptr<Histogram> histogram;
+        };
+
+        Entry& findOrAdd(Kind kind, const std::string& name, const std::string& help, const Labels& labels, uint32_t slotCount);
+        std::vector<uint64_t> collect() const; // Sum of every slot over all threads, requires mutex
+
+        // Slots [0, DiscardSlots) are never exported. Metrics registered once all MaxSlots are taken record there.
+        static constexpr uint32_t DiscardSlots = Histogram::Buckets + 1;
+
+        mutable std::mutex mutex;
+        std::deque<Entry> entries;
+        std::map<std::string, size_t> index; // name{labels} -> entries
+        std::deque<Entry> discarded;         // Registered past the slot table, kept so their references stay valid
+        uint32_t nextSlot = DiscardSlots;
+        std::vector<Detail::ThreadSlots*> threads;
+        std::vector<uint64_t> retired; // Totals of threads that have exited
+    };
+}
@@ -0,0 +1,113 @@
+#include "MetricsEndpoint.hpp"
+#include "Metrics.hpp"
+#include "Debug.hpp"
+#include <string>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    using SocketHandle = SOCKET;
+    static void closeSocket(SocketHandle s) { closesocket(s); }
+    static constexpr SocketHandle invalidSocket = INVALID_SOCKET;
+    static void setTimeouts(SocketHandle s, int ms) {
+        DWORD timeout = static_cast<DWORD>(ms);
+        ::setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        ::setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    }
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+    using SocketHandle = int;
+    static void closeSocket(SocketHandle s) { ::close(s); }
+    static constexpr SocketHandle invalidSocket = -1;
+    static void setTimeouts(SocketHandle s, int ms) {
+        timeval timeout{ ms / 1000, (ms % 1000) * 1000 };
+        ::setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+#endif
+
+bool MetricsEndpoint::start(uint16_t port) {
+    if (running.load(std::memory_order_acquire)) return true;
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) { Debug.Error("MetricsEndpoint: WSAStartup failed."); return false; }
+#endif
+    SocketHandle s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == invalidSocket) { Debug.Error("MetricsEndpoint: can not create socket."); return false; }
+
+    int reuse = 1;
+    ::setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(s, 4) != 0) {
+        Debug.Warn("MetricsEndpoint: port ", port, " is not available, metrics endpoint disabled.");
+        closeSocket(s);
+        return false;
+    }
+
+    listenSocket = static_cast<intptr_t>(s);
+    running.store(true, std::memory_order_release);
+    server = std::thread(&MetricsEndpoint::serve, this);
+    Debug.Log("Metrics endpoint listening on http://127.0.0.1:", port, "/metrics");
+    return true;
+}
+
+void MetricsEndpoint::stop() {
+    if (!running.exchange(false, std::memory_order_acq_rel)) return;
+    if (server.joinable()) server.join();
+    closeSocket(static_cast<SocketHandle>(listenSocket));
+    listenSocket = -1;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void MetricsEndpoint::serve() {
+    const SocketHandle s = static_cast<SocketHandle>(listenSocket);
+    while (running.load(std::memory_order_acquire)) {
+        // Wake up every 200 ms to notice stop()
+#ifdef _WIN32
+        WSAPOLLFD pfd{ s, POLLRDNORM, 0 };
+        if (WSAPoll(&pfd, 1, 200) <= 0) continue;
+#else
+        pollfd pfd{ s, POLLIN, 0 };
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+#endif
+        SocketHandle client = ::accept(s, nullptr, nullptr);
+        if (client == invalidSocket) continue;
+        // Same budget for the client: one that sends nothing or stops reading is dropped instead of blocking stop()
+        setTimeouts(client, 200);
+
+        // The request itself does not matter, every path gets the metrics
+        char request[1024];
+        ::recv(client, request, sizeof(request), 0);
+
+        const std::string body = Metrics::Registry::Instance().prometheusText();
+        std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: ";
+        response += std::to_string(body.size());
+        response += "\r\nConnection: close\r\n\r\n";
+        response += body;
+
+        int flags = 0;
+#ifdef MSG_NOSIGNAL
+        flags = MSG_NOSIGNAL; // A scraper hanging up must not kill the process
+#endif
+        size_t sent = 0;
+        while (sent < response.size()) {
+            int n = ::send(client, response.data() + sent, static_cast<int>(response.size() - sent), flags);
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        closeSocket(client);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+// Serves Metrics::Registry as Prometheus text on http://127.0.0.1:<port>/metrics.
+// Loopback only; one short-lived connection at a time is plenty for a scraper or curl.
+class MetricsEndpoint {
+public:
+    static MetricsEndpoint& Instance() { static MetricsEndpoint instance; return instance; }
+
+    static constexpr uint16_t defaultPort = 9464;
+
+    bool start(uint16_t port = defaultPort);
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+private:
+    MetricsEndpoint() = default;
+    ~MetricsEndpoint() { stop(); }
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    void serve();
+
+    std::atomic<bool> running{false};
+    std::thread server;
+    intptr_t listenSocket = -1;
+};
@@ -0,0 +1,308 @@
+#include "MpsseAnalyzer.hpp"
+#include "Simulation/MpsseEngine.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+namespace {
+    // Shift opcode bits (AN_108 section 3.2)
+    constexpr uint8_t BitMode = 0x02;
+    constexpr uint8_t WriteTdi = 0x10;
+    constexpr uint8_t ReadTdo = 0x20;
+    constexpr uint8_t WriteTms = 0x40;
+    constexpr uint8_t MpsseBitMode = 0x02; // setBitMode mode value
+
+    // Pins are not needed, only command lengths, replies and clocking time
+    class PassiveTarget : public MpsseTarget {
+    public:
+        bool clockBit(bool) override { return false; }
+    };
+
+    // Engine settings the analysis tracks for redundancy. A value only counts as known once set.
+    struct KnownState {
+        int lowPins = -1, highPins = -1; // levels | direction << 8
+        int divisor = -1;
+        int div5 = -1, threePhase = -1, adaptive = -1, loopback = -1;
+    };
+
+    // Compact command names for operation shapes. Periodic runs are folded: "gpio*3", "(wr4bit gpio rd2b)*32".
+    struct ShapeBuilder {
+        std::vector<std::string> tokens;
+        void add(std::string token) { tokens.push_back(std::move(token)); }
+        std::string take() {
+            constexpr size_t MaxPeriod = 8;
+            std::string text;
+            size_t i = 0;
+            while (i < tokens.size()) {
+                size_t bestPeriod = 1, bestRepeats = 1;
+                for (size_t k = 1; k <= MaxPeriod && i + 2 * k <= tokens.size(); ++k) {
+                    size_t repeats = 1;
+                    while (i + (repeats + 1) * k <= tokens.size()
+                           && std::equal(tokens.begin() + i, tokens.begin() + i + k, tokens.begin() + i + repeats * k)) repeats++;
+                    if (repeats > 1 && repeats * k > bestRepeats * bestPeriod) { bestPeriod = k; bestRepeats = repeats; }
+                }
+                if (!text.empty()) text += ' ';
+                if (bestPeriod > 1) text += '(';
+                for (size_t j = 0; j < bestPeriod; ++j) { if (j) text += ' '; text += tokens[i + j]; }
+                if (bestPeriod > 1) text += ')';
+                if (bestRepeats > 1) text += '*' + std::to_string(bestRepeats);
+                i += bestPeriod * bestRepeats;
+            }
+            tokens.clear();
+            return text;
+        }
+    };
+
+    std::string shiftToken(uint8_t op, size_t count, const char* unit) {
+        const char* dir = (op & WriteTdi) && (op & ReadTdo) ? "rw" : (op & ReadTdo) ? "rd" : "wr";
+        return std::string(dir) + std::to_string(count) + unit;
+    }
+
+    bool setKnown(int& known, int value) {
+        const bool redundant = known == value;
+        known = value;
+        return redundant;
+    }
+
+    // Classifies one complete command and updates the counters
+    void classify(const uint8_t* cmd, MpsseAnalyzer::DeviceReport& r, KnownState& state, ShapeBuilder& shape) {
+        const uint8_t op = cmd[0];
+        r.commands++;
+        const bool shift = !(op & 0x80) && (op & (WriteTdi | ReadTdo | WriteTms));
+        if (shift) {
+            if ((op & WriteTms) && (op & BitMode)) { r.bitShifts++; r.bitsShifted += cmd[1] + 1u; shape.add("tms"); }
+            else if (op & BitMode) { r.bitShifts++; r.bitsShifted += cmd[1] + 1u; shape.add(shiftToken(op, cmd[1] + 1u, "bit")); }
+            else {
+                const size_t n = (static_cast<size_t>(cmd[1]) | static_cast<size_t>(cmd[2]) << 8) + 1;
+                r.byteShifts++;
+                r.bytesShifted += n;
+                shape.add(shiftToken(op, n, "b"));
+            }
+            return;
+        }
+        bool modeRedundant = false;
+        switch (op) {
+            case 0x80: r.gpioSets++; if (setKnown(state.lowPins, cmd[1] | cmd[2] << 8)) r.gpioSetsRedundant++; shape.add("gpio"); return;
+            case 0x82: r.gpioSets++; if (setKnown(state.highPins, cmd[1] | cmd[2] << 8)) r.gpioSetsRedundant++; shape.add("gpio"); return;
+            case 0x81: case 0x83: r.gpioReads++; shape.add("gpin"); return;
+            case 0x86: r.divisorSets++; if (setKnown(state.divisor, cmd[1] | cmd[2] << 8)) r.divisorSetsRedundant++; shape.add("div"); return;
+            case 0x87: r.sendImmediates++; shape.add("imm"); return;
+            case 0x8E: r.bitShifts++; r.bitsShifted += cmd[1] + 1u; shape.add("tck"); return;
+            case 0x8F: r.bitShifts++; r.bitsShifted += ((static_cast<uint64_t>(cmd[1]) | static_cast<uint64_t>(cmd[2]) << 8) + 1) * 8; shape.add("tck"); return;
+            case 0x8A: case 0x8B: modeRedundant = setKnown(state.div5, op == 0x8B); break;
+            case 0x8C: case 0x8D: modeRedundant = setKnown(state.threePhase, op == 0x8C); break;
+            case 0x96: case 0x97: modeRedundant = setKnown(state.adaptive, op == 0x96); break;
+            case 0x84: case 0x85: modeRedundant = setKnown(state.loopback, op == 0x84); break;
+            case 0x88: case 0x89: case 0x94: case 0x95: case 0x9C: case 0x9D: case 0x9E: shape.add("misc"); return;
+            default: r.invalidCommands++; shape.add("bad"); return;
+        }
+        r.clockModeSets++;
+        if (modeRedundant) r.clockModeRedundant++;
+        shape.add("clk");
+    }
+
+    MpsseAnalyzer::Distribution distribution(std::vector<double>& values) {
+        MpsseAnalyzer::Distribution d;
+        d.count = values.size();
+        if (values.empty()) return d;
+        std::sort(values.begin(), values.end());
+        auto at = [&](double q) { return values[std::min(values.size() - 1, static_cast<size_t>(q * static_cast<double>(values.size())))]; };
+        d.p50 = at(0.50);
+        d.p90 = at(0.90);
+        d.p99 = at(0.99);
+        d.max = values.back();
+        d.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        return d;
+    }
+
+    MpsseAnalyzer::DeviceReport analyzeStream(const Capture::File& capture, const Capture::Stream& stream, const MpsseAnalyzer::Options& options) {
+        MpsseAnalyzer::DeviceReport r;
+        r.stream = stream;
+
+        PassiveTarget target;
+        MpsseEngine engine(target);
+        std::vector<uint8_t> reply;
+        std::vector<uint8_t> pending; // Command split across writes
+        KnownState state;
+        bool mpsse = false;
+        uint64_t busNs = 0;
+
+        ShapeBuilder commandShape;
+        std::string opShape;
+        std::map<std::string, MpsseAnalyzer::Shape> shapes;
+        std::vector<double> gapsIn, gapsBetween, durations;
+
+        bool inOperation = false;
+        uint64_t opStart = 0, lastEnd = 0, firstStart = 0;
+        uint64_t opTransfers = 0, totalTransfers = 0, turnarounds = 0;
+        size_t outstanding = 0;   // Reply bytes the host has not read yet
+        bool replyDrained = false; // The last read collected the whole reply
+        bool lastWasWrite = false;
+
+        auto endOperation = [&]() {
+            if (!inOperation) return;
+            const double us = static_cast<double>(lastEnd - opStart) / 1e3;
+            durations.push_back(us);
+            r.operationMs += us / 1e3;
+            MpsseAnalyzer::Shape& s = shapes[opShape];
+            s.count++;
+            s.meanDurationUs += us; // Sum for now
+            s.transfers = static_cast<int>(opTransfers);
+            r.maxTransfersPerOperation = std::max(r.maxTransfersPerOperation, opTransfers);
+            inOperation = false;
+        };
+
+        for (const Capture::Transfer& t : capture.transfers) {
+            if (t.stream != stream.id) continue;
+
+            if (t.direction == Capture::Direction::Control) {
+                const auto op = static_cast<Capture::FtdiOp>(t.endpoint);
+                if (op == Capture::FtdiOp::BitMode && t.data.size() >= 8) {
+                    uint32_t mode;
+                    std::memcpy(&mode, t.data.data() + 4, sizeof(mode));
+                    mpsse = mode == MpsseBitMode;
+                }
+                if (op == Capture::FtdiOp::BitMode || op == Capture::FtdiOp::Reset) {
+                    if (op == Capture::FtdiOp::Reset) mpsse = false;
+                    engine.reset();
+                    pending.clear();
+                    state = KnownState{};
+                    outstanding = 0;
+                }
+                else if (op == Capture::FtdiOp::Purge) outstanding = 0;
+                continue;
+            }
+
+            // Operation boundaries: a write after a collected reply, or after a pause, starts a new one
+            const bool write = t.direction == Capture::Direction::Out;
+            const uint64_t start = t.timeNs - std::min<uint64_t>(t.durationNs, t.timeNs);
+            const uint64_t gap = totalTransfers && start > lastEnd ? start - lastEnd : 0;
+            if (totalTransfers == 0) firstStart = start;
+            else if (inOperation && outstanding == 0 && (replyDrained || gap > options.operationGapNs) && (write || gap > options.operationGapNs)) {
+                endOperation();
+                gapsBetween.push_back(static_cast<double>(gap) / 1e3);
+            }
+            else gapsIn.push_back(static_cast<double>(gap) / 1e3);
+            if (!inOperation) { inOperation = true; opStart = start; opTransfers = 0; opShape.clear(); lastWasWrite = false; replyDrained = false; r.operations++; }
+            lastEnd = t.timeNs;
+            totalTransfers++;
+            opTransfers++;
+            r.transferMs += static_cast<double>(t.durationNs) / 1e6;
+            if (t.status != 0) r.failed++;
+            if (!opShape.empty()) opShape += ' ';
+
+            if (write) {
+                r.writes++;
+                r.bytesOut += t.data.size();
+                lastWasWrite = true;
+                replyDrained = false;
+                if (!mpsse) { r.bytesOutsideMpsse += t.data.size(); opShape += 'W'; opShape += std::to_string(t.data.size()); continue; }
+
+                pending.insert(pending.end(), t.data.begin(), t.data.end());
+                size_t pos = 0;
+                while (pos < pending.size()) {
+                    const size_t len = MpsseEngine::commandLength(pending.data() + pos, pending.size() - pos);
+                    if (len == 0 || pos + len > pending.size()) break;
+                    classify(pending.data() + pos, r, state, commandShape);
+                    pos += len;
+                }
+                pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(pos));
+                reply.clear();
+                engine.write(t.data.data(), t.data.size(), reply);
+                outstanding += reply.size();
+                busNs += engine.takeBusTimeNs();
+                opShape += "W["; opShape += commandShape.take(); opShape += ']';
+            }
+            else {
+                r.reads++;
+                r.bytesIn += t.data.size();
+                if (t.data.empty()) r.emptyReads++;
+                if (lastWasWrite) turnarounds++;
+                lastWasWrite = false;
+                outstanding -= std::min(outstanding, t.data.size());
+                replyDrained = outstanding == 0 && !t.data.empty();
+                opShape += 'R'; opShape += std::to_string(t.data.size());
+            }
+        }
+        endOperation();
+
+        r.spanMs = totalTransfers ? static_cast<double>(lastEnd - firstStart) / 1e6 : 0.0;
+        r.busMs = static_cast<double>(busNs) / 1e6;
+        if (r.operations) {
+            r.transfersPerOperation = static_cast<double>(totalTransfers) / static_cast<double>(r.operations);
+            r.turnaroundsPerOperation = static_cast<double>(turnarounds) / static_cast<double>(r.operations);
+        }
+        if (r.operationMs > 0.0) {
+            r.payloadBytesPerSecond = static_cast<double>(r.bytesOut + r.bytesIn) / (r.operationMs / 1e3);
+            r.serialBytesPerSecond = (static_cast<double>(r.bytesShifted) + static_cast<double>(r.bitsShifted) / 8.0) / (r.operationMs / 1e3);
+        }
+        r.gapInOperation = distribution(gapsIn);
+        r.gapBetweenOperations = distribution(gapsBetween);
+        r.operationDuration = distribution(durations);
+
+        for (auto& [signature, s] : shapes) {
+            s.signature = signature;
+            s.meanDurationUs /= static_cast<double>(s.count);
+            r.shapes.push_back(s);
+        }
+        std::sort(r.shapes.begin(), r.shapes.end(), [](const MpsseAnalyzer::Shape& a, const MpsseAnalyzer::Shape& b) { return a.count > b.count; });
+        if (r.shapes.size() > options.topShapes) r.shapes.resize(options.topShapes);
+        return r;
+    }
+
+    double percent(uint64_t part, uint64_t whole) { return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0; }
+}
+
+std::vector<MpsseAnalyzer::DeviceReport> MpsseAnalyzer::analyze(const Capture::File& capture, const Options& options) {
+    std::vector<DeviceReport> reports;
+    for (const Capture::Stream& s : capture.streams) {
+        if (s.bus == Capture::Bus::Ftdi) reports.push_back(analyzeStream(capture, s, options));
+    }
+    return reports;
+}
+
+void MpsseAnalyzer::print(const std::vector<DeviceReport>& reports, std::FILE* out) {
+    for (const DeviceReport& r : reports) {
+        std::fprintf(out, "\n%s [%s], stream %u\n", r.stream.description.c_str(), r.stream.serial.c_str(), r.stream.id);
+        std::fprintf(out, "  transfers     %llu writes (%llu B), %llu reads (%llu B, %llu empty), %llu failed\n",
+                     static_cast<unsigned long long>(r.writes), static_cast<unsigned long long>(r.bytesOut),
+                     static_cast<unsigned long long>(r.reads), static_cast<unsigned long long>(r.bytesIn),
+                     static_cast<unsigned long long>(r.emptyReads), static_cast<unsigned long long>(r.failed));
+        std::fprintf(out, "  operations    %llu, %.2f round trips each (max %llu), %.2f waits for a reply\n",
+                     static_cast<unsigned long long>(r.operations), r.transfersPerOperation,
+                     static_cast<unsigned long long>(r.maxTransfersPerOperation), r.turnaroundsPerOperation);
+        std::fprintf(out, "  commands      %llu: %llu gpio sets, %llu gpio reads, %llu divisor, %llu clock mode, %llu byte shifts (%llu B), %llu bit shifts (%llu bits), %llu send immediate, %llu invalid\n",
+                     static_cast<unsigned long long>(r.commands), static_cast<unsigned long long>(r.gpioSets),
+                     static_cast<unsigned long long>(r.gpioReads), static_cast<unsigned long long>(r.divisorSets),
+                     static_cast<unsigned long long>(r.clockModeSets), static_cast<unsigned long long>(r.byteShifts),
+                     static_cast<unsigned long long>(r.bytesShifted), static_cast<unsigned long long>(r.bitShifts),
+                     static_cast<unsigned long long>(r.bitsShifted), static_cast<unsigned long long>(r.sendImmediates),
+                     static_cast<unsigned long long>(r.invalidCommands));
+        std::fprintf(out, "  redundant     gpio %llu (%.1f%%), divisor %llu (%.1f%%), clock mode %llu (%.1f%%)\n",
+                     static_cast<unsigned long long>(r.gpioSetsRedundant), percent(r.gpioSetsRedundant, r.gpioSets),
+                     static_cast<unsigned long long>(r.divisorSetsRedundant), percent(r.divisorSetsRedundant, r.divisorSets),
+                     static_cast<unsigned long long>(r.clockModeRedundant), percent(r.clockModeRedundant, r.clockModeSets));
+        if (r.bytesOutsideMpsse) std::fprintf(out, "  outside MPSSE %llu B\n", static_cast<unsigned long long>(r.bytesOutsideMpsse));
+        auto share = [](double part, double whole) { return whole > 0.0 ? 100.0 * part / whole : 0.0; };
+        std::fprintf(out, "  time          span %.1f ms, in operations %.1f ms (%.1f%%)\n", r.spanMs, r.operationMs, share(r.operationMs, r.spanMs));
+        std::fprintf(out, "  op time       %.1f%% in transfer calls, %.1f%% idle between them, serial clocking %.2f ms (%.1f%%)\n",
+                     share(r.transferMs, r.operationMs), share(std::max(r.operationMs - r.transferMs, 0.0), r.operationMs),
+                     r.busMs, share(r.busMs, r.operationMs));
+        auto dist = [out](const char* name, const Distribution& d) {
+            if (!d.count) return;
+            std::fprintf(out, "  %-13s n %-8llu mean %9.1f  p50 %9.1f  p90 %9.1f  p99 %9.1f  max %9.1f us\n", name,
+                         static_cast<unsigned long long>(d.count), d.mean, d.p50, d.p90, d.p99, d.max);
+        };
+        dist("operation", r.operationDuration);
+        dist("gap in op", r.gapInOperation);
+        dist("gap between", r.gapBetweenOperations);
+        std::fprintf(out, "  throughput    %.1f kB/s USB payload, %.1f kB/s serial, per second of operation time\n",
+                     r.payloadBytesPerSecond / 1e3, r.serialBytesPerSecond / 1e3);
+        if (!r.shapes.empty()) std::fprintf(out, "  top operations:\n");
+        for (const Shape& s : r.shapes) {
+            std::fprintf(out, "    %6llu x  %2d transfers  %9.1f us  %s\n", static_cast<unsigned long long>(s.count), s.transfers,
+                         s.meanDurationUs, s.signature.c_str());
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TrafficCapture.hpp"
+
+// Transaction-efficiency analysis of captured MPSSE traffic (TrafficCapture files), per FTDI device.
+//
+// Every write is decoded command by command (command lengths, reply sizes and bus timing come from the
+// simulator's MpsseEngine, so the analysis and the simulation agree on the protocol) and transfers are
+// grouped into logical operations: the writes up to a reply plus the reads that collect it. Writes that
+// expect no reply join the operation before them unless more than Options::operationGap passed.
+// The report answers where a driver's USB time goes:
+// - Round trips: transfers per operation, and turnarounds (a write whose reply the host then waits for).
+// - Redundancy: GPIO sets that repeat the current pin state, clock divisor and clock mode commands that
+//   repeat the current setting (e.g. a divisor set at the start of every frame).
+// - Idle gaps between transfers inside operations (host-side processing) and between operations.
+// - Achieved throughput: USB payload and serial clocking per second of operation time.
+//
+// Usage (or the MpsseAnalyze tool):
+//   Capture::File capture;
+//   Capture::load("field.rcap", capture);
+//   MpsseAnalyzer::print(MpsseAnalyzer::analyze(capture), stdout);
+namespace MpsseAnalyzer {
+
+    struct Options {
+        uint64_t operationGapNs = 2'000'000; // A longer pause before a write starts a new operation
+        size_t topShapes = 8;                // Most frequent operation shapes listed per device
+    };
+
+    struct Distribution {
+        uint64_t count = 0;
+        double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0, mean = 0.0; // Microseconds
+    };
+
+    // Operations with the same sequence of transfers and commands, e.g. "W[div gpio*3 rd16b imm] R16"
+    struct Shape {
+        std::string signature;
+        uint64_t count = 0;
+        double meanDurationUs = 0.0;
+        int transfers = 0;
+    };
+
+    struct DeviceReport {
+        Capture::Stream stream;
+
+        // Transfers
+        uint64_t writes = 0, reads = 0, emptyReads = 0, failed = 0;
+        uint64_t bytesOut = 0, bytesIn = 0;
+
+        // Operations
+        uint64_t operations = 0;
+        double transfersPerOperation = 0.0;
+        double turnaroundsPerOperation = 0.0;
+        uint64_t maxTransfersPerOperation = 0;
+
+        // Commands
+        uint64_t commands = 0;
+        uint64_t gpioSets = 0, gpioSetsRedundant = 0, gpioReads = 0;
+        uint64_t divisorSets = 0, divisorSetsRedundant = 0;
+        uint64_t clockModeSets = 0, clockModeRedundant = 0; // Divide-by-5, 3-phase, adaptive, loopback
+        uint64_t byteShifts = 0, bytesShifted = 0;
+        uint64_t bitShifts = 0, bitsShifted = 0;            // Including TMS and clock-only commands
+        uint64_t sendImmediates = 0, invalidCommands = 0;   // Invalid includes the 0xAA/0xAB sync probes
+        uint64_t bytesOutsideMpsse = 0;                     // Written before MPSSE mode was entered
+
+        // Time
+        double spanMs = 0.0;      // First to last transfer
+        double operationMs = 0.0; // Sum of operation durations, first transfer start to last transfer end
+        double transferMs = 0.0;  // Inside write and read calls (needs a version 2 capture)
+        double busMs = 0.0;       // Serial clocking at the configured TCK rate
+        Distribution gapInOperation;       // From the end of one transfer to the start of the next
+        Distribution gapBetweenOperations;
+        Distribution operationDuration;
+        double payloadBytesPerSecond = 0.0; // USB payload (out + in) per second of operation time
+        double serialBytesPerSecond = 0.0;  // Bytes clocked on the serial bus per second of operation time
+
+        std::vector<Shape> shapes;
+    };
+
+    std::vector<DeviceReport> analyze(const Capture::File& capture, const Options& options = {});
+    void print(const std::vector<DeviceReport>& reports, std::FILE* out);
+}
@@ -0,0 +1,159 @@
+#include "Trace.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Trace {
+
+    namespace {
+        constexpr size_t SpansPerThread = 16384;
+        constexpr size_t DetailSize = 48;
+
+        struct Span {
+            const char* category;
+            const char* name;
+            uint64_t startNs;
+            uint64_t endNs;
+            char detail[DetailSize];
+        };
+
+        // One per thread. The owner only contends with an export, which is rare.
+        struct ThreadBuffer {
+            std::mutex mutex;
+            std::unique_ptr<Span[]> spans; // Allocated on the first recorded span
+            uint64_t written = 0; // Total spans, next index is written % SpansPerThread
+            uint32_t tid = 0;
+            std::string threadName;
+        };
+
+        struct Collector {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers; // Kept after thread exit so late exports still see them
+            uint32_t nextTid = 1;
+        };
+        Collector& collector() { static Collector* c = new Collector(); return *c; }
+
+        ThreadBuffer& localBuffer() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+            if (!buffer) {
+                buffer = std::make_shared<ThreadBuffer>();
+                Collector& c = collector();
+                std::lock_guard<std::mutex> lk(c.mutex);
+                buffer->tid = c.nextTid++;
+                c.buffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+
+        void appendEscaped(std::string& out, std::string_view text) {
+            for (char ch : text) {
+                switch (ch) {
+                    case '"':  out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    default:
+                        if (static_cast<unsigned char>(ch) < 0x20) { char buf[8]; std::snprintf(buf, sizeof(buf), "\\u%04x", ch); out += buf; }
+                        else out += ch;
+                }
+            }
+        }
+    }
+
+    uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void setEnabled(bool enabled) {
+        enabledFlag.store(enabled, std::memory_order_relaxed);
+        Debug.Log("Tracing ", enabled ? "enabled." : "disabled.");
+    }
+
+    void setThreadName(std::string_view name) {
+        ThreadBuffer& b = localBuffer();
+        std::lock_guard<std::mutex> lk(b.mutex);
+        b.threadName = name;
+    }
+
+    void record(const char* category, const char* name, std::string_view detail, uint64_t startNs, uint64_t endNs) {
+        ThreadBuffer& b = localBuffer();
+        std::lock_guard<std::mutex> lk(b.mutex);
+        if (!b.spans) b.spans = std::make_unique<Span[]>(SpansPerThread);
+        Span& s = b.spans[b.written % SpansPerThread];
+        s.category = category;
+        s.name = name;
+        s.startNs = startNs;
+        s.endNs = endNs;
+        const size_t n = std::min(detail.size(), DetailSize - 1);
+        std::memcpy(s.detail, detail.data(), n);
+        s.detail[n] = '\0';
+        b.written++;
+    }
+
+    void clear() {
+        Collector& c = collector();
+        std::lock_guard<std::mutex> lk(c.mutex);
+        for (auto& b : c.buffers) {
+            std::lock_guard<std::mutex> blk(b->mutex);
+            b->written = 0;
+        }
+    }
+
+    bool exportChromeJson(const std::string& path, double windowSeconds) {
+        const uint64_t now = nowNs();
+        const uint64_t from = windowSeconds > 0.0 ? now - std::min<uint64_t>(now, static_cast<uint64_t>(windowSeconds * 1e9)) : 0;
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            Collector& c = collector();
+            std::lock_guard<std::mutex> lk(c.mutex);
+            buffers = c.buffers;
+        }
+
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        char buf[160];
+        size_t spans = 0;
+        for (auto& b : buffers) {
+            std::lock_guard<std::mutex> lk(b->mutex);
+            if (!b->threadName.empty()) {
+                if (!first) out += ",\n";
+                first = false;
+                std::snprintf(buf, sizeof(buf), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"", b->tid);
+                out += buf;
+                appendEscaped(out, b->threadName);
+                out += "\"}}";
+            }
+            const uint64_t count = b->spans ? std::min<uint64_t>(b->written, SpansPerThread) : 0;
+            for (uint64_t i = b->written - count; i < b->written; ++i) {
+                const Span& s = b->spans[i % SpansPerThread];
+                if (s.endNs < from) continue;
+                if (!first) out += ",\n";
+                first = false;
+                std::snprintf(buf, sizeof(buf), "{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"cat\":\"",
+                              b->tid, static_cast<double>(s.startNs) / 1e3, static_cast<double>(s.endNs - s.startNs) / 1e3);
+                out += buf;
+                appendEscaped(out, s.category);
+                out += "\",\"name\":\"";
+                appendEscaped(out, s.name);
+                out += '"';
+                if (s.detail[0]) { out += ",\"args\":{\"detail\":\""; appendEscaped(out, s.detail); out += "\"}"; }
+                out += '}';
+                spans++;
+            }
+        }
+        out += "\n]}\n";
+
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) { Debug.Error("Trace export: can not open ", path); return false; }
+        const bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        std::fclose(f);
+        if (ok) Debug.Log("Trace export: ", spans, " spans written to ", path);
+        else Debug.Error("Trace export: write to ", path, " failed");
+        return ok;
+    }
+}
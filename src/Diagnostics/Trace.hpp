@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Span tracing with Chrome trace JSON export (opens in chrome://tracing and ui.perfetto.dev).
+//
+//   RC_TRACE_SCOPE("ftdi", "send");                    // Names must be string literals
+//   RC_TRACE_SCOPE_DETAIL("task", "run", task.name);   // Detail text is copied (up to 47 chars)
+//
+// Off by default. While disabled a span costs one relaxed load. While enabled each thread records
+// into its own fixed-size circular buffer (oldest spans are overwritten), so a trace always holds
+// the most recent activity and can be exported for a chosen window after the interesting moment.
+namespace Trace {
+
+    inline std::atomic<bool> enabledFlag{false};
+    inline bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    // Label of the calling thread in the exported trace ("logic", "ui", ...)
+    void setThreadName(std::string_view name);
+
+    // Writes the spans that ended in the last windowSeconds (0 = everything buffered) as Chrome JSON.
+    bool exportChromeJson(const std::string& path, double windowSeconds = 0.0);
+
+    // Drops all buffered spans
+    void clear();
+
+    uint64_t nowNs();
+    void record(const char* category, const char* name, std::string_view detail, uint64_t startNs, uint64_t endNs);
+
+    class Scope {
+    public:
+        Scope(const char* category, const char* name) : cat(category), label(name), active(isEnabled()) { if (active) start = nowNs(); }
+        Scope(const char* category, const char* name, std::string_view detailText) : Scope(category, name) { if (active) detail = detailText; }
+        Scope(const char* category, const char* name, const char* detailText) : Scope(category, name) { detailCStr = detailText; } // strlen only when recorded
+        ~Scope() { if (active) record(cat, label, detailCStr ? std::string_view(detailCStr) : detail, start, nowNs()); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        const char* cat;
+        const char* label;
+        std::string_view detail; // Must outlive the scope, copied when the span is recorded
+        const char* detailCStr = nullptr;
+        uint64_t start = 0;
+        bool active;
+    };
+}
+
+#define RC_TRACE_CONCAT_INNER(a, b) a##b
+#define RC_TRACE_CONCAT(a, b) RC_TRACE_CONCAT_INNER(a, b)
+#define RC_TRACE_SCOPE(CATEGORY, NAME) ::Trace::Scope RC_TRACE_CONCAT(rcTraceScope, __LINE__)(CATEGORY, NAME)
+#define RC_TRACE_SCOPE_DETAIL(CATEGORY, NAME, DETAIL) ::Trace::Scope RC_TRACE_CONCAT(rcTraceScope, __LINE__)(CATEGORY, NAME, DETAIL)
@@ -0,0 +1,260 @@
+#include "TrafficCapture.hpp"
+#include "Debug.hpp"
+#include "Utils/SchedulerClock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+// File layout, little-endian:
+//   header:   "RCAP" u16 version, u16 reserved, u64 start (system_clock ns since epoch)
+//   records:  u8 type, then
+//     Stream   (1): u32 id, u8 bus, u16 vid, u16 pid, u32 deviceType, u8 busNumber, u8 ports, ports[],
+//                   u16 descriptionLength, description, u16 serialLength, serial, u64 timeNs
+//     Transfer (2): u32 stream, u64 timeNs, u32 durationNs (version 2), u8 direction, u8 endpoint, i32 status, u32 length, payload
+//     Close    (3): u32 stream, u64 timeNs
+//     Gap      (4): u64 transfers dropped since the previous gap record
+namespace {
+    enum RecordType : uint8_t { StreamRecord = 1, TransferRecord = 2, CloseRecord = 3, GapRecord = 4 };
+
+    constexpr size_t HeaderBytes = 16;
+    constexpr size_t TransferHeaderBytes = 1 + 4 + 8 + 4 + 1 + 1 + 4 + 4;
+    constexpr auto flushInterval = std::chrono::milliseconds(50);
+    constexpr size_t flushThreshold = 1u << 20; // Wake the writer early once this much is pending
+
+    template<typename T> void put(std::vector<uint8_t>& out, T value) {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T)); // Little-endian hosts only, like the drivers
+    }
+
+    void putString(std::vector<uint8_t>& out, const std::string& s) {
+        const uint16_t len = static_cast<uint16_t>(std::min<size_t>(s.size(), 0xFFFF));
+        put(out, len);
+        out.insert(out.end(), s.begin(), s.begin() + len);
+    }
+
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+        template<typename T> bool get(T& value) {
+            if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+        bool bytes(size_t n, const uint8_t*& at) {
+            if (static_cast<size_t>(end - p) < n) return false;
+            at = p;
+            p += n;
+            return true;
+        }
+        bool string(std::string& s) {
+            uint16_t len;
+            const uint8_t* at;
+            if (!get(len) || !bytes(len, at)) return false;
+            s.assign(reinterpret_cast<const char*>(at), len);
+            return true;
+        }
+    };
+}
+
+bool TrafficCapture::start(const std::string& path, size_t bufferBytes) {
+    std::lock_guard<std::mutex> state(stateMutex);
+    if (file) { Debug.Warn("Traffic capture already running"); return false; }
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) { Debug.Error("Could not create capture file ", path); return false; }
+
+    std::vector<uint8_t> header(Capture::Magic, Capture::Magic + 4);
+    put(header, Capture::Version);
+    put(header, uint16_t{0});
+    put(header, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+    if (std::fwrite(header.data(), 1, header.size(), f) != header.size()) { std::fclose(f); Debug.Error("Could not write capture file ", path); return false; }
+
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        pending.clear();
+        pending.reserve(std::min<size_t>(bufferBytes, flushThreshold * 4));
+        capacity = bufferBytes;
+        nextStream = 1;
+        startTicks = SchedulerClock::current().now().time_since_epoch().count();
+        stopping = false;
+    }
+    file = f;
+    dropped = 0;
+    written = HeaderBytes;
+    writer = std::thread(&TrafficCapture::writerLoop, this);
+    active.store(true, std::memory_order_release);
+    Debug.Log("Capturing device traffic to ", path);
+    return true;
+}
+
+void TrafficCapture::stop() {
+    std::lock_guard<std::mutex> state(stateMutex);
+    if (!file) return;
+    active.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
+    std::fclose(file);
+    file = nullptr;
+    if (dropped.load() > 0) Debug.Warn("Traffic capture dropped ", dropped.load(), " transfers, the buffer was full");
+}
+
+uint64_t TrafficCapture::timestamp() const {
+    const int64_t ticks = SchedulerClock::current().now().time_since_epoch().count() - startTicks;
+    return ticks > 0 ? static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(SchedulerClock::Clock::duration(ticks)).count()) : 0;
+}
+
+uint32_t TrafficCapture::openStream(const Capture::Stream& info) {
+    if (!isActive()) return 0;
+    std::vector<uint8_t> rec;
+    rec.push_back(StreamRecord);
+    std::lock_guard<std::mutex> lk(mutex);
+    const uint32_t id = nextStream++;
+    put(rec, id);
+    put(rec, static_cast<uint8_t>(info.bus));
+    put(rec, info.vid);
+    put(rec, info.pid);
+    put(rec, info.deviceType);
+    put(rec, info.busNumber);
+    put(rec, static_cast<uint8_t>(std::min<size_t>(info.portPath.size(), 0xFF)));
+    rec.insert(rec.end(), info.portPath.begin(), info.portPath.begin() + std::min<size_t>(info.portPath.size(), 0xFF));
+    putString(rec, info.description);
+    putString(rec, info.serial);
+    put(rec, timestamp());
+    // Stream records are small and a replay is useless without them, so they may exceed the bound
+    pending.insert(pending.end(), rec.begin(), rec.end());
+    return id;
+}
+
+void TrafficCapture::closeStream(uint32_t stream) {
+    if (!stream || !isActive()) return;
+    std::vector<uint8_t> rec;
+    rec.push_back(CloseRecord);
+    put(rec, stream);
+    std::lock_guard<std::mutex> lk(mutex);
+    put(rec, timestamp());
+    pending.insert(pending.end(), rec.begin(), rec.end());
+}
+
+void TrafficCapture::record(uint32_t stream, Capture::Direction direction, uint8_t endpoint, int32_t status, const void* data, size_t size,
+                            uint64_t startedNs) {
+    if (!stream || !isActive()) return;
+    const uint32_t length = static_cast<uint32_t>(data ? size : 0);
+    std::lock_guard<std::mutex> lk(mutex);
+    if (pending.size() + TransferHeaderBytes + length > capacity) { dropped.fetch_add(1, std::memory_order_relaxed); return; }
+    const size_t at = pending.size();
+    pending.push_back(TransferRecord);
+    put(pending, stream);
+    const uint64_t now = timestamp(); // Under the lock: timestamps are in file order
+    put(pending, now);
+    put(pending, static_cast<uint32_t>(startedNs <= now ? std::min<uint64_t>(now - startedNs, 0xFFFFFFFFu) : 0));
+    put(pending, static_cast<uint8_t>(direction));
+    put(pending, endpoint);
+    put(pending, status);
+    put(pending, length);
+    if (length) pending.insert(pending.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + length);
+    if (at < flushThreshold && pending.size() >= flushThreshold) wake.notify_one();
+}
+
+void TrafficCapture::writerLoop() {
+    uint64_t droppedReported = 0;
+    std::unique_lock<std::mutex> lk(mutex);
+    for (;;) {
+        wake.wait_for(lk, flushInterval, [this] { return stopping || pending.size() >= flushThreshold; });
+        scratch.clear();
+        scratch.swap(pending); // Producers continue into the (reserved) scratch buffer of the last round
+        const bool last = stopping;
+        lk.unlock();
+
+        const uint64_t d = dropped.load(std::memory_order_relaxed);
+        if (d != droppedReported) {
+            scratch.push_back(GapRecord);
+            put(scratch, d - droppedReported);
+            droppedReported = d;
+        }
+        if (!scratch.empty()) {
+            if (std::fwrite(scratch.data(), 1, scratch.size(), file) != scratch.size()) Debug.Error("Traffic capture write failed");
+            written.fetch_add(scratch.size(), std::memory_order_relaxed);
+        }
+        if (last) { std::fflush(file); return; }
+        lk.lock();
+    }
+}
+
+bool Capture::load(const std::string& path, File& out, std::string* error) {
+    auto fail = [error](const char* message) { if (error) *error = message; return false; };
+    out = File{};
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return fail("cannot open file");
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[1 << 16];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) bytes.insert(bytes.end(), chunk, chunk + n);
+    std::fclose(f);
+
+    Reader r{ bytes.data(), bytes.data() + bytes.size() };
+    const uint8_t* magic;
+    uint16_t version, reserved;
+    if (!r.bytes(4, magic) || std::memcmp(magic, Magic, 4) != 0) return fail("not a RadCat capture");
+    if (!r.get(version) || !r.get(reserved) || !r.get(out.startUnixNs)) return fail("truncated header");
+    if (version < 1 || version > Version) return fail("unsupported capture version");
+
+    std::unordered_map<uint32_t, size_t> streamIndex; // Stream id -> index in out.streams, ids come from the file
+    while (r.p < r.end) {
+        const uint8_t* recordStart = r.p;
+        uint8_t type;
+        r.get(type);
+        bool ok = false;
+        if (type == StreamRecord) {
+            Stream s;
+            uint8_t bus, ports;
+            const uint8_t* path;
+            ok = r.get(s.id) && r.get(bus) && r.get(s.vid) && r.get(s.pid) && r.get(s.deviceType) && r.get(s.busNumber)
+                && r.get(ports) && r.bytes(ports, path) && r.string(s.description) && r.string(s.serial) && r.get(s.openedNs);
+            if (ok) {
+                s.bus = static_cast<Bus>(bus);
+                s.portPath.assign(path, path + ports);
+                streamIndex[s.id] = out.streams.size();
+                out.streams.push_back(std::move(s));
+            }
+        }
+        else if (type == TransferRecord) {
+            Transfer t;
+            uint8_t direction;
+            uint32_t length;
+            const uint8_t* payload;
+            ok = r.get(t.stream) && r.get(t.timeNs) && (version < 2 || r.get(t.durationNs)) && r.get(direction) && r.get(t.endpoint) && r.get(t.status) && r.get(length) && r.bytes(length, payload);
+            if (ok) {
+                t.direction = static_cast<Direction>(direction);
+                t.data.assign(payload, payload + length);
+                out.transfers.push_back(std::move(t));
+            }
+        }
+        else if (type == CloseRecord) {
+            uint32_t id;
+            uint64_t t;
+            ok = r.get(id) && r.get(t);
+            if (ok) {
+                const auto it = streamIndex.find(id);
+                if (it != streamIndex.end()) out.streams[it->second].closedNs = t;
+            }
+        }
+        else if (type == GapRecord) {
+            uint64_t count;
+            ok = r.get(count);
+            if (ok) out.droppedTransfers += count;
+        }
+        else {
+            if (error) *error = "unknown record type";
+            out.truncated = true;
+            return !out.streams.empty();
+        }
+        if (!ok) { r.p = recordStart; out.truncated = true; break; }
+    }
+    return true;
+}
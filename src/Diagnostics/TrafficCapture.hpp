@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Raw device traffic capture (.rcap files), for reproducing field problems offline.
+//
+// CaptureFTDITransport and CaptureUsbBackend (CompHandlers/CaptureTransport.hpp) sit in front of the real
+// transport and report every open, transfer and configuration call here. Each record carries a timestamp
+// (SchedulerClock, ns since start()), direction, endpoint or operation, status and the exact payload.
+// ReplayFTDITransport and ReplayUsbBackend (Simulation/ReplayTransport.hpp) feed a capture back to the drivers.
+//
+// Off by default. While stopped a call costs one relaxed load. While running, callers append to a bounded
+// in-memory buffer under a short lock (one lock keeps the order of transfers across threads, which replay
+// depends on) and a background thread writes it out. When the buffer is full the transfer is dropped
+// and counted, and the file gets a gap record so a replay knows it is incomplete.
+//
+// Usage:
+//   TrafficCapture::Instance().start("field.rcap");
+//   FTDIHandler::Instance().wrapTransport([](auto inner) { return std::make_unique<CaptureFTDITransport>(std::move(inner)); });
+//   ... run ...
+//   TrafficCapture::Instance().stop();
+namespace Capture {
+
+    enum class Bus : uint8_t { Ftdi = 0, Usb = 1 };
+    enum class Direction : uint8_t { Out = 0, In = 1, Control = 2 };
+
+    // Endpoint field of Control records
+    enum class FtdiOp : uint8_t { Reset = 1, Purge, UsbParameters, LatencyTimer, Timeouts, FlowControl, BitMode };
+    enum class UsbOp : uint8_t { ClaimInterface = 1, ReleaseInterface };
+
+    // One opened device handle
+    struct Stream {
+        uint32_t id = 0;
+        Bus bus = Bus::Ftdi;
+        uint16_t vid = 0;
+        uint16_t pid = 0;
+        uint32_t deviceType = 0;       // FTDI: FT_DEVICE (devInfo.Type), USB: bcdDevice
+        std::string description;       // FTDI description, USB product string
+        std::string serial;
+        uint8_t busNumber = 0;         // USB only
+        std::vector<uint8_t> portPath; // USB only
+        uint64_t openedNs = 0;
+        uint64_t closedNs = 0;         // 0 while open when the capture ended
+    };
+
+    struct Transfer {
+        uint32_t stream = 0;
+        uint64_t timeNs = 0;           // When the call returned
+        uint32_t durationNs = 0;       // Time spent inside the transport call (writes and reads only)
+        Direction direction = Direction::Out;
+        uint8_t endpoint = 0;          // USB endpoint address, FTDI 0, Control: the FtdiOp / UsbOp
+        int32_t status = 0;            // FT_STATUS or libusb result
+        std::vector<uint8_t> data;     // Out: bytes sent, In: bytes received, Control: the arguments
+    };
+
+    struct File {
+        uint64_t startUnixNs = 0;
+        std::vector<Stream> streams;
+        std::vector<Transfer> transfers; // In capture order
+        uint64_t droppedTransfers = 0;   // Sum of the gap records
+        bool truncated = false;          // The file ended inside a record (capture not stopped cleanly)
+    };
+
+    // Reads a capture written by TrafficCapture. A truncated tail is tolerated, everything before it is kept.
+    bool load(const std::string& path, File& out, std::string* error = nullptr);
+
+    constexpr char Magic[4] = {'R', 'C', 'A', 'P'};
+    constexpr uint16_t Version = 2; // 1: transfers without durationNs, still readable
+}
+
+class TrafficCapture {
+public:
+    static TrafficCapture& Instance() { static TrafficCapture instance; return instance; }
+
+    // Creates the file and starts recording. bufferBytes bounds the data waiting for the writer.
+    bool start(const std::string& path, size_t bufferBytes = 64u << 20);
+    // Writes everything recorded so far and closes the file
+    void stop();
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    // Returns the stream id for the records of a newly opened handle, 0 while stopped
+    uint32_t openStream(const Capture::Stream& info);
+    void closeStream(uint32_t stream);
+    // startedNs: timestamp() taken before the transport call, for the duration of writes and reads
+    void record(uint32_t stream, Capture::Direction direction, uint8_t endpoint, int32_t status, const void* data, size_t size,
+                uint64_t startedNs = NoStart);
+    // Capture time (SchedulerClock, ns since start())
+    uint64_t timestamp() const;
+    static constexpr uint64_t NoStart = ~0ull;
+
+    uint64_t droppedTransfers() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return written.load(std::memory_order_relaxed); }
+
+private:
+    TrafficCapture() = default;
+    ~TrafficCapture() { stop(); }
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    void writerLoop();
+
+    std::atomic<bool> active{false};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> written{0};
+
+    std::mutex mutex; // Guards pending and the capture state after it
+    std::condition_variable wake;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> scratch; // Writer thread only
+    size_t capacity = 0;
+    uint32_t nextStream = 1;
+    int64_t startTicks = 0; // SchedulerClock time of start()
+    bool stopping = false;
+
+    std::mutex stateMutex; // Serializes start() and stop()
+    std::FILE* file = nullptr;
+    std::thread writer;
+};
@@ -3,8 +3,10 @@
 #include <QThread>
 #include <QDebug>
 #include "System.hpp"
+#include "Diagnostics/Trace.hpp"
 
 void LogicManager::start() {
+    Trace::setThreadName("logic");
     system = new System();
     QTimer* timer = new QTimer(this); 
     connect(timer, &QTimer::timeout, this, &LogicManager::mainLoop); 
@@ -1,5 +1,10 @@
 #include "MainWindow.hpp"
 #include "LogicThread.hpp"
+#include "LivePlotWidget.hpp"
+#include "MetricsPanel.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <QDockWidget>
+#include <QFileDialog>
 #include <QMenuBar>
 
 
@@ -8,9 +13,16 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     resize(1200, 1000);
     QIcon icon(":/Main_Icon.png");
     setWindowIcon(icon);
+    Trace::setThreadName("ui");
 
-    QWidget* centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
+    livePlot = new LivePlotWidget(this);
+    setCentralWidget(livePlot);
+
+    metricsPanel = new MetricsPanel(this);
+    metricsDock = new QDockWidget("Metrics", this);
+    metricsDock->setWidget(metricsPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, metricsDock);
+    metricsDock->hide();
 
     setupMenuBar();
 
@@ -31,6 +43,17 @@ void MainWindow::setupMenuBar() {
 
     MenuBarStyle();
     //Menu Actions here:
+    viewMenu->addAction(metricsDock->toggleViewAction());
+
+    QAction* recordTrace = fileMenu->addAction("Record Trace");
+    recordTrace->setCheckable(true);
+    recordTrace->setChecked(Trace::isEnabled());
+    connect(recordTrace, &QAction::toggled, this, [](bool on) { Trace::setEnabled(on); });
+    QAction* exportTrace = fileMenu->addAction("Export Trace (last 30 s)...");
+    connect(exportTrace, &QAction::triggered, this, [this] {
+        QString path = QFileDialog::getSaveFileName(this, "Export Trace", "radcat-trace.json", "Chrome/Perfetto trace (*.json)");
+        if (!path.isEmpty()) Trace::exportChromeJson(path.toStdString(), 30.0);
+    });
 }
 
 void MainWindow::MenuBarStyle() {
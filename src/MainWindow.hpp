@@ -4,6 +4,9 @@
 #include <QMainWindow>
 
 class LogicManager;
+class LivePlotWidget;
+class MetricsPanel;
+class QDockWidget;
 class QMenuBar;
 
 class MainWindow : public QMainWindow { 
@@ -16,6 +19,9 @@ public:
 private:
     QThread logicThread;
     LogicManager* logicManager;
+    LivePlotWidget* livePlot;
+    MetricsPanel* metricsPanel;
+    QDockWidget* metricsDock;
 
     void setupMenuBar();
     void MenuBarStyle();
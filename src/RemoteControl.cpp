@@ -0,0 +1,336 @@
+#include "RemoteControl.hpp"
+#include "DeviceHandler.hpp"
+#include "Debug.hpp"
+#include "Diagnostics/Metrics.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <bit>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "The remote control protocol is little-endian");
+
+using namespace RemoteProtocol;
+
+namespace {
+    struct RemoteMetrics {
+        Metrics::Counter& requests;
+        Metrics::Counter& updates;
+        Metrics::Gauge& clients;
+    };
+
+    RemoteMetrics& metrics() {
+        Metrics::Registry& reg = Metrics::Registry::Instance();
+        static RemoteMetrics m{
+            reg.counter("radcat_remote_requests_total", "Remote control requests executed"),
+            reg.counter("radcat_remote_updates_total", "Subscription updates sent to remote control clients"),
+            reg.gauge("radcat_remote_clients", "Connected remote control clients") };
+        return m;
+    }
+
+    EventLoop::StreamMetrics streamMetrics() {
+        Metrics::Registry& reg = Metrics::Registry::Instance();
+        return { reg.counter("radcat_remote_rx_bytes_total", "Bytes received from remote control clients"),
+                 reg.counter("radcat_remote_tx_bytes_total", "Bytes sent to remote control clients"),
+                 reg.counter("radcat_remote_overrun_bytes_total", "Received bytes dropped because a client's receive buffer was full") };
+    }
+
+    uint64_t wallClockNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+#ifndef _WIN32
+    // Non-blocking listening socket on 127.0.0.1, bound is set to the port it got
+    int listenTcp(uint16_t port, uint16_t& bound) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) { Debug.Error("Remote control: can not create socket: ", std::strerror(errno)); return -1; }
+        const int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        socklen_t length = sizeof(addr);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 8) != 0
+            || getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+            Debug.Error("Remote control: can not listen on port ", port, ": ", std::strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+        bound = ntohs(addr.sin_port);
+        return fd;
+    }
+
+    int listenUnix(const std::string& path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) { Debug.Error("Remote control: socket path too long: ", path); return -1; }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        // A socket left behind by a crashed run would block the bind, anything else at that path is not ours
+        struct stat existing{};
+        if (::lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) ::unlink(path.c_str());
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 8) != 0) {
+            Debug.Error("Remote control: can not listen on ", path, ": ", std::strerror(errno));
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Next waiting connection, -1 if there is none
+    int acceptOne(int listener) {
+        const int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return -1;
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets
+        return fd;
+    }
+
+    void closeSocket(int fd) { if (fd >= 0) ::close(fd); }
+    void removeSocketFile(const std::string& path) { ::unlink(path.c_str()); }
+#else
+    int listenTcp(uint16_t port, uint16_t&) {
+        Debug.Error("Remote control is not supported on this platform yet, can not listen on port ", port);
+        return -1;
+    }
+    int listenUnix(const std::string& path) {
+        Debug.Error("Remote control is not supported on this platform yet, can not listen on ", path);
+        return -1;
+    }
+    int acceptOne(int) { return -1; }
+    void closeSocket(int) {}
+    void removeSocketFile(const std::string&) {}
+#endif
+}
+
+RemoteControl::Client::Client(std::unique_ptr<EventLoop::Stream> connection)
+: stream(std::move(connection)), frames({ .sync = {}, .lengthSize = 4, .bigEndian = false, .headerSize = 4, .maxFrameSize = MaxFrameSize }) {}
+
+bool RemoteControl::start(const Config& newConfig) {
+    if (running) return true;
+    if (!newConfig.enabled) { Debug.Log("Remote control disabled."); return true; }
+    config = newConfig;
+    running = true;
+    if (config.tcp && (tcpListener = listenTcp(config.tcpPort, tcpPort)) < 0) { stop(); return false; }
+    if (!config.unixPath.empty() && (unixListener = listenUnix(config.unixPath)) < 0) { stop(); return false; }
+    if (tcpListener >= 0) DEBUG_LOG(LogCategory::Network, "Remote control listening on 127.0.0.1:", tcpPort, ".");
+    if (unixListener >= 0) DEBUG_LOG(LogCategory::Network, "Remote control listening on ", config.unixPath, ".");
+    return true;
+}
+
+void RemoteControl::stop() {
+    if (!running) return;
+    running = false;
+    for (auto& client : clients) closeClient(*client);
+    if (!clients.empty()) metrics().clients.set(0.0);
+    clients.clear();
+    closeSocket(tcpListener);
+    if (unixListener >= 0) {
+        closeSocket(unixListener);
+        removeSocketFile(config.unixPath);
+    }
+    tcpListener = unixListener = -1;
+    tcpPort = 0;
+}
+
+size_t RemoteControl::service(DeviceHandler& devices) {
+    if (!running) return 0;
+    acceptClients(tcpListener, "tcp");
+    acceptClients(unixListener, "unix");
+    size_t executed = 0;
+    for (size_t i = 0; i < clients.size();) {
+        if (serviceClient(*clients[i], devices, executed)) { ++i; continue; }
+        closeClient(*clients[i]);
+        clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i));
+        metrics().clients.set(static_cast<double>(clients.size()));
+    }
+    if (executed) metrics().requests.add(executed);
+    return executed;
+}
+
+void RemoteControl::acceptClients(int listener, const char* kind) {
+    if (listener < 0) return;
+    for (int fd; (fd = acceptOne(listener)) >= 0;) {
+        if (clients.size() >= config.maxClients) {
+            Debug.Warn("Remote control: ", clients.size(), " clients connected already, refusing another.");
+            closeSocket(fd);
+            continue;
+        }
+        auto stream = std::make_unique<EventLoop::Stream>(std::string("remote ") + kind + " #" + std::to_string(nextClient++), fd, true,
+                                                          config.clientBufferSize, config.clientBufferSize, streamMetrics());
+        if (!EventLoop::Instance().attach(*stream)) { EventLoop::Instance().detach(*stream); continue; } // Closes the socket
+        DEBUG_LOG(LogCategory::Network, "Remote control client connected: ", stream->name, ".");
+        clients.push_back(std::make_unique<Client>(std::move(stream)));
+        metrics().clients.set(static_cast<double>(clients.size()));
+    }
+}
+
+void RemoteControl::closeClient(Client& client) {
+    EventLoop::Instance().detach(*client.stream);
+    DEBUG_LOG(LogCategory::Network, "Remote control client disconnected: ", client.stream->name, ".");
+}
+
+// Runs the requests queued on one connection and sends their responses with the due updates in one write
+bool RemoteControl::serviceClient(Client& client, DeviceHandler& devices, size_t& executed) {
+    EventLoop::Stream& stream = *client.stream;
+    if (stream.overruns.load(std::memory_order_relaxed) > 0) {
+        Debug.Warn("Remote control: ", stream.name, " sent more than its receive buffer holds, dropping it.");
+        return false;
+    }
+    client.out.clear();
+    const uint64_t badFrames = client.frames.badFrameCount();
+    const size_t used = client.frames.parse(stream.rx.readable(), [&](std::span<const uint8_t> frame) {
+        if (client.frames.badFrameCount() != badFrames) return; // Out of step, the rest is not to be trusted
+        execute(client, devices, frame);
+        executed++;
+    });
+    stream.rx.consume(used);
+    if (client.frames.badFrameCount() != badFrames) {
+        Debug.Warn("Remote control: ", stream.name, " sent a frame longer than ", MaxFrameSize, " bytes, dropping it.");
+        return false;
+    }
+    if (stream.hasFailed()) return false; // Hung up, what it sent last has been run
+    sendUpdates(client, devices);
+    if (client.out.empty()) return true;
+    RC_TRACE_SCOPE_DETAIL("remote", "respond", stream.name);
+    if (EventLoop::Instance().write(stream, client.out)) return true;
+    Debug.Warn("Remote control: ", stream.name, " does not read its responses, dropping it.");
+    return false;
+}
+
+void RemoteControl::execute(Client& client, DeviceHandler& devices, std::span<const uint8_t> frame) {
+    Reader in(frame.subspan(4));
+    const uint32_t id = in.u32();
+    const Op op = static_cast<Op>(in.u8());
+
+    // Results are written right behind the header, an error takes them back and only sets the status
+    Writer out(client.out);
+    out.begin(id, static_cast<uint8_t>(Status::Ok));
+    const size_t resultsAt = client.out.size();
+    Status status = in.ok() ? Status::Ok : Status::BadRequest;
+
+    auto deviceAt = [&](uint16_t index) { return index < devices.activeDevices.size() ? devices.activeDevices[index].get() : nullptr; };
+    // Arguments complete and the device exists, otherwise the status says why not
+    auto valid = [&](EmptyDevice* device) {
+        if (!in.done()) status = Status::BadRequest;
+        else if (!device) status = Status::NoSuchDevice;
+        return status == Status::Ok;
+    };
+
+    if (status == Status::Ok) switch (op) {
+        case Op::Ping:
+            if (!in.done()) status = Status::BadRequest;
+            break;
+        case Op::ListDevices: {
+            if (!in.done()) { status = Status::BadRequest; break; }
+            const size_t count = std::min<size_t>(devices.activeDevices.size(), 0xFFFF);
+            out.u16(static_cast<uint16_t>(count));
+            for (size_t i = 0; i < count; ++i) {
+                const EmptyDevice& device = *devices.activeDevices[i];
+                out.u16(static_cast<uint16_t>(i));
+                out.u8(device.isInitialized ? 1 : 0);
+                out.u8(device.tasksActive ? 1 : 0);
+                out.str(device.instanceName);
+            }
+            break;
+        }
+        case Op::ReadValue: {
+            EmptyDevice* device = deviceAt(in.u16());
+            const std::string parameter(in.str());
+            if (!valid(device)) break;
+            out.f64(device->readValue(parameter));
+            break;
+        }
+        case Op::SetValue: {
+            EmptyDevice* device = deviceAt(in.u16());
+            const std::string parameter(in.str());
+            const double value = in.f64();
+            if (!valid(device)) break;
+            DEBUG_LOG(LogCategory::Network, "Remote control: ", device->instanceName, " ", parameter, " = ", value);
+            if (!device->setValue(parameter, value)) status = Status::Rejected;
+            break;
+        }
+        case Op::ListTasks: {
+            EmptyDevice* device = deviceAt(in.u16());
+            if (!valid(device)) break;
+            const std::vector<EmptyDevice::TaskInfo> tasks = device->getTaskList();
+            out.u8(device->tasksActive ? 1 : 0);
+            out.u16(static_cast<uint16_t>(std::min<size_t>(tasks.size(), 0xFFFF)));
+            for (size_t i = 0; i < tasks.size() && i < 0xFFFF; ++i) {
+                out.str(tasks[i].name);
+                out.i32(tasks[i].intervalMs);
+            }
+            break;
+        }
+        case Op::SetTasksActive: {
+            EmptyDevice* device = deviceAt(in.u16());
+            const bool active = in.u8() != 0;
+            if (!valid(device)) break;
+            device->tasksActive = active;
+            break;
+        }
+        case Op::SetTaskInterval: {
+            EmptyDevice* device = deviceAt(in.u16());
+            const std::string task(in.str());
+            const int32_t intervalMs = in.i32();
+            if (!valid(device)) break;
+            if (intervalMs < 0) status = Status::BadRequest;
+            else if (!device->setTaskInterval(task, intervalMs)) status = Status::NoSuchTask;
+            break;
+        }
+        case Op::Subscribe: {
+            const uint16_t index = in.u16();
+            std::string parameter(in.str());
+            const uint32_t periodMs = in.u32();
+            if (!valid(deviceAt(index))) break;
+            // Renewing a subscription replaces it. The first update goes out with this response.
+            std::erase_if(client.subscriptions, [id](const Subscription& s) { return s.id == id; });
+            const auto period = std::chrono::milliseconds(std::max<int64_t>(periodMs, config.minSubscriptionPeriodMs));
+            client.subscriptions.push_back({ id, index, std::move(parameter), period, std::chrono::steady_clock::now() });
+            break;
+        }
+        case Op::Unsubscribe: {
+            const uint32_t subscription = in.u32();
+            if (!in.done()) { status = Status::BadRequest; break; }
+            if (std::erase_if(client.subscriptions, [subscription](const Subscription& s) { return s.id == subscription; }) == 0)
+                status = Status::NoSuchSubscription;
+            break;
+        }
+        default:
+            status = Status::UnknownOp;
+            break;
+    }
+
+    if (status != Status::Ok) {
+        client.out.resize(resultsAt);
+        client.out[resultsAt - 1] = static_cast<uint8_t>(status);
+    }
+    out.finish();
+}
+
+void RemoteControl::sendUpdates(Client& client, DeviceHandler& devices) {
+    if (client.subscriptions.empty()) return;
+    const auto now = std::chrono::steady_clock::now();
+    Writer out(client.out);
+    uint64_t sent = 0;
+    for (Subscription& s : client.subscriptions) {
+        if (now < s.next || s.device >= devices.activeDevices.size()) continue;
+        out.begin(s.id, static_cast<uint8_t>(Status::Update));
+        out.u64(wallClockNs());
+        out.f64(devices.activeDevices[s.device]->readValue(s.parameter));
+        out.finish();
+        // Keeps the cadence, but a late logic cycle does not cause a burst of catch-up updates
+        s.next += s.period;
+        if (s.next <= now) s.next = now + s.period;
+        sent++;
+    }
+    if (sent) metrics().updates.add(sent);
+}
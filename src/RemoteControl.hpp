@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CompHandlers/EventLoop.hpp"
+#include "SerialParsers.hpp"
+
+class DeviceHandler;
+
+// Length-prefixed binary protocol of the RemoteControl server, little-endian.
+//   Request:  uint32 length (of everything after it), uint32 request id, uint8 opcode, arguments
+//   Response: uint32 length, uint32 request id (the request's), uint8 status, results
+// Clients may send any number of requests without waiting, each connection's requests are answered in order.
+// Strings are a uint16 length and the bytes. Devices are addressed by their index in ListDevices.
+//
+//   Op               Arguments                               Results
+//   Ping             -                                       -
+//   ListDevices      -                                       uint16 count, count * { uint16 index, uint8 initialized, uint8 tasksActive, string name }
+//   ReadValue        uint16 device, string parameter         double value
+//   SetValue         uint16 device, string parameter, double -, Rejected if the device refused it
+//   ListTasks        uint16 device                           uint8 tasksActive, uint16 count, count * { string name, int32 intervalMs }
+//   SetTasksActive   uint16 device, uint8 active             -
+//   SetTaskInterval  uint16 device, string task, int32 ms    -
+//   Subscribe        uint16 device, string parameter, uint32 periodMs
+//                                                            -, then Update responses with the Subscribe's request id:
+//                                                            uint64 timestampNs (system_clock, since epoch), double value
+//   Unsubscribe      uint32 request id of the Subscribe      -
+namespace RemoteProtocol {
+    enum class Op : uint8_t { Ping, ListDevices, ReadValue, SetValue, ListTasks, SetTasksActive, SetTaskInterval, Subscribe, Unsubscribe };
+    enum class Status : uint8_t { Ok, Update, UnknownOp, BadRequest, NoSuchDevice, NoSuchTask, NoSuchSubscription, Rejected };
+
+    constexpr size_t HeaderSize = 9;         // Length, request id, opcode or status
+    constexpr size_t MaxFrameSize = 64 * 1024;
+
+    // Appends frames to a buffer
+    class Writer {
+    public:
+        explicit Writer(std::vector<uint8_t>& out) : out(out) {}
+
+        // Starts a frame, finish() fills in its length
+        void begin(uint32_t id, uint8_t code) { start = out.size(); u32(0); u32(id); u8(code); }
+        void finish() { const uint32_t length = static_cast<uint32_t>(out.size() - start - 4); std::memcpy(out.data() + start, &length, 4); }
+
+        void u8(uint8_t v) { out.push_back(v); }
+        void u16(uint16_t v) { put(v); }
+        void u32(uint32_t v) { put(v); }
+        void u64(uint64_t v) { put(v); }
+        void i32(int32_t v) { put(v); }
+        void f64(double v) { put(v); }
+        void str(std::string_view s) {
+            const uint16_t length = static_cast<uint16_t>(std::min<size_t>(s.size(), 0xFFFF));
+            u16(length);
+            out.insert(out.end(), s.begin(), s.begin() + length);
+        }
+
+    private:
+        template<typename T> void put(T v) {
+            const size_t at = out.size();
+            out.resize(at + sizeof(T));
+            std::memcpy(out.data() + at, &v, sizeof(T));
+        }
+        std::vector<uint8_t>& out;
+        size_t start = 0;
+    };
+
+    // Reads the fields of one frame. Reading past the end yields zeros and clears ok().
+    class Reader {
+    public:
+        explicit Reader(std::span<const uint8_t> data) : data(data) {}
+
+        uint8_t u8() { return get<uint8_t>(); }
+        uint16_t u16() { return get<uint16_t>(); }
+        uint32_t u32() { return get<uint32_t>(); }
+        uint64_t u64() { return get<uint64_t>(); }
+        int32_t i32() { return get<int32_t>(); }
+        double f64() { return get<double>(); }
+        std::string_view str() {
+            const uint16_t length = u16();
+            if (data.size() - pos < length) { failed = true; return {}; }
+            const std::string_view s(reinterpret_cast<const char*>(data.data() + pos), length);
+            pos += length;
+            return s;
+        }
+
+        bool ok() const { return !failed; }
+        // Everything read, nothing left over
+        bool done() const { return !failed && pos == data.size(); }
+
+    private:
+        template<typename T> T get() {
+            if (data.size() - pos < sizeof(T)) { failed = true; return T{}; }
+            T v;
+            std::memcpy(&v, data.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return v;
+        }
+        std::span<const uint8_t> data;
+        size_t pos = 0;
+        bool failed = false;
+    };
+}
+
+// Drives the active devices from outside the GUI: a beamline control system or a script reads and sets parameters,
+// switches periodic tasks and subscribes to values over a local TCP port or a Unix socket, see RemoteProtocol.
+//
+// Client connections are served by the EventLoop thread, which reads requests into each connection's receive ring
+// as they arrive. service() runs on the logic thread, between device updates: it takes every complete request
+// queued on every connection in one go, executes them against the devices and sends each connection's responses
+// and subscription updates in one write. Device code is only ever called from the logic thread.
+//
+// Loopback TCP and Unix sockets only, there is no authentication. All calls from the logic thread.
+class RemoteControl {
+public:
+    static RemoteControl& Instance() { static RemoteControl instance; return instance; }
+
+    static constexpr uint16_t DefaultPort = 7425;
+
+    struct Config {
+        bool enabled = true;
+        bool tcp = true;
+        uint16_t tcpPort = DefaultPort;      // 127.0.0.1 only. 0 takes any free port, see getTcpPort()
+        std::string unixPath;                // Unix socket as well, empty for none
+        size_t maxClients = 32;
+        size_t clientBufferSize = 1 << 20;   // Each direction. A client that does not read its responses is dropped.
+        int minSubscriptionPeriodMs = 10;
+    };
+
+    bool start() { return start(Config{}); }
+    bool start(const Config& config);
+    // Closes all connections and stops listening
+    void stop();
+    bool isRunning() const { return running; }
+    uint16_t getTcpPort() const { return tcpPort; }
+
+    // Accepts new clients, executes every complete request that arrived since the last call and sends due
+    // subscription updates. Returns the number of requests executed.
+    size_t service(DeviceHandler& devices);
+    size_t clientCount() const { return clients.size(); }
+
+private:
+    RemoteControl() { EventLoop::Instance(); } // Constructed first, so the loop outlives the connections
+    ~RemoteControl() { stop(); }
+    RemoteControl(const RemoteControl&) = delete;
+    RemoteControl& operator=(const RemoteControl&) = delete;
+
+    struct Subscription {
+        uint32_t id;                         // Request id of the Subscribe
+        uint16_t device;
+        std::string parameter;
+        std::chrono::milliseconds period;
+        std::chrono::steady_clock::time_point next;
+    };
+
+    struct Client {
+        explicit Client(std::unique_ptr<EventLoop::Stream> connection);
+        std::unique_ptr<EventLoop::Stream> stream;
+        SerialParse::FrameParser frames;
+        std::vector<uint8_t> out;            // Responses of this service() call
+        std::vector<Subscription> subscriptions;
+    };
+
+    void acceptClients(int listener, const char* kind);
+    void execute(Client& client, DeviceHandler& devices, std::span<const uint8_t> frame);
+    void sendUpdates(Client& client, DeviceHandler& devices);
+    bool serviceClient(Client& client, DeviceHandler& devices, size_t& executed); // False once the client is gone
+    void closeClient(Client& client);
+
+    Config config;
+    bool running = false;
+    int tcpListener = -1;
+    int unixListener = -1;
+    uint16_t tcpPort = 0;
+    uint64_t nextClient = 0;
+    std::vector<std::unique_ptr<Client>> clients;
+};
@@ -0,0 +1,89 @@
+#include "I2cTargetModel.hpp"
+
+namespace {
+    // ADBUS pins
+    constexpr uint8_t Scl = 0x01;
+    constexpr uint8_t SdaOut = 0x02;
+}
+
+void I2cTargetModel::pinsChanged(uint8_t low, uint8_t high) {
+    const bool newScl = low & Scl, newSda = low & SdaOut;
+    std::lock_guard<std::mutex> lk(mutex);
+    if (scl && newScl && sda != newSda) {
+        if (!newSda) { // START or repeated START
+            phase = Phase::Address;
+            selected = nullptr;
+            bit = 0;
+            shiftIn = 0;
+            stats.starts++;
+        }
+        else {
+            phase = Phase::Idle;
+            selected = nullptr;
+            stats.stops++;
+        }
+    }
+    scl = newScl;
+    sda = newSda;
+}
+
+bool I2cTargetModel::clockBit(bool tdi) {
+    std::lock_guard<std::mutex> lk(mutex);
+    bool out = true; // Released
+    if (phase == Phase::Read) {
+        if (bit < 8) out = (selected->registers[selected->pointer] >> (7 - bit)) & 1;
+        else {
+            selected->pointer++;
+            if (tdi) phase = Phase::Ignore; // NAK: the host wants no more bytes
+        }
+    }
+    else if (phase == Phase::Address || phase == Phase::Write) {
+        if (bit < 8) shiftIn = static_cast<uint8_t>(shiftIn << 1 | (tdi ? 1 : 0));
+        else out = !receiveByte(); // ACK pulls SDA low
+    }
+    bit = bit == 8 ? 0 : bit + 1;
+    return out;
+}
+
+bool I2cTargetModel::receiveByte() {
+    if (phase == Phase::Address) {
+        selected = devices[shiftIn >> 1].get();
+        if (!selected) { phase = Phase::Ignore; stats.naks++; return false; }
+        phase = shiftIn & 1 ? Phase::Read : Phase::Write;
+        pointerSet = false;
+        return true;
+    }
+    if (!pointerSet) { selected->pointer = shiftIn; pointerSet = true; }
+    else selected->registers[selected->pointer++] = shiftIn;
+    return true;
+}
+
+void I2cTargetModel::reset() {
+    std::lock_guard<std::mutex> lk(mutex);
+    phase = Phase::Idle;
+    selected = nullptr;
+    bit = 0;
+    scl = sda = true;
+}
+
+void I2cTargetModel::addDevice(uint8_t address) {
+    std::lock_guard<std::mutex> lk(mutex);
+    auto& device = devices[address & 0x7F];
+    if (!device) device = std::make_unique<Device>();
+}
+
+void I2cTargetModel::setRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (auto& device = devices[address & 0x7F]) device->registers[reg] = value;
+}
+
+uint8_t I2cTargetModel::getRegister(uint8_t address, uint8_t reg) {
+    std::lock_guard<std::mutex> lk(mutex);
+    const auto& device = devices[address & 0x7F];
+    return device ? device->registers[reg] : 0;
+}
+
+I2cTargetModel::Stats I2cTargetModel::getStats() {
+    std::lock_guard<std::mutex> lk(mutex);
+    return stats;
+}
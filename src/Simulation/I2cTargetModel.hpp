@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "MpsseEngine.hpp"
+
+// Software model of I2C devices behind an FTDI MPSSE port wired as in FTDI AN_113 (ADBUS0 SCL, ADBUS1 and
+// ADBUS2 tied together as SDA), for SimulatedFTDITransport and I2cBus.
+//
+// START and STOP are SDA edges while SCL is high and arrive as GPIO writes, every clocked bit is one SCL
+// pulse. Each device is a 256-byte register file: the first byte written after the address sets the register
+// pointer, later bytes are stored from there, reads return bytes from the pointer, both auto-increment.
+// The bit the host samples is the model's SDA: released (1) unless a device drives an ACK or a data bit low,
+// so an address nobody answers reads as a NAK.
+class I2cTargetModel : public MpsseTarget {
+public:
+    // ---- MpsseTarget ----
+    void pinsChanged(uint8_t low, uint8_t high) override;
+    bool clockBit(bool tdi) override;
+    void reset() override;
+
+    // ---- Test and harness hooks (thread-safe) ----
+    // Adds a device at a 7-bit address with all registers zero. Adding an address twice keeps the first device.
+    void addDevice(uint8_t address);
+    void setRegister(uint8_t address, uint8_t reg, uint8_t value);
+    uint8_t getRegister(uint8_t address, uint8_t reg);
+
+    struct Stats {
+        uint64_t starts = 0;   // Including repeated STARTs
+        uint64_t stops = 0;
+        uint64_t naks = 0;     // Addresses nobody acknowledged
+    };
+    Stats getStats();
+
+private:
+    struct Device {
+        std::array<uint8_t, 256> registers{};
+        uint8_t pointer = 0;
+    };
+
+    // Where the bus is since the last START: the address byte, bytes from the host, bytes to the host, or a
+    // transaction for another address that is ignored until the next START or STOP
+    enum class Phase { Idle, Address, Write, Read, Ignore };
+
+    bool receiveByte(); // At the ACK clock of a byte from the host, returns whether it is acknowledged
+
+    std::mutex mutex;
+    std::array<std::unique_ptr<Device>, 128> devices;
+    Phase phase = Phase::Idle;
+    Device* selected = nullptr;
+    int bit = 0;                // Clock within the current byte, 8 is the ACK clock
+    uint8_t shiftIn = 0;
+    bool pointerSet = false;    // The current write already set the register pointer
+    bool scl = true, sda = true; // Bus idles high
+    Stats stats;
+};
@@ -0,0 +1,184 @@
+#include "MiniXBoardModel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Pin assignments, see MinixDevice.cpp
+    constexpr uint8_t ADCS = 0x08;         // ADBUS, active low
+    constexpr uint8_t DACS = 0x10;         // ADBUS, active low
+    constexpr uint8_t HV_EN = 0x60;        // ADBUS, both enables high
+    constexpr uint8_t TSCS = 0x08;         // ACBUS, active high
+    constexpr uint8_t DAC_HV = 0x18;
+    constexpr uint8_t DAC_CURRENT = 0x19;
+    constexpr int AdcBits = 12;
+}
+
+MiniXBoardModel::MiniXBoardModel(const Config& cfg) : config(cfg), rng(cfg.seed), tubeC(cfg.ambientC) {}
+
+void MiniXBoardModel::reset() {
+    std::lock_guard<std::mutex> lk(mutex);
+    settle();
+    lowPins = highPins = 0;
+    selected = Chip::None;
+    bitCount = 0;
+    shiftOutBits = 0;
+    hvOn = false;
+}
+
+void MiniXBoardModel::pinsChanged(uint8_t low, uint8_t high) {
+    Chip chip = Chip::None;
+    if (!(low & ADCS)) chip = Chip::Adc;
+    else if (!(low & DACS)) chip = Chip::Dac;
+    else if (high & TSCS) chip = Chip::Temperature;
+
+    if ((low & HV_EN) != (lowPins & HV_EN)) {
+        std::lock_guard<std::mutex> lk(mutex);
+        settle(); // Up to now with the old enables
+        hvOn = (low & HV_EN) == HV_EN;
+    }
+    lowPins = low;
+    highPins = high;
+    if (chip == selected) return;
+
+    if (selected == Chip::Dac) latchDac();
+    selected = chip;
+    bitCount = 0;
+    shiftOut = 0;
+    shiftOutBits = 0;
+    adcStarted = false;
+    adcControlBits = 0;
+    adcControl = 0;
+    dacWord = 0;
+    dacBits = 0;
+    tsByte = 0;
+}
+
+bool MiniXBoardModel::clockBit(bool tdi) {
+    switch (selected) {
+        case Chip::Adc: return clockAdc(tdi);
+        case Chip::Temperature: return clockTemperature(tdi);
+        case Chip::Dac:
+            dacWord = (dacWord << 1) | (tdi ? 1u : 0u);
+            dacBits++;
+            return false;
+        default: return false;
+    }
+}
+
+bool MiniXBoardModel::clockAdc(bool tdi) {
+    if (!adcStarted) { // Leading zeros before the start bit are ignored
+        if (tdi) { adcStarted = true; adcControl = 1; adcControlBits = 1; }
+        return false;
+    }
+    if (adcControlBits < 4) {
+        adcControl = static_cast<uint8_t>(adcControl << 1 | (tdi ? 1 : 0));
+        if (++adcControlBits == 4) {
+            const int channel = (adcControl >> 1) & 1; // ODD/SIGN bit
+            shiftOut = sampleAdc(channel);             // Preceded by the null bit
+            shiftOutBits = AdcBits + 1;
+        }
+        return false;
+    }
+    if (shiftOutBits == 0) return false;
+    return (shiftOut >> --shiftOutBits) & 1;
+}
+
+bool MiniXBoardModel::clockTemperature(bool tdi) {
+    bitCount++;
+    if (bitCount <= 8) { // Address byte
+        tsByte = static_cast<uint8_t>(tsByte << 1 | (tdi ? 1 : 0));
+        if (bitCount == 8) {
+            tsAddress = tsByte & 0x7F;
+            tsWrite = tsByte & 0x80;
+            tsByte = 0;
+            if (!tsWrite) { shiftOut = readTemperatureRegister(tsAddress); shiftOutBits = 8; }
+        }
+        return false;
+    }
+
+    if (tsWrite) {
+        tsByte = static_cast<uint8_t>(tsByte << 1 | (tdi ? 1 : 0));
+        if ((bitCount - 8) % 8 == 0) {
+            if (tsAddress == 0x00) { std::lock_guard<std::mutex> lk(mutex); tsConfig = tsByte; }
+            tsAddress = (tsAddress + 1) & 0x7F;
+            tsByte = 0;
+        }
+        return false;
+    }
+
+    const bool bit = (shiftOut >> --shiftOutBits) & 1;
+    if (shiftOutBits == 0) { // Auto-increment to the next register
+        tsAddress = (tsAddress + 1) & 0x7F;
+        shiftOut = readTemperatureRegister(tsAddress);
+        shiftOutBits = 8;
+    }
+    return bit;
+}
+
+void MiniXBoardModel::settle() {
+    const Clock::time_point now = SchedulerClock::current().now();
+    const double dt = std::chrono::duration<double>(now - lastSettle).count();
+    lastSettle = now;
+    if (dt <= 0.0) return;
+
+    const double ramp = 1.0 - std::exp(-dt / config.rampTimeConstantS);
+    actualKV += ((hvOn ? setKV : 0.0) - actualKV) * ramp;
+    actualUA += ((hvOn ? setUA : 0.0) - actualUA) * ramp;
+    const double watts = actualKV * actualUA / 1000.0;
+    const double thermal = 1.0 - std::exp(-dt / config.thermalTimeConstantS);
+    tubeC += (config.ambientC + config.heatingCPerWatt * watts - tubeC) * thermal;
+}
+
+uint16_t MiniXBoardModel::sampleAdc(int channel) {
+    std::lock_guard<std::mutex> lk(mutex);
+    conversions.fetch_add(1, std::memory_order_relaxed);
+    if (adcStuck[channel]) return *adcStuck[channel] & 0x0FFF;
+    settle();
+    const double volts = channel == 0 ? actualKV / config.kVPerVolt : actualUA / config.uAPerVolt;
+    const double code = volts / config.vRef * (1 << AdcBits) + gauss(rng) * config.adcNoiseLsb;
+    return static_cast<uint16_t>(std::clamp(std::lround(code), 0l, static_cast<long>((1 << AdcBits) - 1)));
+}
+
+uint8_t MiniXBoardModel::readTemperatureRegister(uint8_t address) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (address == 0x00) return tsConfig;
+    if (address != 0x01 && address != 0x02) return 0x00;
+    if (!(tsConfig & 0x01)) { // Continuous conversion, SD clear
+        settle();
+        const double celsius = temperatureOverride ? *temperatureOverride : tubeC + gauss(rng) * config.temperatureNoiseC;
+        tsLastRaw = static_cast<int16_t>(std::clamp(std::lround(celsius * 16.0), -2048l, 2047l));
+    }
+    const uint16_t raw = static_cast<uint16_t>(tsLastRaw) & 0x0FFF;
+    return address == 0x01 ? static_cast<uint8_t>((raw & 0x0F) << 4) : static_cast<uint8_t>(raw >> 4);
+}
+
+void MiniXBoardModel::latchDac() {
+    if (dacBits < 24) return; // Incomplete frame, ignored by the DAC
+    const uint8_t command = static_cast<uint8_t>(dacWord >> (dacBits - 8));
+    const uint16_t code = static_cast<uint16_t>(dacWord >> (dacBits - 24)) & 0x0FFF;
+    const double volts = static_cast<double>(code) / (1 << AdcBits) * config.vRef;
+    std::lock_guard<std::mutex> lk(mutex);
+    settle();
+    if (command == DAC_HV) setKV = volts * config.kVPerVolt;
+    else if (command == DAC_CURRENT) setUA = volts * config.uAPerVolt;
+}
+
+void MiniXBoardModel::setHighVoltage(double kV) { std::lock_guard<std::mutex> lk(mutex); settle(); setKV = kV; }
+
+void MiniXBoardModel::setCurrent(double uA) { std::lock_guard<std::mutex> lk(mutex); settle(); setUA = uA; }
+
+double MiniXBoardModel::highVoltage() { std::lock_guard<std::mutex> lk(mutex); settle(); return actualKV; }
+
+double MiniXBoardModel::current() { std::lock_guard<std::mutex> lk(mutex); settle(); return actualUA; }
+
+double MiniXBoardModel::temperature() { std::lock_guard<std::mutex> lk(mutex); settle(); return temperatureOverride ? *temperatureOverride : tubeC; }
+
+bool MiniXBoardModel::hvEnabled() { std::lock_guard<std::mutex> lk(mutex); return hvOn; }
+
+void MiniXBoardModel::setAdcStuck(int channel, std::optional<uint16_t> code) {
+    if (channel < 0 || channel > 1) return;
+    std::lock_guard<std::mutex> lk(mutex);
+    adcStuck[channel] = code;
+}
+
+void MiniXBoardModel::setTemperatureOverride(std::optional<double> celsius) { std::lock_guard<std::mutex> lk(mutex); temperatureOverride = celsius; }
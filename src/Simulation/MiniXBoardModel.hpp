@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include "MpsseEngine.hpp"
+#include "Utils/SchedulerClock.hpp"
+
+// Software model of the Mini-X controller board behind its FTDI MPSSE port, for SimulatedFTDITransport.
+//
+// ADBUS: bit0 CLK, bit1 DATA out, bit2 DATA in, bit3 ADC CS (low), bit4 DAC CS (low), bit5/6 HV enable A/B.
+// ACBUS: bit3 temperature sensor CE (high).
+//
+// - ADC, MCP3202 style: start bit, SGL, ODD (channel), MSBF, then a null bit and 12 data bits, MSB first.
+//   Channel 0 reads back the high voltage, channel 1 the tube current, with gaussian noise.
+// - Temperature sensor, DS1722 style: address byte (bit 7 = write), then data with auto-increment.
+//   0x00 configuration, 0x01/0x02 temperature LSB/MSB in 1/16 C.
+// - DAC: a command byte (0x18 channel A = HV, 0x19 channel B = current) and a 16-bit word carrying
+//   a 12-bit code, latched when the chip select goes high. The driver does not program the DAC yet,
+//   so this framing is the model's assumption; setHighVoltage()/setCurrent() reach the same set points.
+//
+// High voltage and current follow their set points with a first order lag while both HV enables are high
+// and decay to zero otherwise. The tube temperature rises with the dissipated power. The analog state
+// advances on SchedulerClock time, so it follows a VirtualClock too.
+class MiniXBoardModel : public MpsseTarget {
+public:
+    struct Config {
+        double vRef = 4.096;             // ADC/DAC reference
+        double kVPerVolt = 10.0;         // HV monitor scale, same as MiniXDevice
+        double uAPerVolt = 50.0;         // Current monitor scale
+        double adcNoiseLsb = 1.5;        // Readback noise, standard deviation in ADC codes
+        double temperatureNoiseC = 0.05;
+        double ambientC = 24.0;
+        double heatingCPerWatt = 3.0;
+        double rampTimeConstantS = 0.25; // HV and current settling
+        double thermalTimeConstantS = 20.0;
+        uint32_t seed = 1;
+    };
+
+    MiniXBoardModel() : MiniXBoardModel(Config{}) {}
+    explicit MiniXBoardModel(const Config& config);
+
+    // ---- MpsseTarget ----
+    void pinsChanged(uint8_t low, uint8_t high) override;
+    bool clockBit(bool tdi) override;
+    void reset() override;
+
+    // ---- Test and harness hooks (thread-safe) ----
+    void setHighVoltage(double kV);
+    void setCurrent(double uA);
+    double highVoltage();   // Actual output after settling
+    double current();
+    double temperature();
+    bool hvEnabled();
+
+    // Analog faults: pin an ADC channel (0 HV, 1 current) to a fixed code, or force the temperature.
+    void setAdcStuck(int channel, std::optional<uint16_t> code);
+    void setTemperatureOverride(std::optional<double> celsius);
+
+    uint64_t adcConversions() const { return conversions.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    enum class Chip { None, Adc, Dac, Temperature };
+
+    bool clockAdc(bool tdi);
+    bool clockTemperature(bool tdi);
+    void settle();                     // Advances the analog state to now, requires mutex
+    uint16_t sampleAdc(int channel);
+    uint8_t readTemperatureRegister(uint8_t address);
+    void latchDac();
+
+    Config config;
+    std::mutex mutex;
+    std::mt19937 rng;
+    std::normal_distribution<double> gauss{0.0, 1.0};
+
+    // Pins and bus. Only touched from the MPSSE engine, which the transport serializes.
+    uint8_t lowPins = 0, highPins = 0;
+    Chip selected = Chip::None;
+    uint32_t bitCount = 0;     // Bits clocked since the chip was selected
+    uint32_t shiftOut = 0;     // Bits the chip is sending, MSB first
+    int shiftOutBits = 0;
+
+    // ADC
+    bool adcStarted = false;
+    int adcControlBits = 0;
+    uint8_t adcControl = 0;
+    std::optional<uint16_t> adcStuck[2];
+    std::atomic<uint64_t> conversions{0};
+
+    // DAC
+    uint32_t dacWord = 0;
+    int dacBits = 0;
+
+    // Temperature sensor
+    uint8_t tsAddress = 0;
+    bool tsWrite = false;
+    uint8_t tsByte = 0;
+
+    // Analog state and registers the hooks can reach, guarded by mutex
+    uint8_t tsConfig = 0x01;   // Power-on: shut down (SD bit), no conversions until configured
+    int16_t tsLastRaw = 0;     // Last conversion in 1/16 C
+    std::optional<double> temperatureOverride;
+    double setKV = 0.0, setUA = 0.0;
+    double actualKV = 0.0, actualUA = 0.0, tubeC = 0.0;
+    bool hvOn = false;
+    Clock::time_point lastSettle = SchedulerClock::current().now();
+};
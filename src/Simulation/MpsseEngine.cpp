@@ -0,0 +1,130 @@
+#include "MpsseEngine.hpp"
+
+namespace {
+    // Shift opcode bits (AN_108 section 3.2)
+    constexpr uint8_t BitMode = 0x02;
+    constexpr uint8_t LsbFirst = 0x08;
+    constexpr uint8_t WriteTdi = 0x10;
+    constexpr uint8_t ReadTdo = 0x20;
+    constexpr uint8_t WriteTms = 0x40;
+
+    bool isShift(uint8_t op) { return !(op & 0x80) && (op & (WriteTdi | ReadTdo | WriteTms)); }
+    bool isTms(uint8_t op) { return (op & WriteTms) && (op & BitMode); }
+}
+
+void MpsseEngine::reset() {
+    lowLevels = lowDirection = highLevels = highDirection = 0;
+    divisor = 0;
+    div5 = true;
+    loopback = false;
+    pending.clear();
+    sendImmediate = false;
+    target.reset();
+}
+
+uint64_t MpsseEngine::takeBusTimeNs() {
+    const uint64_t ns = static_cast<uint64_t>(static_cast<double>(bitsClocked) * 1e9 / clockHz());
+    bitsClocked = 0;
+    return ns;
+}
+
+bool MpsseEngine::takeSendImmediate() {
+    const bool seen = sendImmediate;
+    sendImmediate = false;
+    return seen;
+}
+
+size_t MpsseEngine::commandLength(const uint8_t* cmd, size_t available) {
+    const uint8_t op = cmd[0];
+    if (isShift(op)) {
+        if (isTms(op)) return 3;
+        if (op & BitMode) return (op & WriteTdi) ? 3 : 2;
+        if (!(op & WriteTdi)) return 3;
+        if (available < 3) return 0;
+        return 3 + (static_cast<size_t>(cmd[1]) | static_cast<size_t>(cmd[2]) << 8) + 1;
+    }
+    switch (op) {
+        case 0x80: case 0x82: case 0x86: case 0x8F: case 0x9C: case 0x9D: case 0x9E: return 3;
+        case 0x8E: return 2;
+        default: return 1; // Single byte commands and unknown opcodes
+    }
+}
+
+void MpsseEngine::write(const uint8_t* data, size_t size, std::vector<uint8_t>& reply) {
+    pending.insert(pending.end(), data, data + size);
+    size_t pos = 0;
+    while (pos < pending.size()) {
+        const size_t len = commandLength(pending.data() + pos, pending.size() - pos);
+        if (len == 0 || pos + len > pending.size()) break; // Rest of the command comes with the next write
+        execute(pending.data() + pos, reply);
+        pos += len;
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(pos));
+}
+
+bool MpsseEngine::shift(bool tdi) {
+    bitsClocked++;
+    const bool tdo = target.clockBit(tdi);
+    return loopback ? tdi : tdo;
+}
+
+void MpsseEngine::shiftBytes(uint8_t opcode, const uint8_t* out, size_t count, std::vector<uint8_t>& reply) {
+    const bool lsb = opcode & LsbFirst;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t tx = out ? out[i] : 0x00;
+        uint8_t rx = 0;
+        for (int b = 0; b < 8; ++b) {
+            const int bit = lsb ? b : 7 - b;
+            if (shift((tx >> bit) & 1)) rx |= static_cast<uint8_t>(1u << bit);
+        }
+        if (opcode & ReadTdo) reply.push_back(rx);
+    }
+}
+
+void MpsseEngine::shiftBits(uint8_t opcode, uint8_t out, int count, std::vector<uint8_t>& reply) {
+    const bool lsb = opcode & LsbFirst;
+    uint8_t rx = 0;
+    for (int i = 0; i < count; ++i) {
+        bool tdi;
+        if (isTms(opcode)) tdi = out & 0x80; // TDI held at bit 7, TMS bits are not modeled
+        else tdi = lsb ? (out >> i) & 1 : (out >> (7 - i)) & 1;
+        const bool tdo = shift(tdi);
+        // Read bits enter at bit 0 (MSB first) or bit 7 (LSB first), like the real engine
+        if (lsb) rx = static_cast<uint8_t>((rx >> 1) | (tdo ? 0x80 : 0));
+        else rx = static_cast<uint8_t>((rx << 1) | (tdo ? 1 : 0));
+    }
+    if (opcode & ReadTdo) reply.push_back(rx);
+}
+
+void MpsseEngine::execute(const uint8_t* cmd, std::vector<uint8_t>& reply) {
+    const uint8_t op = cmd[0];
+    commandsExecuted++;
+
+    if (isShift(op)) {
+        if (op & BitMode) shiftBits(op, (op & (WriteTdi | WriteTms)) ? cmd[2] : 0, cmd[1] + 1, reply);
+        else shiftBytes(op, (op & WriteTdi) ? cmd + 3 : nullptr, (static_cast<size_t>(cmd[1]) | static_cast<size_t>(cmd[2]) << 8) + 1, reply);
+        return;
+    }
+
+    switch (op) {
+        case 0x80: lowLevels = cmd[1]; lowDirection = cmd[2]; target.pinsChanged(lowLevels, highLevels); break;
+        case 0x82: highLevels = cmd[1]; highDirection = cmd[2]; target.pinsChanged(lowLevels, highLevels); break;
+        case 0x81: reply.push_back(lowLevels & lowDirection); break;
+        case 0x83: reply.push_back(highLevels & highDirection); break;
+        case 0x84: loopback = true; break;
+        case 0x85: loopback = false; break;
+        case 0x86: divisor = static_cast<uint16_t>(cmd[1] | cmd[2] << 8); break;
+        case 0x87: sendImmediate = true; break;
+        case 0x8A: div5 = false; break;
+        case 0x8B: div5 = true; break;
+        case 0x8C: case 0x8D: case 0x96: case 0x97: break; // 3-phase and adaptive clocking do not change the data
+        case 0x8E: for (int i = 0; i <= cmd[1]; ++i) shift(lowLevels & 0x02); break;
+        case 0x8F: for (size_t i = 0; i < ((static_cast<size_t>(cmd[1]) | static_cast<size_t>(cmd[2]) << 8) + 1) * 8; ++i) shift(lowLevels & 0x02); break;
+        case 0x88: case 0x89: case 0x94: case 0x95: case 0x9C: case 0x9D: case 0x9E: break; // GPIOL waits and open-drain, no effect here
+        default:
+            badCommands++;
+            reply.push_back(0xFA);
+            reply.push_back(op);
+            break;
+    }
+}
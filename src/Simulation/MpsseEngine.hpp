@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Whatever hangs off the simulated MPSSE pins (a board model). Sees the GPIO levels and every serial clock.
+class MpsseTarget {
+public:
+    virtual ~MpsseTarget() = default;
+
+    // Called after every SET_DATA_BITS command with the levels of ADBUS (low) and ACBUS (high).
+    virtual void pinsChanged(uint8_t low, uint8_t high) {}
+
+    // One serial clock: tdi is the bit the host drives, the return value is the bit it samples on TDO.
+    // Bits arrive in wire order, LSB/MSB-first has already been applied.
+    virtual bool clockBit(bool tdi) = 0;
+
+    // Called when the host resets the device or leaves MPSSE mode.
+    virtual void reset() {}
+};
+
+// Interprets the MPSSE command stream (FTDI AN_108) the way an FT232H/FT2232H engine does.
+//
+// Supported: SET/GET_DATA_BITS low and high byte, clock divisor, divide-by-5, 3-phase and adaptive
+// clocking flags, loopback, SEND_IMMEDIATE, clock-only commands and all byte/bit shift commands
+// (either edge, MSB or LSB first, write, read or both, TMS). Unknown opcodes answer 0xFA <opcode>,
+// which is also how the driver's 0xAA sync check is satisfied. Commands split across writes are
+// buffered until complete. Not thread-safe, the owner serializes access.
+class MpsseEngine {
+public:
+    explicit MpsseEngine(MpsseTarget& target) : target(target) {}
+
+    // Runs every complete command in data and appends the reply bytes.
+    void write(const uint8_t* data, size_t size, std::vector<uint8_t>& reply);
+
+    // Back to the power-on state (pins inputs, divisor 0, div5 on, no pending bytes).
+    void reset();
+
+    // Nanoseconds of serial clocking since the last call, at the configured TCK frequency.
+    uint64_t takeBusTimeNs();
+
+    // Reply data is only pushed to the host on SEND_IMMEDIATE (or after the chip latency timer).
+    // Returns whether a SEND_IMMEDIATE was seen since the last call.
+    bool takeSendImmediate();
+
+    double clockHz() const { return (div5 ? 12e6 : 60e6) / ((1.0 + divisor) * 2.0); }
+
+    // Length of the command starting at cmd[0], 0 if more bytes are needed to tell.
+    static size_t commandLength(const uint8_t* cmd, size_t available);
+
+    // ---- Pin and engine state, for inspection ----
+    uint8_t lowLevels = 0, lowDirection = 0;
+    uint8_t highLevels = 0, highDirection = 0;
+    uint16_t divisor = 0;
+    bool div5 = true;
+    bool loopback = false;
+    uint64_t commandsExecuted = 0;
+    uint64_t badCommands = 0;
+
+private:
+    void execute(const uint8_t* cmd, std::vector<uint8_t>& reply);
+    bool shift(bool tdi);
+    void shiftBytes(uint8_t opcode, const uint8_t* out, size_t count, std::vector<uint8_t>& reply);
+    void shiftBits(uint8_t opcode, uint8_t out, int count, std::vector<uint8_t>& reply);
+
+    MpsseTarget& target;
+    std::vector<uint8_t> pending; // Incomplete command from the previous write
+    uint64_t bitsClocked = 0;
+    bool sendImmediate = false;
+};
@@ -0,0 +1,305 @@
+#include "ReplayTransport.hpp"
+#include "Utils/SchedulerClock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+
+namespace ReplayDetail {
+
+    std::vector<std::unique_ptr<Device>> build(const Capture::File& file, Capture::Bus bus) {
+        std::vector<std::unique_ptr<Device>> devices;
+        std::map<uint32_t, Session*> byId;
+        auto sameDevice = [](const Capture::Stream& a, const Capture::Stream& b) {
+            return std::tie(a.vid, a.pid, a.serial, a.description, a.busNumber, a.portPath)
+                == std::tie(b.vid, b.pid, b.serial, b.description, b.busNumber, b.portPath);
+        };
+
+        for (const Capture::Stream& s : file.streams) {
+            if (s.bus != bus) continue;
+            auto it = std::find_if(devices.begin(), devices.end(), [&](const std::unique_ptr<Device>& d) { return sameDevice(d->identity, s); });
+            if (it == devices.end()) {
+                devices.push_back(std::make_unique<Device>());
+                devices.back()->identity = s;
+                it = devices.end() - 1;
+            }
+            (*it)->sessions.push_back(std::make_unique<Session>());
+            (*it)->sessions.back()->stream = s;
+            byId[s.id] = (*it)->sessions.back().get();
+        }
+
+        for (const Capture::Transfer& t : file.transfers) {
+            auto it = byId.find(t.stream);
+            if (it == byId.end()) continue;
+            Session& session = *it->second;
+            if (t.direction == Capture::Direction::Out) {
+                session.writes[t.endpoint].push_back(t.data);
+                session.writeStatus[t.endpoint].push_back(t.status);
+                session.writesDone++; // Counts while building, reset below
+            }
+            else if (t.direction == Capture::Direction::In) {
+                Session::Read r;
+                r.writesBefore = session.writesDone;
+                r.status = t.status;
+                r.data = t.data;
+                session.reads[t.endpoint].push_back(std::move(r));
+            }
+        }
+        for (auto& d : devices) for (auto& s : d->sessions) s->writesDone = 0;
+        return devices;
+    }
+
+    ReplayStats collect(const std::vector<std::unique_ptr<Device>>& devices) {
+        ReplayStats total;
+        for (const auto& d : devices) {
+            for (const auto& s : d->sessions) {
+                std::lock_guard<std::mutex> lk(s->mutex);
+                if (!s->used) continue;
+                total.writesMatched += s->stats.writesMatched;
+                total.writesDiverged += s->stats.writesDiverged;
+                total.writesExtra += s->stats.writesExtra;
+                total.readsServed += s->stats.readsServed;
+                total.bytesServed += s->stats.bytesServed;
+                for (const auto& [endpoint, reads] : s->reads)
+                    for (const Session::Read& r : reads) if (r.consumed < r.data.size()) total.readsPending++;
+            }
+        }
+        return total;
+    }
+
+    Session* take(Device& device) {
+        if (device.nextSession >= device.sessions.size()) return nullptr;
+        Session* s = device.sessions[device.nextSession++].get();
+        std::lock_guard<std::mutex> lk(s->mutex);
+        s->used = true;
+        return s;
+    }
+
+    // Consumes the next recorded write of the endpoint and compares it. Returns its recorded status.
+    int32_t replayWrite(Session& s, uint8_t endpoint, const unsigned char* data, size_t size, int32_t okStatus) {
+        s.writesDone++;
+        auto& queue = s.writes[endpoint];
+        if (queue.empty()) { s.stats.writesExtra++; return okStatus; }
+        const std::vector<uint8_t>& recorded = queue.front();
+        if (recorded.size() == size && std::equal(recorded.begin(), recorded.end(), data)) s.stats.writesMatched++;
+        else s.stats.writesDiverged++;
+        const int32_t status = s.writeStatus[endpoint].front();
+        queue.pop_front();
+        s.writeStatus[endpoint].pop_front();
+        return status;
+    }
+
+    bool ready(const Session& s, const Session::Read& r) { return r.writesBefore <= s.writesDone; }
+}
+
+using ReplayDetail::Session;
+
+// ---- FTDI ----
+
+ReplayFTDITransport::ReplayFTDITransport(const Capture::File& capture) : devices(ReplayDetail::build(capture, Capture::Bus::Ftdi)) {}
+
+ReplayStats ReplayFTDITransport::stats() const { return ReplayDetail::collect(devices); }
+
+Session* ReplayFTDITransport::lookup(FT_HANDLE handle) const {
+    std::lock_guard<std::mutex> lk(openMutex);
+    return openHandles.count(handle) ? static_cast<Session*>(handle) : nullptr;
+}
+
+FT_STATUS ReplayFTDITransport::createDeviceInfoList(DWORD& deviceCount) {
+    deviceCount = static_cast<DWORD>(devices.size());
+    return FT_OK;
+}
+
+FT_STATUS ReplayFTDITransport::getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) {
+    if (index >= devices.size()) return FT_DEVICE_NOT_FOUND;
+    const Capture::Stream& id = devices[index]->identity;
+    info = FT_DEVICE_LIST_INFO_NODE{};
+    info.Type = id.deviceType;
+    info.ID = (static_cast<ULONG>(id.vid) << 16) | id.pid;
+    info.LocId = index + 1;
+    std::strncpy(info.SerialNumber, id.serial.c_str(), sizeof(info.SerialNumber) - 1);
+    std::strncpy(info.Description, id.description.c_str(), sizeof(info.Description) - 1);
+    return FT_OK;
+}
+
+FT_STATUS ReplayFTDITransport::open(int index, FT_HANDLE& handle) {
+    handle = nullptr;
+    if (index < 0 || index >= static_cast<int>(devices.size())) return FT_DEVICE_NOT_FOUND;
+    std::lock_guard<std::mutex> lk(openMutex);
+    Session* s = ReplayDetail::take(*devices[index]);
+    if (!s) return FT_DEVICE_NOT_OPENED; // Opened more often than in the recording
+    handle = s;
+    openHandles.insert(s);
+    return FT_OK;
+}
+
+FT_STATUS ReplayFTDITransport::close(FT_HANDLE handle) {
+    std::lock_guard<std::mutex> lk(openMutex);
+    return openHandles.erase(handle) ? FT_OK : FT_INVALID_HANDLE;
+}
+
+FT_STATUS ReplayFTDITransport::write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) {
+    bytesWritten = 0;
+    Session* s = lookup(handle);
+    if (!s) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(s->mutex);
+    const FT_STATUS status = static_cast<FT_STATUS>(ReplayDetail::replayWrite(*s, 0, data, size, FT_OK));
+    if (status == FT_OK) bytesWritten = size;
+    return status;
+}
+
+FT_STATUS ReplayFTDITransport::read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) {
+    bytesRead = 0;
+    Session* s = lookup(handle);
+    if (!s) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(s->mutex);
+    auto& queue = s->reads[0];
+    while (bytesRead < size && !queue.empty() && ReplayDetail::ready(*s, queue.front())) {
+        Session::Read& r = queue.front();
+        if (r.status != FT_OK) {
+            if (bytesRead > 0) break; // Bytes first, the recorded failure on the next call
+            const FT_STATUS status = static_cast<FT_STATUS>(r.status);
+            queue.pop_front();
+            return status;
+        }
+        const size_t n = std::min<size_t>(size - bytesRead, r.data.size() - r.consumed);
+        std::memcpy(buffer + bytesRead, r.data.data() + r.consumed, n);
+        r.consumed += n;
+        bytesRead += static_cast<DWORD>(n);
+        if (r.consumed == r.data.size()) { queue.pop_front(); s->stats.readsServed++; } // Empty recorded reads just drop out
+    }
+    s->stats.bytesServed += bytesRead;
+    return FT_OK;
+}
+
+FT_STATUS ReplayFTDITransport::getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) {
+    rxBytes = 0;
+    Session* s = lookup(handle);
+    if (!s) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(s->mutex);
+    for (const Session::Read& r : s->reads[0]) {
+        if (!ReplayDetail::ready(*s, r) || r.status != FT_OK) break;
+        rxBytes += static_cast<DWORD>(r.data.size() - r.consumed);
+    }
+    return FT_OK;
+}
+
+// ---- USB ----
+
+ReplayUsbBackend::ReplayUsbBackend(const Capture::File& capture) : devices(ReplayDetail::build(capture, Capture::Bus::Usb)) {}
+
+ReplayStats ReplayUsbBackend::stats() const { return ReplayDetail::collect(devices); }
+
+ReplayDetail::Device* ReplayUsbBackend::deviceOf(libusb_device* device) const {
+    for (const auto& d : devices) if (reinterpret_cast<libusb_device*>(d.get()) == device) return d.get();
+    return nullptr;
+}
+
+Session* ReplayUsbBackend::lookup(libusb_device_handle* handle) const {
+    std::lock_guard<std::mutex> lk(openMutex);
+    return openHandles.count(handle) ? reinterpret_cast<Session*>(handle) : nullptr;
+}
+
+int ReplayUsbBackend::getDeviceList(std::vector<libusb_device*>& list) {
+    for (const auto& d : devices) list.push_back(reinterpret_cast<libusb_device*>(d.get()));
+    return static_cast<int>(devices.size());
+}
+
+int ReplayUsbBackend::getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) {
+    ReplayDetail::Device* d = deviceOf(device);
+    if (!d) return LIBUSB_ERROR_NO_DEVICE;
+    descriptor = libusb_device_descriptor{};
+    descriptor.bLength = LIBUSB_DT_DEVICE_SIZE;
+    descriptor.bDescriptorType = LIBUSB_DT_DEVICE;
+    descriptor.idVendor = d->identity.vid;
+    descriptor.idProduct = d->identity.pid;
+    descriptor.bcdDevice = static_cast<uint16_t>(d->identity.deviceType);
+    descriptor.iProduct = d->identity.description.empty() ? 0 : ProductString;
+    descriptor.iSerialNumber = d->identity.serial.empty() ? 0 : SerialString;
+    descriptor.bNumConfigurations = 1;
+    return LIBUSB_SUCCESS;
+}
+
+uint8_t ReplayUsbBackend::getBusNumber(libusb_device* device) {
+    ReplayDetail::Device* d = deviceOf(device);
+    return d ? d->identity.busNumber : 0;
+}
+
+int ReplayUsbBackend::getPortNumbers(libusb_device* device, uint8_t* ports, int length) {
+    ReplayDetail::Device* d = deviceOf(device);
+    if (!d) return LIBUSB_ERROR_NO_DEVICE;
+    const std::vector<uint8_t>& path = d->identity.portPath;
+    if (static_cast<int>(path.size()) > length) return LIBUSB_ERROR_OVERFLOW;
+    std::copy(path.begin(), path.end(), ports);
+    return static_cast<int>(path.size());
+}
+
+int ReplayUsbBackend::open(libusb_device* device, libusb_device_handle** handle) {
+    *handle = nullptr;
+    ReplayDetail::Device* d = deviceOf(device);
+    if (!d) return LIBUSB_ERROR_NO_DEVICE;
+    std::lock_guard<std::mutex> lk(openMutex);
+    Session* s = ReplayDetail::take(*d);
+    if (!s) return LIBUSB_ERROR_ACCESS; // Opened more often than in the recording
+    *handle = reinterpret_cast<libusb_device_handle*>(s);
+    openHandles.insert(s);
+    return LIBUSB_SUCCESS;
+}
+
+void ReplayUsbBackend::close(libusb_device_handle* handle) {
+    std::lock_guard<std::mutex> lk(openMutex);
+    openHandles.erase(handle);
+}
+
+int ReplayUsbBackend::getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) {
+    Session* s = lookup(handle);
+    if (!s) return LIBUSB_ERROR_NO_DEVICE;
+    const std::string* text = index == ProductString ? &s->stream.description : index == SerialString ? &s->stream.serial : nullptr;
+    if (!text || text->empty()) return LIBUSB_ERROR_INVALID_PARAM;
+    const int n = std::min(static_cast<int>(text->size()), length - 1);
+    if (n < 0) return LIBUSB_ERROR_INVALID_PARAM;
+    std::memcpy(data, text->data(), static_cast<size_t>(n));
+    data[n] = 0;
+    return n;
+}
+
+int ReplayUsbBackend::bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                                   int* transferred, unsigned int timeoutMs) {
+    if (transferred) *transferred = 0;
+    Session* s = lookup(handle);
+    if (!s) return LIBUSB_ERROR_NO_DEVICE;
+    const auto timeout = std::chrono::milliseconds(timeoutMs ? timeoutMs : 1000); // 0 waits forever in libusb, capped here
+
+    if (!(endpoint & LIBUSB_ENDPOINT_IN)) {
+        std::lock_guard<std::mutex> lk(s->mutex);
+        const int r = ReplayDetail::replayWrite(*s, endpoint, data, static_cast<size_t>(length), LIBUSB_SUCCESS);
+        if (r >= 0 && transferred) *transferred = length;
+        return r;
+    }
+
+    int status = LIBUSB_ERROR_TIMEOUT;
+    bool wait = true;
+    {
+        std::lock_guard<std::mutex> lk(s->mutex);
+        auto& queue = s->reads[endpoint];
+        if (!queue.empty() && ReplayDetail::ready(*s, queue.front())) {
+            Session::Read& r = queue.front();
+            const size_t n = std::min(static_cast<size_t>(length), r.data.size() - r.consumed);
+            std::memcpy(data, r.data.data() + r.consumed, n);
+            r.consumed += n;
+            if (transferred) *transferred = static_cast<int>(n);
+            s->stats.bytesServed += n;
+            status = r.status;
+            wait = n == 0 && status == LIBUSB_ERROR_TIMEOUT; // A recorded timeout takes its time again
+            if (r.consumed == r.data.size()) { queue.pop_front(); s->stats.readsServed++; }
+            else status = LIBUSB_SUCCESS; // The driver asked for less than was recorded, the rest comes next call
+        }
+    }
+    if (wait) SchedulerClock::current().sleepFor(timeout);
+    return status;
+}
+
+int ReplayUsbBackend::handleEvents(int timeoutMs) {
+    SchedulerClock::current().sleepFor(std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0));
+    return LIBUSB_SUCCESS;
+}
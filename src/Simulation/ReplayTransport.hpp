@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "CompHandlers/FTDITransport.hpp"
+#include "CompHandlers/UsbBackend.hpp"
+#include "Diagnostics/TrafficCapture.hpp"
+
+// Transports that play a TrafficCapture recording back to the unmodified drivers, so a field problem can
+// be stepped through, profiled and fixed on any machine.
+//
+// The captured devices are enumerated again with their recorded identity, and each open() takes the next
+// recorded session of that device. Within a session, playback follows the driver instead of the clock:
+// - Every write / OUT transfer consumes the next recorded one and is compared with it. A different payload
+//   is counted as a divergence (the driver did not do what it did in the field) and playback carries on.
+// - Recorded reads become available once the driver has made the writes that preceded them in the capture,
+//   then come back with their recorded status and bytes. FTDI getQueueStatus reports them as queued.
+// - Nothing readable yet: FTDI reports an empty queue, USB IN transfers wait out their timeout on the
+//   SchedulerClock and return LIBUSB_ERROR_TIMEOUT.
+// Timestamps are not used for pacing, so a replay runs as fast as the driver polls, and the same driver
+// code produces the same results on every run (with a VirtualClock also the same timing).
+//
+// Usage:
+//   Capture::File capture;
+//   Capture::load("field.rcap", capture);
+//   FTDIHandler::Instance().setTransport(std::make_unique<ReplayFTDITransport>(capture));
+//   LibUsbHandler::Instance().setBackend(std::make_unique<ReplayUsbBackend>(capture));
+struct ReplayStats {
+    uint64_t writesMatched = 0;
+    uint64_t writesDiverged = 0; // Payload differs from the recording
+    uint64_t writesExtra = 0;    // Past the end of the recorded session
+    uint64_t readsServed = 0;
+    uint64_t bytesServed = 0;
+    uint64_t readsPending = 0;   // Recorded reads with data the driver has not picked up (yet)
+};
+
+namespace ReplayDetail {
+    // Recorded traffic of one session, split per endpoint with the write order the reads depend on
+    struct Session {
+        struct Read {
+            uint64_t writesBefore = 0; // Writes of the session that preceded it in the capture
+            int32_t status = 0;
+            std::vector<uint8_t> data;
+            size_t consumed = 0;
+        };
+        Capture::Stream stream;
+        std::map<uint8_t, std::deque<std::vector<uint8_t>>> writes; // Endpoint -> payloads, in order
+        std::map<uint8_t, std::deque<int32_t>> writeStatus;
+        std::map<uint8_t, std::deque<Read>> reads;                  // Endpoint -> reads, in order
+        uint64_t writesDone = 0;
+        bool used = false;
+        ReplayStats stats;
+        std::mutex mutex; // Everything above but stream
+    };
+
+    // Sessions grouped by device identity, in order of first appearance
+    struct Device {
+        Capture::Stream identity;
+        std::vector<std::unique_ptr<Session>> sessions;
+        size_t nextSession = 0;
+    };
+
+    std::vector<std::unique_ptr<Device>> build(const Capture::File& file, Capture::Bus bus);
+    ReplayStats collect(const std::vector<std::unique_ptr<Device>>& devices);
+    // Next session of the device, nullptr once all recorded sessions were used
+    Session* take(Device& device);
+}
+
+class ReplayFTDITransport : public FTDITransport {
+public:
+    explicit ReplayFTDITransport(const Capture::File& capture);
+
+    ReplayStats stats() const;
+    int deviceCount() const { return static_cast<int>(devices.size()); }
+
+    FT_STATUS createDeviceInfoList(DWORD& deviceCount) override;
+    FT_STATUS getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) override;
+    FT_STATUS open(int index, FT_HANDLE& handle) override;
+    FT_STATUS close(FT_HANDLE handle) override;
+    // Configuration calls succeed without effect, the recorded device already behaved as configured
+    FT_STATUS resetDevice(FT_HANDLE handle) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS purge(FT_HANDLE handle, ULONG) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS setUSBParameters(FT_HANDLE handle, ULONG, ULONG) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS setLatencyTimer(FT_HANDLE handle, UCHAR) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS setTimeouts(FT_HANDLE handle, ULONG, ULONG) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS setFlowControl(FT_HANDLE handle, USHORT, UCHAR, UCHAR) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS setBitMode(FT_HANDLE handle, UCHAR, UCHAR) override { return lookup(handle) ? FT_OK : FT_INVALID_HANDLE; }
+    FT_STATUS write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) override;
+    FT_STATUS read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) override;
+    FT_STATUS getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) override;
+
+private:
+    ReplayDetail::Session* lookup(FT_HANDLE handle) const; // Open handles only
+
+    std::vector<std::unique_ptr<ReplayDetail::Device>> devices;
+    mutable std::mutex openMutex; // Session selection and openHandles
+    std::unordered_set<const void*> openHandles;
+};
+
+class ReplayUsbBackend : public UsbBackend {
+public:
+    explicit ReplayUsbBackend(const Capture::File& capture);
+
+    ReplayStats stats() const;
+    int deviceCount() const { return static_cast<int>(devices.size()); }
+
+    int initialize() override { return LIBUSB_SUCCESS; }
+    void shutdown() override {}
+    int getDeviceList(std::vector<libusb_device*>& list) override;
+    void refDevice(libusb_device*) override {}   // Devices live as long as the backend
+    void unrefDevice(libusb_device*) override {}
+    int getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) override;
+    uint8_t getBusNumber(libusb_device* device) override;
+    int getPortNumbers(libusb_device* device, uint8_t* ports, int length) override;
+    int open(libusb_device* device, libusb_device_handle** handle) override;
+    void close(libusb_device_handle* handle) override;
+    int getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) override;
+    int claimInterface(libusb_device_handle* handle, int) override { return lookup(handle) ? LIBUSB_SUCCESS : LIBUSB_ERROR_NO_DEVICE; }
+    int releaseInterface(libusb_device_handle* handle, int) override { return lookup(handle) ? LIBUSB_SUCCESS : LIBUSB_ERROR_NO_DEVICE; }
+    int bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                     int* transferred, unsigned int timeoutMs) override;
+    // No hotplug: the recorded devices are attached from the start
+    int registerHotplug(HotplugCallback) override { return LIBUSB_ERROR_NOT_SUPPORTED; }
+    void deregisterHotplug(int) override {}
+    int handleEvents(int timeoutMs) override;
+
+private:
+    enum : uint8_t { ProductString = 1, SerialString = 2 };
+    ReplayDetail::Device* deviceOf(libusb_device* device) const;
+    ReplayDetail::Session* lookup(libusb_device_handle* handle) const; // Open handles only
+
+    std::vector<std::unique_ptr<ReplayDetail::Device>> devices;
+    mutable std::mutex openMutex; // Session selection and openHandles
+    std::unordered_set<const void*> openHandles;
+};
@@ -0,0 +1,372 @@
+#include "SimulatedFTDITransport.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "MiniXBoardModel.hpp"
+
+namespace {
+    constexpr std::chrono::milliseconds MaxBlockingRead{1000}; // Read timeout 0 means "forever" in D2XX
+
+    void copyString(char* dst, size_t size, const std::string& src) {
+        std::memset(dst, 0, size);
+        std::memcpy(dst, src.data(), std::min(src.size(), size - 1));
+    }
+}
+
+SimulatedFTDITransport::~SimulatedFTDITransport() = default;
+
+int SimulatedFTDITransport::addDevice(std::unique_ptr<MpsseTarget> board, const std::string& description, const std::string& serial,
+                                      uint16_t vid, uint16_t pid) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    const int index = static_cast<int>(devices.size());
+    auto dev = std::make_unique<Device>(std::move(board), static_cast<uint32_t>(index + 1));
+    dev->info.Flags = 0;
+    dev->info.Type = 8; // FT_DEVICE_232H in current D2XX headers, the bundled header predates it
+    dev->info.ID = static_cast<DWORD>(vid) << 16 | pid;
+    dev->info.LocId = static_cast<DWORD>(0x1000 + index);
+    copyString(dev->info.SerialNumber, sizeof(dev->info.SerialNumber), serial);
+    copyString(dev->info.Description, sizeof(dev->info.Description), description);
+    dev->info.ftHandle = nullptr;
+    {
+        std::unique_lock<std::shared_mutex> handlesLock(handleMutex);
+        handleSet.insert(dev.get());
+    }
+    devices.push_back(std::move(dev));
+    return index;
+}
+
+int SimulatedFTDITransport::addMiniX(const std::string& serial) {
+    MiniXBoardModel::Config config;
+    config.seed = static_cast<uint32_t>(std::hash<std::string>{}(serial));
+    return addDevice(std::make_unique<MiniXBoardModel>(config), "Mini-X", serial);
+}
+
+int SimulatedFTDITransport::addMultiInterface(std::vector<std::unique_ptr<MpsseTarget>> boards, const std::string& description, const std::string& serial,
+                                              double linkBytesPerSecond) {
+    const int channels = static_cast<int>(boards.size());
+    if (channels != 2 && channels != 4) return -1; // FT2232H or FT4232H only
+    auto link = std::make_shared<Link>();
+    link->bytesPerSecond = linkBytesPerSecond;
+
+    int first = -1;
+    for (int c = 0; c < channels; ++c) {
+        const std::string letter(1, static_cast<char>('A' + c));
+        const int index = addDevice(std::move(boards[c]), description + " " + letter, serial + letter, 0x0403, channels == 2 ? 0x6010 : 0x6011);
+        if (first < 0) first = index;
+        std::lock_guard<std::mutex> lk(listMutex);
+        Device& dev = *devices[index];
+        dev.info.Type = channels == 2 ? 6 : 7; // FT_DEVICE_2232H, FT_DEVICE_4232H. Consecutive LocIds, like the interfaces of one chip
+        dev.link = link;
+        dev.hasMPSSE = channels == 2 || c < 2;
+    }
+    return first;
+}
+
+SimulatedFTDITransport::Clock::time_point SimulatedFTDITransport::Link::reserve(Clock::time_point from, size_t bytes) {
+    std::lock_guard<std::mutex> lk(mutex);
+    const Clock::time_point start = std::max(from, freeAt);
+    freeAt = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(static_cast<double>(bytes) / bytesPerSecond));
+    return freeAt;
+}
+
+int SimulatedFTDITransport::deviceCount() const {
+    std::lock_guard<std::mutex> lk(listMutex);
+    return static_cast<int>(devices.size());
+}
+
+MpsseTarget& SimulatedFTDITransport::board(int index) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    return *devices.at(index)->board;
+}
+
+const MpsseEngine& SimulatedFTDITransport::engine(int index) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    return devices.at(index)->engine;
+}
+
+void SimulatedFTDITransport::setTiming(int index, const Timing& timing) {
+    Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(index).get(); }
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    dev->timing = timing;
+}
+
+void SimulatedFTDITransport::setFaults(int index, const Faults& faults) {
+    Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(index).get(); }
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    dev->faults = faults;
+}
+
+SimulatedFTDITransport::CallCounts SimulatedFTDITransport::callCounts(int index) {
+    Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(index).get(); }
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    return dev->calls;
+}
+
+void SimulatedFTDITransport::setTimingAll(const Timing& timing) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    for (auto& dev : devices) {
+        std::lock_guard<std::mutex> dlk(dev->mutex);
+        dev->timing = timing;
+    }
+}
+
+SimulatedFTDITransport::Device* SimulatedFTDITransport::lookup(FT_HANDLE handle) const {
+    // Handles are Device pointers. Devices are never removed, so a handle stays valid for the transport's lifetime.
+    Device* dev = static_cast<Device*>(handle);
+    std::shared_lock<std::shared_mutex> lk(handleMutex);
+    return handleSet.count(dev) ? dev : nullptr;
+}
+
+size_t SimulatedFTDITransport::readable(const Device& dev, Clock::time_point now) {
+    size_t total = 0;
+    for (const Chunk& chunk : dev.rx) {
+        if (chunk.readyAt > now) break; // Replies arrive in order
+        total += chunk.bytes.size() - chunk.consumed;
+    }
+    return total;
+}
+
+// ---- Enumeration ----
+
+FT_STATUS SimulatedFTDITransport::createDeviceInfoList(DWORD& deviceCount) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    DWORD count = 0;
+    for (auto& dev : devices) {
+        std::lock_guard<std::mutex> dlk(dev->mutex);
+        if (!dev->faults.unplugged) count++;
+    }
+    deviceCount = count;
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) {
+    // Indices skip unplugged devices, like a fresh D2XX list would
+    std::lock_guard<std::mutex> lk(listMutex);
+    DWORD visible = 0;
+    for (auto& dev : devices) {
+        std::lock_guard<std::mutex> dlk(dev->mutex);
+        if (dev->faults.unplugged) continue;
+        if (visible++ != index) continue;
+        info = dev->info;
+        info.Flags = dev->open ? 0x1 : 0x0; // FT_FLAGS_OPENED
+        info.ftHandle = dev->open ? dev.get() : nullptr;
+        return FT_OK;
+    }
+    return FT_DEVICE_NOT_FOUND;
+}
+
+// ---- Device ----
+
+FT_STATUS SimulatedFTDITransport::open(int index, FT_HANDLE& handle) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    int visible = 0;
+    for (auto& dev : devices) {
+        std::lock_guard<std::mutex> dlk(dev->mutex);
+        if (dev->faults.unplugged) continue;
+        if (visible++ != index) continue;
+        if (dev->open) return FT_DEVICE_NOT_OPENED; // D2XX refuses a second open the same way
+        dev->open = true;
+        dev->mpsse = false;
+        dev->rx.clear();
+        dev->engine.reset();
+        handle = dev.get();
+        return FT_OK;
+    }
+    return FT_DEVICE_NOT_FOUND;
+}
+
+FT_STATUS SimulatedFTDITransport::close(FT_HANDLE handle) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    dev->open = false;
+    dev->mpsse = false;
+    dev->rx.clear();
+    dev->engine.reset();
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::resetDevice(FT_HANDLE handle) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    if (dev->faults.unplugged) return FT_IO_ERROR;
+    dev->mpsse = false;
+    dev->rx.clear();
+    dev->engine.reset();
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::purge(FT_HANDLE handle, ULONG mask) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    if (dev->faults.unplugged) return FT_IO_ERROR;
+    if (mask & FT_PURGE_RX) dev->rx.clear();
+    // Written bytes are executed immediately, nothing is left to purge on the TX side
+    return FT_OK;
+}
+
+// ---- Configuration ----
+
+FT_STATUS SimulatedFTDITransport::setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    return dev->open ? FT_OK : FT_INVALID_HANDLE;
+}
+
+FT_STATUS SimulatedFTDITransport::setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    if (latencyMs < 1) return FT_INVALID_PARAMETER;
+    dev->latencyTimerMs = latencyMs;
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    dev->readTimeoutMs = readTimeoutMs; // Writes never block here
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    return dev->open ? FT_OK : FT_INVALID_HANDLE;
+}
+
+FT_STATUS SimulatedFTDITransport::setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) {
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    if (dev->faults.unplugged) return FT_IO_ERROR;
+    if (mode == 0x02) { // MPSSE
+        if (!dev->hasMPSSE) return FT_NOT_SUPPORTED;
+        dev->mpsse = true;
+        return FT_OK;
+    }
+    if (mode == 0x00) { // Reset to the default UART mode
+        dev->mpsse = false;
+        dev->engine.reset();
+        return FT_OK;
+    }
+    return FT_NOT_SUPPORTED; // Only the MPSSE port is modeled
+}
+
+// ---- Data ----
+
+FT_STATUS SimulatedFTDITransport::write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) {
+    bytesWritten = 0;
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+
+    Clock::duration latency;
+    {
+        std::lock_guard<std::mutex> lk(dev->mutex);
+        if (!dev->open) return FT_INVALID_HANDLE;
+        dev->calls.writes++;
+        if (dev->faults.unplugged || chance(*dev, dev->faults.writeErrorRate)) return FT_IO_ERROR;
+        latency = dev->timing.writeLatency;
+        const Clock::time_point now = SchedulerClock::current().now();
+        if (dev->link) latency = std::max(latency, dev->link->reserve(now, size) - now); // Behind the other interfaces' transfers
+
+        if (dev->mpsse) { // Outside MPSSE mode the bytes would go to the UART, which is not modeled
+            dev->reply.clear();
+            dev->engine.write(data, size, dev->reply);
+
+            const Clock::time_point start = std::max(now + latency, dev->busFreeAt);
+            const uint64_t busNs = dev->engine.takeBusTimeNs();
+            dev->busFreeAt = dev->timing.modelBusTime ? start + std::chrono::nanoseconds(busNs) : start;
+            const bool immediate = dev->engine.takeSendImmediate();
+
+            if (!dev->reply.empty() && !chance(*dev, dev->faults.dropReplyRate)) {
+                if (chance(*dev, dev->faults.corruptReplyRate)) {
+                    const size_t bit = std::uniform_int_distribution<size_t>(0, dev->reply.size() * 8 - 1)(dev->rng);
+                    dev->reply[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+                }
+                Chunk chunk;
+                chunk.bytes = dev->reply;
+                chunk.readyAt = dev->busFreeAt + (immediate ? Clock::duration::zero() : std::chrono::milliseconds(dev->latencyTimerMs));
+                if (!dev->rx.empty()) chunk.readyAt = std::max(chunk.readyAt, dev->rx.back().readyAt);
+                dev->rx.push_back(std::move(chunk));
+            }
+        }
+    }
+
+    // The USB round trip is paid by the caller, outside the device lock, so another thread can use the device meanwhile
+    if (latency > Clock::duration::zero()) SchedulerClock::current().sleepFor(latency);
+    bytesWritten = size;
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) {
+    bytesRead = 0;
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+
+    Clock::time_point deadline;
+    Clock::duration latency;
+    {
+        std::lock_guard<std::mutex> lk(dev->mutex);
+        if (!dev->open) return FT_INVALID_HANDLE;
+        dev->calls.reads++;
+        if (dev->faults.unplugged || chance(*dev, dev->faults.readErrorRate)) return FT_IO_ERROR;
+        const std::chrono::milliseconds timeout = dev->readTimeoutMs ? std::chrono::milliseconds(dev->readTimeoutMs) : MaxBlockingRead;
+        deadline = SchedulerClock::current().now() + timeout;
+        latency = dev->timing.readLatency;
+    }
+    if (latency > Clock::duration::zero()) SchedulerClock::current().sleepFor(latency);
+
+    // Like FT_Read: returns once size bytes arrived or the timeout expired, with whatever was received
+    Clock::time_point nextReady{};
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lk(dev->mutex);
+            if (!dev->open) return FT_INVALID_HANDLE;
+            const Clock::time_point now = SchedulerClock::current().now();
+            while (bytesRead < size && !dev->rx.empty() && dev->rx.front().readyAt <= now) {
+                Chunk& chunk = dev->rx.front();
+                const size_t n = std::min<size_t>(size - bytesRead, chunk.bytes.size() - chunk.consumed);
+                std::memcpy(buffer + bytesRead, chunk.bytes.data() + chunk.consumed, n);
+                chunk.consumed += n;
+                bytesRead += static_cast<DWORD>(n);
+                if (chunk.consumed == chunk.bytes.size()) dev->rx.pop_front();
+            }
+            if (bytesRead == size || now >= deadline) {
+                if (!dev->link || !bytesRead) return FT_OK;
+                nextReady = dev->link->reserve(now, bytesRead); // The reply shares the link with the other interfaces
+                break;
+            }
+            // Nothing in flight: poll, a write from another thread may still queue a reply
+            nextReady = dev->rx.empty() ? now + std::chrono::milliseconds(1) : dev->rx.front().readyAt;
+        }
+        SchedulerClock::current().sleepUntil(std::min(nextReady, deadline));
+    }
+    SchedulerClock::current().sleepUntil(nextReady);
+    return FT_OK;
+}
+
+FT_STATUS SimulatedFTDITransport::getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) {
+    rxBytes = 0;
+    Device* dev = lookup(handle);
+    if (!dev) return FT_INVALID_HANDLE;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (!dev->open) return FT_INVALID_HANDLE;
+    if (dev->faults.unplugged) return FT_IO_ERROR;
+    rxBytes = static_cast<DWORD>(readable(*dev, SchedulerClock::current().now()));
+    return FT_OK;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "CompHandlers/FTDITransport.hpp"
+#include "MpsseEngine.hpp"
+#include "Utils/SchedulerClock.hpp"
+
+// FTDITransport with simulated FTDI chips instead of the D2XX library. Each device runs an MpsseEngine
+// in front of a board model (MpsseTarget), so FTDIHandler, DeviceSession, FTDIConnection and the device
+// drivers run unmodified on any machine.
+//
+// Timing follows the chip: every write() and read() costs one USB round trip (Timing), reply bytes only
+// become readable after the bits have been clocked at the configured TCK rate, and replies without
+// SEND_IMMEDIATE wait for the latency timer. Faults are injected per call with the configured rates.
+// All waiting and timing goes through SchedulerClock: with a VirtualClock installed, a driver running on
+// this transport takes no wall time for USB latency, serial clocking or timeouts.
+//
+// Usage:
+//   auto sim = std::make_unique<SimulatedFTDITransport>();
+//   int index = sim->addMiniX("MX0001");
+//   FTDIHandler::Instance().setTransport(std::move(sim)); // Before any device is opened
+class SimulatedFTDITransport : public FTDITransport {
+public:
+    struct Timing {
+        std::chrono::microseconds writeLatency{125}; // One USB 2.0 microframe per call
+        std::chrono::microseconds readLatency{125};
+        bool modelBusTime = true;                    // Replies wait for the serial clock
+    };
+
+    struct Faults {
+        double writeErrorRate = 0.0;   // write() fails with FT_IO_ERROR, nothing reaches the chip
+        double readErrorRate = 0.0;    // read() fails with FT_IO_ERROR
+        double dropReplyRate = 0.0;    // The reply of a write is lost, the host times out
+        double corruptReplyRate = 0.0; // One bit of the reply is flipped
+        bool unplugged = false;        // Every call fails with FT_DEVICE_NOT_FOUND / FT_IO_ERROR
+    };
+
+    SimulatedFTDITransport() = default;
+    ~SimulatedFTDITransport() override;
+
+    // Adds a device to the list, returns its index. Devices can not be removed, unplug them instead.
+    int addDevice(std::unique_ptr<MpsseTarget> board, const std::string& description, const std::string& serial,
+                  uint16_t vid = 0x0403, uint16_t pid = 0x6014);
+    // A MiniXBoardModel with default settings
+    int addMiniX(const std::string& serial);
+    // An FT2232H (2 boards) or FT4232H (4 boards): one listed device per interface, serial and description
+    // suffixed with the channel letter like D2XX does. The interfaces run independently but move their
+    // bytes over one shared USB link of linkBytesPerSecond, so heavy traffic on one slows the others.
+    // FT4232H channels C and D have no MPSSE. Returns the index of channel A, the others follow.
+    int addMultiInterface(std::vector<std::unique_ptr<MpsseTarget>> boards, const std::string& description, const std::string& serial,
+                          double linkBytesPerSecond = 40e6);
+
+    int deviceCount() const;
+    MpsseTarget& board(int index);
+    const MpsseEngine& engine(int index); // Pin state and command counters, do not hold across calls
+    void setTiming(int index, const Timing& timing);
+    void setFaults(int index, const Faults& faults);
+    void setTimingAll(const Timing& timing);
+    // write() and read() calls a device has taken while open, to check how many transfers a driver needs
+    struct CallCounts {
+        uint64_t writes = 0;
+        uint64_t reads = 0;
+    };
+    CallCounts callCounts(int index);
+
+    // ---- FTDITransport ----
+    FT_STATUS createDeviceInfoList(DWORD& deviceCount) override;
+    FT_STATUS getDeviceInfoDetail(DWORD index, FT_DEVICE_LIST_INFO_NODE& info) override;
+    FT_STATUS open(int index, FT_HANDLE& handle) override;
+    FT_STATUS close(FT_HANDLE handle) override;
+    FT_STATUS resetDevice(FT_HANDLE handle) override;
+    FT_STATUS purge(FT_HANDLE handle, ULONG mask) override;
+    FT_STATUS setUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize) override;
+    FT_STATUS setLatencyTimer(FT_HANDLE handle, UCHAR latencyMs) override;
+    FT_STATUS setTimeouts(FT_HANDLE handle, ULONG readTimeoutMs, ULONG writeTimeoutMs) override;
+    FT_STATUS setFlowControl(FT_HANDLE handle, USHORT flowControl, UCHAR xon, UCHAR xoff) override;
+    FT_STATUS setBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode) override;
+    FT_STATUS write(FT_HANDLE handle, const unsigned char* data, DWORD size, DWORD& bytesWritten) override;
+    FT_STATUS read(FT_HANDLE handle, unsigned char* buffer, DWORD size, DWORD& bytesRead) override;
+    FT_STATUS getQueueStatus(FT_HANDLE handle, DWORD& rxBytes) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Chunk {
+        std::vector<uint8_t> bytes;
+        size_t consumed = 0;
+        Clock::time_point readyAt;
+    };
+
+    // USB link of a multi-interface chip, transfers of all its interfaces take turns on it
+    struct Link {
+        std::mutex mutex;
+        double bytesPerSecond = 40e6;
+        Clock::time_point freeAt{};
+        Clock::time_point reserve(Clock::time_point from, size_t bytes); // Returns when the bytes are through
+    };
+
+    struct Device {
+        Device(std::unique_ptr<MpsseTarget> b, uint32_t seed) : board(std::move(b)), engine(*board), rng(seed) {}
+        std::unique_ptr<MpsseTarget> board;
+        MpsseEngine engine;
+        FT_DEVICE_LIST_INFO_NODE info{};
+        std::shared_ptr<Link> link;  // Multi-interface chips only
+        bool hasMPSSE = true;
+        std::mutex mutex; // Device state below
+        bool open = false;
+        bool mpsse = false;
+        UCHAR latencyTimerMs = 16;
+        ULONG readTimeoutMs = 0; // 0: D2XX default, waits for the data (capped at 1 s here)
+        Timing timing;
+        Faults faults;
+        CallCounts calls;
+        std::mt19937 rng;
+        std::deque<Chunk> rx;   // Replies in flight
+        std::vector<uint8_t> reply; // Scratch
+        Clock::time_point busFreeAt = SchedulerClock::current().now(); // Engine still clocking earlier commands until then
+    };
+
+    Device* lookup(FT_HANDLE handle) const; // Any device, open or not: callers check open under the device mutex
+    bool chance(Device& dev, double rate) { return rate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(dev.rng) < rate; }
+    static size_t readable(const Device& dev, Clock::time_point now);
+
+    mutable std::mutex listMutex;
+    std::vector<std::unique_ptr<Device>> devices;
+    // Validates handles for lookup(). Its own lock, shared by lookups, so I/O on different devices never waits on
+    // listMutex or on each other.
+    mutable std::shared_mutex handleMutex;
+    std::unordered_set<const Device*> handleSet;
+};
@@ -0,0 +1,381 @@
+#include "SimulatedUsbBackend.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+SimulatedUsbBackend::~SimulatedUsbBackend() = default;
+
+// ---- Virtual devices ----
+
+int SimulatedUsbBackend::addDevice(const DeviceConfig& config) {
+    Device* raw;
+    {
+        std::lock_guard<std::mutex> lk(listMutex);
+        auto dev = std::make_unique<Device>();
+        dev->id = static_cast<int>(devices.size());
+        dev->config = config;
+        if (dev->config.portPath.empty()) // Root hub port, then one of 200 ports on a hub behind it
+            dev->config.portPath = { static_cast<uint8_t>(1 + dev->id / 200), static_cast<uint8_t>(1 + dev->id % 200) };
+
+        libusb_device_descriptor& d = dev->descriptor;
+        d.bLength = LIBUSB_DT_DEVICE_SIZE;
+        d.bDescriptorType = LIBUSB_DT_DEVICE;
+        d.bcdUSB = 0x0200;
+        d.bDeviceClass = LIBUSB_CLASS_VENDOR_SPEC;
+        d.bMaxPacketSize0 = 64;
+        d.idVendor = config.vid;
+        d.idProduct = config.pid;
+        d.bcdDevice = config.bcdDevice;
+        d.iManufacturer = config.manufacturer.empty() ? 0 : 1;
+        d.iProduct = config.product.empty() ? 0 : 2;
+        d.iSerialNumber = config.serial.empty() ? 0 : 3;
+        d.bNumConfigurations = 1;
+        resetEndpoints(*dev);
+
+        raw = dev.get();
+        deviceSet.insert(raw);
+        devices.push_back(std::move(dev));
+    }
+    queueEvent(raw, true);
+    return raw->id;
+}
+
+void SimulatedUsbBackend::unplug(int id) {
+    Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(id).get(); }
+    {
+        std::lock_guard<std::mutex> lk(dev->mutex);
+        if (!dev->attached) return;
+        dev->attached = false;
+        dev->claimedInterfaces = 0;
+    }
+    queueEvent(dev, false);
+}
+
+void SimulatedUsbBackend::replug(int id) {
+    Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(id).get(); }
+    {
+        std::lock_guard<std::mutex> lk(dev->mutex);
+        if (dev->attached) return;
+        dev->attached = true;
+        resetEndpoints(*dev);
+    }
+    queueEvent(dev, true);
+}
+
+int SimulatedUsbBackend::deviceCount() const {
+    std::lock_guard<std::mutex> lk(listMutex);
+    return static_cast<int>(devices.size());
+}
+
+SimulatedUsbBackend::Stats SimulatedUsbBackend::stats(int id) const {
+    const Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(id).get(); }
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    return dev->stats;
+}
+
+int SimulatedUsbBackend::openHandleCount() const {
+    std::lock_guard<std::mutex> lk(listMutex);
+    return static_cast<int>(handles.size());
+}
+
+int SimulatedUsbBackend::referenceCount(int id) const {
+    const Device* dev;
+    { std::lock_guard<std::mutex> lk(listMutex); dev = devices.at(id).get(); }
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    return dev->references;
+}
+
+// ---- Helpers ----
+
+SimulatedUsbBackend::Device* SimulatedUsbBackend::toDevice(libusb_device* device) const {
+    // libusb_device is opaque, the pointers handed out are Device objects
+    Device* dev = reinterpret_cast<Device*>(device);
+    std::lock_guard<std::mutex> lk(listMutex);
+    return deviceSet.count(dev) ? dev : nullptr;
+}
+
+SimulatedUsbBackend::Handle* SimulatedUsbBackend::toHandle(libusb_device_handle* handle) const {
+    std::lock_guard<std::mutex> lk(listMutex);
+    auto it = handles.find(reinterpret_cast<const Handle*>(handle));
+    return it == handles.end() ? nullptr : it->second.get();
+}
+
+void SimulatedUsbBackend::resetEndpoints(Device& dev) {
+    // In place after the first call: a transfer still in flight on a replugged device keeps a valid endpoint
+    const Clock::time_point now = Clock::now();
+    if (dev.endpoints.empty())
+        for (const Endpoint& config : dev.config.endpoints) dev.endpoints.emplace_back().config = config;
+    for (EndpointState& ep : dev.endpoints) {
+        ep.fifoBytes = 0;
+        ep.fifoCarry = 0.0;
+        ep.lastFill = now;
+        ep.busyUntil = now;
+    }
+}
+
+void SimulatedUsbBackend::fill(EndpointState& ep, Clock::time_point now, Stats& stats) {
+    const double dt = std::chrono::duration<double>(now - ep.lastFill).count();
+    ep.lastFill = now;
+    if (ep.config.bytesPerSecond <= 0.0) { ep.fifoBytes = ep.config.bufferBytes; return; } // Unlimited: always full, nothing lost
+    if (dt <= 0.0) return;
+    ep.fifoCarry += ep.config.bytesPerSecond * dt;
+    const double whole = std::floor(ep.fifoCarry);
+    ep.fifoCarry -= whole;
+    const uint64_t produced = static_cast<uint64_t>(whole);
+    const size_t room = ep.config.bufferBytes - ep.fifoBytes;
+    if (produced > room) stats.overflowBytes += produced - room;
+    ep.fifoBytes += static_cast<size_t>(std::min<uint64_t>(produced, room));
+}
+
+void SimulatedUsbBackend::queueEvent(Device* dev, bool arrived) {
+    {
+        std::lock_guard<std::mutex> lk(eventMutex);
+        if (hotplugCallbacks.empty()) return; // Nobody listening, libusb drops these too
+        events.push_back({ dev, arrived });
+    }
+    eventCv.notify_all();
+}
+
+// ---- Enumeration ----
+
+int SimulatedUsbBackend::getDeviceList(std::vector<libusb_device*>& out) {
+    std::lock_guard<std::mutex> lk(listMutex);
+    for (auto& dev : devices) {
+        std::lock_guard<std::mutex> dlk(dev->mutex);
+        if (!dev->attached) continue;
+        dev->references++;
+        out.push_back(reinterpret_cast<libusb_device*>(dev.get()));
+    }
+    return LIBUSB_SUCCESS;
+}
+
+void SimulatedUsbBackend::refDevice(libusb_device* device) {
+    Device* dev = toDevice(device);
+    if (!dev) return;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    dev->references++;
+}
+
+void SimulatedUsbBackend::unrefDevice(libusb_device* device) {
+    Device* dev = toDevice(device);
+    if (!dev) return;
+    std::lock_guard<std::mutex> lk(dev->mutex);
+    if (dev->references > 0) dev->references--;
+}
+
+int SimulatedUsbBackend::getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) {
+    Device* dev = toDevice(device);
+    if (!dev) return LIBUSB_ERROR_INVALID_PARAM;
+    descriptor = dev->descriptor; // Immutable after addDevice
+    return LIBUSB_SUCCESS;
+}
+
+uint8_t SimulatedUsbBackend::getBusNumber(libusb_device* device) {
+    Device* dev = toDevice(device);
+    return dev ? dev->config.busNumber : 0;
+}
+
+int SimulatedUsbBackend::getPortNumbers(libusb_device* device, uint8_t* ports, int length) {
+    Device* dev = toDevice(device);
+    if (!dev) return LIBUSB_ERROR_INVALID_PARAM;
+    const std::vector<uint8_t>& path = dev->config.portPath;
+    if (static_cast<int>(path.size()) > length) return LIBUSB_ERROR_OVERFLOW;
+    std::copy(path.begin(), path.end(), ports);
+    return static_cast<int>(path.size());
+}
+
+// ---- Device ----
+
+int SimulatedUsbBackend::open(libusb_device* device, libusb_device_handle** handle) {
+    Device* dev = toDevice(device);
+    if (!dev || !handle) return LIBUSB_ERROR_INVALID_PARAM;
+    {
+        std::lock_guard<std::mutex> lk(dev->mutex);
+        if (!dev->attached) return LIBUSB_ERROR_NO_DEVICE;
+        dev->references++; // An open handle keeps its device referenced, like libusb
+    }
+    auto h = std::make_unique<Handle>();
+    h->device = dev;
+    *handle = reinterpret_cast<libusb_device_handle*>(h.get());
+    std::lock_guard<std::mutex> lk(listMutex);
+    handles.emplace(h.get(), std::move(h));
+    return LIBUSB_SUCCESS;
+}
+
+void SimulatedUsbBackend::close(libusb_device_handle* handle) {
+    std::unique_ptr<Handle> h;
+    {
+        std::lock_guard<std::mutex> lk(listMutex);
+        auto it = handles.find(reinterpret_cast<const Handle*>(handle));
+        if (it == handles.end()) return;
+        h = std::move(it->second);
+        handles.erase(it);
+    }
+    std::lock_guard<std::mutex> lk(h->device->mutex);
+    if (h->device->references > 0) h->device->references--;
+}
+
+int SimulatedUsbBackend::getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) {
+    Handle* h = toHandle(handle);
+    if (!h || !data || length <= 0) return LIBUSB_ERROR_INVALID_PARAM;
+    std::lock_guard<std::mutex> lk(h->device->mutex);
+    if (!h->device->attached) return LIBUSB_ERROR_NO_DEVICE;
+    const DeviceConfig& c = h->device->config;
+    const std::string* text = index == 1 ? &c.manufacturer : index == 2 ? &c.product : index == 3 ? &c.serial : nullptr;
+    if (!text || text->empty()) return LIBUSB_ERROR_PIPE; // STALL on an unknown string index
+    const int n = std::min(static_cast<int>(text->size()), length - 1);
+    std::memcpy(data, text->data(), static_cast<size_t>(n));
+    data[n] = 0;
+    return n;
+}
+
+int SimulatedUsbBackend::claimInterface(libusb_device_handle* handle, int interfaceNumber) {
+    Handle* h = toHandle(handle);
+    if (!h || interfaceNumber < 0 || interfaceNumber > 31) return LIBUSB_ERROR_NOT_FOUND;
+    std::lock_guard<std::mutex> lk(h->device->mutex);
+    if (!h->device->attached) return LIBUSB_ERROR_NO_DEVICE;
+    if (h->device->claimedInterfaces & (1 << interfaceNumber)) return LIBUSB_ERROR_BUSY;
+    h->device->claimedInterfaces |= 1 << interfaceNumber;
+    return LIBUSB_SUCCESS;
+}
+
+int SimulatedUsbBackend::releaseInterface(libusb_device_handle* handle, int interfaceNumber) {
+    Handle* h = toHandle(handle);
+    if (!h || interfaceNumber < 0 || interfaceNumber > 31) return LIBUSB_ERROR_NOT_FOUND;
+    std::lock_guard<std::mutex> lk(h->device->mutex);
+    if (!h->device->attached) return LIBUSB_ERROR_NO_DEVICE;
+    h->device->claimedInterfaces &= ~(1 << interfaceNumber);
+    return LIBUSB_SUCCESS;
+}
+
+// ---- Data ----
+
+int SimulatedUsbBackend::bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                                      int* transferred, unsigned int timeoutMs) {
+    if (transferred) *transferred = 0;
+    Handle* h = toHandle(handle);
+    if (!h || !data || length < 0 || !transferred) return LIBUSB_ERROR_INVALID_PARAM;
+    Device& dev = *h->device;
+
+    EndpointState* ep = nullptr;
+    std::chrono::microseconds latency{0};
+    {
+        std::lock_guard<std::mutex> lk(dev.mutex);
+        if (!dev.attached) return LIBUSB_ERROR_NO_DEVICE;
+        for (EndpointState& candidate : dev.endpoints)
+            if (candidate.config.address == endpoint) { ep = &candidate; break; }
+        if (!ep) return LIBUSB_ERROR_PIPE; // No such endpoint, the host sees a STALL
+        latency = ep->config.latency;
+        dev.stats.transfers++;
+    }
+
+    // libusb: a timeout of 0 waits forever. Capped here so a stalled scenario still ends.
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs ? timeoutMs : 60000);
+    if (latency.count() > 0) std::this_thread::sleep_for(latency);
+    return (endpoint & LIBUSB_ENDPOINT_IN) ? transferIn(dev, *ep, data, length, transferred, deadline)
+                                          : transferOut(dev, *ep, data, length, transferred, deadline);
+}
+
+int SimulatedUsbBackend::transferIn(Device& dev, EndpointState& ep, unsigned char* data, int length, int* transferred, Clock::time_point deadline) {
+    if (ep.config.sourcePaced && ep.config.source) {
+        const Clock::duration poll = std::max<Clock::duration>(ep.config.latency, std::chrono::microseconds(125));
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lk(dev.mutex);
+                if (!dev.attached) return LIBUSB_ERROR_NO_DEVICE;
+                const size_t n = ep.config.source(data, static_cast<size_t>(length));
+                if (n > 0) {
+                    dev.stats.bytesIn += n;
+                    *transferred = static_cast<int>(n);
+                    return LIBUSB_SUCCESS;
+                }
+                if (Clock::now() >= deadline) { dev.stats.timeouts++; return LIBUSB_ERROR_TIMEOUT; }
+            }
+            std::this_thread::sleep_until(std::min(Clock::now() + poll, deadline));
+        }
+    }
+
+    for (;;) {
+        Clock::time_point wakeAt;
+        {
+            std::lock_guard<std::mutex> lk(dev.mutex);
+            if (!dev.attached) return LIBUSB_ERROR_NO_DEVICE;
+            const Clock::time_point now = Clock::now();
+            fill(ep, now, dev.stats);
+
+            const size_t wanted = std::min({ static_cast<size_t>(length), ep.config.maxPacketSize, ep.config.bufferBytes });
+            if (ep.fifoBytes >= wanted || (ep.fifoBytes > 0 && now >= deadline)) {
+                size_t n = std::min(static_cast<size_t>(length), ep.fifoBytes);
+                if (ep.config.source) n = std::min(n, ep.config.source(data, n));
+                else std::memset(data, 0, n);
+                if (ep.config.bytesPerSecond > 0.0) ep.fifoBytes -= n;
+                dev.stats.bytesIn += n;
+                *transferred = static_cast<int>(n);
+                return LIBUSB_SUCCESS;
+            }
+            if (now >= deadline) { dev.stats.timeouts++; return LIBUSB_ERROR_TIMEOUT; }
+
+            const double missing = static_cast<double>(wanted - ep.fifoBytes) - ep.fifoCarry;
+            wakeAt = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(missing / ep.config.bytesPerSecond));
+        }
+        std::this_thread::sleep_until(std::min(wakeAt, deadline));
+    }
+}
+
+int SimulatedUsbBackend::transferOut(Device& dev, EndpointState& ep, const unsigned char* data, int length, int* transferred, Clock::time_point deadline) {
+    Clock::time_point doneAt;
+    bool timedOut = false;
+    {
+        std::lock_guard<std::mutex> lk(dev.mutex);
+        if (!dev.attached) return LIBUSB_ERROR_NO_DEVICE;
+        const Clock::time_point now = Clock::now();
+        const double seconds = ep.config.bytesPerSecond > 0.0 ? length / ep.config.bytesPerSecond : 0.0;
+        doneAt = std::max(now, ep.busyUntil) + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        if (doneAt > deadline) { // Only what the device accepts before the deadline goes through
+            const double accepted = std::max(0.0, std::chrono::duration<double>(deadline - std::max(now, ep.busyUntil)).count()) * ep.config.bytesPerSecond;
+            length = std::min(length, static_cast<int>(accepted));
+            doneAt = deadline;
+            timedOut = true;
+            dev.stats.timeouts++;
+        }
+        ep.busyUntil = doneAt;
+        if (ep.config.sink && length > 0) ep.config.sink(data, static_cast<size_t>(length));
+        dev.stats.bytesOut += static_cast<uint64_t>(length);
+        *transferred = length;
+    }
+    std::this_thread::sleep_until(doneAt);
+    return timedOut ? LIBUSB_ERROR_TIMEOUT : LIBUSB_SUCCESS; // With the partial count in transferred, like libusb
+}
+
+// ---- Hotplug ----
+
+int SimulatedUsbBackend::registerHotplug(HotplugCallback callback) {
+    std::lock_guard<std::mutex> lk(eventMutex);
+    const int id = nextCallbackId++;
+    hotplugCallbacks.emplace_back(id, std::move(callback));
+    return id;
+}
+
+void SimulatedUsbBackend::deregisterHotplug(int id) {
+    std::lock_guard<std::mutex> lk(eventMutex);
+    std::erase_if(hotplugCallbacks, [id](const auto& entry){ return entry.first == id; });
+}
+
+int SimulatedUsbBackend::handleEvents(int timeoutMs) {
+    std::deque<HotplugEvent> pending;
+    std::vector<HotplugCallback> callbacks;
+    {
+        std::unique_lock<std::mutex> lk(eventMutex);
+        eventCv.wait_for(lk, std::chrono::milliseconds(std::max(timeoutMs, 0)), [this]{ return !events.empty(); });
+        pending.swap(events);
+        for (auto& entry : hotplugCallbacks) callbacks.push_back(entry.second);
+    }
+    // Outside the lock, a callback may scan, open or deregister
+    for (const HotplugEvent& event : pending)
+        for (auto& callback : callbacks) callback(reinterpret_cast<libusb_device*>(event.device), event.arrived);
+    return LIBUSB_SUCCESS;
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "CompHandlers/UsbBackend.hpp"
+
+// UsbBackend with virtual devices instead of libusb, so LibUsbHandler, DeviceHandler matching and
+// UsbConnection transfers run without hardware, and hundreds of detectors can be attached at once.
+//
+// Each device has its descriptors, strings, bus number and port path, and a set of bulk endpoints.
+// IN endpoints produce data at a set rate into a bounded device FIFO (bytes that do not fit are counted
+// as overflow, like a detector losing events when the host does not keep up); OUT endpoints consume at
+// a set rate. Every transfer also pays a fixed latency. A bulk IN transfer completes once at least one
+// packet is buffered and returns everything buffered up to the requested length, or times out.
+//
+// Hotplug: addDevice(), unplug() and replug() queue arrival/departure events that registered callbacks
+// receive from handleEvents(), the same thread model as libusb. Handles of an unplugged device fail
+// with LIBUSB_ERROR_NO_DEVICE.
+//
+// Usage:
+//   auto usb = std::make_unique<SimulatedUsbBackend>();
+//   SimulatedUsbBackend::DeviceConfig cfg; cfg.vid = 0x1234; cfg.pid = 0x0001; cfg.serial = "DET-001";
+//   cfg.endpoints.push_back({ .address = 0x81, .bytesPerSecond = 8e6 });
+//   usb->addDevice(cfg);
+//   LibUsbHandler::Instance().setBackend(std::move(usb)); // Before scanning
+class SimulatedUsbBackend : public UsbBackend {
+public:
+    struct Endpoint {
+        uint8_t address = 0x81;                       // Bit 7 set = IN (device to host)
+        double bytesPerSecond = 0.0;                  // Production (IN) or consumption (OUT) rate, 0 = unlimited
+        std::chrono::microseconds latency{125};       // Per transfer, one USB 2.0 microframe
+        size_t maxPacketSize = 512;
+        size_t bufferBytes = 64 * 1024;               // IN: device FIFO size
+        // IN: writes up to max bytes of payload, returns the count written. Default: zeros.
+        // Called with the device locked, keep it short and do not call back into the backend.
+        std::function<size_t(uint8_t* data, size_t max)> source;
+        // OUT: receives every payload written. Same locking rules as source.
+        std::function<void(const uint8_t* data, size_t size)> sink;
+        // IN: the source keeps its own schedule (e.g. a detector model emitting events as they happen).
+        // The rate and FIFO model is off; a transfer polls the source once per latency period (at least
+        // one microframe) until it returns data, like a host controller polling a NAKing endpoint.
+        bool sourcePaced = false;
+    };
+
+    struct DeviceConfig {
+        uint16_t vid = 0;
+        uint16_t pid = 0;
+        uint16_t bcdDevice = 0x0100;
+        std::string manufacturer;
+        std::string product;
+        std::string serial;
+        uint8_t busNumber = 1;
+        std::vector<uint8_t> portPath;                // Empty: a unique hub/port path is assigned
+        std::vector<Endpoint> endpoints;
+    };
+
+    struct Stats {
+        uint64_t bytesIn = 0;        // Delivered to the host
+        uint64_t bytesOut = 0;       // Accepted from the host
+        uint64_t overflowBytes = 0;  // Produced while the IN FIFO was full
+        uint64_t transfers = 0;
+        uint64_t timeouts = 0;
+    };
+
+    SimulatedUsbBackend() = default;
+    ~SimulatedUsbBackend() override;
+
+    // Attaches a device, returns its id. Queues an arrival event.
+    int addDevice(const DeviceConfig& config);
+    void unplug(int id);    // Queues a departure event, open handles fail from now on
+    void replug(int id);    // Attaches again (same descriptors, fresh FIFOs), queues an arrival event
+    int deviceCount() const;
+    Stats stats(int id) const;
+    int openHandleCount() const;
+    int referenceCount(int id) const; // libusb_device references held by the host, for leak checks
+
+    // ---- UsbBackend ----
+    int initialize() override { return LIBUSB_SUCCESS; }
+    void shutdown() override {}
+    int getDeviceList(std::vector<libusb_device*>& devices) override;
+    void refDevice(libusb_device* device) override;
+    void unrefDevice(libusb_device* device) override;
+    int getDeviceDescriptor(libusb_device* device, libusb_device_descriptor& descriptor) override;
+    uint8_t getBusNumber(libusb_device* device) override;
+    int getPortNumbers(libusb_device* device, uint8_t* ports, int length) override;
+    int open(libusb_device* device, libusb_device_handle** handle) override;
+    void close(libusb_device_handle* handle) override;
+    int getStringDescriptorAscii(libusb_device_handle* handle, uint8_t index, unsigned char* data, int length) override;
+    int claimInterface(libusb_device_handle* handle, int interfaceNumber) override;
+    int releaseInterface(libusb_device_handle* handle, int interfaceNumber) override;
+    int bulkTransfer(libusb_device_handle* handle, unsigned char endpoint, unsigned char* data, int length,
+                     int* transferred, unsigned int timeoutMs) override;
+    int registerHotplug(HotplugCallback callback) override;
+    void deregisterHotplug(int id) override;
+    int handleEvents(int timeoutMs) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct EndpointState {
+        Endpoint config;
+        size_t fifoBytes = 0;     // IN: bytes buffered in the device
+        double fifoCarry = 0.0;   // IN: fractional bytes produced
+        Clock::time_point lastFill;
+        Clock::time_point busyUntil; // OUT: still consuming earlier data
+    };
+
+    struct Device {
+        int id = 0;
+        DeviceConfig config;
+        libusb_device_descriptor descriptor{};
+        mutable std::mutex mutex; // State below
+        bool attached = true;
+        int references = 0;
+        int claimedInterfaces = 0; // Bit mask
+        std::vector<EndpointState> endpoints;
+        Stats stats;
+    };
+
+    struct Handle {
+        Device* device = nullptr;
+    };
+
+    struct HotplugEvent {
+        Device* device;
+        bool arrived;
+    };
+
+    Device* toDevice(libusb_device* device) const;
+    Handle* toHandle(libusb_device_handle* handle) const;
+    static void resetEndpoints(Device& dev);
+    static void fill(EndpointState& ep, Clock::time_point now, Stats& stats);
+    void queueEvent(Device* dev, bool arrived);
+    int transferIn(Device& dev, EndpointState& ep, unsigned char* data, int length, int* transferred, Clock::time_point deadline);
+    int transferOut(Device& dev, EndpointState& ep, const unsigned char* data, int length, int* transferred, Clock::time_point deadline);
+
+    mutable std::mutex listMutex;
+    std::vector<std::unique_ptr<Device>> devices;       // Never removed, unplugged devices stay detached
+    std::unordered_set<const Device*> deviceSet;        // Validates libusb_device pointers
+    std::unordered_map<const Handle*, std::unique_ptr<Handle>> handles;
+
+    std::mutex eventMutex;
+    std::condition_variable eventCv;
+    std::deque<HotplugEvent> events;
+    std::vector<std::pair<int, HotplugCallback>> hotplugCallbacks;
+    int nextCallbackId = 1;
+};
@@ -0,0 +1,177 @@
+#include "SyntheticDetectorModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    constexpr double FwhmToSigma = 1.0 / 2.3548;
+}
+
+SyntheticDetectorModel::Config SyntheticDetectorModel::co60() {
+    Config c;
+    c.peaks = { {1173.2, 65.0, 1.0}, {1332.5, 70.0, 1.0} };
+    c.continuumScaleKeV = 400.0;
+    return c;
+}
+
+SyntheticDetectorModel::SyntheticDetectorModel(const Config& cfg) : config(cfg), rng(cfg.seed) {
+    std::lock_guard<std::mutex> lk(mutex);
+    std::normal_distribution<float> n(0.0f, 1.0f);
+    for (float& v : noise) v = n(rng);
+    rebuild();
+}
+
+void SyntheticDetectorModel::rebuild() {
+    config.countRate = std::clamp(config.countRate, 0.0, 1e8);
+    config.channels = std::max(config.channels, 1);
+    std::vector<double> weights;
+    double peakSum = 0.0;
+    for (const Peak& p : config.peaks) { weights.push_back(std::max(p.weight, 0.0)); peakSum += std::max(p.weight, 0.0); }
+    weights.push_back(config.peaks.empty() ? 1.0 : config.continuumWeight * peakSum);
+    component = std::discrete_distribution<int>(weights.begin(), weights.end());
+    decayFactor = config.decaySamples > 0.0 ? std::exp(-1.0 / config.decaySamples) : 0.0;
+
+    start = Clock::now();
+    samplesProduced = 0;
+    tail = 0.0;
+    fifo.clear();
+    nextEventNs = 0.0;
+    nextArrival();
+}
+
+void SyntheticDetectorModel::nextArrival() {
+    // Poisson process: exponential gaps, drawn at the current rate (memoryless, so rate changes apply at once)
+    if (config.countRate <= 0.0) { nextEventNs = std::numeric_limits<double>::infinity(); return; }
+    nextEventNs += interval(rng) * 1e9 / config.countRate;
+}
+
+double SyntheticDetectorModel::sampleEnergy() {
+    const int which = component(rng);
+    if (which < static_cast<int>(config.peaks.size())) {
+        const Peak& p = config.peaks[which];
+        return p.energyKeV + gauss(rng) * p.fwhmKeV * FwhmToSigma;
+    }
+    // Truncated exponential continuum, by inverse CDF
+    const double s = std::max(config.continuumScaleKeV, 1e-3);
+    const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    return -s * std::log(1.0 - u * (1.0 - std::exp(-config.maxEnergyKeV / s)));
+}
+
+void SyntheticDetectorModel::catchUp(uint64_t now) {
+    while (nextEventNs <= static_cast<double>(now)) {
+        if (fifo.size() >= config.fifoEvents) {
+            // Full: everything until now is lost. Count it in one draw instead of generating each event.
+            const double gapS = (static_cast<double>(now) - nextEventNs) * 1e-9;
+            const uint64_t missed = 1 + std::poisson_distribution<uint64_t>(config.countRate * gapS)(rng);
+            stats.generated += missed;
+            stats.lost += missed;
+            nextEventNs = static_cast<double>(now);
+            nextArrival();
+            return;
+        }
+        const double energy = sampleEnergy();
+        SyntheticWire::Event e;
+        e.timestampNs = static_cast<uint64_t>(nextEventNs);
+        const double channel = std::max(energy, 0.0) / config.keVPerChannel;
+        if (channel >= config.channels) { e.channel = static_cast<uint16_t>(config.channels - 1); e.flags = SyntheticWire::FlagClipped; }
+        else e.channel = static_cast<uint16_t>(channel);
+        fifo.push_back(e);
+        stats.generated++;
+        nextArrival();
+    }
+}
+
+size_t SyntheticDetectorModel::readListMode(uint8_t* out, size_t max) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (config.waveforms) return 0;
+    catchUp(nowNs());
+    const size_t count = std::min(fifo.size(), max / SyntheticWire::EventBytes);
+    for (size_t i = 0; i < count; ++i) SyntheticWire::encode(fifo[i], out + i * SyntheticWire::EventBytes);
+    fifo.erase(fifo.begin(), fifo.begin() + static_cast<std::ptrdiff_t>(count));
+    stats.delivered += count;
+    return count * SyntheticWire::EventBytes;
+}
+
+size_t SyntheticDetectorModel::readWaveform(uint8_t* out, size_t max) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (!config.waveforms) return 0;
+    const double nsPerSample = 1e9 / config.sampleRateHz;
+    const uint64_t due = static_cast<uint64_t>(static_cast<double>(nowNs()) / nsPerSample);
+    if (due <= samplesProduced) return 0;
+
+    uint64_t backlog = due - samplesProduced;
+    if (backlog > config.fifoSamples) {
+        // Overflowed: skip to the oldest sample still buffered. Pulses in the gap are generated but never seen.
+        const uint64_t skip = backlog - config.fifoSamples;
+        samplesProduced += skip;
+        stats.samplesLost += skip;
+        while (nextEventNs < static_cast<double>(samplesProduced) * nsPerSample) { stats.generated++; nextArrival(); }
+        tail = 0.0;
+        backlog = config.fifoSamples;
+    }
+
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(backlog, max / sizeof(int16_t)));
+    double nextEventSample = nextEventNs / nsPerSample;
+    for (size_t i = 0; i < count; ++i) {
+        const double k = static_cast<double>(samplesProduced + i);
+        while (nextEventSample <= k) {
+            tail += std::max(sampleEnergy(), 0.0) * config.adcPerKeV;
+            stats.generated++;
+            nextArrival();
+            nextEventSample = nextEventNs / nsPerSample;
+        }
+        noiseState = noiseState * 1664525u + 1013904223u; // LCG picks a precomputed noise value
+        const double v = config.baselineAdc + tail + noise[noiseState >> 20] * config.noiseAdc;
+        const int16_t sample = static_cast<int16_t>(std::clamp(std::lround(v), -32768l, 32767l));
+        std::memcpy(out + i * sizeof(int16_t), &sample, sizeof(sample)); // Little-endian hosts only, like the driver
+        tail *= decayFactor;
+    }
+    samplesProduced += count;
+    stats.samplesDelivered += count;
+    return count * sizeof(int16_t);
+}
+
+void SyntheticDetectorModel::command(const uint8_t* data, size_t size) {
+    for (size_t pos = 0; pos + SyntheticWire::CommandBytes <= size; pos += SyntheticWire::CommandBytes) {
+        double value;
+        std::memcpy(&value, data + pos + 1, sizeof(value));
+        switch (data[pos]) {
+            case SyntheticWire::SetCountRate: setCountRate(value); break;
+            case SyntheticWire::SetWaveforms: setWaveforms(value != 0.0); break;
+            case SyntheticWire::Reset: reset(); break;
+            default: break; // Unknown commands are ignored, like the real thing would
+        }
+    }
+}
+
+void SyntheticDetectorModel::setCountRate(double countsPerSecond) {
+    std::lock_guard<std::mutex> lk(mutex);
+    const uint64_t now = nowNs();
+    if (!config.waveforms) catchUp(now); // Events so far keep the old rate
+    config.countRate = std::clamp(countsPerSecond, 0.0, 1e8);
+    nextEventNs = std::max(static_cast<double>(now), config.waveforms ? static_cast<double>(samplesProduced) * 1e9 / config.sampleRateHz : 0.0);
+    nextArrival();
+}
+
+void SyntheticDetectorModel::setWaveforms(bool on) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (config.waveforms == on) return;
+    config.waveforms = on;
+    rebuild();
+}
+
+void SyntheticDetectorModel::reset() {
+    std::lock_guard<std::mutex> lk(mutex);
+    rebuild();
+}
+
+SyntheticDetectorModel::Config SyntheticDetectorModel::getConfig() const {
+    std::lock_guard<std::mutex> lk(mutex);
+    return config;
+}
+
+SyntheticDetectorModel::Stats SyntheticDetectorModel::getStats() const {
+    std::lock_guard<std::mutex> lk(mutex);
+    return stats;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// Wire format between a synthetic detector's firmware (SyntheticDetectorModel) and its driver
+// (SyntheticDetector). All values little-endian.
+namespace SyntheticWire {
+    constexpr uint8_t CommandEndpoint = 0x01;   // OUT: 9-byte commands
+    constexpr uint8_t ListModeEndpoint = 0x81;  // IN: list-mode events, whole events per transfer
+    constexpr uint8_t WaveformEndpoint = 0x82;  // IN: continuous int16 ADC samples, whole samples per transfer
+    constexpr uint16_t Vid = 0x1209;            // pid.codes test range
+    constexpr uint16_t Pid = 0x5D37;
+
+    constexpr size_t EventBytes = 12;
+    constexpr uint16_t FlagClipped = 0x0001;    // Energy above the last channel, reported in the last channel
+
+    struct Event {
+        uint64_t timestampNs = 0;               // Since the firmware was started or reset
+        uint16_t channel = 0;
+        uint16_t flags = 0;
+    };
+
+    inline void encode(const Event& e, uint8_t* out) {
+        for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(e.timestampNs >> (8 * i));
+        out[8] = static_cast<uint8_t>(e.channel); out[9] = static_cast<uint8_t>(e.channel >> 8);
+        out[10] = static_cast<uint8_t>(e.flags); out[11] = static_cast<uint8_t>(e.flags >> 8);
+    }
+
+    inline Event decode(const uint8_t* in) {
+        Event e;
+        for (int i = 0; i < 8; ++i) e.timestampNs |= static_cast<uint64_t>(in[i]) << (8 * i);
+        e.channel = static_cast<uint16_t>(in[8] | in[9] << 8);
+        e.flags = static_cast<uint16_t>(in[10] | in[11] << 8);
+        return e;
+    }
+
+    // Command: opcode byte followed by a double
+    constexpr size_t CommandBytes = 9;
+    enum Command : uint8_t {
+        SetCountRate = 1,   // counts/s
+        SetWaveforms = 2,   // 0 list mode, 1 waveform stream
+        Reset = 3,          // Restarts the clock and drops everything buffered
+    };
+}
+
+// Firmware model of a synthetic radiation detector, the event source behind a simulated USB device.
+// Events follow a Poisson process at the configured count rate (1 to 1e7 counts/s). Energies are drawn
+// from a spectrum of gaussian peaks on an exponential continuum.
+//
+// - List mode: every event is sent as timestamp + channel (SyntheticWire::Event).
+// - Waveform mode: a continuous ADC sample stream at sampleRateHz, each event a step with exponential
+//   decay (a charge-sensitive preamp) plus gaussian noise, for PulseProcessor.
+//
+// The model runs in real time: a read delivers what happened up to now. Anything the host does not
+// collect within the firmware FIFO is lost and counted, the way a real detector drops data when the
+// readout falls behind. Thread-safe.
+class SyntheticDetectorModel {
+public:
+    struct Peak {
+        double energyKeV = 661.7;
+        double fwhmKeV = 45.0;
+        double weight = 1.0;    // Relative intensity
+    };
+
+    struct Config {
+        double countRate = 1e4;                         // Mean counts/s
+        std::vector<Peak> peaks = { {661.7, 45.0, 1.0} }; // Cs-137 on a NaI-like resolution
+        double continuumWeight = 1.5;                   // Relative to the summed peak weights
+        double continuumScaleKeV = 250.0;               // Exponential continuum slope
+        double maxEnergyKeV = 3000.0;
+        int channels = 4096;
+        double keVPerChannel = 0.75;
+        size_t fifoEvents = 1 << 16;                    // List mode buffer
+        // Waveform mode
+        bool waveforms = false;
+        double sampleRateHz = 10e6;
+        double decaySamples = 500.0;                    // Preamp decay constant
+        double adcPerKeV = 4.0;
+        double noiseAdc = 2.0;                          // RMS
+        int baselineAdc = 1000;
+        size_t fifoSamples = 1 << 20;                   // Waveform buffer
+        uint32_t seed = 1;
+    };
+
+    struct Stats {
+        uint64_t generated = 0;     // Events produced by the source
+        uint64_t delivered = 0;     // List mode events handed to the host
+        uint64_t lost = 0;          // List mode events dropped on FIFO overflow
+        uint64_t samplesDelivered = 0;
+        uint64_t samplesLost = 0;
+    };
+
+    static Config cs137() { return Config{}; }
+    static Config co60();   // 1173 and 1332 keV lines
+
+    explicit SyntheticDetectorModel(const Config& config);
+
+    // IN endpoint sources. Fill at most max bytes with whole events/samples, return the bytes written.
+    size_t readListMode(uint8_t* out, size_t max);
+    size_t readWaveform(uint8_t* out, size_t max);
+
+    // OUT endpoint sink, SyntheticWire commands.
+    void command(const uint8_t* data, size_t size);
+
+    void setCountRate(double countsPerSecond);
+    void setWaveforms(bool on);
+    void reset();
+    Config getConfig() const;
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void rebuild();                     // Requires mutex
+    void catchUp(uint64_t nowNs);       // Generates list mode events up to now, requires mutex
+    void nextArrival();
+    double sampleEnergy();
+    uint64_t nowNs() const { return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()); }
+
+    mutable std::mutex mutex;
+    Config config;
+    Stats stats;
+    std::mt19937_64 rng;
+    std::exponential_distribution<double> interval{1.0};
+    std::discrete_distribution<int> component;  // 0..peaks-1, peaks = continuum
+    std::normal_distribution<double> gauss{0.0, 1.0};
+
+    Clock::time_point start = Clock::now();
+    double nextEventNs = 0.0;
+    std::deque<SyntheticWire::Event> fifo;
+
+    // Waveform generator state
+    uint64_t samplesProduced = 0;
+    double tail = 0.0;                  // Sum of decaying pulses
+    double decayFactor = 1.0;
+    std::array<float, 4096> noise{};    // Precomputed gaussian noise, indexed by a fast generator
+    uint32_t noiseState = 1;
+};
@@ -1,10 +1,87 @@
 #include "System.hpp"
 #include "Debug.hpp"
+#include "Diagnostics/MetricsEndpoint.hpp"
+#include "Diagnostics/Trace.hpp"
+#include "Diagnostics/TrafficCapture.hpp"
+#include "CompHandlers/CaptureTransport.hpp"
+#include "CompHandlers/FTDIHandler.hpp"
+#include "CompHandlers/LibUsbHandler.hpp"
+#include "CompHandlers/EventLoop.hpp"
+#include "Simulation/ReplayTransport.hpp"
 #include <stdlib.h>
+#include <sstream>
 #include <string>
 #include <iostream>
 using namespace std;
 
+namespace {
+        // RADCAT_CAPTURE=<file>: record all FTDI and USB traffic from start-up
+        void startCapture(const char* path) {
+                if (!TrafficCapture::Instance().start(path)) return;
+                FTDIHandler::Instance().wrapTransport([](std::unique_ptr<FTDITransport> inner) { return std::make_unique<CaptureFTDITransport>(std::move(inner)); });
+                LibUsbHandler::Instance().wrapBackend([](std::unique_ptr<UsbBackend> inner) { return std::make_unique<CaptureUsbBackend>(std::move(inner)); });
+        }
+
+        // RADCAT_FTDI_BACKEND=libusb|d2xx: driver for FTDI devices, D2XX by default
+        // RADCAT_FTDI_LIBUSB=<serial>,<serial>...: devices (or whole multi-interface chips) driven over libusb regardless
+        void configureFtdiBackends() {
+                FTDIHandler& ftdi = FTDIHandler::Instance();
+                if (const char* backend = std::getenv("RADCAT_FTDI_BACKEND")) {
+                        if (std::string(backend) == "libusb") ftdi.setDefaultBackend(FTDIHandler::Backend::LibUsb);
+                        else if (std::string(backend) != "d2xx") Debug.Warn("Unknown RADCAT_FTDI_BACKEND ", backend, ", using D2XX");
+                }
+                if (const char* serials = std::getenv("RADCAT_FTDI_LIBUSB")) {
+                        std::stringstream list(serials);
+                        for (std::string serial; std::getline(list, serial, ',');)
+                                if (!serial.empty()) ftdi.setBackend(serial, FTDIHandler::Backend::LibUsb);
+                }
+        }
+
+        // RADCAT_REPLAY=<file>: run against a recorded capture instead of the hardware
+        void startReplay(const char* path) {
+                Capture::File capture;
+                std::string error;
+                if (!Capture::load(path, capture, &error)) { Debug.Error("Could not load capture ", path, ": ", error); return; }
+                if (capture.droppedTransfers > 0 || capture.truncated) Debug.Warn("Capture ", path, " is incomplete, replay may diverge");
+                FTDIHandler::Instance().setTransport(std::make_unique<ReplayFTDITransport>(capture));
+                LibUsbHandler::Instance().setBackend(std::make_unique<ReplayUsbBackend>(capture));
+                Debug.Log("Replaying device traffic from ", path);
+        }
+
+        // RADCAT_TELEMETRY=<address>[:<port>] | off: where the UDP telemetry goes, a multicast group by default
+        UdpHandler::Config telemetryConfig() {
+                UdpHandler::Config config;
+                const char* target = std::getenv("RADCAT_TELEMETRY");
+                if (!target) return config;
+                const std::string value(target);
+                if (value == "off") { config.enabled = false; return config; }
+                const size_t colon = value.rfind(':');
+                config.address = value.substr(0, colon);
+                if (colon != std::string::npos) config.port = static_cast<uint16_t>(std::strtoul(value.c_str() + colon + 1, nullptr, 10));
+                return config;
+        }
+
+        // RADCAT_REMOTE=<port>,<unix socket path>... | off: where the remote control server listens, 127.0.0.1:7425 by default.
+        // A number is the TCP port (0 for any free one), anything else a Unix socket. Without a number, TCP is off.
+        RemoteControl::Config remoteConfig() {
+                RemoteControl::Config config;
+                const char* listen = std::getenv("RADCAT_REMOTE");
+                if (!listen) return config;
+                if (std::string(listen) == "off") { config.enabled = false; return config; }
+                config.tcp = false;
+                std::stringstream list(listen);
+                for (std::string entry; std::getline(list, entry, ',');) {
+                        if (entry.empty()) continue;
+                        if (entry.find_first_not_of("0123456789") == std::string::npos) {
+                                config.tcp = true;
+                                config.tcpPort = static_cast<uint16_t>(std::strtoul(entry.c_str(), nullptr, 10));
+                        }
+                        else config.unixPath = entry;
+                }
+                return config;
+        }
+}
+
 bool System::systemInitializor() {
         bool CurrentStatus = true;
         Debug.Log("==================================");
@@ -13,9 +90,23 @@ bool System::systemInitializor() {
         //Initialize Data Handler
         Debug.Log("Initializing Data Handler...");
 
+        Debug.Log("Initializing Metrics Endpoint...");
+        MetricsEndpoint::Instance().start(); // Optional, a busy port only disables the endpoint
+        if (std::getenv("RADCAT_TRACE")) Trace::setEnabled(true); // Trace from start-up, export from the File menu
+        if (const char* replay = std::getenv("RADCAT_REPLAY")) startReplay(replay); // Replays through the D2XX slot, backend selection does not apply
+        else {
+                configureFtdiBackends();
+                if (const char* capture = std::getenv("RADCAT_CAPTURE")) startCapture(capture);
+        }
+
         Debug.Log("Initializing UDP Handler...");
-        //if(udpHandler.start()){Debug.Log("UDP Handler Initialized Successfully.");} 
-        //else {Debug.Error("UDP Handler Initialization Failed!"); CurrentStatus = false;}
+        // Optional like the metrics endpoint, the devices run without anyone listening
+        if(udpHandler.start(telemetryConfig())){Debug.Log("UDP Handler Initialized Successfully.");}
+        else {Debug.Warn("UDP Handler Initialization Failed, telemetry is not published.");}
+
+        Debug.Log("Initializing Remote Control...");
+        if(remoteControl.start(remoteConfig())){Debug.Log("Remote Control Initialized Successfully.");}
+        else {Debug.Warn("Remote Control Initialization Failed, devices can only be driven from the GUI.");}
 
         if (CurrentStatus){Debug.Log("All systems go!"); isRunning = true;}
         else{Debug.Error("System Initialization Failed!",5); isRunning = false;}
@@ -28,10 +119,15 @@ void System::run(){
 
 void System::stop() {
         isRunning = false;
-        //udpHandler.stop();
+        MetricsEndpoint::Instance().stop();
+        TrafficCapture::Instance().stop();
+        remoteControl.stop(); // Its connections are served by the event loop
+        EventLoop::Instance().stop();
+        udpHandler.stop();
     }
 
 void System::logic(){
         //Looped Logic
+        remoteControl.service(deviceHandler);
 
         }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include "DeviceHandler.hpp"
+#include "UdpHandler.hpp"
+#include "RemoteControl.hpp"
 
 using namespace std;
 
@@ -7,6 +9,8 @@ class System{
 public:
     // Core Handlers
     DeviceHandler deviceHandler;
+    UdpHandler& udpHandler = UdpHandler::Instance();
+    RemoteControl& remoteControl = RemoteControl::Instance();
 
     System() : deviceHandler() { if(systemInitializor()) isRunning = true; }
     ~System(){}
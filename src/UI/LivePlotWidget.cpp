@@ -0,0 +1,167 @@
+#include "LivePlotWidget.hpp"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPolygonF>
+#include <QResizeEvent>
+#include <algorithm>
+#include <cmath>
+
+static const QColor traceColors[] = { QColor(0, 170, 0), QColor(30, 144, 255), QColor(255, 140, 0), QColor(220, 20, 60), QColor(148, 0, 211) };
+
+LivePlotWidget::LivePlotWidget(QWidget* parent) : QWidget(parent) {
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    drainBuffer.resize(4096);
+    connect(&frameTimer, &QTimer::timeout, this, &LivePlotWidget::onFrame);
+    setFrameRate(30);
+}
+
+void LivePlotWidget::setFrameRate(int fps) {
+    fps = std::clamp(fps, 1, 60);
+    frameTimer.start(1000 / fps);
+}
+
+void LivePlotWidget::setTimeWindow(double seconds) {
+    timeWindow = std::max(seconds, 0.1);
+    dirty = true;
+}
+
+void LivePlotWidget::resizeEvent(QResizeEvent* event) {
+    dirty = true;
+    QWidget::resizeEvent(event);
+}
+
+// Picks up channels that devices registered since the last frame.
+void LivePlotWidget::syncChannels() {
+    PlotFeed& feed = PlotFeed::Instance();
+    uint64_t version = feed.layoutVersion();
+    if (version == layoutVersion) return;
+    layoutVersion = version;
+
+    for (auto& channel : feed.channels()) {
+        bool known = std::any_of(traces.begin(), traces.end(), [&](const Trace& t) { return t.channel == channel; });
+        if (!known) traces.push_back({ channel, {}, traceColors[traces.size() % std::size(traceColors)] });
+    }
+    auto spectra = feed.spectra();
+    if (!spectrumChannel && !spectra.empty()) spectrumChannel = spectra.front();
+    dirty = true;
+}
+
+// Frame tick: drain the rings, trim old history and repaint only if something changed.
+void LivePlotWidget::onFrame() {
+    syncChannels();
+
+    for (Trace& trace : traces) {
+        size_t n;
+        while ((n = trace.channel->drain(drainBuffer.data(), drainBuffer.size())) > 0) {
+            trace.history.insert(trace.history.end(), drainBuffer.begin(), drainBuffer.begin() + n);
+            dirty = true;
+        }
+        if (trace.history.empty()) continue;
+        const double oldest = trace.history.back().time - timeWindow;
+        while (trace.history.size() > 1 && trace.history.front().time < oldest) trace.history.pop_front();
+    }
+
+    if (spectrumChannel && spectrumChannel->version() != spectrumVersion) {
+        spectrumVersion = spectrumChannel->version();
+        spectrum = spectrumChannel->latest();
+        dirty = true;
+    }
+
+    if (!dirty) return;
+    dirty = false;
+    update();
+}
+
+void LivePlotWidget::Envelope::reset(int columns) {
+    lo.assign(columns, NAN);
+    hi.assign(columns, NAN);
+    empty = true;
+}
+
+void LivePlotWidget::Envelope::add(int column, double value) {
+    if (column < 0 || column >= static_cast<int>(lo.size())) return;
+    if (std::isnan(lo[column])) { lo[column] = hi[column] = value; }
+    else { lo[column] = std::min(lo[column], value); hi[column] = std::max(hi[column], value); }
+    if (empty) { yMin = yMax = value; empty = false; }
+    else { yMin = std::min(yMin, value); yMax = std::max(yMax, value); }
+}
+
+// One polyline with two vertices (min, max) per occupied pixel column.
+void LivePlotWidget::drawEnvelope(QPainter& painter, const QRect& area, const Envelope& env, const QColor& color) {
+    if (env.empty) return;
+    double span = env.yMax - env.yMin;
+    double yMin = env.yMin - (span > 0 ? span * 0.05 : 1.0);
+    double yMax = env.yMax + (span > 0 ? span * 0.05 : 1.0);
+    auto toY = [&](double v) { return area.bottom() - (v - yMin) / (yMax - yMin) * area.height(); };
+
+    QPolygonF line;
+    line.reserve(static_cast<int>(env.lo.size()) * 2);
+    for (int col = 0; col < static_cast<int>(env.lo.size()); ++col) {
+        if (std::isnan(env.lo[col])) continue;
+        double x = area.left() + col + 0.5;
+        line << QPointF(x, toY(env.lo[col]));
+        if (env.hi[col] != env.lo[col]) line << QPointF(x, toY(env.hi[col]));
+    }
+    painter.setPen(QPen(color, 1.5));
+    painter.drawPolyline(line);
+
+    painter.setPen(Qt::gray);
+    painter.drawText(area.adjusted(4, 2, -4, -2), Qt::AlignRight | Qt::AlignTop, QString::number(env.yMax, 'g', 5));
+    painter.drawText(area.adjusted(4, 2, -4, -2), Qt::AlignRight | Qt::AlignBottom, QString::number(env.yMin, 'g', 5));
+}
+
+void LivePlotWidget::drawTrace(QPainter& painter, const QRect& area, const Trace& trace, double tEnd) {
+    const int columns = std::max(area.width(), 1);
+    const double t0 = tEnd - timeWindow;
+    envelope.reset(columns);
+    // The newest sample sits at tEnd and maps to columns itself, it goes into the last column
+    for (const PlotSample& s : trace.history) envelope.add(std::min(static_cast<int>((s.time - t0) / timeWindow * columns), columns - 1), s.value);
+    drawEnvelope(painter, area, envelope, trace.color);
+
+    painter.setPen(trace.color);
+    QString label = QString::fromStdString(trace.channel->name);
+    if (!trace.history.empty()) label += QString(": %1").arg(trace.history.back().value, 0, 'g', 6);
+    painter.drawText(area.adjusted(4, 2, -4, -2), Qt::AlignLeft | Qt::AlignTop, label);
+}
+
+void LivePlotWidget::drawSpectrum(QPainter& painter, const QRect& area) {
+    const int columns = std::max(area.width(), 1);
+    const double bins = static_cast<double>(spectrum->size());
+    envelope.reset(columns);
+    for (size_t bin = 0; bin < spectrum->size(); ++bin) envelope.add(static_cast<int>(bin / bins * columns), (*spectrum)[bin]);
+    drawEnvelope(painter, area, envelope, QColor(255, 215, 0));
+
+    painter.setPen(QColor(255, 215, 0));
+    painter.drawText(area.adjusted(4, 2, -4, -2), Qt::AlignLeft | Qt::AlignTop, QString::fromStdString(spectrumChannel->name));
+}
+
+void LivePlotWidget::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(20, 20, 20));
+
+    const bool showSpectrum = spectrum && !spectrum->empty();
+    const int rows = static_cast<int>(traces.size()) + (showSpectrum ? 1 : 0);
+    if (rows == 0) {
+        painter.setPen(Qt::gray);
+        painter.drawText(rect(), Qt::AlignCenter, "No live data");
+        return;
+    }
+
+    double tEnd = 0.0;
+    for (const Trace& trace : traces) if (!trace.history.empty()) tEnd = std::max(tEnd, trace.history.back().time);
+
+    const int rowHeight = height() / rows;
+    int row = 0;
+    for (const Trace& trace : traces) {
+        QRect area(0, row++ * rowHeight, width(), rowHeight);
+        painter.setPen(QColor(60, 60, 60));
+        painter.drawRect(area.adjusted(0, 0, -1, -1));
+        drawTrace(painter, area.adjusted(1, 1, -1, -1), trace, tEnd);
+    }
+    if (showSpectrum) {
+        QRect area(0, row * rowHeight, width(), height() - row * rowHeight);
+        painter.setPen(QColor(60, 60, 60));
+        painter.drawRect(area.adjusted(0, 0, -1, -1));
+        drawSpectrum(painter, area.adjusted(1, 1, -1, -1));
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <QColor>
+#include <QTimer>
+#include <QWidget>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "PlotFeed.hpp"
+
+class QPainter;
+
+// Live plot of every PlotFeed channel: one row per telemetry channel plus the latest spectrum.
+// The widget pulls from the feed on a fixed frame timer, whatever rate the devices produce at,
+// decimates each row to a min/max envelope of one segment per pixel column,
+// and only repaints when new data arrived or the widget was resized.
+class LivePlotWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit LivePlotWidget(QWidget* parent = nullptr);
+
+    void setFrameRate(int fps);          // Clamped to 1..60
+    void setTimeWindow(double seconds);  // Visible history of the time series rows
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private slots:
+    void onFrame();
+
+private:
+    struct Trace {
+        std::shared_ptr<PlotChannel> channel;
+        std::deque<PlotSample> history;
+        QColor color;
+    };
+
+    // Per pixel column min/max of everything that falls into that column
+    struct Envelope {
+        std::vector<double> lo, hi;
+        double yMin = 0.0, yMax = 0.0;
+        bool empty = true;
+        void reset(int columns);
+        void add(int column, double value);
+    };
+
+    void syncChannels();
+    void drawTrace(QPainter& painter, const QRect& area, const Trace& trace, double tEnd);
+    void drawSpectrum(QPainter& painter, const QRect& area);
+    void drawEnvelope(QPainter& painter, const QRect& area, const Envelope& env, const QColor& color);
+
+    QTimer frameTimer;
+    std::vector<Trace> traces;
+    std::vector<PlotSample> drainBuffer;
+    std::shared_ptr<SpectrumChannel> spectrumChannel;
+    std::shared_ptr<const std::vector<double>> spectrum;
+    uint64_t spectrumVersion = 0;
+    uint64_t layoutVersion = UINT64_MAX;
+    double timeWindow = 60.0;
+    bool dirty = true;
+    Envelope envelope; // Scratch, reused every paint
+};
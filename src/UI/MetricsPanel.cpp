@@ -0,0 +1,87 @@
+#include "MetricsPanel.hpp"
+#include "Diagnostics/Metrics.hpp"
+#include <QHeaderView>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace {
+    enum Column { Name, Labels, Value, Rate, P50, P99, Max, Load, ColumnCount };
+
+    // Nanoseconds as a short human readable duration
+    QString formatDuration(uint64_t ns) {
+        if (ns < 1000) return QString::number(ns) + " ns";
+        if (ns < 1000000) return QString::number(ns / 1e3, 'f', 1) + " us";
+        if (ns < 1000000000) return QString::number(ns / 1e6, 'f', 2) + " ms";
+        return QString::number(ns / 1e9, 'f', 2) + " s";
+    }
+
+    void setCell(QTableWidget* table, int row, int column, const QString& text) {
+        QTableWidgetItem* item = table->item(row, column);
+        if (!item) {
+            item = new QTableWidgetItem();
+            item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+            if (column >= Value) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(row, column, item);
+        }
+        if (item->text() != text) item->setText(text);
+    }
+}
+
+MetricsPanel::MetricsPanel(QWidget* parent) : QWidget(parent) {
+    table = new QTableWidget(0, ColumnCount, this);
+    table->setHorizontalHeaderLabels({ "Metric", "Labels", "Value", "Rate/s", "p50", "p99", "Max", "Load" });
+    table->verticalHeader()->setVisible(false);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(table);
+
+    lastRefresh = std::chrono::steady_clock::now();
+    connect(&refreshTimer, &QTimer::timeout, this, &MetricsPanel::refresh);
+    setRefreshInterval(1000);
+}
+
+void MetricsPanel::setRefreshInterval(int ms) { refreshTimer.start(std::max(ms, 100)); }
+
+void MetricsPanel::refresh() {
+    if (!isVisible()) return; // Collecting walks every thread's slots, skip it while hidden
+
+    const auto now = std::chrono::steady_clock::now();
+    const double dt = std::max(std::chrono::duration<double>(now - lastRefresh).count(), 1e-3);
+    lastRefresh = now;
+
+    std::vector<Metrics::Sample> samples = Metrics::Registry::Instance().snapshot();
+    std::sort(samples.begin(), samples.end(), [](const auto& a, const auto& b) { return a.name != b.name ? a.name < b.name : a.labels < b.labels; });
+    table->setRowCount(static_cast<int>(samples.size()));
+
+    int row = 0;
+    for (const Metrics::Sample& s : samples) {
+        Previous& prev = previous[s.name + "{" + s.labels + "}"];
+        const double rate = (s.value - prev.value) / dt;
+
+        setCell(table, row, Name, QString::fromStdString(s.name));
+        setCell(table, row, Labels, QString::fromStdString(s.labels));
+        setCell(table, row, Value, QString::number(s.value, 'g', 10));
+        if (s.kind == Metrics::Kind::Gauge) {
+            for (int c : { Rate, P50, P99, Max, Load }) setCell(table, row, c, QString());
+        } else {
+            setCell(table, row, Rate, QString::number(rate, 'f', 1));
+        }
+        if (s.kind == Metrics::Kind::Histogram) {
+            const double load = static_cast<double>(s.sum - prev.sum) * 1e-9 / dt;
+            setCell(table, row, P50, formatDuration(s.p50));
+            setCell(table, row, P99, formatDuration(s.p99));
+            setCell(table, row, Max, formatDuration(s.max));
+            setCell(table, row, Load, QString::number(load * 100.0, 'f', 2) + " %");
+        } else if (s.kind == Metrics::Kind::Counter) {
+            for (int c : { P50, P99, Max, Load }) setCell(table, row, c, QString());
+        }
+        prev.value = s.value;
+        prev.sum = s.sum;
+        ++row;
+    }
+}
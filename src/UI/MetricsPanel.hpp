@@ -0,0 +1,31 @@
+#pragma once
+#include <QTimer>
+#include <QWidget>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+class QTableWidget;
+
+// Table of every Metrics::Registry entry, refreshed once per second.
+// Counters show their total and rate, histograms their call rate, p50/p99/max and "Load":
+// the share of one core spent inside the measured section (run time per wall second), which makes
+// the device or task eating the logic cycle budget stand out.
+class MetricsPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit MetricsPanel(QWidget* parent = nullptr);
+
+    void setRefreshInterval(int ms);
+
+private slots:
+    void refresh();
+
+private:
+    struct Previous { double value = 0.0; uint64_t sum = 0; };
+
+    QTimer refreshTimer;
+    QTableWidget* table;
+    std::unordered_map<std::string, Previous> previous; // name{labels} -> last refresh
+    std::chrono::steady_clock::time_point lastRefresh;
+};
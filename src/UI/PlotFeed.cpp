@@ -0,0 +1,43 @@
+#include "PlotFeed.hpp"
+
+void PlotChannel::push(double value) { push(PlotFeed::Instance().now(), value); }
+
+void SpectrumChannel::publish(std::vector<double> counts) {
+    auto snapshot = std::make_shared<const std::vector<double>>(std::move(counts));
+    {
+        std::lock_guard<std::mutex> lk(slotMutex);
+        slot.swap(snapshot);
+    }
+    published.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const std::vector<double>> SpectrumChannel::latest() const {
+    std::lock_guard<std::mutex> lk(slotMutex);
+    return slot;
+}
+
+std::shared_ptr<PlotChannel> PlotFeed::channel(const std::string& name, size_t capacity) {
+    std::lock_guard<std::mutex> lk(registryMutex);
+    for (auto& ch : timeSeries) if (ch->name == name) return ch;
+    timeSeries.push_back(std::make_shared<PlotChannel>(name, capacity));
+    layout.fetch_add(1, std::memory_order_release);
+    return timeSeries.back();
+}
+
+std::shared_ptr<SpectrumChannel> PlotFeed::spectrum(const std::string& name) {
+    std::lock_guard<std::mutex> lk(registryMutex);
+    for (auto& sp : spectrumChannels) if (sp->name == name) return sp;
+    spectrumChannels.push_back(std::make_shared<SpectrumChannel>(name));
+    layout.fetch_add(1, std::memory_order_release);
+    return spectrumChannels.back();
+}
+
+std::vector<std::shared_ptr<PlotChannel>> PlotFeed::channels() const {
+    std::lock_guard<std::mutex> lk(registryMutex);
+    return timeSeries;
+}
+
+std::vector<std::shared_ptr<SpectrumChannel>> PlotFeed::spectra() const {
+    std::lock_guard<std::mutex> lk(registryMutex);
+    return spectrumChannels;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Utils/RingBuffer.hpp"
+
+// Qt-free hand-off point between device code and the live plots.
+// Devices push samples into lock-free rings from the logic thread, the UI drains them at its own frame rate.
+// Nothing here ever signals the Qt event loop, so a high-rate device can not flood it.
+//
+// Usage (device side):
+//   std::shared_ptr<PlotChannel> hvPlot = PlotFeed::Instance().channel(instanceName + " HV (kV)");
+//   hvPlot->push(voltage);
+//
+// A PlotChannel ring has exactly one producer. Devices sharing a chip update in parallel on DeviceHandler lanes,
+// so device channels are always named after the instance: a fixed name would hand one ring to several threads.
+
+struct PlotSample {
+    double time;  // Seconds since PlotFeed start
+    double value;
+};
+
+// Time series channel. One producer thread (the device), one consumer (the plot widget).
+class PlotChannel {
+public:
+    PlotChannel(std::string channelName, size_t capacity) : name(std::move(channelName)), ring(capacity) {}
+    const std::string name;
+
+    // Never blocks. If the UI has fallen behind, the sample is dropped and counted.
+    void push(double value);
+    void push(double time, double value) { if (!ring.push({ time, value })) dropped.fetch_add(1, std::memory_order_relaxed); }
+
+    size_t drain(PlotSample* out, size_t maxCount) { return ring.popBulk(out, maxCount); }
+    size_t queued() const { return ring.size(); }
+    uint64_t droppedSamples() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    SpscRing<PlotSample> ring;
+    std::atomic<uint64_t> dropped{0};
+};
+
+// Spectrum channel. The producer publishes whole snapshots at its own pace, the UI only copies a pointer.
+class SpectrumChannel {
+public:
+    explicit SpectrumChannel(std::string channelName) : name(std::move(channelName)) {}
+    const std::string name;
+
+    void publish(std::vector<double> counts);
+    std::shared_ptr<const std::vector<double>> latest() const;
+    uint64_t version() const { return published.load(std::memory_order_acquire); }
+
+private:
+    mutable std::mutex slotMutex; // Only guards the pointer swap
+    std::shared_ptr<const std::vector<double>> slot;
+    std::atomic<uint64_t> published{0};
+};
+
+class PlotFeed {
+public:
+    static PlotFeed& Instance() { static PlotFeed instance; return instance; }
+
+    // Returns the named channel, creating it on first use.
+    std::shared_ptr<PlotChannel> channel(const std::string& name, size_t capacity = 8192);
+    std::shared_ptr<SpectrumChannel> spectrum(const std::string& name);
+
+    // For consumers: current channel lists and a counter that changes whenever a channel is added.
+    std::vector<std::shared_ptr<PlotChannel>> channels() const;
+    std::vector<std::shared_ptr<SpectrumChannel>> spectra() const;
+    uint64_t layoutVersion() const { return layout.load(std::memory_order_acquire); }
+
+    // Seconds since the feed was created, the common time axis of all channels.
+    double now() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+private:
+    PlotFeed() = default;
+    PlotFeed(const PlotFeed&) = delete;
+    PlotFeed& operator=(const PlotFeed&) = delete;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    mutable std::mutex registryMutex;
+    std::vector<std::shared_ptr<PlotChannel>> timeSeries;
+    std::vector<std::shared_ptr<SpectrumChannel>> spectrumChannels;
+    std::atomic<uint64_t> layout{0};
+};
@@ -0,0 +1,299 @@
+#include "UdpHandler.hpp"
+#include "Debug.hpp"
+#include "Diagnostics/Metrics.hpp"
+#include "Diagnostics/Trace.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <random>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <arpa/inet.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "The telemetry wire format is little-endian");
+static_assert(sizeof(UdpHandler::DatagramHeader) == 24 && sizeof(UdpHandler::Record) == 24, "Telemetry wire structs must not be padded");
+
+namespace {
+    constexpr auto idleSleep = std::chrono::milliseconds(1);
+    constexpr size_t MaxBatch = 64; // Datagrams per sendmmsg()
+
+    struct TelemetryMetrics {
+        Metrics::Counter& records;
+        Metrics::Counter& datagrams;
+        Metrics::Counter& dropped;
+        Metrics::Counter& sendErrors;
+    };
+
+    TelemetryMetrics& metrics() {
+        Metrics::Registry& reg = Metrics::Registry::Instance();
+        static TelemetryMetrics m{
+            reg.counter("radcat_telemetry_records_total", "Telemetry records published over UDP"),
+            reg.counter("radcat_telemetry_datagrams_total", "Telemetry datagrams sent"),
+            reg.counter("radcat_telemetry_dropped_records_total", "Telemetry records dropped because a producer ring was full"),
+            reg.counter("radcat_telemetry_send_errors_total", "Telemetry datagrams the socket did not take") };
+        return m;
+    }
+
+#ifndef _WIN32
+    // Connected UDP socket to the configured group or host, -1 on failure
+    int openSocket(const UdpHandler::Config& config) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* found = nullptr;
+        const int r = getaddrinfo(config.address.c_str(), std::to_string(config.port).c_str(), &hints, &found);
+        if (r != 0) { Debug.Error("Telemetry: can not resolve ", config.address, ": ", gai_strerror(r)); return -1; }
+        const sockaddr_in destination = *reinterpret_cast<const sockaddr_in*>(found->ai_addr);
+        freeaddrinfo(found);
+
+        const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) { Debug.Error("Telemetry: can not create socket: ", std::strerror(errno)); return -1; }
+        const int sendBuffer = 4 << 20; // Room for bursts while the publisher thread is descheduled
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+        if (IN_MULTICAST(ntohl(destination.sin_addr.s_addr))) {
+            const int ttl = config.ttl;
+            const int loop = config.loopback ? 1 : 0;
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+            in_addr outgoing{};
+            if (!config.interfaceAddress.empty()) {
+                if (inet_pton(AF_INET, config.interfaceAddress.c_str(), &outgoing) != 1 || setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &outgoing, sizeof(outgoing)) != 0) {
+                    Debug.Error("Telemetry: can not send through interface ", config.interfaceAddress);
+                    ::close(fd);
+                    return -1;
+                }
+            }
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&destination), sizeof(destination)) != 0) {
+            Debug.Error("Telemetry: can not send to ", config.address, ":", config.port, ": ", std::strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void closeSocket(int fd) { if (fd >= 0) ::close(fd); }
+
+    // A unicast listener that went away makes the next send report ECONNREFUSED once, that is not a failure
+    bool transientError(int error) { return error == EINTR || error == ECONNREFUSED; }
+
+    bool sendDatagram(int fd, const void* data, size_t size) {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (::send(fd, data, size, 0) == static_cast<ssize_t>(size)) return true;
+            if (!transientError(errno)) return false;
+        }
+        return false;
+    }
+#else
+    int openSocket(const UdpHandler::Config& config) {
+        Debug.Error("Telemetry publishing is not supported on this platform yet, can not send to ", config.address, ":", config.port);
+        return -1;
+    }
+    void closeSocket(int) {}
+    bool sendDatagram(int, const void*, size_t) { return false; }
+#endif
+}
+
+bool UdpHandler::start(const Config& newConfig) {
+    if (publisher.joinable()) return true;
+    if (!newConfig.enabled) { Debug.Log("Telemetry publishing disabled."); return true; }
+    config = newConfig;
+    sock = openSocket(config);
+    if (sock < 0) return false;
+    source = std::random_device{}();
+    batch.resize(MaxBatch * RecordsPerDatagram);
+    headers.resize(MaxBatch);
+    stopRequested.store(false, std::memory_order_release);
+    running.store(true, std::memory_order_release);
+    publisher = std::thread(&UdpHandler::publisherLoop, this);
+    DEBUG_LOG(LogCategory::Network, "Publishing telemetry to ", config.address, ":", config.port, ".");
+    return true;
+}
+
+void UdpHandler::stop() {
+    if (!publisher.joinable()) return;
+    running.store(false, std::memory_order_release);
+    stopRequested.store(true, std::memory_order_release);
+    publisher.join();
+    closeSocket(sock);
+    sock = -1;
+}
+
+uint16_t UdpHandler::channel(const std::string& name) {
+    std::lock_guard<std::mutex> lk(channelsMutex);
+    auto it = channelIds.find(name);
+    if (it != channelIds.end()) return it->second;
+    if (channelNames.size() >= 0xFFFF) { Debug.Error("Telemetry: no channel id left for ", name); return 0; }
+    channelNames.push_back(name);
+    const uint16_t id = static_cast<uint16_t>(channelNames.size());
+    channelIds.emplace(name, id);
+    catalogVersion.fetch_add(1, std::memory_order_release);
+    return id;
+}
+
+uint64_t UdpHandler::droppedRecords() const {
+    std::lock_guard<std::mutex> lk(registryMutex);
+    uint64_t dropped = retiredDropped;
+    for (const auto& buffer : buffers) dropped += buffer->dropped.load(std::memory_order_relaxed);
+    return dropped;
+}
+
+// Each thread owns one ring. The holder marks it retired on thread exit so the publisher can free it once drained.
+UdpHandler::ThreadBuffer& UdpHandler::localBuffer() {
+    struct Holder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~Holder() { if (buffer) buffer->retired.store(true, std::memory_order_release); }
+    };
+    thread_local Holder holder;
+    if (!holder.buffer) holder.buffer = registerThread();
+    return *holder.buffer;
+}
+
+std::shared_ptr<UdpHandler::ThreadBuffer> UdpHandler::registerThread() {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lk(registryMutex);
+    buffers.push_back(buffer);
+    return buffer;
+}
+
+void UdpHandler::publisherLoop() {
+    Trace::setThreadName("telemetry");
+    uint64_t sentCatalog = 0;
+    auto nextCatalog = std::chrono::steady_clock::now();
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        const uint64_t version = catalogVersion.load(std::memory_order_acquire);
+        const auto now = std::chrono::steady_clock::now();
+        if (version != sentCatalog || now >= nextCatalog) {
+            sendCatalog();
+            sentCatalog = version;
+            nextCatalog = now + std::chrono::milliseconds(config.catalogIntervalMs);
+        }
+        if (drainOnce() == 0) std::this_thread::sleep_for(idleSleep);
+    }
+    drainOnce();
+}
+
+// Sends everything the rings hold, a full batch of datagrams per sendmmsg()
+size_t UdpHandler::drainOnce() {
+    {
+        std::lock_guard<std::mutex> lk(registryMutex);
+        current = buffers;
+    }
+    size_t filled = 0;
+    size_t total = 0;
+    for (const auto& buffer : current) {
+        for (size_t n; (n = buffer->ring.popBulk(batch.data() + filled, batch.size() - filled)) > 0;) {
+            filled += n;
+            if (filled < batch.size()) break;
+            sendData(filled);
+            total += filled;
+            filled = 0;
+        }
+    }
+    if (filled) sendData(filled);
+    total += filled;
+
+    const uint64_t dropped = countDropped();
+    if (dropped > reportedDropped) {
+        DEBUG_WARN(LogCategory::Network, "Telemetry: ", dropped - reportedDropped, " records dropped, producer rings were full.");
+        metrics().dropped.add(dropped - reportedDropped);
+        reportedDropped = dropped;
+    }
+    return total;
+}
+
+// Frees the rings of exited threads once they are empty
+uint64_t UdpHandler::countDropped() {
+    std::lock_guard<std::mutex> lk(registryMutex);
+    for (auto it = buffers.begin(); it != buffers.end();) {
+        ThreadBuffer& buffer = **it;
+        if (buffer.retired.load(std::memory_order_acquire) && buffer.ring.size() == 0) {
+            retiredDropped += buffer.dropped.load(std::memory_order_relaxed);
+            it = buffers.erase(it);
+        }
+        else ++it;
+    }
+    uint64_t dropped = retiredDropped;
+    for (const auto& buffer : buffers) dropped += buffer->dropped.load(std::memory_order_relaxed);
+    return dropped;
+}
+
+UdpHandler::DatagramHeader UdpHandler::header(DatagramType type, size_t count) {
+    return { Magic, Version, type, static_cast<uint16_t>(count), source,
+             static_cast<uint32_t>(std::min<uint64_t>(reportedDropped, 0xFFFFFFFFu)), sequence.fetch_add(1, std::memory_order_relaxed) };
+}
+
+// Names of all channels, several datagrams if they do not fit in one. Also the heartbeat while nothing is published.
+void UdpHandler::sendCatalog() {
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lk(channelsMutex);
+        names = channelNames;
+    }
+    uint8_t datagram[MaxDatagramBytes];
+    size_t used = sizeof(DatagramHeader);
+    size_t count = 0;
+    auto flush = [&] {
+        const DatagramHeader h = header(DatagramType::Catalog, count);
+        std::memcpy(datagram, &h, sizeof(h));
+        if (sendDatagram(sock, datagram, used)) metrics().datagrams.add();
+        else metrics().sendErrors.add();
+        used = sizeof(DatagramHeader);
+        count = 0;
+    };
+    for (size_t i = 0; i < names.size(); ++i) {
+        const size_t length = std::min<size_t>(names[i].size(), 255); // Longer names are cut
+        if (used + 3 + length > MaxDatagramBytes) flush();
+        const uint16_t id = static_cast<uint16_t>(i + 1);
+        std::memcpy(datagram + used, &id, sizeof(id));
+        datagram[used + 2] = static_cast<uint8_t>(length);
+        std::memcpy(datagram + used + 3, names[i].data(), length);
+        used += 3 + length;
+        count++;
+    }
+    if (count > 0 || names.empty()) flush();
+}
+
+#ifndef _WIN32
+
+// Packs count records of the batch into datagrams, header and records go out straight from where they are
+void UdpHandler::sendData(size_t count) {
+    RC_TRACE_SCOPE("telemetry", "send");
+    mmsghdr messages[MaxBatch];
+    iovec parts[MaxBatch][2];
+    const size_t datagrams = (count + RecordsPerDatagram - 1) / RecordsPerDatagram;
+    for (size_t i = 0; i < datagrams; ++i) {
+        const size_t first = i * RecordsPerDatagram;
+        const size_t records = std::min(RecordsPerDatagram, count - first);
+        headers[i] = header(DatagramType::Data, records);
+        parts[i][0] = { &headers[i], sizeof(DatagramHeader) };
+        parts[i][1] = { batch.data() + first, records * sizeof(Record) };
+        messages[i] = {};
+        messages[i].msg_hdr.msg_iov = parts[i];
+        messages[i].msg_hdr.msg_iovlen = 2;
+    }
+    size_t sent = 0;
+    for (int retries = 0; sent < datagrams;) {
+        const int n = ::sendmmsg(sock, messages + sent, static_cast<unsigned int>(datagrams - sent), 0);
+        if (n > 0) { sent += static_cast<size_t>(n); continue; }
+        if (n < 0 && transientError(errno) && ++retries < 4) continue;
+        // The rest of the batch is lost, listeners see the gap in the sequence numbers
+        DEBUG_WARN(LogCategory::Network, "Telemetry: send failed: ", std::strerror(errno));
+        metrics().sendErrors.add(datagrams - sent);
+        break;
+    }
+    metrics().datagrams.add(sent);
+    metrics().records.add(count);
+}
+
+#else
+
+void UdpHandler::sendData(size_t) {}
+
+#endif
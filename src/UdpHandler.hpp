@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Utils/RingBuffer.hpp"
+
+// Publishes device telemetry and events as compact binary UDP datagrams, by default to a multicast group so any
+// number of control-room displays and archivers can listen without each of them polling RadCat.
+//
+// Producers (device tasks, acquisition threads) only copy a 24 byte record into their own thread's lock-free ring.
+// The publisher thread drains all rings, packs the records into datagrams and hands a whole batch of datagrams to
+// the kernel with one sendmmsg(). A full ring drops the record and counts it, publishing never blocks device code.
+// While the publisher is stopped, publishing costs one atomic load.
+//
+// Wire format, little-endian:
+//   Header (24 bytes): magic "RCT1", version, type (Data or Catalog), entry count, source id (random per run, a
+//     change means RadCat restarted), records dropped before sending so far, sequence number (one per datagram,
+//     consecutive over both types, so a gap is a lost datagram).
+//   Data: count * Record.
+//   Catalog: count * { uint16 channel, uint8 name length, name }. Sent when a channel is added and every
+//     catalogIntervalMs, so listeners that join late learn the channel names.
+//
+// Usage (device side):
+//   uint16_t hv = UdpHandler::Instance().channel(instanceName + " HV (kV)"); // Per instance, listeners tell devices apart by name
+//   UdpHandler::Instance().sample(hv, voltage);
+class UdpHandler {
+public:
+    static UdpHandler& Instance() { static UdpHandler instance; return instance; }
+
+    static constexpr uint32_t Magic = 0x31544352; // "RCT1"
+    static constexpr uint8_t Version = 1;
+    static constexpr size_t MaxDatagramBytes = 1472; // Ethernet MTU less IP and UDP headers, never fragmented
+
+    enum class DatagramType : uint8_t { Data = 1, Catalog = 2 };
+    enum class RecordKind : uint8_t { Sample = 0, Event = 1 };
+
+    struct DatagramHeader {
+        uint32_t magic;
+        uint8_t version;
+        DatagramType type;
+        uint16_t count;
+        uint32_t source;
+        uint32_t droppedRecords;             // Saturates
+        uint64_t sequence;
+    };
+
+    struct Record {
+        uint64_t timestampNs;                // system_clock, since epoch
+        uint16_t channel;
+        RecordKind kind;
+        uint8_t reserved;
+        uint32_t code;                       // Device defined for events (e.g. the ADC channel of a list-mode event), 0 for samples
+        double value;
+    };
+
+    static constexpr size_t RecordsPerDatagram = (MaxDatagramBytes - sizeof(DatagramHeader)) / sizeof(Record);
+    static constexpr size_t RingRecords = 16384; // Per producer thread
+
+    struct Config {
+        bool enabled = true;
+        std::string address = "239.255.42.99"; // Multicast group (organization-local scope) or a unicast host
+        uint16_t port = 5099;
+        int ttl = 1;                         // Multicast hops, 1 stays on the local subnet
+        std::string interfaceAddress;        // Outgoing interface for multicast, empty for the routing default
+        bool loopback = true;                // Multicast copies for listeners on this host
+        int catalogIntervalMs = 1000;
+    };
+
+    bool start() { return start(Config{}); }
+    bool start(const Config& config);
+    // Sends what is still queued, then stops the publisher thread. Later records are discarded.
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Id of the named channel, created on first use. Ids start at 1, 0 means no channel (all 65535 taken).
+    uint16_t channel(const std::string& name);
+
+    // ---- Producers, any thread ----
+    void sample(uint16_t channel, double value) { publish(channel, RecordKind::Sample, 0, value, now()); }
+    void event(uint16_t channel, uint32_t code, double value) { publish(channel, RecordKind::Event, code, value, now()); }
+    // For blocks of records, the timestamp is taken once by the caller
+    void publish(uint16_t channel, RecordKind kind, uint32_t code, double value, uint64_t timestampNs) {
+        if (!running.load(std::memory_order_acquire)) return;
+        ThreadBuffer& buffer = localBuffer();
+        Record* rec = buffer.ring.reserve();
+        if (!rec) { buffer.dropped.fetch_add(1, std::memory_order_relaxed); return; }
+        *rec = { timestampNs, channel, kind, 0, code, value };
+        buffer.ring.commit();
+    }
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    uint64_t droppedRecords() const;
+    uint64_t sentDatagrams() const { return sequence.load(std::memory_order_relaxed); }
+
+private:
+    UdpHandler() = default;
+    ~UdpHandler() { stop(); }
+    UdpHandler(const UdpHandler&) = delete;
+    UdpHandler& operator=(const UdpHandler&) = delete;
+
+    struct ThreadBuffer {
+        ThreadBuffer() : ring(RingRecords) {}
+        SpscRing<Record> ring;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};    // Owning thread exited, freed once drained
+    };
+
+    ThreadBuffer& localBuffer();
+    std::shared_ptr<ThreadBuffer> registerThread();
+    void publisherLoop();
+    size_t drainOnce();                      // Returns the number of records sent
+    void sendData(size_t count);
+    void sendCatalog();
+    DatagramHeader header(DatagramType type, size_t count);
+    uint64_t countDropped();                 // Publisher thread, also frees retired buffers
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+    std::thread publisher;
+    Config config;
+    int sock = -1;
+    uint32_t source = 0;
+    std::atomic<uint64_t> sequence{0};
+
+    mutable std::mutex registryMutex;        // Thread registration only
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint64_t retiredDropped = 0;
+
+    std::mutex channelsMutex;
+    std::unordered_map<std::string, uint16_t> channelIds;
+    std::vector<std::string> channelNames;   // Index id - 1
+    std::atomic<uint64_t> catalogVersion{0};
+
+    // Publisher thread only
+    std::vector<std::shared_ptr<ThreadBuffer>> current;
+    std::vector<Record> batch;
+    std::vector<DatagramHeader> headers;
+    uint64_t reportedDropped = 0;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+// Bounded single-producer/single-consumer ring. push() and pop() never block and never allocate.
+// Capacity is rounded up to a power of two. When full, push() fails and the caller decides what to drop.
+template<typename T> class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing only holds trivially copyable types");
+public:
+    explicit SpscRing(size_t minCapacity) {
+        size_t cap = 2;
+        while (cap < minCapacity) cap <<= 1;
+        mask = cap - 1;
+        cells = std::make_unique<T[]>(cap);
+    }
+
+    bool push(const T& value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache > mask) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache > mask) return false;
+        }
+        cells[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Zero-copy push: reserve() hands out the next free cell (or nullptr when full),
+    // the producer fills it in place and publishes it with commit().
+    T* reserve() {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tailCache > mask) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h - tailCache > mask) return nullptr;
+        }
+        return &cells[h & mask];
+    }
+    void commit() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool pop(T& value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == headCache) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t == headCache) return false;
+        }
+        value = cells[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops up to maxCount items into out, returns how many were copied.
+    size_t popBulk(T* out, size_t maxCount) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t available = head.load(std::memory_order_acquire) - t;
+        const size_t count = available < maxCount ? available : maxCount;
+        for (size_t i = 0; i < count; ++i) out[i] = cells[(t + i) & mask];
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate when called from a third thread, exact from either end.
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    static constexpr size_t cacheLine = 64;
+    alignas(cacheLine) std::atomic<size_t> head{0}; // Written by the producer
+    size_t tailCache = 0;                           // Producer's view of tail
+    alignas(cacheLine) std::atomic<size_t> tail{0}; // Written by the consumer
+    size_t headCache = 0;                           // Consumer's view of head
+    alignas(cacheLine) size_t mask = 0;
+    std::unique_ptr<T[]> cells;
+};
+
+
+// Single-producer/single-consumer byte ring for stream I/O, nothing is copied in between: the producer fills
+// the free space in place (writable() hands it out as up to two spans, e.g. for readv) and publishes it with
+// commit(), the consumer parses the stored bytes in place through readable() and frees them with consume().
+// Capacity is rounded up to a power of two.
+class SpscByteRing {
+public:
+    // Up to two pieces, second is only used when the range wraps around the end of the storage
+    template<typename T> struct Spans {
+        std::span<T> first;
+        std::span<T> second;
+        size_t size() const { return first.size() + second.size(); }
+        bool empty() const { return first.empty() && second.empty(); }
+    };
+
+    explicit SpscByteRing(size_t minCapacity) {
+        size_t cap = 2;
+        while (cap < minCapacity) cap <<= 1;
+        mask = cap - 1;
+        bytes = std::make_unique<uint8_t[]>(cap);
+    }
+
+    // Producer side
+    Spans<uint8_t> writable() {
+        const size_t h = head.load(std::memory_order_relaxed);
+        return split<uint8_t>(h, capacity() - (h - tail.load(std::memory_order_acquire)));
+    }
+    void commit(size_t count) { head.store(head.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+    // Copies as much of data as fits, returns how much that was.
+    size_t write(std::span<const uint8_t> data) {
+        Spans<uint8_t> free = writable();
+        const size_t a = std::min(data.size(), free.first.size());
+        const size_t b = std::min(data.size() - a, free.second.size());
+        if (a) std::memcpy(free.first.data(), data.data(), a);
+        if (b) std::memcpy(free.second.data(), data.data() + a, b);
+        commit(a + b);
+        return a + b;
+    }
+
+    // Consumer side
+    Spans<const uint8_t> readable() const {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        return split<const uint8_t>(t, head.load(std::memory_order_acquire) - t);
+    }
+    void consume(size_t count) { tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+    // Approximate when called from a third thread, exact from either end.
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    template<typename T> Spans<T> split(size_t position, size_t count) const {
+        const size_t start = position & mask;
+        const size_t first = std::min(count, capacity() - start);
+        return { std::span<T>(bytes.get() + start, first), std::span<T>(bytes.get(), count - first) };
+    }
+
+    static constexpr size_t cacheLine = 64;
+    alignas(cacheLine) std::atomic<size_t> head{0}; // Written by the producer
+    alignas(cacheLine) std::atomic<size_t> tail{0}; // Written by the consumer
+    alignas(cacheLine) size_t mask = 0;
+    std::unique_ptr<uint8_t[]> bytes;
+};
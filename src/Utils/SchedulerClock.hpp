@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Time source of the periodic task scheduler and of device-side waits and timeouts (settling delays,
+// FTDI polling), so scenarios can run on simulated time.
+//
+// - RealClock: steady_clock and real sleeps. The default.
+// - VirtualClock: time only moves when a wait asks it to. sleepUntil() jumps straight to the deadline,
+//   so a 12-hour automation runs as fast as the code between deadlines, and every run sees the same times.
+//   Meant for one thread driving devices on simulated transports (SimulatedFTDITransport follows it).
+//   Threads streaming on their own schedule (acquisition loops, SimulatedUsbBackend) stay on real time.
+//
+// Time points are steady_clock time points: a virtual clock starts at the real time it was created,
+// so values stored before it was installed stay comparable.
+//
+// Usage:
+//   VirtualClock clock;
+//   SchedulerClock::install(&clock);        // Before devices are created
+//   handler.runUntil(clock.now() + std::chrono::hours(12));
+//   SchedulerClock::install(nullptr);        // Back to real time
+class SchedulerClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~SchedulerClock() = default;
+    virtual Clock::time_point now() const = 0;
+    virtual void sleepUntil(Clock::time_point deadline) = 0;
+    void sleepFor(Clock::duration duration) { sleepUntil(now() + duration); }
+
+    // The clock every scheduler and device wait uses. Not owned, nullptr restores the real clock.
+    static SchedulerClock& current() { SchedulerClock* c = active.load(std::memory_order_acquire); return c ? *c : realClock(); }
+    static void install(SchedulerClock* clock) { active.store(clock, std::memory_order_release); }
+    // A clock other than the default real one is installed
+    static bool installed() { return active.load(std::memory_order_acquire) != nullptr; }
+
+private:
+    static SchedulerClock& realClock();
+    static inline std::atomic<SchedulerClock*> active{nullptr}; // Constant-initialized, safe during static init
+};
+
+class RealClock : public SchedulerClock {
+public:
+    Clock::time_point now() const override { return Clock::now(); }
+    void sleepUntil(Clock::time_point deadline) override { std::this_thread::sleep_until(deadline); }
+};
+
+class VirtualClock : public SchedulerClock {
+public:
+    VirtualClock() : VirtualClock(Clock::now()) {}
+    explicit VirtualClock(Clock::time_point start) : ticks(start.time_since_epoch().count()) {}
+
+    Clock::time_point now() const override { return Clock::time_point(Clock::duration(ticks.load(std::memory_order_acquire))); }
+    // Never goes back, a deadline in the past returns at once
+    void sleepUntil(Clock::time_point deadline) override { advanceTo(deadline); }
+
+    void advance(Clock::duration duration) { advanceTo(now() + duration); }
+    void advanceTo(Clock::time_point t) {
+        const Clock::rep target = t.time_since_epoch().count();
+        Clock::rep cur = ticks.load(std::memory_order_relaxed);
+        while (cur < target && !ticks.compare_exchange_weak(cur, target, std::memory_order_acq_rel)) {}
+    }
+
+private:
+    std::atomic<Clock::rep> ticks;
+};
+
+inline SchedulerClock& SchedulerClock::realClock() {
+    static RealClock clock;
+    return clock;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Small set of vector kernels shared by the data paths (histogram merge, pulse shaping, ADC decoding, etc.).
+// Each kernel has an SSE2 (x86-64) or NEON (ARM64) body and a scalar fallback for everything else.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define RADCAT_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define RADCAT_SIMD_NEON 1
+#endif
+
+namespace Simd {
+
+    // dst[i] += src[i]
+    inline void addU64(uint64_t* dst, const uint64_t* src, size_t n) {
+        size_t i = 0;
+    #if defined(RADCAT_SIMD_SSE2)
+        for (; i + 4 <= n; i += 4) {
+            __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i + 2));
+            __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi64(a0, b0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 2), _mm_add_epi64(a1, b1));
+        }
+    #elif defined(RADCAT_SIMD_NEON)
+        for (; i + 4 <= n; i += 4) {
+            vst1q_u64(dst + i, vaddq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+            vst1q_u64(dst + i + 2, vaddq_u64(vld1q_u64(dst + i + 2), vld1q_u64(src + i + 2)));
+        }
+    #endif
+        for (; i < n; ++i) dst[i] += src[i];
+    }
+
+    // dst[i] -= src[i]
+    inline void subU64(uint64_t* dst, const uint64_t* src, size_t n) {
+        size_t i = 0;
+    #if defined(RADCAT_SIMD_SSE2)
+        for (; i + 2 <= n; i += 2) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi64(a, b));
+        }
+    #elif defined(RADCAT_SIMD_NEON)
+        for (; i + 2 <= n; i += 2) vst1q_u64(dst + i, vsubq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+    #endif
+        for (; i < n; ++i) dst[i] -= src[i];
+    }
+
+    // Returns the sum of src[0..n)
+    inline uint64_t sumU64(const uint64_t* src, size_t n) {
+        size_t i = 0;
+        uint64_t total = 0;
+    #if defined(RADCAT_SIMD_SSE2)
+        __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+        for (; i + 4 <= n; i += 4) {
+            acc0 = _mm_add_epi64(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+            acc1 = _mm_add_epi64(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 2)));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(acc0, acc1));
+        total = lanes[0] + lanes[1];
+    #elif defined(RADCAT_SIMD_NEON)
+        uint64x2_t acc = vdupq_n_u64(0);
+        for (; i + 2 <= n; i += 2) acc = vaddq_u64(acc, vld1q_u64(src + i));
+        total = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+    #endif
+        for (; i < n; ++i) total += src[i];
+        return total;
+    }
+
+    // dst[i] = src[i] widened to 32 bits, optionally negated (for negative-polarity detectors)
+    inline void widenI16(const int16_t* src, int32_t* dst, size_t n, bool invert) {
+        size_t i = 0;
+    #if defined(RADCAT_SIMD_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= n; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            if (invert) { lo = _mm_sub_epi32(zero, lo); hi = _mm_sub_epi32(zero, hi); }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), hi);
+        }
+    #elif defined(RADCAT_SIMD_NEON)
+        for (; i + 8 <= n; i += 8) {
+            int16x8_t v = vld1q_s16(src + i);
+            int32x4_t lo = vmovl_s16(vget_low_s16(v));
+            int32x4_t hi = vmovl_s16(vget_high_s16(v));
+            if (invert) { lo = vnegq_s32(lo); hi = vnegq_s32(hi); }
+            vst1q_s32(dst + i, lo);
+            vst1q_s32(dst + i + 4, hi);
+        }
+    #endif
+        for (; i < n; ++i) dst[i] = invert ? -static_cast<int32_t>(src[i]) : static_cast<int32_t>(src[i]);
+    }
+
+    // dst[i] = x[i] - x[i-k] - x[i-l] + x[i-k-l]  (trapezoidal shaper front end)
+    // x must have k + l valid samples of history in front of x[0].
+    inline void fourTapDiff(const int32_t* x, int32_t* dst, size_t n, size_t k, size_t l) {
+        size_t i = 0;
+    #if defined(RADCAT_SIMD_SSE2)
+        for (; i + 4 <= n; i += 4) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i - k));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i - l));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i - k - l));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(_mm_sub_epi32(a, b), _mm_sub_epi32(d, c)));
+        }
+    #elif defined(RADCAT_SIMD_NEON)
+        for (; i + 4 <= n; i += 4) {
+            int32x4_t a = vld1q_s32(x + i), b = vld1q_s32(x + i - k), c = vld1q_s32(x + i - l), d = vld1q_s32(x + i - k - l);
+            vst1q_s32(dst + i, vaddq_s32(vsubq_s32(a, b), vsubq_s32(d, c)));
+        }
+    #endif
+        for (; i < n; ++i) dst[i] = x[i] - x[i - k] - x[i - l] + x[i - k - l];
+    }
+
+    // Decodes big-endian byte pairs into ADC codes: codes[i] = ((raw[2i] << 8 | raw[2i+1]) >> shift) & mask
+    inline void decodeBigEndianPairs(const unsigned char* raw, uint16_t* codes, size_t pairs, int shift, uint16_t mask) {
+        size_t i = 0;
+    #if defined(RADCAT_SIMD_SSE2)
+        const __m128i vmask = _mm_set1_epi16(static_cast<short>(mask));
+        const __m128i vshift = _mm_cvtsi32_si128(shift);
+        for (; i + 8 <= pairs; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + 2 * i));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); // byte swap
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), _mm_and_si128(_mm_srl_epi16(v, vshift), vmask));
+        }
+    #elif defined(RADCAT_SIMD_NEON)
+        const uint16x8_t vmask = vdupq_n_u16(mask);
+        const int16x8_t vshift = vdupq_n_s16(static_cast<int16_t>(-shift));
+        for (; i + 8 <= pairs; i += 8) {
+            uint16x8_t v = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(raw + 2 * i)));
+            vst1q_u16(codes + i, vandq_u16(vshlq_u16(v, vshift), vmask));
+        }
+    #endif
+        for (; i < pairs; ++i) codes[i] = static_cast<uint16_t>(((raw[2 * i] << 8 | raw[2 * i + 1]) >> shift) & mask);
+    }
+
+}
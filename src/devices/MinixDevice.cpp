@@ -1,6 +1,11 @@
 #include "MiniXDevice.hpp"
 #include "ftd2xx.h"
 #include "Debug.hpp"
+#include "Utils/Simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
 
 REGISTER_DEVICE(MiniXDevice,"Mini-X");
 using namespace std;
@@ -37,14 +42,7 @@ Bit 7 (0x80): [Unused/Reserved]
 #define CLK_FN CLK_FN_NEG
 
 // MPSSE Commands
-#define CMD_SET_DATA_BITS_LOWBYTE   0x80    // Set Data Bits Low Byte
-#define CMD_SET_DATA_BITS_HIGHBYTE  0x82    // Set Data Bits High Byte
-#define CMD_GET_DATA_BITS_LOWBYTE   0x81    // Get Data Bits Low Byte
-#define CMD_GET_DATA_BITS_HIGHBYTE  0x83    // Get Data Bits High Byte
-#define CMD_SET_CLK_DIVISOR         0x86    // Set CLK divisor
-#define CMD_CLOCK_OUT_BITS_MSB      0x13    // Clock out bits, MSB first
-#define CMD_CLOCK_IN_BYTES_MSB      0x20    // Clock in bytes, MSB first
-#define CMD_CLOCK_OUT_BYTES_NEG     0x10    // Clock out bytes on negative edge, MSB first
+#define CMD_SEND_IMMEDIATE          0x87    // Flush the MPSSE read buffer back to the host
 
 // Pin/Port Definitions
 #define OUTPUTMODE                  0x7B    // Output mode mask
@@ -82,14 +80,10 @@ Bit 7 (0x80): [Unused/Reserved]
 #define CLK_DIVISOR_LOW             0x03    // Clock divisor low byte
 #define CLK_DIVISOR_HIGH            0x00    // Clock divisor high byte
 
-// Length Definitions
-#define LENGTH_1_BYTE               0x00    // 0=1byte
-#define LENGTH_2_BYTES              0x01    // 1=2bytes
-#define LENGTH_4_BITS               0x03    // 3=4bits
-
 #pragma endregion
 
 bool MiniXDevice::connect() {
+    registerChannels();
     if (!connection.fConnect()) return false;
     if (!initializeGPIOs()) return false;
     return true;
@@ -104,25 +98,42 @@ void MiniXDevice::update() {
 }
 
 void MiniXDevice::setupTasks() {
-    addTask([this]{ currentTemperature = readTemperature(); }, 1000);
-    addTask([this]{ currentCurrent = readCurrent(); }, 2000);
-    addTask([this]{ currentVoltage = readVoltage(); }, 3000);
+    addTask([this]{ currentTemperature = readTemperature(); temperaturePlot->push(currentTemperature); UdpHandler::Instance().sample(temperatureTelemetry, currentTemperature); }, 1000, "temperature");
+    addTask([this]{ currentCurrent = readCurrent(); currentPlot->push(currentCurrent); UdpHandler::Instance().sample(currentTelemetry, currentCurrent); }, 2000, "current");
+    addTask([this]{ currentVoltage = readVoltage(); voltagePlot->push(currentVoltage); UdpHandler::Instance().sample(voltageTelemetry, currentVoltage); }, 3000, "voltage");
+}
+
+// Named after the instance: every board gets its own traces and telemetry channels, and boards on one chip updating on parallel lanes
+// never push into the same single-producer ring
+void MiniXDevice::registerChannels() {
+    if (voltagePlot) return;
+    PlotFeed& feed = PlotFeed::Instance();
+    voltagePlot = feed.channel(instanceName + " HV (kV)");
+    currentPlot = feed.channel(instanceName + " Current (uA)");
+    temperaturePlot = feed.channel(instanceName + " Temperature (C)");
+    UdpHandler& telemetry = UdpHandler::Instance();
+    voltageTelemetry = telemetry.channel(voltagePlot->name);
+    currentTelemetry = telemetry.channel(currentPlot->name);
+    temperatureTelemetry = telemetry.channel(temperaturePlot->name);
 }
 
+// Latest readback of the periodic tasks, no bus traffic
 double MiniXDevice::readValue(const std::string& parameter) {
-    // Implement reading values based on the parameter
+    if (parameter == "voltage") return currentVoltage;
+    if (parameter == "current") return currentCurrent;
+    if (parameter == "temperature") return currentTemperature;
     return 0.0;
 }
 
 bool MiniXDevice::setValue(const std::string& parameter, double value) {
-    // Implement setting values based on the parameter
-    return true;
+    // The HV/current DAC is not programmed yet (setVoltage/setCurrent are not written, the DAC framing is unverified),
+    // refuse rather than report a setpoint that was never applied
+    Debug.Warn("Mini-X: setting ", parameter, " is not supported yet.");
+    return false;
 }
 
 bool MiniXDevice::initialize() {
     if (!setupTemperatureSensor()) return false;
-    if (!setupClockDivisor()) return false;
-    
 
     //setVoltage(0.0);
     //this_thread::sleep_for(chrono::milliseconds(200));
@@ -134,233 +145,119 @@ bool MiniXDevice::initialize() {
 
 // Minix Self Functions
 
-bool MiniXDevice::setupClockDivisor(){
-    unsigned char tx[10]; DWORD ret_bytes; int pos = 0;
-    setClockDivisor(tx, pos, 3);
-    FT_STATUS status = connection.sendData(tx, pos);
-    if (status != FT_OK) { Debug.Error("Error setting clock divisor: ", status); return false; }
-    if constexpr (debug) Debug.Log("Clock divisor set successfully.");
-    return true;
+// Chip selects and SPI modes of the board's peripherals. The bus keeps their chip selects inactive.
+void MiniXDevice::setupBus() {
+    adcDevice = bus.addDevice({ .select = { SpiBus::Port::Low, ADCS }, .mode = 0 });
+    dacDevice = bus.addDevice({ .select = { SpiBus::Port::Low, DACS }, .mode = 0 });
+    // DS1722: CE active high, latches its clock polarity with the clock low at CE, then runs with the clock idling high.
+    // Commands go out on the rising edge like the vendor sequence does.
+    temperatureSensor = bus.addDevice({ .select = { SpiBus::Port::High, TSCS }, .selectActiveHigh = true, .mode = 3,
+                                        .clockLowAtSelect = true, .writeEdge = SpiBus::Edge::Rising });
 }
 
 bool MiniXDevice::setupTemperatureSensor(){
-    unsigned char tx[100]; DWORD ret_bytes; int pos = 0;
-    setClockDivisor(tx, pos, 0);
-
-    //take TSCS low and clock 2 bytes of data into the Temp Sensor
-    tx[pos++] = 0x80;//Setup MPSSE Low byte I/O lines
-    CLEAR(LowByteHiLowState, CLKSTATE);//take CLock low
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    // set TS chip select high
-    tx[pos++] = 0x82;//Setup MPSSE High byte I/O lines
-    SET(HighByteHiLowState, TSCS);  //take chip select high
-    tx[pos++] = HighByteHiLowState;//1110 0011  hi/low state if output (clock & data init to high)
-    tx[pos++] = OUTPUTMODE_H;
-
-    //take TSCS low and clock 2 bytes of data into the Temp Sensor
-    tx[pos++] = 0x80;//Setup MPSSE Low byte I/O lines
-    CLEAR(LowByteHiLowState, CLKSTATE);//take CLock low
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    //take TSCS low and clock 2 bytes of data into the Temp Sensor
-    tx[pos++] = 0x80;//Setup MPSSE Low byte I/O lines
-    CLEAR(LowByteHiLowState, CLKSTATE);//take CLock low
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    //take TSCS low and clock 2 bytes of data into the Temp Sensor
-    tx[pos++] = 0x80;//Setup MPSSE Low byte I/O lines
-    SET(LowByteHiLowState, CLKSTATE);
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    tx[pos++] = 0x10;   //Clock out 2 bytes on positive edge, MSB first
-    tx[pos++] = 0x01;   //LengthL 0=1byte, 1=2bytes
-    tx[pos++] = 0x00;   //LengthH 
-    tx[pos++] = TSCONFIG; //set configuration register
-    tx[pos++] = TSCMD + 0x08;   // continuous convert, 12-bit res., no shutdown
-
-    // set TS chip select low
-    tx[pos++] = 0x82;//Setup MPSSE High byte I/O lines
-    CLEAR(HighByteHiLowState, TSCS);  //take chip select low
-    tx[pos++] = HighByteHiLowState;// 1110 0011  hi/low state if output (clock & data init to high)
-    tx[pos++] = OUTPUTMODE_H;
-
-    FT_STATUS status = connection.sendData(tx, pos);
-    if (status != FT_OK) { Debug.Error("Temperature Sensor setup error"); return false; }
+    const unsigned char config[] = { TSCONFIG, TSCMD + 0x08 }; // Configuration register: continuous convert, 12-bit res., no shutdown
+    bus.begin(temperatureSensor);
+    bus.write(config);
+    bus.end();
+    if (!bus.execute()) { Debug.Error("Temperature Sensor setup error"); return false; }
     return true;
 }
 
 double MiniXDevice::readVoltage() {
-    if (!connection.isDeviceOpen() || !connection.isMPSSEOn()) {Debug.Error("Device not open or MPSSE not enabled for temperature reading.");return -1.0;}
-    unsigned char tx[100], rx[100]; DWORD ret_bytes; int pos = 0;
-
-    setClockDivisor(tx, pos);
-    
-    // Start condition - take ADC clock enable low
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    LowByteHiLowState &= ~ADCS; // Clear ADCS bit (take ADC clock enable low)
-    LowByteHiLowState &= ~CLKSTATE; // Clear CLKSTATE (take clock low)
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    // Send control nibble - clock out 4 bits
-    tx[pos++] = CMD_CLOCK_OUT_BITS_MSB;
-    tx[pos++] = LENGTH_4_BITS;
-    tx[pos++] = AD0; // Voltage channel
-
-    // Set data direction to input
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = INPUTMODE;
-
-    // Read 2 bytes from A/D conversion
-    tx[pos++] = CMD_CLOCK_IN_BYTES_MSB;
-    tx[pos++] = LENGTH_2_BYTES;
-    tx[pos++] = LENGTH_1_BYTE; // LengthH
-
-    // Take ADCS back high
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    LowByteHiLowState |= ADCS; // Set ADCS bit (take ADC enable high)
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    // Send the command string
-    FT_STATUS status = connection.sendData(tx, pos);
-    if (status != FT_OK) {Debug.Error("HV ADC write command error: ", status);return -1.0;}
-    if (status == FT_OK) {Debug.Log("HV ADC write command sent successfully.");}
-
-    this_thread::sleep_for(chrono::milliseconds(50));
-
-    status = connection.receiveData(rx, 2, ret_bytes);
-    if (status != FT_OK) {Debug.Error("HV ADC read data status error: ", status);return -1.0;}
-    if (ret_bytes < 2) {Debug.Error("HV ADC too few data bytes returned: ", ret_bytes);return -1.0;}
-
-    // Convert ADC result to voltage (bit manipulation handled in utility)
-    double voltage = convertToVoltage(rx[0], rx[1]);
-
-    Debug.Log("Read voltage: " + std::to_string(voltage) + " kV");
+    AdcBurstResult burst = readVoltageBurst(adcOversampling);
+    if (!burst.ok) return -1.0;
+    double voltage = adcUseMedian ? burst.median : burst.mean;
+    if constexpr (debug) Debug.Log("Read voltage: ", voltage, " kV (", burst.samples, " samples, sigma ", burst.stdDev, ")");
     return voltage;
 }
 
 double MiniXDevice::readCurrent() {
-    if (!connection.isDeviceOpen() || !connection.isMPSSEOn()) {Debug.Error("Device not open or MPSSE not enabled for temperature reading.");return -1.0;}
-    unsigned char tx[100], rx[100]; DWORD ret_bytes; int pos = 0;
-
-    setClockDivisor(tx, pos);
-    
-    // Start condition - take ADC clock enable low
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    LowByteHiLowState &= ~ADCS; // Clear ADCS bit (take ADC clock enable low)
-    LowByteHiLowState &= ~CLKSTATE; // Clear CLKSTATE (take clock low)
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    // Send control nibble - clock out 4 bits
-    tx[pos++] = CMD_CLOCK_OUT_BITS_MSB;
-    tx[pos++] = LENGTH_4_BITS;
-    tx[pos++] = AD1; // Current channel
-
-    // Set data direction to input
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = INPUTMODE;
-
-    // Read 2 bytes from A/D conversion
-    tx[pos++] = CMD_CLOCK_IN_BYTES_MSB;
-    tx[pos++] = LENGTH_2_BYTES;
-    tx[pos++] = LENGTH_1_BYTE; // LengthH
-
-    // Take ADCS back high
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    LowByteHiLowState |= ADCS; // Set ADCS bit (take ADC enable high)
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-
-    // Send the command string
-    FT_STATUS status = connection.sendData(tx, pos);
-    if (status != FT_OK) {Debug.Error("Current ADC write command error: ", status);return -1.0;}
-    if constexpr (debug) Debug.Log("Current ADC write command sent successfully.");
-    this_thread::sleep_for(chrono::milliseconds(200));
-
-    // Read the reply
-    status = connection.receiveData(rx, 2, ret_bytes);
-    if (status != FT_OK) {Debug.Error("Current ADC read data status error: ", status);return -1.0;}
-    if (ret_bytes < 2) {Debug.Error("Current ADC too few data bytes returned: ", ret_bytes);return -1.0;}
-
-    double current = convertToCurrent(rx[0], rx[1]);
-
-    Debug.Log("Read current: " + std::to_string(current) + " uA");
+    AdcBurstResult burst = readCurrentBurst(adcOversampling);
+    if (!burst.ok) return -1.0;
+    double current = adcUseMedian ? burst.median : burst.mean;
+    if constexpr (debug) Debug.Log("Read current: ", current, " uA (", burst.samples, " samples, sigma ", burst.stdDev, ")");
     return current;
 }
 
+MiniXDevice::AdcBurstResult MiniXDevice::readVoltageBurst(int samples) { return lastVoltageBurst = readAdcBurst(AD0, samples, voltageTable); }
+
+MiniXDevice::AdcBurstResult MiniXDevice::readCurrentBurst(int samples) { return lastCurrentBurst = readAdcBurst(AD1, samples, currentTable); }
+
+// Queues `samples` complete ADC conversions back to back in one MPSSE command stream,
+// reads all code pairs in one go and reduces them to mean/median/noise statistics.
+MiniXDevice::AdcBurstResult MiniXDevice::readAdcBurst(unsigned char channel, int samples, const std::array<double, 4096>& table) {
+    AdcBurstResult result;
+    samples = std::clamp(samples, 1, MaxBurstSamples);
+
+    const size_t at = queueAdcBurst(channel, samples);
+    if (!bus.execute(AdcBurstTimeoutMs)) {Debug.Error("ADC burst failed.");return result;}
+
+    std::vector<double> values(samples);
+    convertWithTable(table, bus.reply().subspan(at, samples * 2), values);
+
+    double sum = 0.0;
+    result.min = result.max = values[0];
+    for (double v : values) { sum += v; result.min = std::min(result.min, v); result.max = std::max(result.max, v); }
+    result.mean = sum / samples;
+    double sq = 0.0;
+    for (double v : values) sq += (v - result.mean) * (v - result.mean);
+    result.stdDev = samples > 1 ? std::sqrt(sq / (samples - 1)) : 0.0;
+    std::nth_element(values.begin(), values.begin() + samples / 2, values.end());
+    result.median = values[samples / 2];
+    result.samples = samples;
+    result.ok = true;
+    return result;
+}
+
+// One conversion per sample. The bus sets the clock divisor once and the whole reply (2 bytes per sample)
+// comes back in one read. Returns the offset of the first sample in the bus reply.
+size_t MiniXDevice::queueAdcBurst(unsigned char channel, int samples) {
+    size_t first = 0;
+    for (int i = 0; i < samples; ++i) {
+        bus.begin(adcDevice);           // ADC chip select and clock low
+        bus.writeBits(channel, 4);      // Control nibble: start, single-ended, channel, MSB first
+        const size_t at = bus.read(2);  // Null bit, 12 data bits, 3 trailing bits
+        if (i == 0) first = at;
+        bus.end();                      // ADC chip select back high, ends this conversion
+    }
+    return first;
+}
+
+int MiniXDevice::buildAdcBurstCommands(unsigned char channel, int samples, std::span<unsigned char> tx) {
+    samples = std::clamp(samples, 1, MaxBurstSamples);
+    if (tx.size() < adcBurstCommandSize(samples)) return 0;
+    queueAdcBurst(channel, samples);
+    std::span<const uint8_t> commands = bus.queued();
+    std::copy(commands.begin(), commands.end(), tx.begin());
+    int pos = static_cast<int>(commands.size());
+    tx[pos++] = CMD_SEND_IMMEDIATE;
+    bus.discard();
+    return pos;
+}
+
 double MiniXDevice::readTemperature() {
-    if (!connection.isDeviceOpen() || !connection.isMPSSEOn()) {Debug.Error("Device not open or MPSSE not enabled for temperature reading.");return -1.0;}
-    unsigned char tx[100], rx[100]; DWORD ret_bytes; int pos = 0;
-
-    setClockDivisor(tx, pos, 3);
-    // Set TS chip select low (prepare for communication)
-    tx[pos++] = CMD_SET_DATA_BITS_HIGHBYTE;
-    CLEAR(HighByteHiLowState, TSCS);  // TS chip select low
-    tx[pos++] = HighByteHiLowState;
-    tx[pos++] = OUTPUTMODE_H;
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    CLEAR(LowByteHiLowState, CLKSTATE);
-    CLEAR(LowByteHiLowState, DATASTATE);
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-    activateTemperatureSensor(tx, pos, HighByteHiLowState);
-    tx[pos++] = CMD_SET_DATA_BITS_LOWBYTE;
-    SET(LowByteHiLowState, CLKSTATE);
-    CLEAR(LowByteHiLowState, DATASTATE);
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;
-    // Read cmd
-    tx[pos++] = 0x12; // Clock out bits, MSB first (different from 0x13!)
-    tx[pos++] = 0x07; // 7 = 8 bits - 1
-    tx[pos++] = 0x01; // CORRECT temp sensor command (not 0xE0!)
-    // Read 2 bytes from temperature sensor (CORRECT COMMAND!)
-    tx[pos++] = 0x20; // Clock IN bytes, MSB first (not CMD_CLOCK_IN_BYTES_MSB!)
-    tx[pos++] = LENGTH_2_BYTES;  // Read 2 bytes
-    tx[pos++] = LENGTH_1_BYTE;   // High byte = 0 (total = 2 bytes)
-    deactivateTemperatureSensor(tx, pos, HighByteHiLowState);
-
-    FT_STATUS status = connection.sendData(tx, pos);
-    if (status != FT_OK) {Debug.Error("Temperature sensor write command error: ", status);return -1.0;}
-    if constexpr (debug) Debug.Log("Temperature sensor write command sent successfully.");
-    this_thread::sleep_for(chrono::milliseconds());
-
-    status = connection.receiveData(rx, 2, ret_bytes);
-    if (status != FT_OK) {Debug.Error("Temperature sensor read data status error: ", status);return -1.0;}
-    if (ret_bytes < 2) {Debug.Error("Temperature sensor too few data bytes returned: ", ret_bytes);return -1.0;}
+    bus.begin(temperatureSensor);
+    bus.writeBits(TSLSB, 8);        // Read from the temperature LSB, the MSB follows by auto-increment
+    const size_t at = bus.read(2);
+    bus.end();
+    if (!bus.execute()) {Debug.Error("Temperature sensor read failed.");return -1.0;}
+    std::span<const uint8_t> rx = bus.reply().subspan(at, 2);
     // Process temperature result (different from ADC - direct MSB/LSB)
     double temperature = convertToTemperature(rx[1], rx[0], false); // Celsius
-    if constexpr (debug) Debug.Log("Read temperature: " + std::to_string(temperature) + " C");
+    if constexpr (debug) Debug.Log("Read temperature: ", temperature, " C");
     return temperature;
 }
 
 bool MiniXDevice::initializeGPIOs() {
-    unsigned char tx[100]; FT_STATUS status;
-    //initialize clock, data, and digital I/O on Low-Byte, 8-bit port 
-    int pos=0;
-    // set TS chip select low
-    tx[pos++] = 0x82;//Setup MPSSE High byte I/O lines
-    HighByteHiLowState = OUTPUTMODE_H;
-    CLEAR(HighByteHiLowState, TSCS);  //take chip select high
-    tx[pos++] = HighByteHiLowState; //1110 0011  hi/low state if output (clock & data init to high)
-    tx[pos++] = OUTPUTMODE_H;
-    tx[pos++] = 0x80;//Setup MPSSE Low byte I/O lines
-    LowByteHiLowState = 0xFB;//Initialize all high 1111 1011
-    //LowByteHiLowState = OUTPUTMODE;//Initialize 20071203
-    CLEAR(LowByteHiLowState, CTRL_HV_EN_A); //HVEN A disabled
-    CLEAR(LowByteHiLowState, CTRL_HV_EN_B); //HVEN B disabled
-    tx[pos++] = LowByteHiLowState;
-    tx[pos++] = OUTPUTMODE;//0xFB
-    status = connection.sendData(tx, pos);
-    if(status != FT_OK){printf("Error initializing I/O lines.\n");return false;}
+    // The device was just opened, whatever the bus remembers about its pins is stale
+    bus.invalidate();
+    unsigned char lowByte = 0xFB;//Initialize all high 1111 1011
+    CLEAR(lowByte, CTRL_HV_EN_A); //HVEN A disabled
+    CLEAR(lowByte, CTRL_HV_EN_B); //HVEN B disabled
+    bus.setPort(SpiBus::Port::High, 0x00, OUTPUTMODE_H); // TS chip select low
+    bus.setPort(SpiBus::Port::Low, lowByte, OUTPUTMODE);
+    if(!bus.execute()){printf("Error initializing I/O lines.\n");return false;}
     return true;
 }
 
@@ -381,6 +278,7 @@ void MiniXDevice::startingParameters() {
     SafeWattageMW = (double)((WattageMax - SafetyMargin) * 1000.0);
     TemperatureMax = 50.0;         // Temperature Max C
     TemperatureMin = 0.0;          // Temperature Min C 
+    rebuildConversionTables();
 }
 
 bool MiniXDevice::safetyChecks() {
@@ -403,43 +301,48 @@ bool MiniXDevice::safetyChecks() {
     return true;
 }
 
-void MiniXDevice::setClockDivisor(unsigned char* tx, int& pos, int clockDivisor) {
-        tx[pos++] = CMD_SET_CLK_DIVISOR;
-        tx[pos++] = clockDivisor & 0xFF;
-        tx[pos++] = (clockDivisor >> 8) & 0xFF;
+// The ADC answers with a null bit, 12 data bits and 3 trailing bits, MSB first.
+static constexpr int ADCCodeShift = 3;
+static constexpr uint16_t ADCCodeMask = 0x0FFF;
+
+void MiniXDevice::rebuildConversionTables() {
+    for (int code = 0; code < static_cast<int>(voltageTable.size()); ++code) {
+        double adcVolts = static_cast<double>(code) / DAC_ADC_Scale * VRef;
+        voltageTable[code] = adcVolts * HighVoltageConversionFactor;
+        currentTable[code] = adcVolts * CurrentConversionFactor;
     }
+}
 
-double MiniXDevice::convertToVoltage(unsigned char rx0, unsigned char rx1, double VRef, double DAC_ADC_Scale, double HighVoltageConversionFactor) {
-    // Extract 12-bit ADC value using original main.cpp bit manipulation
-    unsigned char msb = rx0 >> 3;
-    unsigned char lsb = ((rx0 & 0x07) << 5) | (rx1 >> 3);
-    int ivolts = (msb << 8) | lsb;
-    
-    // Convert ADC value to voltage using the reference voltage and scale
-    double voltage = (static_cast<double>(ivolts) / DAC_ADC_Scale * VRef) * HighVoltageConversionFactor;
+void MiniXDevice::setConversionParameters(double vRef, double highVoltageConversionFactor, double currentConversionFactor) {
+    VRef = vRef;
+    HighVoltageConversionFactor = highVoltageConversionFactor;
+    CurrentConversionFactor = currentConversionFactor;
+    rebuildConversionTables();
+}
 
-    Debug.Log("MSB: " + std::to_string(msb) + ", LSB: " + std::to_string(lsb) + 
-                ", ADC Value: " + std::to_string(ivolts) + 
-                ", Converted Voltage: " + std::to_string(voltage) + "V");
+double MiniXDevice::convertToVoltage(unsigned char rx0, unsigned char rx1) const {
+    return voltageTable[((rx0 << 8 | rx1) >> ADCCodeShift) & ADCCodeMask];
+}
 
-    return voltage;
-    }
+double MiniXDevice::convertToCurrent(unsigned char rx0, unsigned char rx1) const {
+    return currentTable[((rx0 << 8 | rx1) >> ADCCodeShift) & ADCCodeMask];
+}
 
-double MiniXDevice::convertToCurrent(unsigned char rx0, unsigned char rx1, double VRef, double DAC_ADC_Scale, double CurrentConversionFactor) {
-        // Extract 12-bit ADC value using original main.cpp bit manipulation
-        unsigned char msb = rx0 >> 3;
-        unsigned char lsb = ((rx0 & 0x07) << 5) | (rx1 >> 3);
-        int ivolts = (msb << 8) | lsb;
-        
-        // Convert ADC value to voltage first, then to current
-        double current = (static_cast<double>(ivolts) / DAC_ADC_Scale * VRef) * CurrentConversionFactor;
+void MiniXDevice::convertToVoltages(std::span<const unsigned char> raw, std::span<double> out) const { convertWithTable(voltageTable, raw, out); }
 
-        Debug.Log("MSB: " + std::to_string(msb) + ", LSB: " + std::to_string(lsb) + 
-                  ", ADC Value: " + std::to_string(ivolts) + 
-                  ", Converted Current: " + std::to_string(current) + "µA");
+void MiniXDevice::convertToCurrents(std::span<const unsigned char> raw, std::span<double> out) const { convertWithTable(currentTable, raw, out); }
 
-        return current;
+// Decodes codes in stack-sized chunks with the SIMD kernel, then maps them through the table.
+void MiniXDevice::convertWithTable(const std::array<double, 4096>& table, std::span<const unsigned char> raw, std::span<double> out) {
+    const size_t samples = std::min(raw.size() / 2, out.size());
+    uint16_t codes[256];
+    for (size_t done = 0; done < samples; ) {
+        const size_t chunk = std::min<size_t>(samples - done, std::size(codes));
+        Simd::decodeBigEndianPairs(raw.data() + 2 * done, codes, chunk, ADCCodeShift, ADCCodeMask);
+        for (size_t i = 0; i < chunk; ++i) out[done + i] = table[codes[i]];
+        done += chunk;
     }
+}
 
 double MiniXDevice::convertToTemperature(unsigned char MSB, unsigned char LSB, bool isF) {
         int tempRaw = (MSB << 4) + (LSB >> 4); double temp_c;
@@ -449,20 +352,3 @@ double MiniXDevice::convertToTemperature(unsigned char MSB, unsigned char LSB, b
         // Debug.Log("MSB: " + std::to_string(MSB) + ", LSB: " + std::to_string(LSB) + ", Raw 12-bit: " + std::to_string(tempRaw) + ", Temperature: " + std::to_string(temperature) + (isF ? "°F" : "°C"));
         return temperature;
     }
-
-void MiniXDevice::activateTemperatureSensor(unsigned char* tx, int& pos, unsigned char& HighByteHiLowState) {
-        tx[pos++] = CMD_SET_DATA_BITS_HIGHBYTE;
-        SET(HighByteHiLowState, TSCS); 
-        tx[pos++] = HighByteHiLowState;
-        tx[pos++] = OUTPUTMODE_H;
-        // Debug.Log("Activated temperature sensor (TSCS low).");
-}
-
-void MiniXDevice::deactivateTemperatureSensor(unsigned char* tx, int& pos, unsigned char& HighByteHiLowState) {
-        tx[pos++] = CMD_SET_DATA_BITS_HIGHBYTE;
-        CLEAR(HighByteHiLowState, TSCS);
-        tx[pos++] = HighByteHiLowState;
-        tx[pos++] = OUTPUTMODE_H;
-        // Debug.Log("Deactivated temperature sensor (TSCS high).");
-    }
-
@@ -1,11 +1,16 @@
 #pragma once
+#include <array>
+#include <span>
 #include "DeviceCore.hpp"
 #include "FTDIConnection.hpp"
+#include "SpiBus.hpp"
+#include "UI/PlotFeed.hpp"
+#include "UdpHandler.hpp"
 
-class MiniXDevice : public BaseDevice<FTDIConnection> {
+class MiniXDevice : public BaseDevice<FTDIConnection, SpiBus> {
 public:
     static constexpr bool debug = false;
-    MiniXDevice() : BaseDevice() { startingParameters(); setupTasks(); }
+    MiniXDevice() : BaseDevice() { startingParameters(); setupBus(); setupTasks(); }
     static inline const DeviceRegistry::RegistryEntry::DeviceInfo deviceInfo = {"Mini-X"};
 
     // Implement virtual methods
@@ -22,32 +27,68 @@ public:
     void setCurrent(double voltage);
     void setHVOnOff(bool on);
 
-    // Hardware State Variables
-    unsigned char LowByteHiLowState;
-    unsigned char HighByteHiLowState;
+    // Updates the ADC reference and conversion factors and rebuilds the conversion tables.
+    void setConversionParameters(double vRef, double highVoltageConversionFactor, double currentConversionFactor);
+
+    // Batched conversion: raw holds ADC byte pairs as clocked in (2 bytes per sample), out receives one value per pair.
+    // No logging and no per-sample floating point math, suitable for oversampled and streaming reads.
+    void convertToVoltages(std::span<const unsigned char> raw, std::span<double> out) const;
+    void convertToCurrents(std::span<const unsigned char> raw, std::span<double> out) const;
+
+    // Builds the MPSSE command stream of an ADC burst for channel (0xD0 voltage, 0xF0 current) into tx, without sending it.
+    // tx must hold adcBurstCommandSize(samples) bytes. Returns the command length, 0 if tx is too small.
+    static constexpr size_t adcBurstCommandSize(int samples) { return 3 + static_cast<size_t>(samples) * 12 + 1; }
+    int buildAdcBurstCommands(unsigned char channel, int samples, std::span<unsigned char> tx);
+
+    // Oversampled ADC readback. All conversions go out in one MPSSE command stream and come back in one read.
+    struct AdcBurstResult {
+        bool ok = false;
+        int samples = 0;
+        double mean = 0.0;
+        double median = 0.0;
+        double stdDev = 0.0; // Sample standard deviation, the readback noise
+        double min = 0.0;
+        double max = 0.0;
+    };
+    AdcBurstResult readVoltageBurst(int samples);
+    AdcBurstResult readCurrentBurst(int samples);
+    const AdcBurstResult& getLastVoltageBurst() const { return lastVoltageBurst; }
+    const AdcBurstResult& getLastCurrentBurst() const { return lastCurrentBurst; }
+
+    // Samples per periodic HV/current readback, and whether the median (instead of the mean) is reported.
+    int adcOversampling = 32;
+    bool adcUseMedian = false;
 
 private:
     bool initializeGPIOs();
+    void setupBus();
     void startingParameters();
     double readVoltage();
     double readCurrent();
     double readTemperature();
+    AdcBurstResult readAdcBurst(unsigned char channel, int samples, const std::array<double, 4096>& table);
+    size_t queueAdcBurst(unsigned char channel, int samples);
+    static constexpr int MaxBurstSamples = 256;  // 512 reply bytes, well inside the chip's RX buffer
+    static constexpr int AdcBurstTimeoutMs = 100;
     bool safetyChecks();
+    void registerChannels();
     bool setupTemperatureSensor();
-    bool setupClockDivisor();
-    void setClockDivisor(unsigned char* tx, int& pos, int clockDivisor = 3);
 
     // Conversion Utilities
-    double convertToVoltage(unsigned char rx0, unsigned char rx1, double VRef = 4.096, double DAC_ADC_Scale = 4096.0, double HighVoltageConversionFactor = 10.0);
-    double convertToCurrent(unsigned char rx0, unsigned char rx1, double VRef = 4.096, double DAC_ADC_Scale = 4096.0, double CurrentConversionFactor = 50.0);
+    double convertToVoltage(unsigned char rx0, unsigned char rx1) const;
+    double convertToCurrent(unsigned char rx0, unsigned char rx1) const;
     double convertToTemperature(unsigned char MSB, unsigned char LSB, bool isF = false);
-
-    // Temperature sensor control
-    void activateTemperatureSensor(unsigned char* tx, int& pos, unsigned char& HighByteHiLowState);
-    void deactivateTemperatureSensor(unsigned char* tx, int& pos, unsigned char& HighByteHiLowState);
+    void rebuildConversionTables();
+    static void convertWithTable(const std::array<double, 4096>& table, std::span<const unsigned char> raw, std::span<double> out);
 
     // Minix Components
     FTDIConnection& connection = getComponentRef<FTDIConnection>();
+    SpiBus& bus = getComponentRef<SpiBus>();
+
+    // Peripherals on the SPI bus, declared in setupBus()
+    int adcDevice = -1;
+    int dacDevice = -1;
+    int temperatureSensor = -1;
 
     // Minix-specific variables
     bool hvOn = false;
@@ -56,9 +97,21 @@ private:
     bool CurrentSetErr = false;
 
     // Minix Status Variables
-    double currentVoltage;
-    double currentCurrent;
-    double currentTemperature;
+    double currentVoltage = 0.0;
+    double currentCurrent = 0.0;
+    double currentTemperature = 0.0;
+    AdcBurstResult lastVoltageBurst;
+    AdcBurstResult lastCurrentBurst;
+
+    // Live plot channels, one set per instance. Registered by connect(), once the DeviceHandler has named the device.
+    std::shared_ptr<PlotChannel> voltagePlot;
+    std::shared_ptr<PlotChannel> currentPlot;
+    std::shared_ptr<PlotChannel> temperaturePlot;
+
+    // Telemetry channels, same names as the plots
+    uint16_t voltageTelemetry = 0;
+    uint16_t currentTelemetry = 0;
+    uint16_t temperatureTelemetry = 0;
 
     // Mini-X Configuration Parameters
     double DefaultHighVoltage;
@@ -77,4 +130,8 @@ private:
     double SafetyMargin;
     double SafeWattageMW;
 
+    // ADC code -> calibrated value, one entry per 12-bit code. Rebuilt whenever VRef or a conversion factor changes.
+    std::array<double, 4096> voltageTable{};
+    std::array<double, 4096> currentTable{};
+
 };
\ No newline at end of file
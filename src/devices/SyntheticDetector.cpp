@@ -0,0 +1,187 @@
+#include "SyntheticDetector.hpp"
+#include "Debug.hpp"
+#include "Simulation/SimulatedUsbBackend.hpp"
+#include <cstring>
+
+REGISTER_DEVICE(SyntheticDetector, "Synthetic Detector");
+
+SyntheticDetector::~SyntheticDetector() {
+    running = false;
+    if (acquisition.joinable()) acquisition.join();
+}
+
+bool SyntheticDetector::connect() {
+    if (running) return true;
+    if (!connection.isDeviceOpen()) { Debug.Error("Synthetic Detector: USB device not open"); return false; }
+    if (!connection.claimInterface(0)) return false;
+    registerChannels();
+
+    // Calibration matches the firmware defaults: list-mode channels and pulse heights both land on keV
+    const SyntheticDetectorModel::Config firmware;
+    histogram.configure(firmware.channels, 0.0, firmware.keVPerChannel);
+    PulseProcessor::Config shaping;
+    shaping.sampleRateHz = firmware.sampleRateHz;
+    shaping.riseSamples = 40;
+    shaping.flatTopSamples = 20;
+    shaping.fastRiseSamples = 8;
+    shaping.decaySamples = firmware.decaySamples;
+    shaping.threshold = 20.0;
+    shaping.energyGain = 1.0 / firmware.adcPerKeV;
+    pulses.configure(shaping);
+
+    if (!sendCommand(SyntheticWire::Reset, 0.0)) { connection.closeDevice(); return false; }
+    events = 0; bytes = 0; errors = 0; lastEvents = 0;
+    running = true;
+    acquisition = std::thread(&SyntheticDetector::acquisitionLoop, this);
+
+    isInitialized = true;
+    tasksActive = true;
+    if constexpr (debug) Debug.Log("Synthetic Detector connected.");
+    return true;
+}
+
+void SyntheticDetector::registerChannels() {
+    if (ratePlot) return;
+    ratePlot = PlotFeed::Instance().channel(instanceName + " Rate (cps)");
+    spectrum = PlotFeed::Instance().spectrum(instanceName + " Spectrum");
+    rateTelemetry = UdpHandler::Instance().channel(ratePlot->name);
+    eventTelemetry = UdpHandler::Instance().channel(instanceName + " Events (keV)");
+}
+
+bool SyntheticDetector::disconnect() {
+    tasksActive = false;
+    isInitialized = false;
+    running = false;
+    if (acquisition.joinable()) acquisition.join();
+    connection.closeDevice();
+    return true;
+}
+
+void SyntheticDetector::setupTasks() {
+    addTask([this]{
+        const uint64_t now = events.load(std::memory_order_relaxed);
+        measuredRate = static_cast<double>(now - lastEvents);
+        lastEvents = now;
+        ratePlot->push(measuredRate);
+        UdpHandler::Instance().sample(rateTelemetry, measuredRate);
+        const MCAHistogram::Snapshot snap = histogram.snapshot();
+        spectrum->publish(std::vector<double>(snap.counts.begin(), snap.counts.end()));
+    }, 1000, "rate");
+}
+
+double SyntheticDetector::readValue(const std::string& parameter) {
+    if (parameter == "countRate") return measuredRate;
+    if (parameter == "events") return static_cast<double>(events.load());
+    if (parameter == "bytes") return static_cast<double>(bytes.load());
+    if (parameter == "errors") return static_cast<double>(errors.load());
+    if (parameter == "totalCounts") return static_cast<double>(histogram.totalCounts());
+    return 0.0;
+}
+
+bool SyntheticDetector::setValue(const std::string& parameter, double value) {
+    if (parameter == "countRate") return sendCommand(SyntheticWire::SetCountRate, value);
+    if (parameter == "waveforms") {
+        if (!sendCommand(SyntheticWire::SetWaveforms, value != 0.0 ? 1.0 : 0.0)) return false;
+        waveformMode = value != 0.0;
+        return true;
+    }
+    if (parameter == "reset") {
+        if (!sendCommand(SyntheticWire::Reset, 0.0)) return false;
+        histogram.clear();
+        return true;
+    }
+    return false;
+}
+
+bool SyntheticDetector::sendCommand(SyntheticWire::Command command, double value) {
+    unsigned char tx[SyntheticWire::CommandBytes];
+    tx[0] = command;
+    std::memcpy(tx + 1, &value, sizeof(value));
+    int r = connection.sendData(SyntheticWire::CommandEndpoint, tx, sizeof(tx), TransferTimeoutMs);
+    if (r != static_cast<int>(sizeof(tx))) { Debug.Error("Synthetic Detector command ", static_cast<int>(command), " failed: ", r); return false; }
+    return true;
+}
+
+void SyntheticDetector::acquisitionLoop() {
+    std::vector<unsigned char> rx(TransferBytes);
+    std::vector<SyntheticWire::Event> decoded;
+    std::vector<int16_t> samples;
+    std::vector<PulseProcessor::PulseEvent> found;
+    UdpHandler& telemetry = UdpHandler::Instance();
+    bool wasWaveform = false;
+
+    while (running) {
+        const bool waveform = waveformMode.load(std::memory_order_relaxed);
+        if (waveform && !wasWaveform) pulses.reset(); // Fresh filter state, the firmware restarted its stream
+        wasWaveform = waveform;
+
+        const unsigned char endpoint = waveform ? SyntheticWire::WaveformEndpoint : SyntheticWire::ListModeEndpoint;
+        int n = connection.receiveData(endpoint, rx.data(), TransferBytes, TransferTimeoutMs);
+        if (n == LIBUSB_ERROR_TIMEOUT) continue; // Nothing happened, normal at low rates and while switching modes
+        if (n < 0) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            if (n == LIBUSB_ERROR_NO_DEVICE) { Debug.Error("Synthetic Detector unplugged, stopping acquisition"); break; }
+            continue;
+        }
+        bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+
+        if (!waveform) {
+            const size_t count = static_cast<size_t>(n) / SyntheticWire::EventBytes;
+            decoded.resize(count);
+            for (size_t i = 0; i < count; ++i) decoded[i] = SyntheticWire::decode(rx.data() + i * SyntheticWire::EventBytes);
+            if (eventSink) eventSink(decoded);
+            for (const SyntheticWire::Event& e : decoded) histogram.addChannel(e.channel);
+            if (telemetry.isRunning()) {
+                const uint64_t now = UdpHandler::now();
+                const MCAHistogram::Calibration cal = histogram.calibration();
+                const double offset = cal.energyOffset, gain = cal.energyPerBin;
+                for (const SyntheticWire::Event& e : decoded) telemetry.publish(eventTelemetry, UdpHandler::RecordKind::Event, e.channel, offset + gain * e.channel, now);
+            }
+            events.fetch_add(count, std::memory_order_relaxed);
+        }
+        else {
+            samples.resize(static_cast<size_t>(n) / sizeof(int16_t));
+            std::memcpy(samples.data(), rx.data(), samples.size() * sizeof(int16_t));
+            found.clear();
+            pulses.processBlock(samples, found);
+            for (const PulseProcessor::PulseEvent& e : found) histogram.addEvent(e.energy);
+            if (telemetry.isRunning()) {
+                const uint64_t now = UdpHandler::now();
+                for (const PulseProcessor::PulseEvent& e : found) telemetry.publish(eventTelemetry, UdpHandler::RecordKind::Event, e.pileUp ? 1 : 0, e.energy, now);
+            }
+            events.fetch_add(found.size(), std::memory_order_relaxed);
+        }
+    }
+}
+
+std::shared_ptr<SyntheticDetectorModel> SyntheticDetector::attachSimulated(SimulatedUsbBackend& usb, const SyntheticDetectorModel::Config& config,
+                                                                           const std::string& serial) {
+    auto model = std::make_shared<SyntheticDetectorModel>(config);
+
+    SimulatedUsbBackend::DeviceConfig cfg;
+    cfg.vid = SyntheticWire::Vid;
+    cfg.pid = SyntheticWire::Pid;
+    cfg.manufacturer = "RadCat";
+    cfg.product = "Synthetic Detector";
+    cfg.serial = serial;
+
+    SimulatedUsbBackend::Endpoint listMode;
+    listMode.address = SyntheticWire::ListModeEndpoint;
+    listMode.sourcePaced = true;
+    listMode.source = [model](uint8_t* data, size_t max) { return model->readListMode(data, max); };
+    cfg.endpoints.push_back(listMode);
+
+    SimulatedUsbBackend::Endpoint waveform;
+    waveform.address = SyntheticWire::WaveformEndpoint;
+    waveform.sourcePaced = true;
+    waveform.source = [model](uint8_t* data, size_t max) { return model->readWaveform(data, max); };
+    cfg.endpoints.push_back(waveform);
+
+    SimulatedUsbBackend::Endpoint commands;
+    commands.address = SyntheticWire::CommandEndpoint;
+    commands.sink = [model](const uint8_t* data, size_t size) { model->command(data, size); };
+    cfg.endpoints.push_back(commands);
+
+    usb.addDevice(cfg);
+    return model;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+#include "DeviceCore.hpp"
+#include "UsbConnection.hpp"
+#include "MCAHistogram.hpp"
+#include "PulseProcessor.hpp"
+#include "UI/PlotFeed.hpp"
+#include "UdpHandler.hpp"
+#include "Simulation/SyntheticDetectorModel.hpp"
+
+class SimulatedUsbBackend;
+
+// Virtual radiation detector for end-to-end load tests. It is a regular registered device: the scan finds it
+// on the (simulated) USB bus, connect() starts an acquisition thread that reads list-mode events or raw
+// waveforms over UsbConnection bulk transfers, and the data goes through PulseProcessor and MCAHistogram
+// like a real detector's would. Count rate and mode are set over the command endpoint.
+//
+// Usage:
+//   auto usb = std::make_unique<SimulatedUsbBackend>();
+//   SyntheticDetector::attachSimulated(*usb, SyntheticDetectorModel::cs137(), "SYN-001");
+//   LibUsbHandler::Instance().setBackend(std::move(usb)); // Before scanning
+class SyntheticDetector : public BaseDevice<UsbConnection, MCAHistogram, PulseProcessor> {
+public:
+    static constexpr bool debug = false;
+    SyntheticDetector() : BaseDevice() { setupTasks(); }
+    ~SyntheticDetector() override;
+    static inline const DeviceRegistry::RegistryEntry::DeviceInfo deviceInfo = {"Synthetic Detector", SyntheticWire::Vid, SyntheticWire::Pid};
+
+    // Implement virtual methods
+    virtual bool connect() override;
+    virtual bool disconnect() override;
+    virtual void setupTasks() override;
+    // countRate (measured, counts/s), events, bytes, errors, totalCounts
+    virtual double readValue(const std::string& parameter) override;
+    // countRate (counts/s), waveforms (0/1), reset
+    virtual bool setValue(const std::string& parameter, double value) override;
+
+    // Called from the acquisition thread with every list-mode block, before histogramming. Set before connect().
+    std::function<void(std::span<const SyntheticWire::Event>)> eventSink;
+
+    // Attaches a synthetic detector running the given model to a simulated bus. Returns the model, which
+    // the backend keeps alive, for inspecting what was generated and lost.
+    static std::shared_ptr<SyntheticDetectorModel> attachSimulated(SimulatedUsbBackend& usb, const SyntheticDetectorModel::Config& config,
+                                                                   const std::string& serial);
+
+private:
+    void acquisitionLoop();
+    bool sendCommand(SyntheticWire::Command command, double value);
+    void registerChannels();
+
+    // Whole 512-byte packets, whole 12-byte events and whole 2-byte samples, nothing is split across transfers
+    static constexpr int TransferBytes = 126 * 512;
+    static_assert(TransferBytes % 512 == 0 && TransferBytes % SyntheticWire::EventBytes == 0 && TransferBytes % sizeof(int16_t) == 0);
+    static constexpr unsigned int TransferTimeoutMs = 100;
+
+    // Components
+    UsbConnection& connection = getComponentRef<UsbConnection>();
+    MCAHistogram& histogram = getComponentRef<MCAHistogram>();
+    PulseProcessor& pulses = getComponentRef<PulseProcessor>();
+
+    // Acquisition state
+    std::thread acquisition;
+    std::atomic<bool> running{false};
+    std::atomic<bool> waveformMode{false};
+    std::atomic<uint64_t> events{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> errors{0};
+    uint64_t lastEvents = 0;
+    double measuredRate = 0.0;
+
+    // Live plot channels, one set per instance. Registered by connect(), once the DeviceHandler has named the device.
+    std::shared_ptr<PlotChannel> ratePlot;
+    std::shared_ptr<SpectrumChannel> spectrum;
+
+    // Telemetry channels: the rate once a second and every event with its energy in keV. List-mode events carry
+    // their ADC channel as the event code, waveform events their pile-up flag. Registered with the plot channels.
+    uint16_t rateTelemetry = 0;
+    uint16_t eventTelemetry = 0;
+};
@@ -8,7 +8,11 @@
 #include <algorithm>
 #include <chrono>
 #include "DeviceRegistry.hpp"
+#include "Debug.hpp"
+#include "Diagnostics/Metrics.hpp"
+#include "Diagnostics/Trace.hpp"
 #include "DeviceHandler.hpp"
+#include "Utils/SchedulerClock.hpp"
 
 
 // Device registration macro REGISTER_DEVICE(class, "Name")
@@ -62,6 +66,19 @@ public:
     // This flag should be set to true once the device has successfully connected and is ready for operation.
     bool isInitialized = false;
 
+    // Name of this instance in metrics and diagnostics. Set by the DeviceHandler when the device is activated.
+    std::string instanceName = "unnamed";
+
+    // Periodic tasks as the system sees them, for remote control and diagnostics.
+    struct TaskInfo {
+        std::string name;
+        int intervalMs;
+    };
+    virtual std::vector<TaskInfo> getTaskList() const = 0;
+
+    // Changes the interval of the named task, from its next run on. Returns false if the device has no such task.
+    virtual bool setTaskInterval(const std::string& name, int intervalMs) = 0;
+
     // Component Access For Systems and Handlers (Not For Device Use). 
     // As a device programmer, if you need component access inside device, use getComponentRef<T>() instead of this.
     template<typename T> T* systemGetComponent() { return static_cast<T*>(baseGetComponent(typeid(T))); }
@@ -89,6 +106,13 @@ private:
     // This function is called by the system every logic cycle.
     // Not for device programmer use. Use update() instead.
     virtual void systemUpdate() = 0;
+
+    // Earliest time a periodic task is due, time_point::max() if none will run. Lets the DeviceHandler
+    // sleep (or jump a virtual clock) straight to the next deadline.
+    virtual std::chrono::steady_clock::time_point nextTaskDue() const = 0;
+
+    // Time spent in systemUpdate(), set up by the DeviceHandler
+    Metrics::Histogram* updateTime = nullptr;
 };
 
 
@@ -97,6 +121,19 @@ struct PeriodicTask {
     std::chrono::steady_clock::time_point nextUpdate;
     int intervalMs;
     std::function<void()> task;
+    std::string name; // Shown in metrics and traces, defaults to task<index>
+    std::string traceName; // device:name
+
+    // Registered on the first run, once the device has its instance name
+    Metrics::Histogram* runTime = nullptr;
+    Metrics::Histogram* lateness = nullptr;
+    void registerMetrics(const std::string& deviceName) {
+        Metrics::Registry& reg = Metrics::Registry::Instance();
+        const Metrics::Labels labels = { {"device", deviceName}, {"task", name} };
+        runTime = &reg.histogram("radcat_task_run_seconds", "Periodic task execution time", labels);
+        lateness = &reg.histogram("radcat_task_lateness_seconds", "Periodic task start delay after its scheduled time", labels);
+        traceName = deviceName + ":" + name;
+    }
 };
 
 
@@ -143,14 +180,34 @@ public:
     };
 
     // Add a periodic task to be executed every intervalMs milliseconds.
-    void addTask(std::function<void()> func, int intervalMs) {
+    // The optional name identifies the task in metrics (run time, lateness).
+    void addTask(std::function<void()> func, int intervalMs, std::string name = {}) {
         PeriodicTask t;
         t.intervalMs = intervalMs;
         t.task = func;
-        t.nextUpdate = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
+        t.name = name.empty() ? "task" + std::to_string(tasks.size()) : std::move(name);
+        t.nextUpdate = SchedulerClock::current().now() + std::chrono::milliseconds(intervalMs);
         tasks.push_back(t);
     }
 
+    std::vector<TaskInfo> getTaskList() const override final {
+        std::vector<TaskInfo> list;
+        list.reserve(tasks.size());
+        for (const auto& t : tasks) list.push_back({ t.name, t.intervalMs });
+        return list;
+    }
+
+    // A shorter interval takes effect right away, a longer one after the run already scheduled
+    bool setTaskInterval(const std::string& name, int intervalMs) override final {
+        for (auto& t : tasks) {
+            if (t.name != name) continue;
+            t.intervalMs = intervalMs;
+            t.nextUpdate = std::min(t.nextUpdate, SchedulerClock::current().now() + std::chrono::milliseconds(intervalMs));
+            return true;
+        }
+        return false;
+    }
+
 protected:
     std::vector<PeriodicTask> tasks;
 
@@ -168,15 +225,29 @@ private:
         update();
         if (!tasksActive) return;
 
-        auto now = std::chrono::steady_clock::now();
+        auto now = SchedulerClock::current().now();
         for (auto& t : tasks) {
             if (now >= t.nextUpdate) {
+                if (!t.runTime) t.registerMetrics(instanceName);
+                t.lateness->record(now - t.nextUpdate);
+                if (now - t.nextUpdate > std::chrono::milliseconds(t.intervalMs))
+                    DEBUG_WARN(LogCategory::Task, "Periodic task ", t.name, " (", t.intervalMs, " ms) running ", std::chrono::duration_cast<std::chrono::milliseconds>(now - t.nextUpdate).count(), " ms late.");
+                RC_TRACE_SCOPE_DETAIL("task", "task", t.traceName);
+                Metrics::ScopedTimer runTimer(*t.runTime);
                 t.task();
                 t.nextUpdate = now + std::chrono::milliseconds(t.intervalMs);
             }
         }
     }
 
+    // Next deadline for the DeviceHandler, only counts tasks that systemUpdate() would run
+    virtual std::chrono::steady_clock::time_point nextTaskDue() const override final {
+        auto due = std::chrono::steady_clock::time_point::max();
+        if (!isInitialized || !tasksActive) return due;
+        for (const auto& t : tasks) due = std::min(due, t.nextUpdate);
+        return due;
+    }
+
     // Component Access For Systems and Handlers (Not For Device Use). 
     // As a device programmer, if you need component access inside device, use getComponentRef<T>() instead of this.
     void* baseGetComponent(const std::type_info& ti) override final {
@@ -0,0 +1,110 @@
+#include "DeviceHandler.hpp"
+#include "Debug.hpp"
+#include "MinixDevice.hpp"
+#include "CompHandlers/CaptureTransport.hpp"
+#include "Diagnostics/MpsseAnalyzer.hpp"
+#include "Diagnostics/TrafficCapture.hpp"
+#include "Simulation/SimulatedFTDITransport.hpp"
+#include "Utils/SchedulerClock.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// MpsseAnalyze: where an FTDI driver's USB time goes, from a traffic capture (RADCAT_CAPTURE=<file>).
+//
+// Decodes the MPSSE command streams of every captured FTDI device and reports round trips per logical
+// operation, redundant GPIO / clock divisor / clock mode commands, idle gaps and achieved throughput,
+// plus the most frequent operation shapes. See Diagnostics/MpsseAnalyzer.hpp.
+//
+// --simulate S captures S seconds of a simulated Mini-X on virtual time first and analyzes that,
+// to check what a driver change does to its traffic without hardware.
+//
+// Usage: MpsseAnalyze field.rcap [--op-gap-ms 2] [--top 8]
+//        MpsseAnalyze --simulate 60
+namespace {
+
+    struct Options {
+        std::string path;
+        double operationGapMs = 2.0;
+        int top = 8;
+        double simulateSeconds = 0.0;
+    };
+
+    void printUsage() {
+        std::cout << "Usage: MpsseAnalyze <capture.rcap> [options]\n"
+                     "  --op-gap-ms MS   Pause that separates two logical operations (default 2)\n"
+                     "  --top N          Operation shapes listed per device (default 8)\n"
+                     "  --simulate S     Capture S seconds of a simulated Mini-X (virtual time) and analyze it\n";
+    }
+
+    // Runs one Mini-X on the simulated FTDI bus under capture, like the application's logic loop would
+    bool captureSimulatedMiniX(const std::string& path, double seconds) {
+        VirtualClock clock;
+        SchedulerClock::install(&clock);
+        auto sim = std::make_unique<SimulatedFTDITransport>();
+        sim->addMiniX("MXSIM0");
+        FTDIHandler::Instance().setTransport(std::move(sim));
+        if (!TrafficCapture::Instance().start(path)) { SchedulerClock::install(nullptr); return false; }
+        FTDIHandler::Instance().wrapTransport([](std::unique_ptr<FTDITransport> inner) { return std::make_unique<CaptureFTDITransport>(std::move(inner)); });
+
+        bool ok = false;
+        {
+            DeviceHandler handler;
+            DeviceHandler::FoundDeviceInfo found;
+            found.connectionType = DeviceHandler::FoundDeviceInfo::ConnectionType::FTDI;
+            found.deviceRegistryEntry = &DeviceRegistry::registry()["Mini-X"];
+            found.FTDIScannedDeviceInfo = std::make_unique<FTDIHandler::ScannedDeviceInfo>();
+            found.FTDIScannedDeviceInfo->scanIndex = 0;
+            FTDIHandler::Instance().getTransport().getDeviceInfoDetail(0, found.FTDIScannedDeviceInfo->devInfo);
+            handler.activateDevice(found);
+            if (!handler.activeDevices.empty() && handler.activeDevices[0]->connect()) {
+                // Mini-X connect() leaves scheduling to the caller
+                handler.activeDevices[0]->isInitialized = true;
+                handler.activeDevices[0]->tasksActive = true;
+                handler.runUntil(clock.now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)));
+                handler.activeDevices[0]->disconnect();
+                ok = true;
+            }
+        }
+        TrafficCapture::Instance().stop();
+        SchedulerClock::install(nullptr);
+        if (!ok) std::cerr << "Simulated Mini-X did not connect\n";
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+        if (arg == "--op-gap-ms") opt.operationGapMs = std::atof(next().c_str());
+        else if (arg == "--top") opt.top = std::atoi(next().c_str());
+        else if (arg == "--simulate") opt.simulateSeconds = std::atof(next().c_str());
+        else if (!arg.empty() && arg[0] != '-' && opt.path.empty()) opt.path = arg;
+        else { printUsage(); return arg == "--help" || arg == "-h" ? 0 : 2; }
+    }
+    AsyncLogger::Instance().setConsoleOutput(false);
+
+    if (opt.simulateSeconds > 0.0) {
+        if (opt.path.empty()) opt.path = (std::filesystem::temp_directory_path() / "mpsse_simulated.rcap").string();
+        if (!captureSimulatedMiniX(opt.path, opt.simulateSeconds)) return 1;
+    }
+    if (opt.path.empty()) { printUsage(); return 2; }
+
+    Capture::File capture;
+    std::string error;
+    if (!Capture::load(opt.path, capture, &error)) { std::cerr << "Could not load " << opt.path << ": " << error << "\n"; return 1; }
+    if (capture.truncated) std::cerr << "Capture is truncated, analyzing what was written\n";
+    if (capture.droppedTransfers) std::cerr << capture.droppedTransfers << " transfers were dropped while capturing, counts are lower bounds\n";
+
+    MpsseAnalyzer::Options options;
+    options.operationGapNs = static_cast<uint64_t>(std::max(opt.operationGapMs, 0.0) * 1e6);
+    options.topShapes = static_cast<size_t>(std::max(opt.top, 0));
+    const std::vector<MpsseAnalyzer::DeviceReport> reports = MpsseAnalyzer::analyze(capture, options);
+    std::printf("%s: %zu FTDI device session(s), %zu transfers\n", opt.path.c_str(), reports.size(), capture.transfers.size());
+    MpsseAnalyzer::print(reports, stdout);
+    return 0;
+}
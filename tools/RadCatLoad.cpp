@@ -0,0 +1,418 @@
+#include "DeviceHandler.hpp"
+#include "AllComponents.hpp"
+#include "Debug.hpp"
+#include "MinixDevice.hpp"
+#include "SyntheticDetector.hpp"
+#include "Diagnostics/LogControl.hpp"
+#include "Simulation/SimulatedFTDITransport.hpp"
+#include "Simulation/SimulatedUsbBackend.hpp"
+#include "UI/PlotFeed.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+// RadCatLoad: headless scaling test of DeviceHandler with hundreds of simulated instruments.
+//
+// A fleet of simulated devices goes through the same phases as in the application: scan, activate,
+// connect and steady-state logic updates, driven by one logic loop like LogicManager::mainLoop(). A
+// consumer thread drains the plot feed at the UI frame rate. At the end the run reports task lateness
+// percentiles, logic cycle times, device update times, CPU, memory per device and plot queue depth.
+//
+// Fleet:
+//   --devices N     Load devices on the simulated USB bus: periodic tasks doing blocking bulk reads,
+//                   with intervals (10 ms to 5 s) and transfer latencies (125 us to 2 ms) mixed per device
+//   --detectors N   SyntheticDetectors in list mode, each with its own acquisition thread, at --rate cps
+//   --minix N       Mini-X boards on the simulated FTDI bus (MPSSE engine and board model)
+//
+// Usage: RadCatLoad --devices 500 --detectors 8 --rate 1e5 --duration 30
+namespace {
+
+    constexpr uint16_t LoadVid = SyntheticWire::Vid;
+    constexpr uint16_t LoadPid = 0x5D38;
+    constexpr unsigned char LoadEndpoint = 0x81;
+
+    // A generic instrument: a few periodic tasks, each reading a status block over USB and plotting one value.
+    class LoadDevice : public BaseDevice<UsbConnection> {
+    public:
+        static inline const DeviceRegistry::RegistryEntry::DeviceInfo deviceInfo = {"Load Device", LoadVid, LoadPid};
+
+        struct Profile {
+            std::vector<int> intervalsMs;
+            int readBytes = 64;
+        };
+        Profile profile;
+
+        bool connect() override {
+            if (!connection.isDeviceOpen() || !connection.claimInterface(0)) return false;
+            for (int interval : profile.intervalsMs) {
+                auto plot = PlotFeed::Instance().channel(instanceName + " " + std::to_string(interval) + " ms");
+                addTask([this, plot]{
+                    int n = connection.receiveData(LoadEndpoint, buffer.data(), profile.readBytes, 50);
+                    if (n < 0) { errors++; return; }
+                    plot->push(static_cast<double>(buffer[0]));
+                }, interval, std::to_string(interval) + "ms");
+            }
+            isInitialized = true;
+            tasksActive = true;
+            return true;
+        }
+        bool disconnect() override { tasksActive = false; isInitialized = false; connection.closeDevice(); return true; }
+        double readValue(const std::string& parameter) override { return parameter == "errors" ? static_cast<double>(errors) : 0.0; }
+        bool setValue(const std::string&, double) override { return false; }
+
+    private:
+        UsbConnection& connection = getComponentRef<UsbConnection>();
+        std::vector<unsigned char> buffer = std::vector<unsigned char>(4096);
+        uint64_t errors = 0;
+    };
+
+    REGISTER_DEVICE(LoadDevice, "Load Device");
+
+    // Mixes, picked per device with co-prime strides so intervals and latencies combine evenly
+    const std::vector<std::vector<int>> IntervalMixes = { {10}, {50, 1000}, {100, 500}, {250}, {1000, 2000, 5000} };
+    const std::vector<std::chrono::microseconds> LatencyMix = { std::chrono::microseconds(125), std::chrono::microseconds(500),
+                                                                std::chrono::microseconds(1000), std::chrono::microseconds(2000) };
+
+    struct Options {
+        int devices = 100;
+        int detectors = 4;
+        int minix = 0;
+        double rate = 1e4;
+        double warmupSeconds = 2.0;
+        double durationSeconds = 10.0;
+        int uiFps = 30;
+    };
+
+    // ---- Process statistics ----
+    double processCpuSeconds() {
+    #ifdef _WIN32
+        FILETIME created, exited, kernel, user;
+        GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+        auto seconds = [](const FILETIME& f) { return static_cast<double>((static_cast<uint64_t>(f.dwHighDateTime) << 32) | f.dwLowDateTime) * 1e-7; };
+        return seconds(kernel) + seconds(user);
+    #else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+    #endif
+    }
+
+    double threadCpuSeconds() {
+    #ifdef _WIN32
+        FILETIME created, exited, kernel, user;
+        GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user);
+        auto seconds = [](const FILETIME& f) { return static_cast<double>((static_cast<uint64_t>(f.dwHighDateTime) << 32) | f.dwLowDateTime) * 1e-7; };
+        return seconds(kernel) + seconds(user);
+    #else
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+    #endif
+    }
+
+    // Resident set size in bytes (peak RSS where the current value is not available)
+    double residentBytes() {
+    #ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return static_cast<double>(counters.WorkingSetSize);
+    #elif defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        long pages = 0, resident = 0;
+        statm >> pages >> resident;
+        return static_cast<double>(resident) * 4096.0;
+    #else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<double>(usage.ru_maxrss); // Bytes on macOS
+    #endif
+    }
+
+    // ---- UI stand-in ----
+    // Drains every plot channel at the frame rate like LivePlotWidget, and records how deep the rings were.
+    struct UiConsumer {
+        std::atomic<bool> running{true};
+        std::atomic<bool> measuring{false};
+        size_t maxChannelDepth = 0;     // Deepest single ring seen at a frame
+        size_t maxTotalDepth = 0;       // Most samples waiting over all rings at a frame
+        double totalDepthSum = 0.0;
+        uint64_t frames = 0;
+        uint64_t drained = 0;
+        std::shared_ptr<const std::vector<double>> lastSpectrum;
+
+        void run(int fps) {
+            std::vector<PlotSample> buffer(4096);
+            auto next = std::chrono::steady_clock::now();
+            while (running) {
+                next += std::chrono::microseconds(1000000 / fps);
+                std::this_thread::sleep_until(next);
+                size_t total = 0, deepest = 0;
+                uint64_t frameDrained = 0;
+                for (auto& channel : PlotFeed::Instance().channels()) {
+                    const size_t depth = channel->queued();
+                    total += depth;
+                    deepest = std::max(deepest, depth);
+                    size_t n;
+                    while ((n = channel->drain(buffer.data(), buffer.size())) > 0) frameDrained += n;
+                }
+                for (auto& spectrum : PlotFeed::Instance().spectra()) lastSpectrum = spectrum->latest();
+                if (!measuring) continue;
+                maxChannelDepth = std::max(maxChannelDepth, deepest);
+                maxTotalDepth = std::max(maxTotalDepth, total);
+                totalDepthSum += static_cast<double>(total);
+                drained += frameDrained;
+                frames++;
+            }
+        }
+    };
+
+    void printUsage() {
+        std::cout << "Usage: RadCatLoad [options]\n"
+                     "  --devices N      Simulated USB load devices with mixed task intervals and latencies (default 100)\n"
+                     "  --detectors N    SyntheticDetectors in list mode (default 4)\n"
+                     "  --rate CPS       Detector count rate (default 1e4)\n"
+                     "  --minix N        Simulated Mini-X boards on the FTDI bus (default 0)\n"
+                     "  --warmup S       Seconds of logic updates before measuring (default 2)\n"
+                     "  --duration S     Measured steady-state seconds (default 10)\n"
+                     "  --ui-fps N       Plot feed drain rate, 0 = no consumer (default 30)\n";
+    }
+
+    double seconds(uint64_t ns) { return static_cast<double>(ns) * 1e-9; }
+
+    void printHistogram(const char* label, const Metrics::Sample& s) {
+        std::printf("  %-26s n=%-10.0f p50 %9.3f ms  p90 %9.3f ms  p99 %9.3f ms  max %9.3f ms\n", label, s.value,
+                    seconds(s.p50) * 1e3, seconds(s.p90) * 1e3, seconds(s.p99) * 1e3, seconds(s.max) * 1e3);
+    }
+
+    std::vector<uint64_t> difference(std::vector<uint64_t> later, const std::vector<uint64_t>& earlier) {
+        for (size_t i = 0; i < later.size() && i < earlier.size(); ++i) later[i] -= earlier[i];
+        return later;
+    }
+
+    // Nanoseconds each device has spent in its logic updates so far (radcat_device_update_seconds), by label set
+    std::unordered_map<std::string, uint64_t> deviceUpdateNs(const Metrics::Registry& reg) {
+        std::unordered_map<std::string, uint64_t> out;
+        for (const Metrics::Sample& s : reg.snapshot())
+            if (s.kind == Metrics::Kind::Histogram && s.name == "radcat_device_update_seconds") out[s.labels] = s.sum;
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : std::string(); };
+        if (arg == "--devices") opt.devices = std::atoi(next().c_str());
+        else if (arg == "--detectors") opt.detectors = std::atoi(next().c_str());
+        else if (arg == "--rate") opt.rate = std::atof(next().c_str());
+        else if (arg == "--minix") opt.minix = std::atoi(next().c_str());
+        else if (arg == "--warmup") opt.warmupSeconds = std::atof(next().c_str());
+        else if (arg == "--duration") opt.durationSeconds = std::atof(next().c_str());
+        else if (arg == "--ui-fps") opt.uiFps = std::atoi(next().c_str());
+        else { printUsage(); return arg == "--help" || arg == "-h" ? 0 : 2; }
+    }
+    opt.devices = std::max(opt.devices, 0);
+    opt.detectors = std::max(opt.detectors, 0);
+    opt.minix = std::max(opt.minix, 0);
+
+    // Errors only, on the log file. A fleet this size would otherwise measure the console.
+    AsyncLogger::Instance().setConsoleOutput(false);
+    LogControl::configure("*=1");
+    Trace::setThreadName("logic");
+
+    const double rssStart = residentBytes();
+
+    // ---- Simulated buses ----
+    auto usb = std::make_unique<SimulatedUsbBackend>();
+    for (int i = 0; i < opt.devices; ++i) {
+        SimulatedUsbBackend::DeviceConfig cfg;
+        cfg.vid = LoadVid;
+        cfg.pid = LoadPid;
+        cfg.product = "Load Device";
+        cfg.serial = "LD" + std::to_string(i);
+        SimulatedUsbBackend::Endpoint in;
+        in.address = LoadEndpoint;
+        in.latency = LatencyMix[static_cast<size_t>(i) % LatencyMix.size()];
+        cfg.endpoints.push_back(in);
+        usb->addDevice(cfg);
+    }
+    for (int i = 0; i < opt.detectors; ++i) {
+        SyntheticDetectorModel::Config cfg = i % 2 ? SyntheticDetectorModel::co60() : SyntheticDetectorModel::cs137();
+        cfg.countRate = opt.rate;
+        cfg.seed = static_cast<uint32_t>(i + 1);
+        SyntheticDetector::attachSimulated(*usb, cfg, "SYN" + std::to_string(i));
+    }
+    LibUsbHandler::Instance().setBackend(std::move(usb));
+
+    auto ftdi = std::make_unique<SimulatedFTDITransport>();
+    for (int i = 0; i < opt.minix; ++i) ftdi->addMiniX("MX" + std::to_string(i));
+    SimulatedFTDITransport* ftdiSim = ftdi.get();
+    FTDIHandler::Instance().setTransport(std::move(ftdi));
+
+    DeviceHandler handler;
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+    // ---- Scan ----
+    auto phase = Clock::now();
+    handler.deviceScan();
+    const double scanMs = elapsedMs(phase);
+    const size_t scanned = handler.foundDevices.size();
+
+    // The Mini-X registry entry only carries a name, which is below the scan's match threshold. Its boards
+    // are listed the way a match would list them.
+    for (int i = 0; i < opt.minix; ++i) {
+        DeviceHandler::FoundDeviceInfo found;
+        found.connectionType = DeviceHandler::FoundDeviceInfo::ConnectionType::FTDI;
+        found.deviceRegistryEntry = &DeviceRegistry::registry()["Mini-X"];
+        found.FTDIScannedDeviceInfo = std::make_unique<FTDIHandler::ScannedDeviceInfo>();
+        found.FTDIScannedDeviceInfo->scanIndex = i;
+        ftdiSim->getDeviceInfoDetail(static_cast<DWORD>(i), found.FTDIScannedDeviceInfo->devInfo);
+        handler.foundDevices.push_back(std::move(found));
+    }
+
+    // ---- Activate ----
+    phase = Clock::now();
+    for (auto& found : handler.foundDevices) handler.activateDevice(found);
+    const double activateMs = elapsedMs(phase);
+
+    // ---- Connect ----
+    phase = Clock::now();
+    int connected = 0, loadIndex = 0;
+    for (auto& device : handler.activeDevices) {
+        if (auto* load = dynamic_cast<LoadDevice*>(device.get())) {
+            load->profile.intervalsMs = IntervalMixes[static_cast<size_t>(loadIndex) * 3 % IntervalMixes.size()];
+            loadIndex++;
+        }
+        if (!device->connect()) continue;
+        // Drivers that leave the flags to the caller get them set here, the way the UI would have to
+        device->isInitialized = true;
+        device->tasksActive = true;
+        connected++;
+    }
+    const double connectMs = elapsedMs(phase);
+    const double rssConnected = residentBytes();
+
+    // ---- Steady state ----
+    UiConsumer ui;
+    std::thread uiThread;
+    if (opt.uiFps > 0) uiThread = std::thread([&ui, fps = opt.uiFps]{ Trace::setThreadName("ui"); ui.run(fps); });
+
+    Metrics::Registry& reg = Metrics::Registry::Instance();
+    Metrics::Histogram& cycleTime = reg.histogram("radcat_load_cycle_seconds", "One deviceLogicUpdate() over the whole fleet");
+    auto runLogic = [&](double forSeconds) {
+        const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(forSeconds));
+        uint64_t cycles = 0;
+        while (Clock::now() < end) {
+            Metrics::ScopedTimer t(cycleTime);
+            handler.deviceLogicUpdate();
+            cycles++;
+        }
+        return cycles;
+    };
+
+    runLogic(opt.warmupSeconds);
+
+    const auto latenessBefore = reg.histogramTotals("radcat_task_lateness_seconds");
+    const auto runBefore = reg.histogramTotals("radcat_task_run_seconds");
+    const auto cycleBefore = reg.histogramTotals("radcat_load_cycle_seconds");
+    const auto updateBefore = reg.histogramTotals("radcat_device_update_seconds");
+    const auto deviceUpdateBefore = deviceUpdateNs(reg);
+    const double cpuBefore = processCpuSeconds();
+    const double logicCpuBefore = threadCpuSeconds();
+    const Clock::time_point measureStart = Clock::now();
+    std::vector<double> detectorEventsBefore;
+    for (auto& device : handler.activeDevices) if (dynamic_cast<SyntheticDetector*>(device.get())) detectorEventsBefore.push_back(device->readValue("events"));
+    ui.measuring = true;
+
+    const uint64_t cycles = runLogic(opt.durationSeconds);
+
+    ui.measuring = false;
+    const double wallSeconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+    const double cpuSeconds = processCpuSeconds() - cpuBefore;
+    const double logicCpuSeconds = threadCpuSeconds() - logicCpuBefore;
+    const Metrics::Sample lateness = Metrics::Registry::summarize("lateness", difference(reg.histogramTotals("radcat_task_lateness_seconds"), latenessBefore));
+    const Metrics::Sample taskRun = Metrics::Registry::summarize("run", difference(reg.histogramTotals("radcat_task_run_seconds"), runBefore));
+    const Metrics::Sample cycle = Metrics::Registry::summarize("cycle", difference(reg.histogramTotals("radcat_load_cycle_seconds"), cycleBefore));
+    const Metrics::Sample update = Metrics::Registry::summarize("update", difference(reg.histogramTotals("radcat_device_update_seconds"), updateBefore));
+
+    // Share of the run each device spent in its updates, sorted for percentiles. Includes blocking transfers, and
+    // lane devices overlap, so the shares add up to more than the logic thread's CPU.
+    std::vector<double> updateShare;
+    for (const auto& [labels, ns] : deviceUpdateNs(reg)) {
+        auto before = deviceUpdateBefore.find(labels);
+        updateShare.push_back(seconds(ns - (before == deviceUpdateBefore.end() ? 0 : before->second)) / wallSeconds * 100.0);
+    }
+    std::sort(updateShare.begin(), updateShare.end());
+    auto sharePercentile = [&](double q) { return updateShare.empty() ? 0.0 : updateShare[std::min(updateShare.size() - 1, static_cast<size_t>(q * updateShare.size()))]; };
+    const double rssEnd = residentBytes();
+
+    double detectorEvents = 0.0;
+    size_t detectorIndex = 0;
+    for (auto& device : handler.activeDevices)
+        if (dynamic_cast<SyntheticDetector*>(device.get())) detectorEvents += device->readValue("events") - detectorEventsBefore[detectorIndex++];
+
+    uint64_t droppedSamples = 0;
+    for (auto& channel : PlotFeed::Instance().channels()) droppedSamples += channel->droppedSamples();
+
+    if (uiThread.joinable()) { ui.running = false; uiThread.join(); }
+    for (auto& device : handler.activeDevices) device->disconnect();
+
+    // ---- Report ----
+    const double fleet = static_cast<double>(std::max<size_t>(handler.activeDevices.size(), 1));
+    // Number of ticks the fleet asked for: every task once per interval
+    double expectedRuns = 0.0;
+    for (auto& device : handler.activeDevices)
+        if (auto* load = dynamic_cast<LoadDevice*>(device.get()))
+            for (int interval : load->profile.intervalsMs) expectedRuns += wallSeconds * 1000.0 / interval;
+
+    std::printf("RadCatLoad: %d load devices, %d detectors at %.0f cps, %d Mini-X\n", opt.devices, opt.detectors, opt.rate, opt.minix);
+    std::printf("\nPhases\n");
+    std::printf("  scan      %10.1f ms  %zu matched\n", scanMs, scanned);
+    std::printf("  activate  %10.1f ms  %zu active\n", activateMs, handler.activeDevices.size());
+    std::printf("  connect   %10.1f ms  %d connected\n", connectMs, connected);
+    std::printf("\nSteady state (%.1f s after %.1f s warm-up)\n", wallSeconds, opt.warmupSeconds);
+    printHistogram("task lateness", lateness);
+    printHistogram("task run time", taskRun);
+    printHistogram("logic cycle", cycle);
+    printHistogram("device update", update);
+    std::printf("  %-26s %.0f (load device tasks due: %.0f)\n", "task runs", lateness.value, expectedRuns);
+    std::printf("  %-26s %.0f cycles/s\n", "logic rate", static_cast<double>(cycles) / wallSeconds);
+    if (opt.detectors > 0) std::printf("  %-26s %.0f events/s\n", "detector throughput", detectorEvents / wallSeconds);
+    std::printf("\nCPU\n");
+    std::printf("  %-26s %6.1f %% of one core\n", "process", cpuSeconds / wallSeconds * 100.0);
+    std::printf("  %-26s %6.1f %% of one core\n", "logic thread", logicCpuSeconds / wallSeconds * 100.0);
+    std::printf("  %-26s p50 %6.3f %%  p90 %6.3f %%  p99 %6.3f %%  max %6.3f %% of the run\n", "update time per device",
+                sharePercentile(0.5), sharePercentile(0.9), sharePercentile(0.99), updateShare.empty() ? 0.0 : updateShare.back());
+    std::printf("\nMemory\n");
+    std::printf("  %-26s %8.1f MiB\n", "before devices", rssStart / (1 << 20));
+    std::printf("  %-26s %8.1f MiB\n", "after connect", rssConnected / (1 << 20));
+    std::printf("  %-26s %8.1f MiB\n", "end of run", rssEnd / (1 << 20));
+    std::printf("  %-26s %8.1f KiB\n", "per device", (rssEnd - rssStart) / fleet / 1024.0);
+    std::printf("\nPlot feed (UI queue)\n");
+    if (opt.uiFps > 0 && ui.frames > 0) {
+        std::printf("  %-26s %zu channels, %llu frames at %d fps\n", "consumer", PlotFeed::Instance().channels().size(), static_cast<unsigned long long>(ui.frames), opt.uiFps);
+        std::printf("  %-26s mean %.1f  max %zu samples\n", "queued per frame", ui.totalDepthSum / static_cast<double>(ui.frames), ui.maxTotalDepth);
+        std::printf("  %-26s %zu samples\n", "deepest channel", ui.maxChannelDepth);
+        std::printf("  %-26s %.0f samples/s\n", "drained", static_cast<double>(ui.drained) / wallSeconds);
+    }
+    else std::printf("  no consumer (--ui-fps 0)\n");
+    std::printf("  %-26s %llu samples\n", "dropped (full rings)", static_cast<unsigned long long>(droppedSamples));
+    return 0;
+}